@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+
+# This script combines the codec (nanostream.h, nanostream.c and the
+# basis layouts it uses) into nanostream_single.h, a header that can be
+# dropped into another project in the style of the stb libraries:
+#
+#   #define NANOSTREAM_IMPLEMENTATION
+#   #include "nanostream_single.h"
+#
+# in one source file provides the definitions. Defining
+# NANOSTREAM_STATIC as well makes the functions static inline, so that
+# the compiler can inline the codec into the caller's own loops without
+# link time optimization.
+#
+# The internal functions, tables and macros of nanostream.c are given
+# a nanostream__ prefix or undefined at the end of the implementation,
+# so that they cannot collide with the names of the including file.
+
+import argparse
+import re
+from pathlib import Path
+
+PUBLIC_FUNCTION = re.compile(r'^(\s*)(void|int|unsigned char) (nanostream_\w+)\(', re.M)
+PUBLIC_DEFINITION = re.compile(r'^(void|int|unsigned char)\n(nanostream_\w+)\(', re.M)
+STATIC_FUNCTION = re.compile(r'^static [\w ]+\n(\w+)\(', re.M)
+LOCAL_INCLUDE = re.compile(r'^#include "[^"]+"\n', re.M)
+SYSTEM_INCLUDE = re.compile(r'^#include <([^>]+)>\n', re.M)
+DEFINE = re.compile(r'^#define (\w+)', re.M)
+
+def strip_pragma(text: str) -> str:
+    return text.replace('#pragma once\n', '').strip() + '\n'
+
+def rename(text: str, names: list[str], prefix: str) -> str:
+    for name in names:
+        text = re.sub(r'\b' + name + r'\b', prefix + name, text)
+    return text
+
+def declarations(header: str) -> str:
+    return PUBLIC_FUNCTION.sub(r'\1NANOSTREAM_DEF \2 \3(', strip_pragma(header))
+
+def implementation(source: str, layouts_header: str, layouts: str) -> tuple[str, list[str]]:
+    includes = sorted(set(SYSTEM_INCLUDE.findall(source)))
+    source = SYSTEM_INCLUDE.sub('', LOCAL_INCLUDE.sub('', source)).strip() + '\n'
+    source = PUBLIC_DEFINITION.sub(r'NANOSTREAM_DEF \1\n\2(', source)
+
+    # Only the macros of the layout header are needed; the tables are defined right after them.
+    layout_macros = '\n'.join(line for line in strip_pragma(layouts_header).split('\n') if not line.startswith('extern'))
+    layout_macros = re.sub(r'\n{3,}', '\n\n', layout_macros).strip() + '\n'
+    tables = LOCAL_INCLUDE.sub('', layouts).strip() + '\n'
+    tables = re.sub(r'^const ', 'static const ', tables, flags=re.M)
+    tables = re.sub(r'^/\* Generated by [^*]*\*/\n+', '', tables)
+
+    body = layout_macros + '\n' + tables + '\n' + source
+
+    table_names = re.findall(r'^static const \w+ (\w+)\[', tables, re.M)
+    helper_names = STATIC_FUNCTION.findall(source)
+    for name in table_names:
+        body = re.sub(r'\b' + name + r'\b', 'nanostream__' + name[len('nanostream_'):], body)
+    body = rename(body, helper_names, 'nanostream__')
+
+    macros = [m for m in DEFINE.findall(body) if not m.startswith('NANOSTREAM_')]
+    macros += [m for m in DEFINE.findall(layout_macros)]
+    undefs = ''.join(f'#undef {name}\n' for name in macros)
+    return body + '\n' + undefs, includes
+
+def write_single_header(path: Path, header: str, source: str, layouts_header: str, layouts: str) -> None:
+    impl, includes = implementation(source, layouts_header, layouts)
+    include_lines = ''.join(f'#include <{name}>\n' for name in includes)
+
+    text = f'''/* Generated by amalgamate.py from nanostream.h, nanostream.c and nanostream_layouts.c.
+ *
+ * Single header version of the nanostream codec. In exactly one source file, write
+ *
+ *   #define NANOSTREAM_IMPLEMENTATION
+ *   #include "nanostream_single.h"
+ *
+ * Define NANOSTREAM_STATIC as well to make every function static inline, so the codec can be inlined into the
+ * including file without link time optimization. In that case, each file that uses the codec defines both. */
+
+#ifndef NANOSTREAM_SINGLE_H
+#define NANOSTREAM_SINGLE_H
+
+#ifdef NANOSTREAM_STATIC
+#define NANOSTREAM_DEF static inline
+#else
+#define NANOSTREAM_DEF extern
+#endif
+
+{declarations(header)}
+#endif /* NANOSTREAM_SINGLE_H */
+
+#if defined(NANOSTREAM_IMPLEMENTATION) && !defined(NANOSTREAM_SINGLE_IMPLEMENTATION)
+#define NANOSTREAM_SINGLE_IMPLEMENTATION
+
+{include_lines}
+#ifdef __cplusplus
+extern "C"
+{{
+#endif
+
+{impl}
+#ifdef __cplusplus
+}} /* extern "C" */
+#endif
+
+#endif /* NANOSTREAM_IMPLEMENTATION */
+'''
+    path.write_text(text, encoding='utf-8')
+
+def main() -> None:
+    ap = argparse.ArgumentParser()
+    ap.add_argument('--output', type=Path, default=Path('nanostream_single.h'))
+    args = ap.parse_args()
+
+    def read(name: str) -> str:
+        return Path(name).read_text(encoding='utf-8')
+
+    write_single_header(args.output,
+                        read('nanostream.h'),
+                        read('nanostream.c'),
+                        read('nanostream_layouts.h'),
+                        read('nanostream_layouts.c'))
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+
+# This script rearranges the basis in nanostream_eigen.c into the
+# layouts the encoder and decoder kernels in nanostream.c stream
+# through, and writes them to nanostream_layouts.c. The basis in
+# nanostream_eigen.c is planar: channel, then row, then column. Every
+# layout here is in the interleaved order of packed RGB pixels (row,
+# then column, then channel), so an 8x8 block is read and written as
+# eight runs of 24 bytes with no deinterleaving.
+#
+#  - nanostream_basis_aosoa: for the encoder, groups of LANES
+#    consecutive values, and for each group the LANES entries of each
+#    basis vector, prescaled by 1/255 so that 8-bit pixels can be
+#    projected directly. nanostream_mean_projection holds the
+#    projection of the mean block, which is subtracted once per block
+#    instead of from every pixel.
+#  - nanostream_basis_interleaved: for the decoder, each basis vector
+#    in interleaved order, prescaled by 255 along with
+#    nanostream_mean_interleaved, so a block is reconstructed in 0..255
+#    by adding scaled rows and converted to bytes in one pass.
+#  - nanostream_basis_half and nanostream_mean_half: the same as the
+#    interleaved layout, for the means of each 2x2 cell of a block,
+#    which is all the half resolution decoder needs.
+
+import argparse
+import re
+from pathlib import Path
+
+D: int = 3 * 8 * 8
+BLOCK: int = 8
+HALF: int = BLOCK // 2
+
+# Must match NANOSTREAM_BASIS_LANES in nanostream_layouts.h.
+LANES: int = 8
+
+def parse_float_array(text: str, name: str) -> list[float]:
+    match = re.search(name + r'\[[^=]*=\s*\{(.*?)\};', text, re.S)
+    if match is None:
+        raise ValueError(f'{name} was not found')
+    return [float(v.rstrip('f')) for v in re.findall(r'[-+]?\d+\.\d+e[-+]\d+f', match.group(1))]
+
+def planar_index(c: int, y: int, x: int) -> int:
+    return c * BLOCK * BLOCK + y * BLOCK + x
+
+def interleaved_order() -> list[int]:
+    return [planar_index(c, y, x) for y in range(BLOCK) for x in range(BLOCK) for c in range(3)]
+
+def format_c_float(x: float) -> str:
+    return f'{x:.9e}f'
+
+def write_array(lines: list[str], declaration: str, rows: list[list[float]]) -> None:
+    lines.append(f'{declaration} = {{')
+    if len(rows) == 1:
+        lines.append('  ' + ', '.join(format_c_float(v) for v in rows[0]))
+    else:
+        for row in rows:
+            lines.append('  { ' + ', '.join(format_c_float(v) for v in row) + ' },')
+    lines.append('};')
+    lines.append('')
+
+def write_layouts(path: Path, mean: list[float], basis: list[list[float]]) -> None:
+    k = len(basis)
+    order = interleaved_order()
+
+    aosoa = []
+    for g in range(0, D, LANES):
+        aosoa.append([basis[i][order[g + lane]] / 255.0 for i in range(k) for lane in range(LANES)])
+
+    projection = [sum(mean[j] * basis[i][j] for j in range(D)) for i in range(k)]
+
+    interleaved = [[255.0 * basis[i][j] for j in order] for i in range(k)]
+    mean_interleaved = [255.0 * mean[j] for j in order]
+
+    def cell(values: list[float], c: int, y: int, x: int) -> float:
+        return 0.25 * sum(values[planar_index(c, 2 * y + dy, 2 * x + dx)] for dy in range(2) for dx in range(2))
+
+    cells = [(c, y, x) for y in range(HALF) for x in range(HALF) for c in range(3)]
+    basis_half = [[255.0 * cell(basis[i], c, y, x) for (c, y, x) in cells] for i in range(k)]
+    mean_half = [255.0 * cell(mean, c, y, x) for (c, y, x) in cells]
+
+    lines: list[str] = []
+    lines.append('/* Generated by basis_layouts.py from nanostream_eigen.c. */')
+    lines.append('')
+    lines.append('#include "nanostream_layouts.h"')
+    lines.append('')
+    write_array(lines, 'const float nanostream_basis_aosoa[NANOSTREAM_BASIS_GROUPS][8 * NANOSTREAM_BASIS_LANES]', aosoa)
+    write_array(lines, 'const float nanostream_mean_projection[8]', [projection])
+    write_array(lines, 'const float nanostream_basis_interleaved[8][192]', interleaved)
+    write_array(lines, 'const float nanostream_mean_interleaved[192]', [mean_interleaved])
+    write_array(lines, 'const float nanostream_basis_half[8][48]', basis_half)
+    write_array(lines, 'const float nanostream_mean_half[48]', [mean_half])
+
+    path.write_text('\n'.join(lines), encoding='utf-8')
+
+def main() -> None:
+    ap = argparse.ArgumentParser()
+    ap.add_argument('--input', type=Path, default=Path('nanostream_eigen.c'))
+    ap.add_argument('--output', type=Path, default=Path('nanostream_layouts.c'))
+    args = ap.parse_args()
+
+    text = args.input.read_text(encoding='utf-8')
+    mean = parse_float_array(text, 'nanostream_mean')
+    values = parse_float_array(text, 'nanostream_eigen_values')
+    if len(mean) != D or len(values) != 8 * D:
+        raise ValueError(f'unexpected table sizes: {len(mean)} and {len(values)}')
+
+    basis = [values[i:i + D] for i in range(0, len(values), D)]
+    write_layouts(args.output, mean, basis)
+
+if __name__ == '__main__':
+    main()
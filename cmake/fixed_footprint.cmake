@@ -0,0 +1,39 @@
+# Reports the flash and RAM footprint of the fixed point codec.
+#
+# Expects OBJECTS (a list of object files) and SIZE (the size program). The stack use of each function is read from
+# the .su files that -fstack-usage writes next to the objects.
+
+set(total_text 0)
+set(total_data 0)
+set(total_bss 0)
+
+foreach(object IN LISTS OBJECTS)
+  execute_process(COMMAND "${SIZE}" "${object}" OUTPUT_VARIABLE output RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "failed to run ${SIZE} on ${object}")
+  endif()
+
+  # The second line of the Berkeley format is: text data bss dec hex filename
+  string(REGEX MATCH "\n[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)" line "${output}")
+  math(EXPR total_text "${total_text} + ${CMAKE_MATCH_1}")
+  math(EXPR total_data "${total_data} + ${CMAKE_MATCH_2}")
+  math(EXPR total_bss "${total_bss} + ${CMAKE_MATCH_3}")
+
+  get_filename_component(name "${object}" NAME)
+  message("${name}: ${CMAKE_MATCH_1} bytes of code and constants, ${CMAKE_MATCH_2} bytes of data, ${CMAKE_MATCH_3} bytes of bss")
+
+  string(REGEX REPLACE "\\.o(bj)?$" ".su" stack_usage "${object}")
+  if(EXISTS "${stack_usage}")
+    file(STRINGS "${stack_usage}" functions)
+    foreach(function IN LISTS functions)
+      # file:line:column:name<tab>bytes<tab>qualifiers
+      if(function MATCHES "([^:]+)\t([0-9]+)\t(.*)$")
+        message("  ${CMAKE_MATCH_1}: ${CMAKE_MATCH_2} bytes of stack (${CMAKE_MATCH_3})")
+      endif()
+    endforeach()
+  endif()
+endforeach()
+
+math(EXPR flash "${total_text} + ${total_data}")
+math(EXPR ram "${total_data} + ${total_bss}")
+message("flash: ${flash} bytes, static RAM: ${ram} bytes")
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+
+# This script converts the floating point basis in nanostream_eigen.c
+# into the integer tables used by the fixed point codec in
+# nanostream_fixed.c. The basis vectors are stored as 16-bit integers
+# with as many fractional bits as their largest entry allows (Q15 for
+# entries up to one, more for the typical basis whose entries are
+# much smaller), the mean block in Q31, and the projection of the
+# mean onto each basis vector is precomputed in the units the encoder
+# accumulates in (8-bit pixels times the basis), so that the encoder
+# never has to subtract the mean from each pixel.
+
+import argparse
+import re
+from pathlib import Path
+
+D: int = 3 * 8 * 8
+
+def parse_float_array(text: str, name: str) -> list[float]:
+    match = re.search(name + r'\[[^=]*=\s*\{(.*?)\};', text, re.S)
+    if match is None:
+        raise ValueError(f'{name} was not found')
+    return [float(v.rstrip('f')) for v in re.findall(r'[-+]?\d+\.\d+e[-+]\d+f', match.group(1))]
+
+def to_fixed(x: float, frac_bits: int, min_value: int, max_value: int) -> int:
+    return max(min_value, min(max_value, round(x * (1 << frac_bits))))
+
+def write_tables(path: Path, mean: list[float], basis: list[list[float]]) -> None:
+    k = len(basis)
+    largest = max(abs(e) for row in basis for e in row)
+    # Since each basis vector has unit length, the encoder's sums stay below 255 * sqrt(192) * 2^frac_bits, which
+    # fits in 32 bits up to 18 fractional bits.
+    frac_bits = 15
+    while frac_bits < 18 and round(largest * (1 << (frac_bits + 1))) <= 32767:
+        frac_bits += 1
+
+    mean_q31 = [to_fixed(m, 31, -(1 << 31), (1 << 31) - 1) for m in mean]
+    basis_q = [[to_fixed(e, frac_bits, -(1 << 15), (1 << 15) - 1) for e in row] for row in basis]
+    projection = [round(sum(255.0 * mean[j] * row[j] for j in range(D))) for row in basis_q]
+
+    lines: list[str] = []
+    lines.append('/* Generated by fixed_point_tables.py from nanostream_eigen.c. */')
+    lines.append('')
+    lines.append('#include <stdint.h>')
+    lines.append('')
+
+    lines.append(f'const int32_t nanostream_fixed_mean[{D}] = {{')
+    lines.append('  ' + ', '.join(str(v) for v in mean_q31))
+    lines.append('};')
+    lines.append('')
+
+    lines.append(f'const int nanostream_fixed_basis_frac_bits = {frac_bits};')
+    lines.append('')
+
+    lines.append(f'const int16_t nanostream_fixed_basis[{k}][{D}] = {{')
+    for row in basis_q:
+        lines.append('  { ' + ', '.join(str(v) for v in row) + ' },')
+    lines.append('};')
+    lines.append('')
+
+    lines.append(f'const int32_t nanostream_fixed_mean_projection[{k}] = {{')
+    lines.append('  ' + ', '.join(str(v) for v in projection))
+    lines.append('};')
+    lines.append('')
+
+    path.write_text('\n'.join(lines), encoding='utf-8')
+
+def main() -> None:
+    ap = argparse.ArgumentParser()
+    ap.add_argument('--input', type=Path, default=Path('nanostream_eigen.c'))
+    ap.add_argument('--output', type=Path, default=Path('nanostream_fixed_tables.c'))
+    args = ap.parse_args()
+
+    text = args.input.read_text(encoding='utf-8')
+    mean = parse_float_array(text, 'nanostream_mean')
+    values = parse_float_array(text, 'nanostream_eigen_values')
+    if len(mean) != D or len(values) % D != 0:
+        raise ValueError(f'unexpected table sizes: {len(mean)} and {len(values)}')
+
+    basis = [values[i:i + D] for i in range(0, len(values), D)]
+    write_tables(args.output, mean, basis)
+
+if __name__ == '__main__':
+    main()
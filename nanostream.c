@@ -1,6 +1,9 @@
 #include "nanostream.h"
 
+#include "nanostream_layouts.h"
+
 #include <math.h>
+#include <stdint.h>
 #include <string.h>
 
 #define NUM_VALUES_PER_BLOCK 192
@@ -10,57 +13,59 @@
 #define BLOCKS_PER_X (NANOSTREAM_TILE_WIDTH / BLOCK_SIZE)
 #define BLOCKS_PER_Y (NANOSTREAM_TILE_HEIGHT / BLOCK_SIZE)
 
-extern const float nanostream_mean[NUM_VALUES_PER_BLOCK];
-extern const float nanostream_eigen_values[NUM_EIGEN_VALUES][NUM_VALUES_PER_BLOCK];
+/* The lowest bits of the first lower eigenvalue bound of a packet that hold the index of its basis, when a tile is
+ * encoded with one of several. */
+#define BASIS_INDEX_MASK ((uint32_t)(NANOSTREAM_MAX_BASES - 1))
 
-static float
-u8_to_f32(const unsigned char x)
-{
-  return ((float)x) * (1.0F / 255.0F);
-}
+/* The number of blocks of a tile that the basis it is encoded with is chosen on, and the stride they are taken at,
+ * which is coprime to the number of blocks so that they spread over the tile. */
+#define CHOICE_BLOCKS 16
+#define CHOICE_STRIDE 97
 
+/* Clamps and rounds a value in [0, 255]. Since the value is not negative once clamped, adding one half and truncating
+ * rounds it, which unlike lrintf compiles to vector instructions. */
 static unsigned char
 f32_to_u8(const float x)
 {
   float y = x;
   if (y < 0.0F)
     y = 0.0F;
-  if (y > 1.0F)
-    y = 1.0F;
-  int v = (int)lrintf(y * 255.0F);
-  if (v < 0)
-    v = 0;
-  if (v > 255)
-    v = 255;
-  return (unsigned char)v;
+  if (y > 255.0F)
+    y = 255.0F;
+  return (unsigned char)(int)(y + 0.5F);
 }
 
+/* Projects a block onto the basis. The pixels are read in their packed order, NANOSTREAM_BASIS_LANES at a time, and
+ * each lane accumulates its own partial sums, so the inner loops map onto vector instructions without shuffles. */
 static void
-block_to_vec(const unsigned char* rgb, const int pitch, float* v)
+block_to_eigen_values(const unsigned char* rgb,
+                      const int pitch,
+                      const float (*aosoa)[8 * NANOSTREAM_BASIS_LANES],
+                      const float* mean_projection,
+                      float* eigen_values_out)
 {
-  float* r = v;
-  float* g = r + (BLOCK_SIZE * BLOCK_SIZE);
-  float* b = g + (BLOCK_SIZE * BLOCK_SIZE);
-  for (int y = 0; y < BLOCK_SIZE; y++) {
-    const unsigned char* line = rgb + y * pitch;
-    for (int x = 0; x < BLOCK_SIZE; x++) {
-      r[y * BLOCK_SIZE + x] = u8_to_f32(line[x * 3 + 0]);
-      g[y * BLOCK_SIZE + x] = u8_to_f32(line[x * 3 + 1]);
-      b[y * BLOCK_SIZE + x] = u8_to_f32(line[x * 3 + 2]);
-    }
+  float acc[NUM_EIGEN_VALUES][NANOSTREAM_BASIS_LANES];
+  memset(acc, 0, sizeof(acc));
+
+  const int groups_per_row = (BLOCK_SIZE * 3) / NANOSTREAM_BASIS_LANES;
+
+  for (int g = 0; g < NANOSTREAM_BASIS_GROUPS; g++) {
+    const unsigned char* in = rgb + (g / groups_per_row) * pitch + (g % groups_per_row) * NANOSTREAM_BASIS_LANES;
+    const float* basis = aosoa[g];
+
+    float v[NANOSTREAM_BASIS_LANES];
+    for (int lane = 0; lane < NANOSTREAM_BASIS_LANES; lane++)
+      v[lane] = (float)in[lane];
+
+    for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+      for (int lane = 0; lane < NANOSTREAM_BASIS_LANES; lane++)
+        acc[i][lane] += v[lane] * basis[i * NANOSTREAM_BASIS_LANES + lane];
   }
-}
 
-/* FIXED: center by mean, accumulate, and store. */
-static void
-to_eigen_values(const float* v, float* eigen_values_out)
-{
   for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
-    float s = 0.0F;
-    for (int j = 0; j < NUM_VALUES_PER_BLOCK; j++) {
-      const float centered = v[j] - nanostream_mean[j];
-      s += centered * nanostream_eigen_values[i][j];
-    }
+    float s = -mean_projection[i];
+    for (int lane = 0; lane < NANOSTREAM_BASIS_LANES; lane++)
+      s += acc[i][lane];
     eigen_values_out[i] = s;
   }
 }
@@ -135,10 +140,42 @@ quantize_eigen_values(const float* ev, const float* ev_min, const float* ev_max,
   bits[3] = (unsigned char)((q4 & 0x03) | ((q5 & 0x03) << 2) | ((q6 & 0x03) << 4) | ((q7 & 0x03) << 6));
 }
 
-void
-nanostream_encode_tile(const unsigned char* rgb, const int pitch, unsigned char* packet_buffer)
+/* Records the index of a basis in the lowest bits of a lower eigenvalue bound. If that would raise the bound, it is
+ * moved down by one more step of those bits instead, so that the eigenvalues stay within it. */
+static float
+stamp_basis_index(const float bound, const int index)
 {
-  float v[NUM_VALUES_PER_BLOCK];
+  uint32_t bits;
+  memcpy(&bits, &bound, sizeof(bits));
+
+  uint32_t stamped = (bits & ~BASIS_INDEX_MASK) | (uint32_t)index;
+  float value;
+  memcpy(&value, &stamped, sizeof(value));
+  if (value > bound) {
+    if (bits & 0x80000000u) {
+      stamped += BASIS_INDEX_MASK + 1;
+    } else if ((bits & ~BASIS_INDEX_MASK) == 0) {
+      stamped = 0x80000000u | (uint32_t)index;
+    } else {
+      stamped -= BASIS_INDEX_MASK + 1;
+    }
+    memcpy(&value, &stamped, sizeof(value));
+  }
+
+  return value;
+}
+
+/* 'basis_index' is recorded in the packet unless it is negative. */
+static void
+encode_tile(const nanostream_basis* basis,
+            const int basis_index,
+            const unsigned char* rgb,
+            const int pitch,
+            unsigned char* packet_buffer)
+{
+  const float(*aosoa)[8 * NANOSTREAM_BASIS_LANES] = basis ? basis->aosoa : nanostream_basis_aosoa;
+  const float* mean_projection = basis ? basis->mean_projection : nanostream_mean_projection;
+
   float eigen_values[BLOCKS_PER_X * BLOCKS_PER_Y][NUM_EIGEN_VALUES];
   float ev_min[NUM_EIGEN_VALUES];
   float ev_max[NUM_EIGEN_VALUES];
@@ -151,13 +188,15 @@ nanostream_encode_tile(const unsigned char* rgb, const int pitch, unsigned char*
   for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
     for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
       const unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
-      block_to_vec(block_rgb_ptr, pitch, v);
       float* ev = eigen_values[block_y * BLOCKS_PER_X + block_x];
-      to_eigen_values(v, ev);
+      block_to_eigen_values(block_rgb_ptr, pitch, aosoa, mean_projection, ev);
       expand_eigen_value_bounds(ev, ev_min, ev_max);
     }
   }
 
+  if (basis_index >= 0)
+    ev_min[0] = stamp_basis_index(ev_min[0], basis_index);
+
   memcpy(packet_buffer, ev_min, sizeof(ev_min));
   packet_buffer += sizeof(ev_min);
 
@@ -170,38 +209,207 @@ nanostream_encode_tile(const unsigned char* rgb, const int pitch, unsigned char*
   }
 }
 
-static void
-eigen_values_to_block_vec(const float* ev, float* v_out)
+void
+nanostream_encode_tile(const unsigned char* rgb, const int pitch, unsigned char* packet_buffer)
+{
+  encode_tile(NULL, -1, rgb, pitch, packet_buffer);
+}
+
+void
+nanostream_encode_tile_with_basis(const nanostream_basis* basis,
+                                  const unsigned char* rgb,
+                                  const int pitch,
+                                  unsigned char* packet_buffer)
+{
+  encode_tile(basis, -1, rgb, pitch, packet_buffer);
+}
+
+/* Estimates the squared error, in units of 0 to 1, that encoding a sample of the blocks of a tile with a basis leaves:
+ * what the eigenvalues do not capture of each block, plus what quantizing them over their ranges in the sample
+ * adds. A basis that compacts more of the energy of the blocks into fewer eigenvalues, whose ranges are then narrower
+ * for the bits a packet has for them, scores lower. */
+static float
+choice_error(const nanostream_basis* basis, const unsigned char* rgb, const int pitch)
+{
+  static const float levels[NUM_EIGEN_VALUES] = { 255.0F, 255.0F, 15.0F, 15.0F, 3.0F, 3.0F, 3.0F, 3.0F };
+
+  const float(*aosoa)[8 * NANOSTREAM_BASIS_LANES] = basis ? basis->aosoa : nanostream_basis_aosoa;
+  const float* mean_projection = basis ? basis->mean_projection : nanostream_mean_projection;
+  const float* mean = basis ? basis->mean_interleaved : nanostream_mean_interleaved;
+
+  float ev_min[NUM_EIGEN_VALUES];
+  float ev_max[NUM_EIGEN_VALUES];
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    ev_min[i] = INFINITY;
+    ev_max[i] = -INFINITY;
+  }
+
+  float residual = 0.0F;
+  for (int sample = 0; sample < CHOICE_BLOCKS; sample++) {
+    const int block = (sample * CHOICE_STRIDE) % (BLOCKS_PER_X * BLOCKS_PER_Y);
+    const unsigned char* in =
+      rgb + ((block / BLOCKS_PER_X) * BLOCK_SIZE) * pitch + ((block % BLOCKS_PER_X) * BLOCK_SIZE * 3);
+
+    float ev[NUM_EIGEN_VALUES];
+    block_to_eigen_values(in, pitch, aosoa, mean_projection, ev);
+    expand_eigen_value_bounds(ev, ev_min, ev_max);
+
+    float distance = 0.0F;
+    for (int y = 0; y < BLOCK_SIZE; y++) {
+      for (int k = 0; k < BLOCK_SIZE * 3; k++) {
+        const float d = (float)in[y * pitch + k] - mean[y * BLOCK_SIZE * 3 + k];
+        distance += d * d;
+      }
+    }
+
+    float captured = 0.0F;
+    for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+      captured += ev[i] * ev[i];
+
+    residual += distance * (1.0F / (255.0F * 255.0F)) - captured;
+  }
+
+  /* Rounding to steps of a given size adds a twelfth of the square of the step to each eigenvalue of each block. */
+  float quantization = 0.0F;
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    const float step = (ev_max[i] - ev_min[i]) / levels[i];
+    quantization += step * step * (1.0F / 12.0F);
+  }
+
+  return residual + quantization * (float)CHOICE_BLOCKS;
+}
+
+int
+nanostream_choose_basis(const nanostream_basis* const* bases,
+                        const int num_bases,
+                        const unsigned char* rgb,
+                        const int pitch)
 {
-  for (int j = 0; j < NUM_VALUES_PER_BLOCK; j++) {
-    float x = nanostream_mean[j];
-    for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
-      x += ev[i] * nanostream_eigen_values[i][j];
+  const int n = (num_bases < NANOSTREAM_MAX_BASES) ? num_bases : NANOSTREAM_MAX_BASES;
+  if (n <= 1)
+    return 0;
+
+  int best = 0;
+  float best_error = INFINITY;
+  for (int i = 0; i < n; i++) {
+    const float error = choice_error(bases[i], rgb, pitch);
+    if (error < best_error) {
+      best_error = error;
+      best = i;
     }
-    v_out[j] = x;
+  }
+
+  return best;
+}
+
+void
+nanostream_encode_tile_with_bases(const nanostream_basis* const* bases,
+                                  const int num_bases,
+                                  const unsigned char* rgb,
+                                  const int pitch,
+                                  unsigned char* packet_buffer)
+{
+  if (num_bases <= 1) {
+    encode_tile((num_bases == 1) ? bases[0] : NULL, -1, rgb, pitch, packet_buffer);
+    return;
+  }
+
+  const int index = nanostream_choose_basis(bases, num_bases, rgb, pitch);
+  encode_tile(bases[index], index, rgb, pitch, packet_buffer);
+}
+
+int
+nanostream_packet_basis(const unsigned char* packet_buffer)
+{
+  uint32_t bits;
+  memcpy(&bits, packet_buffer, sizeof(bits));
+  return (int)(bits & BASIS_INDEX_MASK);
+}
+
+/* Reconstructs values in interleaved order from the coefficients, by adding each scaled basis vector to the mean. */
+static void
+reconstruct_interleaved(const float* ev, const float* mean, const float* basis, const int n, float* x)
+{
+  memcpy(x, mean, sizeof(float) * (size_t)n);
+
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    const float e = ev[i];
+    const float* row = basis + i * n;
+    for (int j = 0; j < n; j++)
+      x[j] += e * row[j];
   }
 }
 
 static void
-vec_to_block(unsigned char* rgb, const int pitch, const float* v)
+reconstruct_block(const float* ev, const nanostream_basis* basis, float* x)
 {
-  const float* r = v;
-  const float* g = r + (BLOCK_SIZE * BLOCK_SIZE);
-  const float* b = g + (BLOCK_SIZE * BLOCK_SIZE);
+  if (basis) {
+    reconstruct_interleaved(ev, basis->mean_interleaved, &basis->interleaved[0][0], NUM_VALUES_PER_BLOCK, x);
+  } else {
+    reconstruct_interleaved(
+      ev, nanostream_mean_interleaved, &nanostream_basis_interleaved[0][0], NUM_VALUES_PER_BLOCK, x);
+  }
+}
 
+static void
+store_block(const float* x, unsigned char* rgb, const int pitch)
+{
   for (int y = 0; y < BLOCK_SIZE; y++) {
     unsigned char* line = rgb + y * pitch;
-    for (int x = 0; x < BLOCK_SIZE; x++) {
-      const int idx = y * BLOCK_SIZE + x;
-      line[x * 3 + 0] = f32_to_u8(r[idx]);
-      line[x * 3 + 1] = f32_to_u8(g[idx]);
-      line[x * 3 + 2] = f32_to_u8(b[idx]);
-    }
+    const float* row = x + y * BLOCK_SIZE * 3;
+    for (int k = 0; k < BLOCK_SIZE * 3; k++)
+      line[k] = f32_to_u8(row[k]);
   }
 }
 
+static void
+eigen_values_to_block(const float* ev, const nanostream_basis* basis, unsigned char* rgb, const int pitch)
+{
+  float x[NUM_VALUES_PER_BLOCK];
+  reconstruct_block(ev, basis, x);
+  store_block(x, rgb, pitch);
+}
+
+/* Inverse of quantize_eigen_values. */
+static void
+dequantize_eigen_values(const unsigned char* bits, const float* ev_min, const float* ev_max, float* ev)
+{
+  const unsigned char b0 = bits[0];
+  const unsigned char b1 = bits[1];
+  const unsigned char b2 = bits[2];
+  const unsigned char b3 = bits[3];
+
+  const int q0 = (int)b0;
+  const int q1 = (int)b1;
+  const int q2 = (int)((b2 >> 4) & 0x0F);
+  const int q3 = (int)(b2 & 0x0F);
+
+  const int q4 = (int)(b3 & 0x03);
+  const int q5 = (int)((b3 >> 2) & 0x03);
+  const int q6 = (int)((b3 >> 4) & 0x03);
+  const int q7 = (int)((b3 >> 6) & 0x03);
+
+  ev[0] = dequantize_f32(q0, ev_min[0], ev_max[0], 255);
+  ev[1] = dequantize_f32(q1, ev_min[1], ev_max[1], 255);
+  ev[2] = dequantize_f32(q2, ev_min[2], ev_max[2], 15);
+  ev[3] = dequantize_f32(q3, ev_min[3], ev_max[3], 15);
+  ev[4] = dequantize_f32(q4, ev_min[4], ev_max[4], 3);
+  ev[5] = dequantize_f32(q5, ev_min[5], ev_max[5], 3);
+  ev[6] = dequantize_f32(q6, ev_min[6], ev_max[6], 3);
+  ev[7] = dequantize_f32(q7, ev_min[7], ev_max[7], 3);
+}
+
 void
 nanostream_decode_tile(const unsigned char* packet_buffer, int pitch, unsigned char* rgb)
+{
+  nanostream_decode_tile_with_basis(NULL, packet_buffer, pitch, rgb);
+}
+
+void
+nanostream_decode_tile_with_basis(const nanostream_basis* basis,
+                                  const unsigned char* packet_buffer,
+                                  const int pitch,
+                                  unsigned char* rgb)
 {
   float ev_min[NUM_EIGEN_VALUES];
   float ev_max[NUM_EIGEN_VALUES];
@@ -213,39 +421,225 @@ nanostream_decode_tile(const unsigned char* packet_buffer, int pitch, unsigned c
   packet_buffer += sizeof(ev_max);
 
   float ev[NUM_EIGEN_VALUES];
-  float v[NUM_VALUES_PER_BLOCK];
 
   for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
     for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
-      const unsigned char b0 = packet_buffer[0];
-      const unsigned char b1 = packet_buffer[1];
-      const unsigned char b2 = packet_buffer[2];
-      const unsigned char b3 = packet_buffer[3];
+      dequantize_eigen_values(packet_buffer, ev_min, ev_max, ev);
       packet_buffer += BYTES_PER_EV_BLOCK;
 
-      const int q0 = (int)b0;
-      const int q1 = (int)b1;
-      const int q2 = (int)((b2 >> 4) & 0x0F);
-      const int q3 = (int)(b2 & 0x0F);
+      unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
+      eigen_values_to_block(ev, basis, block_rgb_ptr, pitch);
+    }
+  }
+}
+
+/* The basis of 'bases' that a packet names, as nanostream_decode_tile_with_bases picks it. */
+static const nanostream_basis*
+packet_basis(const nanostream_basis* const* bases, const int num_bases, const unsigned char* packet_buffer)
+{
+  if (num_bases <= 1)
+    return (num_bases == 1) ? bases[0] : NULL;
 
-      const int q4 = (int)(b3 & 0x03);
-      const int q5 = (int)((b3 >> 2) & 0x03);
-      const int q6 = (int)((b3 >> 4) & 0x03);
-      const int q7 = (int)((b3 >> 6) & 0x03);
+  const int index = nanostream_packet_basis(packet_buffer);
+  return (index < num_bases) ? bases[index] : bases[0];
+}
 
-      ev[0] = dequantize_f32(q0, ev_min[0], ev_max[0], 255);
-      ev[1] = dequantize_f32(q1, ev_min[1], ev_max[1], 255);
-      ev[2] = dequantize_f32(q2, ev_min[2], ev_max[2], 15);
-      ev[3] = dequantize_f32(q3, ev_min[3], ev_max[3], 15);
-      ev[4] = dequantize_f32(q4, ev_min[4], ev_max[4], 3);
-      ev[5] = dequantize_f32(q5, ev_min[5], ev_max[5], 3);
-      ev[6] = dequantize_f32(q6, ev_min[6], ev_max[6], 3);
-      ev[7] = dequantize_f32(q7, ev_min[7], ev_max[7], 3);
+void
+nanostream_decode_tile_with_bases(const nanostream_basis* const* bases,
+                                  const int num_bases,
+                                  const unsigned char* packet_buffer,
+                                  const int pitch,
+                                  unsigned char* rgb)
+{
+  nanostream_decode_tile_with_basis(packet_basis(bases, num_bases, packet_buffer), packet_buffer, pitch, rgb);
+}
 
-      eigen_values_to_block_vec(ev, v);
+/* Dequantizes the coefficients of one block of a packet. */
+static void
+dequantize_block(const unsigned char* packet_buffer, const int block_x, const int block_y, float* ev)
+{
+  float ev_min[NUM_EIGEN_VALUES];
+  float ev_max[NUM_EIGEN_VALUES];
+  memcpy(ev_min, packet_buffer, sizeof(ev_min));
+  memcpy(ev_max, packet_buffer + sizeof(ev_min), sizeof(ev_max));
+
+  const unsigned char* bits =
+    packet_buffer + sizeof(ev_min) + sizeof(ev_max) + (block_y * BLOCKS_PER_X + block_x) * BYTES_PER_EV_BLOCK;
+  dequantize_eigen_values(bits, ev_min, ev_max, ev);
+}
+
+int
+nanostream_conceal_tile(const unsigned char* const* neighbours, const int pitch, unsigned char* rgb)
+{
+  return nanostream_conceal_tile_with_basis(NULL, neighbours, pitch, rgb);
+}
+
+int
+nanostream_conceal_tile_with_basis(const nanostream_basis* basis,
+                                   const unsigned char* const* neighbours,
+                                   const int pitch,
+                                   unsigned char* rgb)
+{
+  return nanostream_conceal_tile_with_bases(&basis, 1, neighbours, pitch, rgb);
+}
+
+int
+nanostream_conceal_tile_with_bases(const nanostream_basis* const* bases,
+                                   const int num_bases,
+                                   const unsigned char* const* neighbours,
+                                   const int pitch,
+                                   unsigned char* rgb)
+{
+  const unsigned char* left = neighbours[0];
+  const unsigned char* right = neighbours[1];
+  const unsigned char* above = neighbours[2];
+  const unsigned char* below = neighbours[3];
+  if (!left && !right && !above && !below)
+    return -1;
+
+  /* The blocks along the edges that face the lost tile. */
+  float left_edge[BLOCKS_PER_Y][NUM_EIGEN_VALUES];
+  float right_edge[BLOCKS_PER_Y][NUM_EIGEN_VALUES];
+  float top_edge[BLOCKS_PER_X][NUM_EIGEN_VALUES];
+  float bottom_edge[BLOCKS_PER_X][NUM_EIGEN_VALUES];
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    if (left)
+      dequantize_block(left, BLOCKS_PER_X - 1, block_y, left_edge[block_y]);
+    if (right)
+      dequantize_block(right, 0, block_y, right_edge[block_y]);
+  }
+
+  for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+    if (above)
+      dequantize_block(above, block_x, BLOCKS_PER_Y - 1, top_edge[block_x]);
+    if (below)
+      dequantize_block(below, block_x, 0, bottom_edge[block_x]);
+  }
+
+  /* Neighbours encoded with the same basis are blended in one group, since their coefficients mean the same. */
+  const nanostream_basis* group_bases[4];
+  int group[4] = { 0 };
+  int num_groups = 0;
+  for (int n = 0; n < 4; n++) {
+    if (!neighbours[n])
+      continue;
+    const nanostream_basis* basis = packet_basis(bases, num_bases, neighbours[n]);
+    for (group[n] = 0; (group[n] < num_groups) && (group_bases[group[n]] != basis); group[n]++) {
+    }
+    if (group[n] == num_groups)
+      group_bases[num_groups++] = basis;
+  }
+
+  /* Reconstruction is linear, so blending the coefficients blends the blocks they stand for. */
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      float ev[4][NUM_EIGEN_VALUES] = { { 0.0F } };
+      float weights[4] = { 0.0F };
+
+      const float* sources[4] = { left ? left_edge[block_y] : NULL,
+                                  right ? right_edge[block_y] : NULL,
+                                  above ? top_edge[block_x] : NULL,
+                                  below ? bottom_edge[block_x] : NULL };
+      const int distances[4] = { block_x + 1, BLOCKS_PER_X - block_x, block_y + 1, BLOCKS_PER_Y - block_y };
+
+      for (int n = 0; n < 4; n++) {
+        if (!sources[n])
+          continue;
+        const float weight = 1.0F / (float)distances[n];
+        for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+          ev[group[n]][i] += weight * sources[n][i];
+        weights[group[n]] += weight;
+      }
+
+      for (int g = 0; g < num_groups; g++) {
+        for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+          ev[g][i] /= weights[g];
+      }
 
       unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
-      vec_to_block(block_rgb_ptr, pitch, v);
+      if (num_groups == 1) {
+        eigen_values_to_block(ev[0], group_bases[0], block_rgb_ptr, pitch);
+        continue;
+      }
+
+      /* Blocks of different bases are blended after reconstruction instead, by the weight of their groups. */
+      float total = 0.0F;
+      for (int g = 0; g < num_groups; g++)
+        total += weights[g];
+
+      float x[NUM_VALUES_PER_BLOCK] = { 0.0F };
+      for (int g = 0; g < num_groups; g++) {
+        float group_x[NUM_VALUES_PER_BLOCK];
+        reconstruct_block(ev[g], group_bases[g], group_x);
+        const float share = weights[g] / total;
+        for (int j = 0; j < NUM_VALUES_PER_BLOCK; j++)
+          x[j] += share * group_x[j];
+      }
+      store_block(x, block_rgb_ptr, pitch);
+    }
+  }
+
+  return 0;
+}
+
+#define HALF_BLOCK_SIZE (BLOCK_SIZE / 2)
+#define NUM_VALUES_PER_HALF_BLOCK (HALF_BLOCK_SIZE * HALF_BLOCK_SIZE * 3)
+
+void
+nanostream_decode_tile_half(const unsigned char* packet_buffer, const int pitch, unsigned char* rgb)
+{
+  nanostream_decode_tile_half_with_basis(NULL, packet_buffer, pitch, rgb);
+}
+
+void
+nanostream_decode_tile_half_with_basis(const nanostream_basis* basis,
+                                       const unsigned char* packet_buffer,
+                                       const int pitch,
+                                       unsigned char* rgb)
+{
+  const float* mean_half = basis ? basis->mean_half : nanostream_mean_half;
+  const float* basis_half = basis ? &basis->half[0][0] : &nanostream_basis_half[0][0];
+
+  float ev_min[NUM_EIGEN_VALUES];
+  float ev_max[NUM_EIGEN_VALUES];
+
+  memcpy(ev_min, packet_buffer, sizeof(ev_min));
+  packet_buffer += sizeof(ev_min);
+
+  memcpy(ev_max, packet_buffer, sizeof(ev_max));
+  packet_buffer += sizeof(ev_max);
+
+  float ev[NUM_EIGEN_VALUES];
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      dequantize_eigen_values(packet_buffer, ev_min, ev_max, ev);
+      packet_buffer += BYTES_PER_EV_BLOCK;
+
+      unsigned char* block_rgb_ptr = rgb + (block_y * HALF_BLOCK_SIZE) * pitch + (block_x * HALF_BLOCK_SIZE * 3);
+
+      /* Since reconstruction is linear, the mean of each 2x2 cell is the same combination of the basis averaged over
+       * the cell, which the half layout holds. */
+      float x[NUM_VALUES_PER_HALF_BLOCK];
+      reconstruct_interleaved(ev, mean_half, basis_half, NUM_VALUES_PER_HALF_BLOCK, x);
+
+      for (int y = 0; y < HALF_BLOCK_SIZE; y++) {
+        unsigned char* line = block_rgb_ptr + y * pitch;
+        const float* row = x + y * HALF_BLOCK_SIZE * 3;
+        for (int k = 0; k < HALF_BLOCK_SIZE * 3; k++)
+          line[k] = f32_to_u8(row[k]);
+      }
     }
   }
 }
+
+void
+nanostream_decode_tile_half_with_bases(const nanostream_basis* const* bases,
+                                       const int num_bases,
+                                       const unsigned char* packet_buffer,
+                                       const int pitch,
+                                       unsigned char* rgb)
+{
+  nanostream_decode_tile_half_with_basis(packet_basis(bases, num_bases, packet_buffer), packet_buffer, pitch, rgb);
+}
@@ -6,6 +6,9 @@
 
 #define NANOSTREAM_PACKET_SIZE (1200 + (8 * 2 * sizeof(float)))
 
+/* The most bases a tile can be chosen to be encoded with (see nanostream_encode_tile_with_bases). */
+#define NANOSTREAM_MAX_BASES 16
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -15,6 +18,82 @@ extern "C"
 
   void nanostream_decode_tile(const unsigned char* packet_buffer, int pitch, unsigned char* rgb);
 
+  /* Decodes a tile at half resolution, (NANOSTREAM_TILE_WIDTH / 2) x (NANOSTREAM_TILE_HEIGHT / 2), where each pixel is
+   * the mean of a 2x2 group of the full resolution tile. The means are computed from the coefficients directly,
+   * without reconstructing the full resolution pixels. */
+  void nanostream_decode_tile_half(const unsigned char* packet_buffer, int pitch, unsigned char* rgb);
+
+  /* Fills in a tile whose packet was lost from the packets of the tiles around it: 'neighbours' holds the packets of
+   * the tiles to the left, to the right, above and below, any of which may be NULL. Each block gets the coefficients
+   * of the nearest edge block of each of those tiles, weighted by the inverse of its distance, so the tile blends
+   * smoothly into its surroundings. Returns -1, leaving the pixels as they are, if every neighbour is NULL. */
+  int nanostream_conceal_tile(const unsigned char* const* neighbours, int pitch, unsigned char* rgb);
+
+  /* A basis other than the built-in one, such as one derived from the content of a stream (see nanostream_basis.h). */
+  typedef struct nanostream_basis nanostream_basis;
+
+  /* Like the functions above, with the given basis, or the built-in one if it is null. A packet does not say which
+   * basis it was encoded with: it must be decoded with the same one. Packets encoded with several bases (see
+   * nanostream_encode_tile_with_bases) must not be decoded or concealed with these, nor with the functions above. */
+  void nanostream_encode_tile_with_basis(const nanostream_basis* basis,
+                                         const unsigned char* rgb,
+                                         int pitch,
+                                         unsigned char* packet_buffer);
+
+  void nanostream_decode_tile_with_basis(const nanostream_basis* basis,
+                                         const unsigned char* packet_buffer,
+                                         int pitch,
+                                         unsigned char* rgb);
+
+  int nanostream_conceal_tile_with_basis(const nanostream_basis* basis,
+                                         const unsigned char* const* neighbours,
+                                         int pitch,
+                                         unsigned char* rgb);
+
+  void nanostream_decode_tile_half_with_basis(const nanostream_basis* basis,
+                                              const unsigned char* packet_buffer,
+                                              int pitch,
+                                              unsigned char* rgb);
+
+  /* Encodes a tile with whichever of 'bases', a bank of up to NANOSTREAM_MAX_BASES such as one trained with
+   * nanostream_basis_bank_train, suits it best, and records its index in the packet, in the lowest bits of the first
+   * lower eigenvalue bound. A null entry stands for the built-in basis. The choice costs about 7% of encoding the tile
+   * per basis; with a single basis there is none, and the packet is that of nanostream_encode_tile_with_basis. */
+  void nanostream_encode_tile_with_bases(const nanostream_basis* const* bases,
+                                         int num_bases,
+                                         const unsigned char* rgb,
+                                         int pitch,
+                                         unsigned char* packet_buffer);
+
+  /* Decode a packet with the basis it names, of the same bases it was encoded with, at the same cost as with one. A
+   * packet that names a basis beyond 'num_bases' is decoded with the first. */
+  void nanostream_decode_tile_with_bases(const nanostream_basis* const* bases,
+                                         int num_bases,
+                                         const unsigned char* packet_buffer,
+                                         int pitch,
+                                         unsigned char* rgb);
+
+  void nanostream_decode_tile_half_with_bases(const nanostream_basis* const* bases,
+                                              int num_bases,
+                                              const unsigned char* packet_buffer,
+                                              int pitch,
+                                              unsigned char* rgb);
+
+  /* Conceals a lost tile from neighbours that may name different bases. Neighbours of the same basis are blended as
+   * nanostream_conceal_tile blends them, and those of different bases after reconstruction. */
+  int nanostream_conceal_tile_with_bases(const nanostream_basis* const* bases,
+                                         int num_bases,
+                                         const unsigned char* const* neighbours,
+                                         int pitch,
+                                         unsigned char* rgb);
+
+  /* The index of the basis nanostream_encode_tile_with_bases encodes a tile with: the one that leaves the least error
+   * on a sample of its blocks, counting both what the eigenvalues do not capture and their quantization. */
+  int nanostream_choose_basis(const nanostream_basis* const* bases, int num_bases, const unsigned char* rgb, int pitch);
+
+  /* The index of the basis a packet encoded with several was encoded with. */
+  int nanostream_packet_basis(const unsigned char* packet_buffer);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
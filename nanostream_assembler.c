@@ -0,0 +1,423 @@
+#include "nanostream_assembler.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The number of released frames whose fastest transit makes up the base that delays are measured against. It follows
+ * slow drifts of the clocks and changes of route, while a single slow frame does not move it. */
+#define BASE_FRAMES 64
+
+struct slot
+{
+  int used;
+  uint32_t frame;
+  uint64_t timestamp_us;
+  int tiles_sent;
+  int tiles_received;
+  int64_t min_transit_us;
+  int basis_version;
+
+  /* The image with the tiles of this frame decoded into it; the others are filled in on release. */
+  unsigned char* rgb;
+  unsigned char* present;
+  /* The packets that arrived, for concealment from neighbours, or null when not concealing that way. */
+  unsigned char* packets;
+};
+
+struct nanostream_assembler
+{
+  nanostream_assembler_config config;
+
+  int width;
+  int height;
+  int num_tiles;
+
+  nanostream_net_bases* bases;
+
+  struct slot* slots;
+  int num_used;
+
+  /* The image of the last released frame. */
+  unsigned char* shown;
+  int released_any;
+  uint32_t last_released;
+
+  /* The fastest transit of each of the latest frames, and the smoothed excess over their minimum and its mean
+   * deviation, in microseconds. */
+  int64_t base_window[BASE_FRAMES];
+  int base_count;
+  int base_next;
+  int have_estimate;
+  double smoothed_us;
+  double deviation_us;
+
+  nanostream_assembler_stats stats;
+};
+
+nanostream_assembler*
+nanostream_assembler_create(const nanostream_assembler_config* config)
+{
+  nanostream_assembler* assembler = calloc(1, sizeof(nanostream_assembler));
+  if (!assembler)
+    return NULL;
+
+  assembler->config = *config;
+  if (assembler->config.jitter_factor <= 0.0)
+    assembler->config.jitter_factor = 4.0;
+  if (assembler->config.max_delay_us == 0)
+    assembler->config.max_delay_us = 200000;
+  if (assembler->config.min_delay_us > assembler->config.max_delay_us)
+    assembler->config.min_delay_us = assembler->config.max_delay_us;
+  if (assembler->config.max_frames <= 0)
+    assembler->config.max_frames = 8;
+
+  assembler->slots = calloc((size_t)assembler->config.max_frames, sizeof(struct slot));
+  assembler->bases = nanostream_net_bases_create();
+  if (!assembler->slots || !assembler->bases) {
+    nanostream_net_bases_destroy(assembler->bases);
+    free(assembler->slots);
+    free(assembler);
+    return NULL;
+  }
+
+  return assembler;
+}
+
+static void
+free_images(nanostream_assembler* assembler)
+{
+  for (int i = 0; i < assembler->config.max_frames; i++) {
+    struct slot* slot = &assembler->slots[i];
+    free(slot->rgb);
+    free(slot->present);
+    free(slot->packets);
+    memset(slot, 0, sizeof(struct slot));
+  }
+  free(assembler->shown);
+  assembler->shown = NULL;
+  assembler->num_used = 0;
+}
+
+void
+nanostream_assembler_destroy(nanostream_assembler* assembler)
+{
+  if (!assembler)
+    return;
+
+  free_images(assembler);
+  nanostream_net_bases_destroy(assembler->bases);
+  free(assembler->slots);
+  free(assembler);
+}
+
+/* Allocates the images for a new image size. The previous frame starts out black. */
+static int
+resize(nanostream_assembler* assembler, const int width, const int height)
+{
+  free_images(assembler);
+  assembler->width = 0;
+  assembler->height = 0;
+  assembler->released_any = 0;
+
+  const int num_tiles = nanostream_frame_tiles_x(width) * nanostream_frame_tiles_y(height);
+  const size_t image_size = (size_t)width * (size_t)height * 3;
+  const int keep_packets = assembler->config.concealment == NANOSTREAM_CONCEAL_NEIGHBOURS;
+
+  assembler->shown = calloc(image_size, 1);
+  if (!assembler->shown)
+    return -1;
+
+  for (int i = 0; i < assembler->config.max_frames; i++) {
+    struct slot* slot = &assembler->slots[i];
+    slot->rgb = malloc(image_size);
+    slot->present = malloc((size_t)num_tiles);
+    slot->packets = keep_packets ? malloc((size_t)num_tiles * NANOSTREAM_PACKET_SIZE) : NULL;
+    if (!slot->rgb || !slot->present || (keep_packets && !slot->packets)) {
+      free_images(assembler);
+      return -1;
+    }
+  }
+
+  assembler->width = width;
+  assembler->height = height;
+  assembler->num_tiles = num_tiles;
+  return 0;
+}
+
+static int64_t
+base_transit(const nanostream_assembler* assembler)
+{
+  int64_t base = INT64_MAX;
+  for (int i = 0; i < assembler->base_count; i++) {
+    if (assembler->base_window[i] < base)
+      base = assembler->base_window[i];
+  }
+  return base;
+}
+
+static uint64_t
+playout_delay(const nanostream_assembler* assembler)
+{
+  const nanostream_assembler_config* c = &assembler->config;
+  const double delay = assembler->smoothed_us + c->jitter_factor * assembler->deviation_us;
+  if (delay <= (double)c->min_delay_us)
+    return c->min_delay_us;
+  if (delay >= (double)c->max_delay_us)
+    return c->max_delay_us;
+  return (uint64_t)delay;
+}
+
+/* Adds the transit time of a tile to the estimate, before the first frame is released measured against the fastest
+ * transit so far. */
+static void
+update_estimate(nanostream_assembler* assembler, const int64_t transit_us)
+{
+  if (assembler->base_count == 0) {
+    assembler->base_window[0] = transit_us;
+    assembler->base_count = 1;
+    assembler->base_next = 1;
+  } else if ((assembler->stats.frames_complete + assembler->stats.frames_incomplete) == 0) {
+    if (transit_us < assembler->base_window[0])
+      assembler->base_window[0] = transit_us;
+  }
+
+  int64_t excess = transit_us - base_transit(assembler);
+  if (excess < 0)
+    excess = 0;
+
+  if (!assembler->have_estimate) {
+    /* Start with half the longest delay, as the tiles of the first frame are still to show how they spread. */
+    assembler->smoothed_us = (double)excess;
+    assembler->deviation_us = (double)assembler->config.max_delay_us / (2.0 * assembler->config.jitter_factor);
+    assembler->have_estimate = 1;
+  } else {
+    const double error = (double)excess - assembler->smoothed_us;
+    assembler->smoothed_us += error / 8.0;
+    assembler->deviation_us += ((error < 0.0 ? -error : error) - assembler->deviation_us) / 4.0;
+  }
+}
+
+static void
+add_base(nanostream_assembler* assembler, const int64_t transit_us)
+{
+  assembler->base_window[assembler->base_next] = transit_us;
+  assembler->base_next = (assembler->base_next + 1) % BASE_FRAMES;
+  if (assembler->base_count < BASE_FRAMES)
+    assembler->base_count++;
+}
+
+static struct slot*
+find_slot(nanostream_assembler* assembler, const uint32_t frame)
+{
+  for (int i = 0; i < assembler->config.max_frames; i++) {
+    struct slot* slot = &assembler->slots[i];
+    if (slot->used && (slot->frame == frame))
+      return slot;
+  }
+  return NULL;
+}
+
+static struct slot*
+oldest_slot(const nanostream_assembler* assembler)
+{
+  struct slot* oldest = NULL;
+  for (int i = 0; i < assembler->config.max_frames; i++) {
+    struct slot* slot = &assembler->slots[i];
+    if (slot->used && (!oldest || ((int32_t)(slot->frame - oldest->frame) < 0)))
+      oldest = slot;
+  }
+  return oldest;
+}
+
+int
+nanostream_assembler_add(nanostream_assembler* assembler, const uint64_t now_us, const nanostream_net_packet* packet)
+{
+  const nanostream_net_header* header = &packet->header;
+  if (header->type == NANOSTREAM_NET_BASIS)
+    return (nanostream_net_bases_add(assembler->bases, packet) >= 0) ? 0 : -1;
+
+  if ((header->type != NANOSTREAM_NET_TILE) || (packet->payload_size < NANOSTREAM_PACKET_SIZE))
+    return -1;
+
+  if ((header->width != assembler->width) || (header->height != assembler->height)) {
+    if (resize(assembler, header->width, header->height) != 0)
+      return -1;
+  }
+  if ((header->tile < 0) || (header->tile >= assembler->num_tiles))
+    return -1;
+
+  /* Late tiles count too: they are the ones that show the delay is too short. */
+  const int64_t transit_us = (int64_t)(now_us - header->timestamp_us);
+  update_estimate(assembler, transit_us);
+
+  if (assembler->released_any && ((int32_t)(header->frame - assembler->last_released) <= 0)) {
+    assembler->stats.tiles_late++;
+    return -1;
+  }
+
+  const int basis_version = (int)NANOSTREAM_NET_BASIS_VERSION(header->flags);
+  const nanostream_basis* basis;
+  if (nanostream_net_bases_find(assembler->bases, basis_version, &basis) != 0) {
+    assembler->stats.tiles_without_basis++;
+    return -1;
+  }
+
+  struct slot* slot = find_slot(assembler, header->frame);
+  if (!slot) {
+    if (assembler->num_used == assembler->config.max_frames) {
+      assembler->stats.tiles_dropped++;
+      return -1;
+    }
+    for (int i = 0; i < assembler->config.max_frames; i++) {
+      if (!assembler->slots[i].used) {
+        slot = &assembler->slots[i];
+        break;
+      }
+    }
+    slot->used = 1;
+    slot->frame = header->frame;
+    slot->timestamp_us = header->timestamp_us;
+    slot->tiles_sent = header->num_tiles;
+    slot->tiles_received = 0;
+    slot->min_transit_us = transit_us;
+    slot->basis_version = basis_version;
+    memset(slot->present, 0, (size_t)assembler->num_tiles);
+    assembler->num_used++;
+  }
+
+  if (slot->present[header->tile]) {
+    assembler->stats.tiles_duplicate++;
+    return -1;
+  }
+
+  if (transit_us < slot->min_transit_us)
+    slot->min_transit_us = transit_us;
+
+  nanostream_decode_frame_with_basis(
+    basis, packet->payload, header->tile, 1, assembler->width, assembler->height, assembler->width * 3, slot->rgb);
+  if (slot->packets)
+    memcpy(slot->packets + (size_t)header->tile * NANOSTREAM_PACKET_SIZE, packet->payload, NANOSTREAM_PACKET_SIZE);
+  slot->present[header->tile] = 1;
+  slot->tiles_received++;
+  assembler->stats.tiles_decoded++;
+  return 0;
+}
+
+static uint64_t
+deadline(const nanostream_assembler* assembler, const struct slot* slot)
+{
+  return slot->timestamp_us + (uint64_t)base_transit(assembler) + playout_delay(assembler);
+}
+
+static int
+releasable(const nanostream_assembler* assembler, const struct slot* slot)
+{
+  return (slot->tiles_received >= slot->tiles_sent) || (assembler->num_used == assembler->config.max_frames);
+}
+
+uint64_t
+nanostream_assembler_next_deadline(const nanostream_assembler* assembler)
+{
+  const struct slot* slot = oldest_slot(assembler);
+  if (!slot)
+    return UINT64_MAX;
+  return releasable(assembler, slot) ? 0 : deadline(assembler, slot);
+}
+
+/* Copies the pixels of a tile from one image to another. */
+static void
+copy_tile(const nanostream_assembler* assembler, const int tile, const unsigned char* from, unsigned char* to)
+{
+  const int tiles_x = nanostream_frame_tiles_x(assembler->width);
+  const int x = (tile % tiles_x) * NANOSTREAM_TILE_WIDTH;
+  const int y = (tile / tiles_x) * NANOSTREAM_TILE_HEIGHT;
+  const int w = (assembler->width - x < NANOSTREAM_TILE_WIDTH) ? (assembler->width - x) : NANOSTREAM_TILE_WIDTH;
+  const int h = (assembler->height - y < NANOSTREAM_TILE_HEIGHT) ? (assembler->height - y) : NANOSTREAM_TILE_HEIGHT;
+  const size_t pitch = (size_t)assembler->width * 3;
+  const size_t offset = (size_t)y * pitch + (size_t)x * 3;
+
+  for (int row = 0; row < h; row++)
+    memcpy(to + offset + (size_t)row * pitch, from + offset + (size_t)row * pitch, (size_t)w * 3);
+}
+
+int
+nanostream_assembler_release(nanostream_assembler* assembler, const uint64_t now_us, nanostream_assembled_frame* frame)
+{
+  struct slot* slot = oldest_slot(assembler);
+  if (!slot)
+    return 0;
+
+  const uint64_t due_us = deadline(assembler, slot);
+  if (!releasable(assembler, slot) && (now_us < due_us))
+    return 0;
+
+  const int complete = slot->tiles_received >= slot->tiles_sent;
+  const int whole = slot->tiles_sent == assembler->num_tiles;
+
+  /* The tiles that did not arrive, or were not sent, keep the previous frame; lost ones may then be concealed. */
+  int concealed = 0;
+  if (slot->tiles_received < assembler->num_tiles) {
+    for (int i = 0; i < assembler->num_tiles; i++) {
+      if (!slot->present[i])
+        copy_tile(assembler, i, assembler->shown, slot->rgb);
+    }
+    const nanostream_basis* basis;
+    if (!complete && whole && (nanostream_net_bases_find(assembler->bases, slot->basis_version, &basis) == 0)) {
+      concealed = nanostream_conceal_frame_with_basis(basis,
+                                                      slot->packets,
+                                                      slot->present,
+                                                      0,
+                                                      assembler->num_tiles,
+                                                      assembler->width,
+                                                      assembler->height,
+                                                      assembler->width * 3,
+                                                      assembler->config.concealment,
+                                                      slot->rgb);
+    }
+  }
+
+  unsigned char* image = slot->rgb;
+  slot->rgb = assembler->shown;
+  assembler->shown = image;
+
+  if (assembler->released_any && ((slot->frame - assembler->last_released) > 1))
+    assembler->stats.frames_missing += slot->frame - assembler->last_released - 1;
+  assembler->released_any = 1;
+  assembler->last_released = slot->frame;
+
+  if (complete) {
+    assembler->stats.frames_complete++;
+  } else {
+    assembler->stats.frames_incomplete++;
+  }
+  add_base(assembler, slot->min_transit_us);
+
+  frame->frame = slot->frame;
+  frame->timestamp_us = slot->timestamp_us;
+  frame->width = assembler->width;
+  frame->height = assembler->height;
+  frame->rgb = assembler->shown;
+  frame->tiles_sent = slot->tiles_sent;
+  frame->tiles_received = slot->tiles_received;
+  frame->tiles_concealed = concealed;
+  frame->slack_us = (int64_t)(now_us - due_us);
+
+  slot->used = 0;
+  assembler->num_used--;
+  return 1;
+}
+
+int
+nanostream_assembler_basis_version(const nanostream_assembler* assembler)
+{
+  return nanostream_net_bases_latest(assembler->bases);
+}
+
+void
+nanostream_assembler_get_stats(const nanostream_assembler* assembler, nanostream_assembler_stats* stats)
+{
+  *stats = assembler->stats;
+  stats->playout_delay_us = playout_delay(assembler);
+  stats->jitter_us = (uint64_t)assembler->deviation_us;
+}
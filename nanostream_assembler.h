@@ -0,0 +1,112 @@
+#pragma once
+
+#include "nanostream_frame.h"
+#include "nanostream_net.h"
+
+#include <stdint.h>
+
+/* A frame assembler collects the tile packets of one stream by frame, decodes each tile as it arrives, and decides
+ * when each frame is shown: as soon as all of its tiles arrived, or at its playout deadline with the missing tiles
+ * concealed. Frames are released in order, so a tile that arrives out of order is still used as long as its frame
+ * was not released yet.
+ *
+ * The deadline adapts to the network. Every tile's transit time, from the timestamp of its frame to its arrival, is
+ * compared with the fastest transit of the latest frames; the smoothed excess and its mean deviation, as TCP estimates
+ * round trip times, give the playout delay. Sender and receiver clocks need not agree, since only differences of
+ * transit times are used. A fixed delay is either too long most of the time or too short when jitter spikes.
+ *
+ * Tiles are decoded with the basis their datagrams name, which the assembler collects from the basis datagrams of the
+ * stream (see nanostream_net_bases_create).
+ *
+ * The assembler does not read clocks: the caller passes the time to every call. Linux only, like nanostream_net.h. */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_assembler_config
+  {
+    /* How the tiles lost from a frame are filled in. */
+    nanostream_concealment concealment;
+
+    /* The playout delay is the smoothed excess transit time plus 'jitter_factor' times its mean deviation, zero for
+     * 4, kept between min_delay_us and max_delay_us, zero for 200 ms. Equal bounds give a fixed delay. */
+    double jitter_factor;
+    uint64_t min_delay_us;
+    uint64_t max_delay_us;
+
+    /* The number of frames that can be assembled at once, zero for 8. While all are in use, the oldest frame is
+     * released without waiting for its deadline, and tiles of newer frames are dropped. */
+    int max_frames;
+  } nanostream_assembler_config;
+
+  typedef struct nanostream_assembled_frame
+  {
+    uint32_t frame;
+    uint64_t timestamp_us;
+
+    /* The whole image, with a pitch of width * 3. Valid until the next call that releases a frame. */
+    int width;
+    int height;
+    const unsigned char* rgb;
+
+    /* The tiles the frame was sent with, those that arrived, and those of the rest filled in from their neighbours;
+     * the others show the previous frame. */
+    int tiles_sent;
+    int tiles_received;
+    int tiles_concealed;
+
+    /* The time from the frame's deadline to its release, negative if it was released early because it was complete. */
+    int64_t slack_us;
+  } nanostream_assembled_frame;
+
+  typedef struct nanostream_assembler_stats
+  {
+    /* Frames released with all of their tiles, released without some of them, and never seen at all. */
+    uint64_t frames_complete;
+    uint64_t frames_incomplete;
+    uint64_t frames_missing;
+
+    uint64_t tiles_decoded;
+    /* Tiles that arrived after their frame was released, twice, or while every frame was in use. */
+    uint64_t tiles_late;
+    uint64_t tiles_duplicate;
+    uint64_t tiles_dropped;
+    /* Tiles encoded with a basis that had not arrived. */
+    uint64_t tiles_without_basis;
+
+    /* The current playout delay, and the mean deviation of transit times it was estimated from. */
+    uint64_t playout_delay_us;
+    uint64_t jitter_us;
+  } nanostream_assembler_stats;
+
+  typedef struct nanostream_assembler nanostream_assembler;
+
+  /* Returns null on failure. */
+  nanostream_assembler* nanostream_assembler_create(const nanostream_assembler_config* config);
+
+  void nanostream_assembler_destroy(nanostream_assembler* assembler);
+
+  /* Adds a datagram that arrived at now_us and decodes its tile into its frame, or collects the part of a basis it
+   * carries. Other datagrams are ignored. A change of image size starts over, dropping the frames being assembled.
+   * Returns zero if the datagram was used, or -1 if not. */
+  int nanostream_assembler_add(nanostream_assembler* assembler, uint64_t now_us, const nanostream_net_packet* packet);
+
+  /* Releases the oldest frame if it is complete or its deadline passed at now_us. Returns 1 and fills in 'frame' if
+   * one was released, and zero otherwise; call it again until it returns zero. */
+  int nanostream_assembler_release(nanostream_assembler* assembler,
+                                   uint64_t now_us,
+                                   nanostream_assembled_frame* frame);
+
+  /* The time at which a frame is next due to be released, or UINT64_MAX if no frame is being assembled. */
+  uint64_t nanostream_assembler_next_deadline(const nanostream_assembler* assembler);
+
+  /* The version of the latest basis collected, for the receiver to acknowledge, zero if none. */
+  int nanostream_assembler_basis_version(const nanostream_assembler* assembler);
+
+  void nanostream_assembler_get_stats(const nanostream_assembler* assembler, nanostream_assembler_stats* stats);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,763 @@
+#include "nanostream_basis.h"
+
+#include "nanostream_endian.h"
+#include "nanostream_layouts.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define D 192
+#define K 8
+#define BLOCK_SIZE 8
+#define BLOCKS_PER_TILE ((NANOSTREAM_TILE_WIDTH / BLOCK_SIZE) * (NANOSTREAM_TILE_HEIGHT / BLOCK_SIZE))
+#define TILE_PITCH (NANOSTREAM_TILE_WIDTH * 3)
+#define TILE_BYTES (NANOSTREAM_TILE_HEIGHT * TILE_PITCH)
+
+/* The number of the latest sampled tiles kept to compare bases on. */
+#define RECENT_TILES 4
+
+/* The number of subspace iterations per derivation. Starting from the basis in use, which is close unless the content
+ * changed completely, a few are enough; the next derivation carries on from where this one left off. */
+#define ITERATIONS 8
+
+/* Sampled blocks step through the blocks of a tile by this stride, which is coprime to their number. */
+#define SAMPLE_STRIDE 97
+
+/* Which tiles are sampled is pseudo-random, since every n-th tile would keep to the same positions of frames whose
+ * number of tiles is a multiple of n. */
+#define SAMPLE_MULTIPLIER 1664525u
+#define SAMPLE_INCREMENT 1013904223u
+
+extern const float nanostream_mean[D];
+extern const float nanostream_eigen_values[K][D];
+
+struct nanostream_basis_trainer
+{
+  nanostream_basis_trainer_config config;
+
+  /* The weight of the blocks seen, the sum of their values, and the upper triangle of the sum of their products, in
+   * units of 0 to 1. */
+  double count;
+  double sum[D];
+  double products[D][D];
+
+  uint32_t random;
+  unsigned int next_block;
+
+  /* The latest sampled tiles, to compare bases on: the quantization of the eigenvalues depends on their ranges within
+   * whole tiles. */
+  unsigned char recent[RECENT_TILES][TILE_BYTES];
+  int num_recent;
+  unsigned char decoded[TILE_BYTES];
+};
+
+/* The planar index of each value of a block in the interleaved order of packed RGB pixels. */
+static int
+planar_index(const int interleaved)
+{
+  const int pixel = interleaved / 3;
+  return (interleaved % 3) * BLOCK_SIZE * BLOCK_SIZE + pixel;
+}
+
+nanostream_basis*
+nanostream_basis_create(const float* mean, const float* vectors)
+{
+  nanostream_basis* basis = malloc(sizeof(nanostream_basis));
+  if (!basis)
+    return NULL;
+
+  memcpy(basis->mean, mean ? mean : nanostream_mean, sizeof(basis->mean));
+  memcpy(basis->vectors, vectors ? vectors : &nanostream_eigen_values[0][0], sizeof(basis->vectors));
+
+  /* The same layouts as basis_layouts.py writes for the built-in basis. */
+  for (int j = 0; j < D; j++) {
+    const int p = planar_index(j);
+    for (int i = 0; i < K; i++) {
+      basis->aosoa[j / NANOSTREAM_BASIS_LANES][i * NANOSTREAM_BASIS_LANES + j % NANOSTREAM_BASIS_LANES] =
+        basis->vectors[i][p] / 255.0f;
+      basis->interleaved[i][j] = 255.0f * basis->vectors[i][p];
+    }
+    basis->mean_interleaved[j] = 255.0f * basis->mean[p];
+  }
+
+  /* Each value of the half layout is the mean of a 2x2 cell of the interleaved one. */
+  for (int y = 0; y < BLOCK_SIZE / 2; y++) {
+    for (int x = 0; x < BLOCK_SIZE / 2; x++) {
+      for (int c = 0; c < 3; c++) {
+        const int h = (y * (BLOCK_SIZE / 2) + x) * 3 + c;
+        const int j = (2 * y * BLOCK_SIZE + 2 * x) * 3 + c;
+        const int cell[4] = { j, j + 3, j + BLOCK_SIZE * 3, j + BLOCK_SIZE * 3 + 3 };
+        for (int i = 0; i < K; i++) {
+          basis->half[i][h] = 0.25f * (basis->interleaved[i][cell[0]] + basis->interleaved[i][cell[1]] +
+                                       basis->interleaved[i][cell[2]] + basis->interleaved[i][cell[3]]);
+        }
+        basis->mean_half[h] = 0.25f * (basis->mean_interleaved[cell[0]] + basis->mean_interleaved[cell[1]] +
+                                       basis->mean_interleaved[cell[2]] + basis->mean_interleaved[cell[3]]);
+      }
+    }
+  }
+
+  for (int i = 0; i < K; i++) {
+    double s = 0.0;
+    for (int j = 0; j < D; j++)
+      s += (double)basis->mean[j] * (double)basis->vectors[i][j];
+    basis->mean_projection[i] = (float)s;
+  }
+
+  return basis;
+}
+
+void
+nanostream_basis_destroy(nanostream_basis* basis)
+{
+  free(basis);
+}
+
+static void
+store_float(unsigned char* out, const float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  nanostream_store_u32le(out, bits);
+}
+
+static float
+load_float(const unsigned char* data)
+{
+  const uint32_t bits = nanostream_load_u32le(data);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+void
+nanostream_basis_store(const nanostream_basis* basis, unsigned char* out)
+{
+  for (int j = 0; j < D; j++)
+    store_float(out + 4 * j, basis->mean[j]);
+  for (int i = 0; i < K; i++) {
+    for (int j = 0; j < D; j++)
+      store_float(out + 4 * (D * (1 + i) + j), basis->vectors[i][j]);
+  }
+}
+
+nanostream_basis*
+nanostream_basis_load(const unsigned char* data)
+{
+  float mean[D];
+  float vectors[K][D];
+
+  for (int j = 0; j < D; j++) {
+    mean[j] = load_float(data + 4 * j);
+    if (!(mean[j] >= -1.0f) || !(mean[j] <= 2.0f))
+      return NULL;
+  }
+
+  /* The vectors must be orthonormal, or the encoder's projections would not be the eigenvalues the decoder expects. */
+  for (int i = 0; i < K; i++) {
+    for (int j = 0; j < D; j++) {
+      vectors[i][j] = load_float(data + 4 * (D * (1 + i) + j));
+      if (!isfinite(vectors[i][j]))
+        return NULL;
+    }
+    for (int k = 0; k <= i; k++) {
+      double dot = 0.0;
+      for (int j = 0; j < D; j++)
+        dot += (double)vectors[i][j] * (double)vectors[k][j];
+      if (fabs(dot - ((k == i) ? 1.0 : 0.0)) > 1e-3)
+        return NULL;
+    }
+  }
+
+  return nanostream_basis_create(mean, &vectors[0][0]);
+}
+
+nanostream_basis_trainer*
+nanostream_basis_trainer_create(const nanostream_basis_trainer_config* config)
+{
+  nanostream_basis_trainer* trainer = calloc(1, sizeof(nanostream_basis_trainer));
+  if (!trainer)
+    return NULL;
+
+  trainer->config = *config;
+  if (trainer->config.sample_interval <= 0)
+    trainer->config.sample_interval = 4;
+  if (trainer->config.min_blocks <= 0)
+    trainer->config.min_blocks = 1024;
+  if (!(trainer->config.forget > 0.0))
+    trainer->config.forget = 0.5;
+  if (trainer->config.forget > 1.0)
+    trainer->config.forget = 1.0;
+
+  return trainer;
+}
+
+void
+nanostream_basis_trainer_destroy(nanostream_basis_trainer* trainer)
+{
+  free(trainer);
+}
+
+/* The block of a tile at a block index, in the row-major order of blocks. */
+static const unsigned char*
+tile_block(const unsigned char* rgb, const int pitch, const int block)
+{
+  const int blocks_x = NANOSTREAM_TILE_WIDTH / BLOCK_SIZE;
+  return rgb + (block / blocks_x) * BLOCK_SIZE * pitch + (block % blocks_x) * BLOCK_SIZE * 3;
+}
+
+static void
+add_block(nanostream_basis_trainer* trainer, const unsigned char* in, const int pitch)
+{
+  double x[D];
+  for (int row = 0; row < BLOCK_SIZE; row++) {
+    for (int j = 0; j < BLOCK_SIZE * 3; j++)
+      x[planar_index(row * BLOCK_SIZE * 3 + j)] = in[row * pitch + j] * (1.0 / 255.0);
+  }
+
+  for (int i = 0; i < D; i++) {
+    trainer->sum[i] += x[i];
+    double* products = trainer->products[i];
+    const double xi = x[i];
+    for (int j = i; j < D; j++)
+      products[j] += xi * x[j];
+  }
+  trainer->count += 1.0;
+}
+
+void
+nanostream_basis_trainer_add_tile(nanostream_basis_trainer* trainer, const unsigned char* rgb, const int pitch)
+{
+  trainer->random = trainer->random * SAMPLE_MULTIPLIER + SAMPLE_INCREMENT;
+  if ((trainer->random >> 16) % (uint32_t)trainer->config.sample_interval != 0)
+    return;
+
+  add_block(trainer, tile_block(rgb, pitch, (int)(trainer->next_block * SAMPLE_STRIDE % BLOCKS_PER_TILE)), pitch);
+
+  unsigned char* recent = trainer->recent[trainer->next_block % RECENT_TILES];
+  for (int row = 0; row < NANOSTREAM_TILE_HEIGHT; row++)
+    memcpy(recent + row * TILE_PITCH, rgb + row * pitch, TILE_PITCH);
+  if (trainer->num_recent < RECENT_TILES)
+    trainer->num_recent++;
+  trainer->next_block++;
+}
+
+double
+nanostream_basis_trainer_blocks(const nanostream_basis_trainer* trainer)
+{
+  return trainer->count;
+}
+
+/* Orthonormalizes the rows of 'q' in order (modified Gram-Schmidt). A row that is left with nothing is replaced by
+ * the unit vector that is least covered by the rows before it. */
+static void
+orthonormalize(double q[K][D])
+{
+  for (int i = 0; i < K; i++) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+      for (int k = 0; k < i; k++) {
+        double dot = 0.0;
+        for (int j = 0; j < D; j++)
+          dot += q[i][j] * q[k][j];
+        for (int j = 0; j < D; j++)
+          q[i][j] -= dot * q[k][j];
+      }
+
+      double norm = 0.0;
+      for (int j = 0; j < D; j++)
+        norm += q[i][j] * q[i][j];
+      norm = sqrt(norm);
+      if (norm > 1e-12) {
+        for (int j = 0; j < D; j++)
+          q[i][j] /= norm;
+        break;
+      }
+
+      int least = 0;
+      double least_cover = INFINITY;
+      for (int j = 0; j < D; j++) {
+        double cover = 0.0;
+        for (int k = 0; k < i; k++)
+          cover += q[k][j] * q[k][j];
+        if (cover < least_cover) {
+          least_cover = cover;
+          least = j;
+        }
+      }
+      memset(q[i], 0, sizeof(q[i]));
+      q[i][least] = 1.0;
+    }
+  }
+}
+
+/* Diagonalizes a symmetric matrix with cyclic Jacobi rotations. On return, the diagonal of 'a' holds the eigenvalues,
+ * and the columns of 'v' the eigenvectors. */
+static void
+jacobi(double a[K][K], double v[K][K])
+{
+  for (int i = 0; i < K; i++) {
+    for (int j = 0; j < K; j++)
+      v[i][j] = (i == j) ? 1.0 : 0.0;
+  }
+
+  for (int sweep = 0; sweep < 32; sweep++) {
+    double off = 0.0;
+    for (int p = 0; p < K; p++) {
+      for (int q = p + 1; q < K; q++)
+        off += a[p][q] * a[p][q];
+    }
+    if (off < 1e-30)
+      break;
+
+    for (int p = 0; p < K; p++) {
+      for (int q = p + 1; q < K; q++) {
+        if (fabs(a[p][q]) < 1e-300)
+          continue;
+
+        const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+        const double t = ((theta >= 0.0) ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+        const double c = 1.0 / sqrt(t * t + 1.0);
+        const double s = t * c;
+
+        for (int k = 0; k < K; k++) {
+          const double akp = a[k][p];
+          const double akq = a[k][q];
+          a[k][p] = c * akp - s * akq;
+          a[k][q] = s * akp + c * akq;
+        }
+        for (int k = 0; k < K; k++) {
+          const double apk = a[p][k];
+          const double aqk = a[q][k];
+          a[p][k] = c * apk - s * aqk;
+          a[q][k] = s * apk + c * aqk;
+        }
+        for (int k = 0; k < K; k++) {
+          const double vkp = v[k][p];
+          const double vkq = v[k][q];
+          v[k][p] = c * vkp - s * vkq;
+          v[k][q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+}
+
+/* The mean squared error per value, in units of 0 to 255, that encoding and decoding the recent tiles leaves,
+ * quantization included. A basis that captures more of the blocks seen can still lose to the one in use once its
+ * eigenvalues are quantized to the bits a packet has for them. */
+static double
+coding_error(nanostream_basis_trainer* trainer, const nanostream_basis* basis)
+{
+  unsigned char packet[NANOSTREAM_PACKET_SIZE];
+  double total = 0.0;
+  for (int t = 0; t < trainer->num_recent; t++) {
+    nanostream_encode_tile_with_basis(basis, trainer->recent[t], TILE_PITCH, packet);
+    nanostream_decode_tile_with_basis(basis, packet, TILE_PITCH, trainer->decoded);
+    for (int i = 0; i < TILE_BYTES; i++) {
+      const int d = (int)trainer->recent[t][i] - (int)trainer->decoded[i];
+      total += (double)(d * d);
+    }
+  }
+
+  return (trainer->num_recent > 0) ? total / ((double)trainer->num_recent * TILE_BYTES) : 0.0;
+}
+
+/* Derives a basis from the blocks seen with a number of subspace iterations from 'current', and forgets some of the
+ * blocks. */
+static nanostream_basis*
+derive(nanostream_basis_trainer* trainer, const nanostream_basis* current, const int iterations)
+{
+  double(*c)[D] = malloc(sizeof(double[D][D]));
+  if (!c)
+    return NULL;
+
+  double m[D];
+  for (int i = 0; i < D; i++)
+    m[i] = trainer->sum[i] / trainer->count;
+  for (int i = 0; i < D; i++) {
+    for (int j = i; j < D; j++) {
+      c[i][j] = trainer->products[i][j] / trainer->count - m[i] * m[j];
+      c[j][i] = c[i][j];
+    }
+  }
+
+  const float(*start)[D] = current ? current->vectors : nanostream_eigen_values;
+
+  /* Subspace iteration: multiplying by the covariance and orthonormalizing again turns the vectors towards the
+   * leading eigenvectors. */
+  double q[K][D];
+  for (int i = 0; i < K; i++) {
+    for (int j = 0; j < D; j++)
+      q[i][j] = start[i][j];
+  }
+
+  for (int iteration = 0; iteration < iterations; iteration++) {
+    double z[K][D];
+    for (int i = 0; i < K; i++) {
+      for (int j = 0; j < D; j++) {
+        double s = 0.0;
+        for (int k = 0; k < D; k++)
+          s += c[j][k] * q[i][k];
+        z[i][j] = s;
+      }
+    }
+    memcpy(q, z, sizeof(q));
+    orthonormalize(q);
+  }
+
+  /* Rayleigh-Ritz: the eigenvectors of the covariance within the subspace, ordered by how much they capture. */
+  double cq[K][D];
+  for (int i = 0; i < K; i++) {
+    for (int j = 0; j < D; j++) {
+      double s = 0.0;
+      for (int k = 0; k < D; k++)
+        s += c[j][k] * q[i][k];
+      cq[i][j] = s;
+    }
+  }
+
+  double t[K][K];
+  for (int i = 0; i < K; i++) {
+    for (int k = 0; k < K; k++) {
+      double s = 0.0;
+      for (int j = 0; j < D; j++)
+        s += q[i][j] * cq[k][j];
+      t[i][k] = s;
+    }
+  }
+  for (int i = 0; i < K; i++) {
+    for (int k = i + 1; k < K; k++) {
+      t[i][k] = 0.5 * (t[i][k] + t[k][i]);
+      t[k][i] = t[i][k];
+    }
+  }
+
+  double w[K][K];
+  jacobi(t, w);
+
+  int order[K];
+  for (int i = 0; i < K; i++)
+    order[i] = i;
+  for (int i = 1; i < K; i++) {
+    const int o = order[i];
+    int k = i;
+    for (; (k > 0) && (t[order[k - 1]][order[k - 1]] < t[o][o]); k--)
+      order[k] = order[k - 1];
+    order[k] = o;
+  }
+
+  float mean[D];
+  float vectors[K][D];
+  for (int j = 0; j < D; j++)
+    mean[j] = (float)m[j];
+
+  for (int i = 0; i < K; i++) {
+    double v[D];
+    double along_start = 0.0;
+    for (int j = 0; j < D; j++) {
+      double s = 0.0;
+      for (int k = 0; k < K; k++)
+        s += w[k][order[i]] * q[k][j];
+      v[j] = s;
+      along_start += s * start[i][j];
+    }
+
+    /* The sign is arbitrary; keeping that of the vector it replaces keeps the eigenvalues of similar blocks alike. */
+    const double sign = (along_start < 0.0) ? -1.0 : 1.0;
+    for (int j = 0; j < D; j++)
+      vectors[i][j] = (float)(sign * v[j]);
+  }
+
+  free(c);
+
+  /* The blocks seen so far fade, so that the next basis follows the content as it changes. */
+  const double keep = 1.0 - trainer->config.forget;
+  trainer->count *= keep;
+  for (int i = 0; i < D; i++) {
+    trainer->sum[i] *= keep;
+    for (int j = i; j < D; j++)
+      trainer->products[i][j] *= keep;
+  }
+
+  return nanostream_basis_create(mean, &vectors[0][0]);
+}
+
+nanostream_basis*
+nanostream_basis_trainer_derive(nanostream_basis_trainer* trainer,
+                                const nanostream_basis* current,
+                                double* current_error,
+                                double* derived_error)
+{
+  if (trainer->count < (double)trainer->config.min_blocks)
+    return NULL;
+
+  nanostream_basis* derived = derive(trainer, current, ITERATIONS);
+  if (derived && current_error)
+    *current_error = coding_error(trainer, current);
+  if (derived && derived_error)
+    *derived_error = coding_error(trainer, derived);
+  return derived;
+}
+
+/* The blocks of each tile that bank training describes the tile by and derives bases from, taken at SAMPLE_STRIDE. */
+#define DESCRIPTOR_BLOCKS 32
+#define BANK_BLOCKS 64
+
+/* The size of a tile descriptor: the mean and the spread of each eigenvalue of its blocks in the built-in basis. */
+#define DESCRIPTOR_SIZE (2 * K)
+
+#define KMEANS_ITERATIONS 16
+
+/* Bank training has time to run the subspace iterations to convergence rather than follow content as it changes. */
+#define BANK_ITERATIONS 32
+
+int
+nanostream_basis_bank_load(const unsigned char* data, const size_t size, nanostream_basis** bases)
+{
+  if ((size == 0) || ((size % NANOSTREAM_BASIS_SIZE) != 0) || (size / NANOSTREAM_BASIS_SIZE > NANOSTREAM_MAX_BASES))
+    return -1;
+
+  const int num_bases = (int)(size / NANOSTREAM_BASIS_SIZE);
+  for (int i = 0; i < num_bases; i++) {
+    bases[i] = nanostream_basis_load(data + (size_t)i * NANOSTREAM_BASIS_SIZE);
+    if (!bases[i]) {
+      while (i > 0)
+        nanostream_basis_destroy(bases[--i]);
+      return -1;
+    }
+  }
+
+  return num_bases;
+}
+
+/* Describes a tile by the mean and the spread of the eigenvalues of a sample of its blocks in the built-in basis, which
+ * tell flat areas from textures, edges and colors apart. */
+static void
+describe_tile(const unsigned char* rgb, const int pitch, float* descriptor)
+{
+  double sum[K] = { 0.0 };
+  double squares[K] = { 0.0 };
+
+  for (int sample = 0; sample < DESCRIPTOR_BLOCKS; sample++) {
+    const unsigned char* in = tile_block(rgb, pitch, sample * SAMPLE_STRIDE % BLOCKS_PER_TILE);
+    double x[D];
+    for (int row = 0; row < BLOCK_SIZE; row++) {
+      for (int j = 0; j < BLOCK_SIZE * 3; j++) {
+        const int p = planar_index(row * BLOCK_SIZE * 3 + j);
+        x[p] = in[row * pitch + j] * (1.0 / 255.0) - nanostream_mean[p];
+      }
+    }
+
+    for (int i = 0; i < K; i++) {
+      double e = 0.0;
+      for (int j = 0; j < D; j++)
+        e += nanostream_eigen_values[i][j] * x[j];
+      sum[i] += e;
+      squares[i] += e * e;
+    }
+  }
+
+  for (int i = 0; i < K; i++) {
+    const double mean = sum[i] / DESCRIPTOR_BLOCKS;
+    const double variance = squares[i] / DESCRIPTOR_BLOCKS - mean * mean;
+    descriptor[i] = (float)mean;
+    descriptor[K + i] = (float)sqrt((variance > 0.0) ? variance : 0.0);
+  }
+}
+
+static float
+descriptor_distance(const float* a, const float* b)
+{
+  float d = 0.0f;
+  for (int i = 0; i < DESCRIPTOR_SIZE; i++)
+    d += (a[i] - b[i]) * (a[i] - b[i]);
+  return d;
+}
+
+/* Clusters the descriptors by k-means, seeded the k-means++ way from a fixed generator so that training repeats. */
+static void
+cluster_descriptors(const float (*descriptors)[DESCRIPTOR_SIZE],
+                    const int num_tiles,
+                    const int num_clusters,
+                    float* nearest,
+                    int* cluster)
+{
+  float(*centers)[DESCRIPTOR_SIZE] = malloc(sizeof(float[DESCRIPTOR_SIZE]) * (size_t)num_clusters);
+  int* counts = malloc(sizeof(int) * (size_t)num_clusters);
+  if (!centers || !counts) {
+    free(centers);
+    free(counts);
+    for (int t = 0; t < num_tiles; t++)
+      cluster[t] = t % num_clusters;
+    return;
+  }
+
+  uint32_t random = 1;
+  memcpy(centers[0], descriptors[0], sizeof(centers[0]));
+  for (int t = 0; t < num_tiles; t++)
+    nearest[t] = descriptor_distance(descriptors[t], centers[0]);
+
+  for (int c = 1; c < num_clusters; c++) {
+    double total = 0.0;
+    for (int t = 0; t < num_tiles; t++)
+      total += nearest[t];
+
+    random = random * SAMPLE_MULTIPLIER + SAMPLE_INCREMENT;
+    double target = total * (double)(random >> 8) / (double)(1u << 24);
+    int chosen = num_tiles - 1;
+    for (int t = 0; t < num_tiles; t++) {
+      target -= nearest[t];
+      if (target < 0.0) {
+        chosen = t;
+        break;
+      }
+    }
+
+    memcpy(centers[c], descriptors[chosen], sizeof(centers[c]));
+    for (int t = 0; t < num_tiles; t++) {
+      const float d = descriptor_distance(descriptors[t], centers[c]);
+      if (d < nearest[t])
+        nearest[t] = d;
+    }
+  }
+
+  for (int iteration = 0; iteration < KMEANS_ITERATIONS; iteration++) {
+    int moved = 0;
+    for (int t = 0; t < num_tiles; t++) {
+      int best = 0;
+      float best_distance = INFINITY;
+      for (int c = 0; c < num_clusters; c++) {
+        const float d = descriptor_distance(descriptors[t], centers[c]);
+        if (d < best_distance) {
+          best_distance = d;
+          best = c;
+        }
+      }
+      moved += ((iteration == 0) || (cluster[t] != best)) ? 1 : 0;
+      cluster[t] = best;
+    }
+    if (moved == 0)
+      break;
+
+    /* A cluster that lost all of its tiles keeps its center. */
+    memset(counts, 0, sizeof(int) * (size_t)num_clusters);
+    for (int t = 0; t < num_tiles; t++)
+      counts[cluster[t]]++;
+    for (int c = 0; c < num_clusters; c++) {
+      if (counts[c] > 0)
+        memset(centers[c], 0, sizeof(centers[c]));
+    }
+    for (int t = 0; t < num_tiles; t++) {
+      for (int i = 0; i < DESCRIPTOR_SIZE; i++)
+        centers[cluster[t]][i] += descriptors[t][i] / (float)counts[cluster[t]];
+    }
+  }
+
+  free(centers);
+  free(counts);
+}
+
+/* Derives the basis of each cluster but the first, the built-in basis, from the blocks of its tiles, starting from its
+ * basis so far. A cluster without tiles keeps its basis. Returns zero, or -1 on failure. */
+static int
+derive_clusters(nanostream_basis_trainer* trainer,
+                const unsigned char* const* tiles,
+                const int num_tiles,
+                const int pitch,
+                const int* cluster,
+                const int num_bases,
+                nanostream_basis** bases)
+{
+  for (int b = 1; b < num_bases; b++) {
+    for (int t = 0; t < num_tiles; t++) {
+      if (cluster[t] != b)
+        continue;
+      for (int sample = 0; sample < BANK_BLOCKS; sample++)
+        add_block(trainer, tile_block(tiles[t], pitch, sample * SAMPLE_STRIDE % BLOCKS_PER_TILE), pitch);
+    }
+    if (trainer->count == 0.0)
+      continue;
+
+    nanostream_basis* derived = derive(trainer, bases[b], BANK_ITERATIONS);
+    if (!derived)
+      return -1;
+    nanostream_basis_destroy(bases[b]);
+    bases[b] = derived;
+  }
+
+  return 0;
+}
+
+int
+nanostream_basis_bank_train(const nanostream_basis_bank_config* config,
+                            const unsigned char* const* tiles,
+                            const int num_tiles,
+                            const int pitch,
+                            nanostream_basis** bases)
+{
+  int num_bases = (config->num_bases > 0) ? config->num_bases : 8;
+  if (num_bases > NANOSTREAM_MAX_BASES)
+    num_bases = NANOSTREAM_MAX_BASES;
+  if (num_bases > num_tiles + 1)
+    num_bases = num_tiles + 1;
+  const int rounds = (config->rounds > 0) ? config->rounds : 4;
+
+  /* Every cluster starts from the built-in basis, and the first stays it. */
+  int created = 0;
+  for (; created < num_bases; created++) {
+    bases[created] = nanostream_basis_create(NULL, NULL);
+    if (!bases[created])
+      break;
+  }
+
+  /* Forgetting everything after each derivation leaves the trainer empty for the next cluster. */
+  nanostream_basis_trainer_config trainer_config;
+  memset(&trainer_config, 0, sizeof(trainer_config));
+  trainer_config.min_blocks = 1;
+  trainer_config.forget = 1.0;
+  nanostream_basis_trainer* trainer = nanostream_basis_trainer_create(&trainer_config);
+  float(*descriptors)[DESCRIPTOR_SIZE] = malloc(sizeof(float[DESCRIPTOR_SIZE]) * (size_t)(num_tiles + 1));
+  float* nearest = malloc(sizeof(float) * (size_t)(num_tiles + 1));
+  int* cluster = malloc(sizeof(int) * (size_t)(num_tiles + 1));
+
+  int result = -1;
+  if ((created == num_bases) && trainer && descriptors && nearest && cluster) {
+    /* The tiles are first clustered into the bases after the built-in one by what their blocks look like... */
+    for (int t = 0; t < num_tiles; t++)
+      describe_tile(tiles[t], pitch, descriptors[t]);
+    if (num_bases > 1) {
+      cluster_descriptors((const float(*)[DESCRIPTOR_SIZE])descriptors, num_tiles, num_bases - 1, nearest, cluster);
+      for (int t = 0; t < num_tiles; t++)
+        cluster[t]++;
+    }
+    result = (num_bases > 1) ? derive_clusters(trainer, tiles, num_tiles, pitch, cluster, num_bases, bases) : 0;
+
+    /* ...and then move to the basis the encoder would choose for them, until none moves. */
+    for (int round = 0; (result == 0) && (round < rounds) && (num_bases > 1); round++) {
+      int moved = 0;
+      for (int t = 0; t < num_tiles; t++) {
+        const int best = nanostream_choose_basis((const nanostream_basis* const*)bases, num_bases, tiles[t], pitch);
+        moved += (best != cluster[t]) ? 1 : 0;
+        cluster[t] = best;
+      }
+      if (moved == 0)
+        break;
+      result = derive_clusters(trainer, tiles, num_tiles, pitch, cluster, num_bases, bases);
+    }
+  }
+
+  nanostream_basis_trainer_destroy(trainer);
+  free(descriptors);
+  free(nearest);
+  free(cluster);
+
+  if (result != 0) {
+    for (int i = 0; i < created; i++)
+      nanostream_basis_destroy(bases[i]);
+    return -1;
+  }
+
+  return num_bases;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "nanostream.h"
+
+#include <stddef.h>
+
+/* Bases other than the built-in one, and their derivation from the content of a stream. The built-in basis was
+ * trained once, offline, on generic images; a basis derived from what a fixed camera or a screen actually shows
+ * captures more of each block in the same eight eigenvalues, so the quality is better at the same packet size.
+ *
+ * A trainer keeps a running mean and covariance of blocks sampled from the tiles being encoded, and derives the
+ * leading eigenvectors of the covariance by subspace iteration, starting from the basis in use, which takes a few
+ * milliseconds rather than a full eigendecomposition. Its blocks fade with every derivation, so that the basis follows
+ * the content as it changes.
+ *
+ * A decoder has to use the same basis as the encoder, so a derived basis is sent to receivers (see
+ * nanostream_net_send_basis), and encoders only switch to it once they have it (see nanostream_server.h).
+ *
+ * A bank of bases, each trained on a different kind of content, such as sky, foliage, text or skin, lets the encoder
+ * choose a basis per tile instead (see nanostream_encode_tile_with_bases). Banks are trained offline from sample
+ * images, and the encoder and the decoder load the same one. */
+
+/* The size of a stored basis: the mean and the eight vectors, as little-endian floats. */
+#define NANOSTREAM_BASIS_SIZE ((1 + 8) * 192 * 4)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* Creates a basis from a mean block and eight orthonormal vectors, in the planar order (channel, row, column) and
+   * the units (0 to 1) of nanostream_eigen.c. Null for either takes that of the built-in basis. Returns null on
+   * failure. */
+  nanostream_basis* nanostream_basis_create(const float* mean, const float* vectors);
+
+  void nanostream_basis_destroy(nanostream_basis* basis);
+
+  /* Writes NANOSTREAM_BASIS_SIZE bytes. */
+  void nanostream_basis_store(const nanostream_basis* basis, unsigned char* out);
+
+  /* Creates a basis from NANOSTREAM_BASIS_SIZE bytes written by nanostream_basis_store. Returns null on failure,
+   * including if the data is not a plausible basis. */
+  nanostream_basis* nanostream_basis_load(const unsigned char* data);
+
+  typedef struct nanostream_basis_trainer_config
+  {
+    /* One block is sampled from every sample_interval-th tile added, zero for 4. Sampling a block costs about a
+     * tenth of encoding a tile. */
+    int sample_interval;
+
+    /* The number of blocks to have seen before a basis is derived, zero for 1024. */
+    int min_blocks;
+
+    /* The share of the blocks seen so far that is forgotten after each derivation, zero for a half. One forgets them
+     * all, so each basis is derived from the blocks since the last one only. */
+    double forget;
+  } nanostream_basis_trainer_config;
+
+  /* A trainer is not safe to use from several threads at once. */
+  typedef struct nanostream_basis_trainer nanostream_basis_trainer;
+
+  /* Returns null on failure. */
+  nanostream_basis_trainer* nanostream_basis_trainer_create(const nanostream_basis_trainer_config* config);
+
+  void nanostream_basis_trainer_destroy(nanostream_basis_trainer* trainer);
+
+  /* Adds a whole tile, NANOSTREAM_TILE_WIDTH by NANOSTREAM_TILE_HEIGHT pixels of packed RGB, to sample a block from
+   * if it is its turn. */
+  void nanostream_basis_trainer_add_tile(nanostream_basis_trainer* trainer, const unsigned char* rgb, int pitch);
+
+  /* The weight of the blocks seen, which starts at zero and shrinks with every derivation. */
+  double nanostream_basis_trainer_blocks(const nanostream_basis_trainer* trainer);
+
+  /* Derives a basis from the blocks seen, starting from 'current', or the built-in basis if it is null, and forgets
+   * some of the blocks. 'current_error' and 'derived_error', unless null, receive the mean squared error per value,
+   * in units of 0 to 255, that encoding the latest blocks seen with either basis leaves, quantization included. Returns
+   * null if too few blocks were seen, or on failure. */
+  nanostream_basis* nanostream_basis_trainer_derive(nanostream_basis_trainer* trainer,
+                                                    const nanostream_basis* current,
+                                                    double* current_error,
+                                                    double* derived_error);
+
+  /* Creates the bases of a bank from 'size' bytes of bases stored one after the other by nanostream_basis_store, up
+   * to NANOSTREAM_MAX_BASES of them. Returns their number, or -1 on failure, including if the size does not fit. */
+  int nanostream_basis_bank_load(const unsigned char* data, size_t size, nanostream_basis** bases);
+
+  typedef struct nanostream_basis_bank_config
+  {
+    /* The number of bases, zero for 8, at most NANOSTREAM_MAX_BASES. The first is the built-in basis, for the tiles
+     * that none of the others suits. */
+    int num_bases;
+
+    /* The most rounds of moving tiles between bases after clustering, zero for 4. */
+    int rounds;
+  } nanostream_basis_bank_config;
+
+  /* Trains a bank of bases from whole tiles, NANOSTREAM_TILE_WIDTH by NANOSTREAM_TILE_HEIGHT pixels of packed RGB with
+   * a common pitch. The tiles are clustered by k-means on the mean and the spread of the eigenvalues of their blocks in
+   * the built-in basis, and each cluster gets the principal components of its blocks. Then, for a few rounds, every
+   * tile moves to the basis nanostream_choose_basis picks for it, and the bases are derived again. Fills in 'bases'
+   * with at most config->num_bases bases, fewer if there are too few tiles, to be destroyed by the caller, and returns
+   * their number, or -1 on failure. Takes a few seconds per thousand tiles with eight bases. */
+  int nanostream_basis_bank_train(const nanostream_basis_bank_config* config,
+                                  const unsigned char* const* tiles,
+                                  int num_tiles,
+                                  int pitch,
+                                  nanostream_basis** bases);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
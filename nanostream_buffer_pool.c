@@ -0,0 +1,250 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "nanostream_buffer_pool.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_MMAP 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define CACHE_LINE_SIZE 64
+
+#define PAGE_SIZE_4K 4096
+
+#define ROUND_UP(x, n) ((((x) + ((n) - 1)) / (n)) * (n))
+
+struct nanostream_buffer_pool
+{
+  /* The free list is a stack of buffer indices. The head holds the index of the top buffer plus one (zero when the
+   * stack is empty) in the low 32 bits and a counter in the high 32 bits, which changes on every update so that a pop
+   * racing with a pop and push of the same buffer fails its compare-and-swap (the ABA problem). */
+  _Atomic uint64_t head;
+
+  /* The index plus one of the buffer below each buffer on the stack. */
+  _Atomic uint32_t* next;
+
+  unsigned char* base;
+  size_t stride;
+  size_t buffer_size;
+  int num_buffers;
+
+  /* What was allocated, to release it. */
+  void* region;
+  size_t region_size;
+  nanostream_buffer_backing backing;
+};
+
+#ifdef HAVE_MMAP
+
+/* Writes to every page so that they are faulted in now rather than on first use. */
+static void
+touch_pages(unsigned char* data, const size_t size)
+{
+  for (size_t i = 0; i < size; i += PAGE_SIZE_4K)
+    data[i] = 0;
+}
+
+static int
+map_region(nanostream_buffer_pool* pool, const size_t size)
+{
+#ifdef MAP_HUGETLB
+  int populate = 0;
+#ifdef MAP_POPULATE
+  populate = MAP_POPULATE;
+#endif
+  void* huge = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+  if (huge != MAP_FAILED) {
+    pool->region = huge;
+    pool->region_size = size;
+    pool->base = huge;
+    pool->backing = NANOSTREAM_BUFFER_BACKING_HUGE_PAGES;
+    return 0;
+  }
+#endif
+
+  /* Over-allocate so that the region can be aligned to a huge page, which transparent huge pages require. */
+  const size_t mapped_size = size + NANOSTREAM_HUGE_PAGE_SIZE;
+  unsigned char* mapped = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED)
+    return -1;
+
+  unsigned char* aligned = (unsigned char*)ROUND_UP((uintptr_t)mapped, (uintptr_t)NANOSTREAM_HUGE_PAGE_SIZE);
+  const size_t head = (size_t)(aligned - mapped);
+  const size_t tail = mapped_size - head - size;
+  if (head > 0)
+    munmap(mapped, head);
+  if (tail > 0)
+    munmap(aligned + size, tail);
+
+  pool->region = aligned;
+  pool->region_size = size;
+  pool->base = aligned;
+  pool->backing = NANOSTREAM_BUFFER_BACKING_PAGES;
+
+#ifdef MADV_HUGEPAGE
+  if (madvise(aligned, size, MADV_HUGEPAGE) == 0)
+    pool->backing = NANOSTREAM_BUFFER_BACKING_TRANSPARENT_HUGE_PAGES;
+#endif
+
+  touch_pages(aligned, size);
+  return 0;
+}
+
+static void
+unmap_region(nanostream_buffer_pool* pool)
+{
+  munmap(pool->region, pool->region_size);
+}
+
+#else
+
+static int
+map_region(nanostream_buffer_pool* pool, const size_t size)
+{
+  unsigned char* data = malloc(size + PAGE_SIZE_4K);
+  if (!data)
+    return -1;
+
+  memset(data, 0, size + PAGE_SIZE_4K);
+  pool->region = data;
+  pool->region_size = size + PAGE_SIZE_4K;
+  pool->base = (unsigned char*)ROUND_UP((uintptr_t)data, (uintptr_t)PAGE_SIZE_4K);
+  pool->backing = NANOSTREAM_BUFFER_BACKING_HEAP;
+  return 0;
+}
+
+static void
+unmap_region(nanostream_buffer_pool* pool)
+{
+  free(pool->region);
+}
+
+#endif
+
+nanostream_buffer_pool*
+nanostream_buffer_pool_create(const size_t buffer_size, const int num_buffers)
+{
+  if ((buffer_size == 0) || (num_buffers <= 0))
+    return NULL;
+
+  const size_t stride =
+    (buffer_size >= PAGE_SIZE_4K) ? ROUND_UP(buffer_size, PAGE_SIZE_4K) : ROUND_UP(buffer_size, CACHE_LINE_SIZE);
+  if (stride > (SIZE_MAX - NANOSTREAM_HUGE_PAGE_SIZE * 2) / (size_t)num_buffers)
+    return NULL;
+
+  nanostream_buffer_pool* pool = calloc(1, sizeof(nanostream_buffer_pool));
+  if (!pool)
+    return NULL;
+
+  pool->next = malloc((size_t)num_buffers * sizeof(pool->next[0]));
+  if (!pool->next || (map_region(pool, ROUND_UP(stride * (size_t)num_buffers, NANOSTREAM_HUGE_PAGE_SIZE)) != 0)) {
+    free(pool->next);
+    free(pool);
+    return NULL;
+  }
+
+  pool->stride = stride;
+  pool->buffer_size = buffer_size;
+  pool->num_buffers = num_buffers;
+
+  /* Stack the buffers so that the first one is on top. */
+  for (int i = 0; i < num_buffers; i++)
+    atomic_init(&pool->next[i], (uint32_t)((i + 1 < num_buffers) ? (i + 2) : 0));
+
+  atomic_init(&pool->head, (uint64_t)1);
+
+  return pool;
+}
+
+void
+nanostream_buffer_pool_destroy(nanostream_buffer_pool* pool)
+{
+  if (!pool)
+    return;
+
+  unmap_region(pool);
+  free(pool->next);
+  free(pool);
+}
+
+void*
+nanostream_buffer_pool_acquire(nanostream_buffer_pool* pool)
+{
+  uint64_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+
+  for (;;) {
+    const uint32_t top = (uint32_t)head;
+    if (top == 0)
+      return NULL;
+
+    const uint32_t next = atomic_load_explicit(&pool->next[top - 1], memory_order_relaxed);
+    const uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+
+    if (atomic_compare_exchange_weak_explicit(
+          &pool->head, &head, new_head, memory_order_acquire, memory_order_acquire))
+      return pool->base + (size_t)(top - 1) * pool->stride;
+  }
+}
+
+void
+nanostream_buffer_pool_release(nanostream_buffer_pool* pool, void* buffer)
+{
+  if (!buffer)
+    return;
+
+  const uint32_t index = (uint32_t)(((unsigned char*)buffer - pool->base) / pool->stride);
+
+  uint64_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+
+  for (;;) {
+    atomic_store_explicit(&pool->next[index], (uint32_t)head, memory_order_relaxed);
+
+    const uint64_t new_head = (((head >> 32) + 1) << 32) | (index + 1);
+
+    if (atomic_compare_exchange_weak_explicit(
+          &pool->head, &head, new_head, memory_order_release, memory_order_relaxed))
+      return;
+  }
+}
+
+size_t
+nanostream_buffer_pool_buffer_size(const nanostream_buffer_pool* pool)
+{
+  return pool->buffer_size;
+}
+
+int
+nanostream_buffer_pool_num_buffers(const nanostream_buffer_pool* pool)
+{
+  return pool->num_buffers;
+}
+
+nanostream_buffer_backing
+nanostream_buffer_pool_backing(const nanostream_buffer_pool* pool)
+{
+  return pool->backing;
+}
+
+const char*
+nanostream_buffer_backing_name(const nanostream_buffer_backing backing)
+{
+  switch (backing) {
+    case NANOSTREAM_BUFFER_BACKING_HEAP:
+      return "heap";
+    case NANOSTREAM_BUFFER_BACKING_PAGES:
+      return "4 KB pages";
+    case NANOSTREAM_BUFFER_BACKING_TRANSPARENT_HUGE_PAGES:
+      return "transparent huge pages";
+    case NANOSTREAM_BUFFER_BACKING_HUGE_PAGES:
+      return "2 MB huge pages";
+  }
+  return "unknown";
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+
+/* A buffer pool hands out fixed-size buffers (frames, bands or packet slabs) carved from a single region that is
+ * allocated and faulted in up front, backed by 2 MB huge pages where the system allows it. Buffers are recycled through
+ * a lock-free free list, so acquiring and releasing them is safe from any thread and never calls malloc or takes a
+ * lock. Huge pages matter when gathering 8x8 blocks from frames with large pitches, where every row of a block would
+ * otherwise land on a different 4 KB page. */
+
+/* The size of the huge pages regions are rounded up to. */
+#define NANOSTREAM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_buffer_pool nanostream_buffer_pool;
+
+  typedef enum nanostream_buffer_backing
+  {
+    /* Allocated from the heap, on systems without mmap. */
+    NANOSTREAM_BUFFER_BACKING_HEAP = 0,
+    /* Regular pages, when neither kind of huge page is available. */
+    NANOSTREAM_BUFFER_BACKING_PAGES = 1,
+    /* A 2 MB aligned mapping for which transparent huge pages were requested with madvise. */
+    NANOSTREAM_BUFFER_BACKING_TRANSPARENT_HUGE_PAGES = 2,
+    /* Explicit huge pages from the reserved pool (MAP_HUGETLB). */
+    NANOSTREAM_BUFFER_BACKING_HUGE_PAGES = 3
+  } nanostream_buffer_backing;
+
+  /* Creates a pool of 'num_buffers' buffers of at least 'buffer_size' bytes. Buffers of 4 KB or more are page aligned,
+   * smaller ones are aligned to 64 bytes. Returns null if the memory could not be allocated. */
+  nanostream_buffer_pool* nanostream_buffer_pool_create(size_t buffer_size, int num_buffers);
+
+  /* All buffers must have been released. */
+  void nanostream_buffer_pool_destroy(nanostream_buffer_pool* pool);
+
+  /* Takes a buffer from the pool, or returns null if every buffer is in use. */
+  void* nanostream_buffer_pool_acquire(nanostream_buffer_pool* pool);
+
+  /* Returns a buffer acquired from this pool. */
+  void nanostream_buffer_pool_release(nanostream_buffer_pool* pool, void* buffer);
+
+  size_t nanostream_buffer_pool_buffer_size(const nanostream_buffer_pool* pool);
+
+  int nanostream_buffer_pool_num_buffers(const nanostream_buffer_pool* pool);
+
+  nanostream_buffer_backing nanostream_buffer_pool_backing(const nanostream_buffer_pool* pool);
+
+  /* Returns a short description of a backing, for reports. */
+  const char* nanostream_buffer_backing_name(nanostream_buffer_backing backing);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* CRC32C (Castagnoli), the checksum of iSCSI and ext4. It detects every burst error of up to 32 bits, so a damaged
+ * float in a packet header cannot slip through, and current CPUs compute it in hardware.
+ *
+ * The crc32 instruction of SSE4.2 or ARMv8 is used when the compiler targets it, and on x86-64 with GCC or Clang also
+ * when the CPU has it at run time; a portable slicing-by-8 loop otherwise. */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* Continues the checksum 'crc' over 'size' more bytes; start with zero. nanostream_crc32c(0, "123456789", 9) is
+   * 0xE3069283. */
+  uint32_t nanostream_crc32c(uint32_t crc, const void* data, size_t size);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
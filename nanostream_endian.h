@@ -0,0 +1,46 @@
+#pragma once
+
+/* Internal helpers for the little-endian fields used by the file formats. */
+
+#include <stdint.h>
+
+static inline void
+nanostream_store_u16le(unsigned char* p, const uint16_t v)
+{
+  p[0] = (unsigned char)(v & 0xFF);
+  p[1] = (unsigned char)((v >> 8) & 0xFF);
+}
+
+static inline void
+nanostream_store_u32le(unsigned char* p, const uint32_t v)
+{
+  p[0] = (unsigned char)(v & 0xFF);
+  p[1] = (unsigned char)((v >> 8) & 0xFF);
+  p[2] = (unsigned char)((v >> 16) & 0xFF);
+  p[3] = (unsigned char)((v >> 24) & 0xFF);
+}
+
+static inline void
+nanostream_store_u64le(unsigned char* p, const uint64_t v)
+{
+  nanostream_store_u32le(p, (uint32_t)(v & 0xFFFFFFFFu));
+  nanostream_store_u32le(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline uint16_t
+nanostream_load_u16le(const unsigned char* p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t
+nanostream_load_u32le(const unsigned char* p)
+{
+  return ((uint32_t)p[0]) | (((uint32_t)p[1]) << 8) | (((uint32_t)p[2]) << 16) | (((uint32_t)p[3]) << 24);
+}
+
+static inline uint64_t
+nanostream_load_u64le(const unsigned char* p)
+{
+  return ((uint64_t)nanostream_load_u32le(p)) | (((uint64_t)nanostream_load_u32le(p + 4)) << 32);
+}
@@ -0,0 +1,229 @@
+#include "nanostream_fec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Multiplies in GF(256) with the polynomial x^8 + x^4 + x^3 + x^2 + 1. Only used to build tables and matrices, never
+ * per byte of a block. */
+static unsigned char
+gf_mul(unsigned int a, unsigned int b)
+{
+  unsigned int product = 0;
+  while (b) {
+    if (b & 1u)
+      product ^= a;
+    a <<= 1;
+    if (a & 0x100u)
+      a ^= 0x11Du;
+    b >>= 1;
+  }
+  return (unsigned char)product;
+}
+
+static unsigned char
+gf_inv(const unsigned char a)
+{
+  /* a^254 = a^-1, as the multiplicative group has order 255. */
+  unsigned char result = 1;
+  unsigned char power = a;
+  for (unsigned int e = 254; e; e >>= 1) {
+    if (e & 1u)
+      result = gf_mul(result, power);
+    power = gf_mul(power, power);
+  }
+  return result;
+}
+
+/* The coefficient of data block i in parity block j. The Cauchy matrix 1 / (x_j + y_i) with x_j = j and y_i = m + i
+ * has only invertible square submatrices; scaling column i by x_0 + y_i keeps that, and makes the first row ones. */
+static unsigned char
+coefficient(const int j, const int i, const int m)
+{
+  const unsigned int y = (unsigned int)(m + i);
+  return gf_mul(y, gf_inv((unsigned char)((unsigned int)j ^ y)));
+}
+
+/* dst += c * src, using the products of c with every low and high nibble. */
+static void
+multiply_add(unsigned char* dst, const unsigned char* src, const unsigned char c, const size_t size)
+{
+  if (c == 0)
+    return;
+
+  size_t i = 0;
+
+  if (c == 1) {
+    for (; i < size; i++)
+      dst[i] ^= src[i];
+    return;
+  }
+
+  unsigned char low[16];
+  unsigned char high[16];
+  for (unsigned int n = 0; n < 16; n++) {
+    low[n] = gf_mul(c, n);
+    high[n] = gf_mul(c, n << 4);
+  }
+
+#if defined(__SSSE3__)
+  const __m128i low_table = _mm_loadu_si128((const __m128i*)low);
+  const __m128i high_table = _mm_loadu_si128((const __m128i*)high);
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  for (; i + 16 <= size; i += 16) {
+    const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+    const __m128i lo = _mm_shuffle_epi8(low_table, _mm_and_si128(s, mask));
+    const __m128i hi = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi64(s, 4), mask));
+    const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(d, _mm_xor_si128(lo, hi)));
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t low_table = vld1q_u8(low);
+  const uint8x16_t high_table = vld1q_u8(high);
+  const uint8x16_t mask = vdupq_n_u8(0x0f);
+  for (; i + 16 <= size; i += 16) {
+    const uint8x16_t s = vld1q_u8(src + i);
+    const uint8x16_t lo = vqtbl1q_u8(low_table, vandq_u8(s, mask));
+    const uint8x16_t hi = vqtbl1q_u8(high_table, vshrq_n_u8(s, 4));
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), veorq_u8(lo, hi)));
+  }
+#endif
+
+  for (; i < size; i++)
+    dst[i] ^= low[src[i] & 0x0f] ^ high[src[i] >> 4];
+}
+
+void
+nanostream_fec_encode(const unsigned char* const* data,
+                      const int k,
+                      unsigned char* const* parity,
+                      const int m,
+                      const size_t size)
+{
+  for (int j = 0; j < m; j++) {
+    memset(parity[j], 0, size);
+    for (int i = 0; i < k; i++)
+      multiply_add(parity[j], data[i], coefficient(j, i, m), size);
+  }
+}
+
+/* Inverts an n by n matrix in place by Gauss-Jordan elimination. Returns -1 if it is singular. */
+static int
+invert(unsigned char* a, const int n)
+{
+  unsigned char inverse[NANOSTREAM_FEC_MAX_PARITY * NANOSTREAM_FEC_MAX_PARITY];
+  memset(inverse, 0, (size_t)n * (size_t)n);
+  for (int i = 0; i < n; i++)
+    inverse[i * n + i] = 1;
+
+  for (int col = 0; col < n; col++) {
+    int pivot = col;
+    while ((pivot < n) && (a[pivot * n + col] == 0))
+      pivot++;
+    if (pivot == n)
+      return -1;
+
+    if (pivot != col) {
+      for (int c = 0; c < n; c++) {
+        unsigned char t = a[col * n + c];
+        a[col * n + c] = a[pivot * n + c];
+        a[pivot * n + c] = t;
+        t = inverse[col * n + c];
+        inverse[col * n + c] = inverse[pivot * n + c];
+        inverse[pivot * n + c] = t;
+      }
+    }
+
+    const unsigned char scale = gf_inv(a[col * n + col]);
+    for (int c = 0; c < n; c++) {
+      a[col * n + c] = gf_mul(a[col * n + c], scale);
+      inverse[col * n + c] = gf_mul(inverse[col * n + c], scale);
+    }
+
+    for (int r = 0; r < n; r++) {
+      const unsigned char factor = a[r * n + col];
+      if ((r == col) || (factor == 0))
+        continue;
+      for (int c = 0; c < n; c++) {
+        a[r * n + c] ^= gf_mul(factor, a[col * n + c]);
+        inverse[r * n + c] ^= gf_mul(factor, inverse[col * n + c]);
+      }
+    }
+  }
+
+  memcpy(a, inverse, (size_t)n * (size_t)n);
+  return 0;
+}
+
+int
+nanostream_fec_decode(unsigned char* const* blocks,
+                      const unsigned char* present,
+                      const int k,
+                      const int m,
+                      const size_t size)
+{
+  int missing[NANOSTREAM_FEC_MAX_PARITY];
+  int parities[NANOSTREAM_FEC_MAX_PARITY];
+  int num_missing = 0;
+  int num_parities = 0;
+
+  for (int i = 0; i < k; i++) {
+    if (present[i])
+      continue;
+    if (num_missing == m)
+      return -1;
+    missing[num_missing++] = i;
+  }
+  if (num_missing == 0)
+    return 0;
+
+  for (int j = 0; (j < m) && (num_parities < num_missing); j++) {
+    if (present[k + j])
+      parities[num_parities++] = j;
+  }
+  if (num_parities < num_missing)
+    return -1;
+
+  const int n = num_missing;
+
+  /* One parity block rebuilds one data block: the parity minus the present data is the missing block, scaled. */
+  unsigned char* syndromes = malloc((size_t)n * size);
+  if (!syndromes)
+    return -1;
+
+  for (int r = 0; r < n; r++) {
+    unsigned char* s = syndromes + (size_t)r * size;
+    memcpy(s, blocks[k + parities[r]], size);
+    for (int i = 0; i < k; i++) {
+      if (present[i])
+        multiply_add(s, blocks[i], coefficient(parities[r], i, m), size);
+    }
+  }
+
+  /* The syndromes are the submatrix of the used parity rows and missing columns times the missing blocks. */
+  unsigned char matrix[NANOSTREAM_FEC_MAX_PARITY * NANOSTREAM_FEC_MAX_PARITY];
+  for (int r = 0; r < n; r++) {
+    for (int c = 0; c < n; c++)
+      matrix[r * n + c] = coefficient(parities[r], missing[c], m);
+  }
+
+  if (invert(matrix, n) != 0) {
+    free(syndromes);
+    return -1;
+  }
+
+  for (int r = 0; r < n; r++) {
+    unsigned char* out = blocks[missing[r]];
+    memset(out, 0, size);
+    for (int c = 0; c < n; c++)
+      multiply_add(out, syndromes + (size_t)c * size, matrix[r * n + c], size);
+  }
+
+  free(syndromes);
+  return 0;
+}
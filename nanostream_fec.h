@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+
+/* Forward error correction over groups of equally sized blocks: systematic Reed-Solomon over GF(256) with a Cauchy
+ * matrix, scaled so that the first parity block is the XOR of the data blocks. With m parity blocks for k data blocks,
+ * any k of the k + m blocks rebuild the data. One parity block per group is plain XOR parity.
+ *
+ * The multiply-add kernel uses SSSE3 or NEON table lookups when the compiler targets them, and a portable loop
+ * otherwise. */
+
+/* The largest group: k data blocks and m parity blocks. */
+#define NANOSTREAM_FEC_MAX_DATA 64
+#define NANOSTREAM_FEC_MAX_PARITY 16
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* Computes the m parity blocks of k data blocks of 'size' bytes each. */
+  void nanostream_fec_encode(const unsigned char* const* data,
+                             int k,
+                             unsigned char* const* parity,
+                             int m,
+                             size_t size);
+
+  /* Rebuilds the missing data blocks of a group in place. 'blocks' holds the k data blocks followed by the m parity
+   * blocks, and 'present' says which of them were received; missing data blocks must point to writable buffers, and
+   * missing parity blocks are not read. Returns zero if every data block is present or was rebuilt, or -1 if fewer
+   * than k blocks are present. */
+  int nanostream_fec_decode(unsigned char* const* blocks,
+                            const unsigned char* present,
+                            int k,
+                            int m,
+                            size_t size);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,608 @@
+#include "nanostream_feedback.h"
+
+#include "nanostream_endian.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The ranges of losses and the refresh requests a stream keeps until they are reported. */
+#define MAX_MISSING 256
+#define MAX_REFRESH 256
+
+/* A sequence number this far from the highest one seen, ahead or behind, or a frame number this far behind, means the
+ * sender started the stream over rather than that datagrams were lost. At 4K, that is over a hundred whole frames. A
+ * loss range is therefore always short enough for a single range of a feedback datagram. */
+#define RESTART_DISTANCE UINT16_MAX
+#define RESTART_FRAMES 64
+
+/* How long a reported loss is remembered, to count it as repaired if it arrives after all. */
+#define REPORTED_EXPIRY_US 1000000
+
+/* The largest feedback payload that fits in a datagram. */
+#define MAX_FEEDBACK_PAYLOAD (NANOSTREAM_NET_MAX_DATAGRAM_SIZE - NANOSTREAM_NET_HEADER_SIZE)
+
+struct missing
+{
+  uint32_t sequence;
+  uint32_t count;
+  int reported;
+  uint64_t time_us;
+};
+
+struct reporter_stream
+{
+  int active;
+  uint32_t highest;
+  uint32_t frame;
+
+  /* The latest datagram received, echoed back to the sender. */
+  uint32_t echo_sequence;
+  uint64_t echo_arrival_us;
+
+  /* In increasing order of sequence number. */
+  struct missing* missing;
+  int num_missing;
+
+  int* refresh;
+  int num_refresh;
+
+  /* The basis held, and nonzero until a feedback datagram acknowledged it. */
+  int basis_version;
+  int acknowledge;
+
+  int sent_any;
+  uint64_t last_sent_us;
+  uint32_t next_sequence;
+};
+
+struct nanostream_feedback_reporter
+{
+  nanostream_feedback_reporter_config config;
+  struct reporter_stream* streams;
+  nanostream_feedback_reporter_stats stats;
+};
+
+nanostream_feedback_reporter*
+nanostream_feedback_reporter_create(const nanostream_feedback_reporter_config* config)
+{
+  nanostream_feedback_reporter* reporter = calloc(1, sizeof(nanostream_feedback_reporter));
+  if (!reporter)
+    return NULL;
+
+  reporter->config = *config;
+  if (reporter->config.max_streams <= 0)
+    reporter->config.max_streams = 64;
+  if (reporter->config.reorder_delay_us == 0)
+    reporter->config.reorder_delay_us = 2000;
+  if (reporter->config.interval_us == 0)
+    reporter->config.interval_us = 5000;
+
+  reporter->streams = calloc((size_t)reporter->config.max_streams, sizeof(struct reporter_stream));
+  if (!reporter->streams) {
+    free(reporter);
+    return NULL;
+  }
+
+  return reporter;
+}
+
+void
+nanostream_feedback_reporter_destroy(nanostream_feedback_reporter* reporter)
+{
+  if (!reporter)
+    return;
+
+  for (int i = 0; i < reporter->config.max_streams; i++) {
+    free(reporter->streams[i].missing);
+    free(reporter->streams[i].refresh);
+  }
+  free(reporter->streams);
+  free(reporter);
+}
+
+/* Returns the stream, allocating its lists the first time it is seen, or null. */
+static struct reporter_stream*
+reporter_stream_of(nanostream_feedback_reporter* reporter, const int stream)
+{
+  if ((stream < 0) || (stream >= reporter->config.max_streams))
+    return NULL;
+
+  struct reporter_stream* s = &reporter->streams[stream];
+  if (!s->missing) {
+    s->missing = malloc(MAX_MISSING * sizeof(struct missing));
+    s->refresh = malloc(MAX_REFRESH * sizeof(int));
+    if (!s->missing || !s->refresh) {
+      free(s->missing);
+      free(s->refresh);
+      s->missing = NULL;
+      s->refresh = NULL;
+      return NULL;
+    }
+  }
+  return s;
+}
+
+static void
+remove_missing(struct reporter_stream* s, const int index)
+{
+  memmove(&s->missing[index], &s->missing[index + 1], (size_t)(s->num_missing - index - 1) * sizeof(struct missing));
+  s->num_missing--;
+}
+
+void
+nanostream_feedback_reporter_add(nanostream_feedback_reporter* reporter,
+                                 const uint64_t now_us,
+                                 const nanostream_net_packet* packet)
+{
+  const nanostream_net_header* header = &packet->header;
+  if ((header->type != NANOSTREAM_NET_TILE) && (header->type != NANOSTREAM_NET_PARITY))
+    return;
+
+  struct reporter_stream* s = reporter_stream_of(reporter, header->stream);
+  if (!s)
+    return;
+
+  const uint32_t sequence = header->sequence;
+  const int32_t ahead = (int32_t)(sequence - s->highest);
+  const int32_t frames_ahead = (int32_t)(header->frame - s->frame);
+
+  if (!s->active || (ahead >= RESTART_DISTANCE) || (ahead <= -RESTART_DISTANCE) || (frames_ahead < -RESTART_FRAMES)) {
+    s->active = 1;
+    s->highest = sequence;
+    s->frame = header->frame;
+    s->echo_sequence = sequence;
+    s->echo_arrival_us = now_us;
+    s->num_missing = 0;
+    return;
+  }
+
+  if (frames_ahead > 0)
+    s->frame = header->frame;
+
+  if (ahead > 0) {
+    /* Only datagrams sent once are echoed, as the sender measures the round trip from when it first sent them. */
+    s->echo_sequence = sequence;
+    s->echo_arrival_us = now_us;
+
+    /* The sequence numbers skipped over are missing, however many, as a whole lost frame is the loss that matters
+     * most. When the list is full, the oldest range gives way. */
+    if (ahead > 1) {
+      if (s->num_missing == MAX_MISSING)
+        remove_missing(s, 0);
+      s->missing[s->num_missing].sequence = s->highest + 1;
+      s->missing[s->num_missing].count = (uint32_t)ahead - 1;
+      s->missing[s->num_missing].reported = 0;
+      s->missing[s->num_missing].time_us = now_us;
+      s->num_missing++;
+    }
+    s->highest = sequence;
+    return;
+  }
+
+  /* Reordered, late, or sent again: it is taken out of the range it falls in, which may split the range in two. */
+  for (int i = 0; i < s->num_missing; i++) {
+    struct missing* m = &s->missing[i];
+    const uint32_t offset = sequence - m->sequence;
+    if (offset >= m->count)
+      continue;
+
+    if (m->reported)
+      reporter->stats.repaired++;
+
+    if (m->count == 1) {
+      remove_missing(s, i);
+    } else if (offset == 0) {
+      m->sequence++;
+      m->count--;
+    } else if (offset == m->count - 1) {
+      m->count--;
+    } else if ((s->num_missing == MAX_MISSING) && (i == 0)) {
+      /* No room for both halves, and this is the oldest range, so its older half gives way. */
+      m->sequence = sequence + 1;
+      m->count -= offset + 1;
+    } else {
+      if (s->num_missing == MAX_MISSING) {
+        remove_missing(s, 0);
+        i--;
+      }
+      memmove(&s->missing[i + 1], &s->missing[i], (size_t)(s->num_missing - i) * sizeof(struct missing));
+      s->num_missing++;
+      s->missing[i].count = offset;
+      s->missing[i + 1].sequence = sequence + 1;
+      s->missing[i + 1].count -= offset + 1;
+    }
+    break;
+  }
+}
+
+void
+nanostream_feedback_reporter_request_refresh(nanostream_feedback_reporter* reporter, const int stream, const int tile)
+{
+  struct reporter_stream* s = reporter_stream_of(reporter, stream);
+  if (!s || (tile < 0))
+    return;
+
+  for (int i = 0; i < s->num_refresh; i++) {
+    if (s->refresh[i] == tile)
+      return;
+  }
+  if (s->num_refresh < MAX_REFRESH)
+    s->refresh[s->num_refresh++] = tile;
+}
+
+void
+nanostream_feedback_reporter_acknowledge_basis(nanostream_feedback_reporter* reporter,
+                                               const int stream,
+                                               const int version)
+{
+  struct reporter_stream* s = reporter_stream_of(reporter, stream);
+  if (!s)
+    return;
+
+  s->basis_version = version;
+  s->acknowledge = 1;
+}
+
+/* Builds the feedback payload of a stream from its due losses and refresh requests. Returns its size, or zero if there
+ * is nothing to report. */
+static size_t
+build_feedback(nanostream_feedback_reporter* reporter,
+               struct reporter_stream* s,
+               const uint64_t now_us,
+               unsigned char* payload)
+{
+  unsigned char* ranges = payload + NANOSTREAM_NET_FEEDBACK_HEADER_SIZE;
+  size_t size = NANOSTREAM_NET_FEEDBACK_HEADER_SIZE;
+  int num_ranges = 0;
+
+  /* Room is kept for the refresh requests, so that losses cannot crowd them out. */
+  const int num_refresh = s->num_refresh;
+  const size_t refresh_size = 2 * (size_t)num_refresh;
+
+  for (int i = 0; i < s->num_missing; i++) {
+    struct missing* m = &s->missing[i];
+    if (m->reported || (now_us - m->time_us < reporter->config.reorder_delay_us))
+      continue;
+
+    /* A loss range right after the last range extends it. */
+    unsigned char* last = ranges + 6 * (num_ranges - 1);
+    const uint32_t last_count = (num_ranges > 0) ? nanostream_load_u16le(last + 4) : 0;
+    if ((num_ranges > 0) && (nanostream_load_u32le(last) + last_count == m->sequence) &&
+        (last_count + m->count <= UINT16_MAX)) {
+      nanostream_store_u16le(last + 4, (uint16_t)(last_count + m->count));
+    } else {
+      if (size + 6 + refresh_size > MAX_FEEDBACK_PAYLOAD)
+        break;
+      nanostream_store_u32le(ranges + 6 * num_ranges, m->sequence);
+      nanostream_store_u16le(ranges + 6 * num_ranges + 4, (uint16_t)m->count);
+      num_ranges++;
+      size += 6;
+    }
+
+    m->reported = 1;
+    m->time_us = now_us;
+    reporter->stats.reported += m->count;
+  }
+
+  if ((num_ranges == 0) && (num_refresh == 0) && !s->acknowledge)
+    return 0;
+
+  unsigned char* tiles = payload + size;
+  for (int i = 0; i < num_refresh; i++)
+    nanostream_store_u16le(tiles + 2 * i, (uint16_t)s->refresh[i]);
+  size += refresh_size;
+  reporter->stats.refreshes_requested += (uint64_t)num_refresh;
+  s->num_refresh = 0;
+
+  nanostream_store_u32le(payload, s->echo_sequence);
+  nanostream_store_u32le(payload + 4, (uint32_t)(now_us - s->echo_arrival_us));
+  nanostream_store_u16le(payload + 8, (uint16_t)num_ranges);
+  nanostream_store_u16le(payload + 10, (uint16_t)num_refresh);
+  return size;
+}
+
+int
+nanostream_feedback_reporter_send(nanostream_feedback_reporter* reporter,
+                                  const uint64_t now_us,
+                                  nanostream_net_sender* sender)
+{
+  unsigned char payload[MAX_FEEDBACK_PAYLOAD];
+  int sent = 0;
+
+  for (int stream = 0; stream < reporter->config.max_streams; stream++) {
+    struct reporter_stream* s = &reporter->streams[stream];
+    if (!s->active || (s->sent_any && (now_us - s->last_sent_us < reporter->config.interval_us)))
+      continue;
+
+    /* Reported losses that never arrived are forgotten after a while. */
+    while ((s->num_missing > 0) && s->missing[0].reported && (now_us - s->missing[0].time_us > REPORTED_EXPIRY_US))
+      remove_missing(s, 0);
+
+    const size_t size = build_feedback(reporter, s, now_us, payload);
+    if (size == 0)
+      continue;
+
+    nanostream_net_header header;
+    memset(&header, 0, sizeof(header));
+    header.type = NANOSTREAM_NET_FEEDBACK;
+    header.stream = stream;
+    header.frame = (uint32_t)s->basis_version;
+    header.sequence = s->next_sequence++;
+
+    s->acknowledge = 0;
+    s->sent_any = 1;
+    s->last_sent_us = now_us;
+    if (nanostream_net_send(sender, &header, payload, size) == 0) {
+      reporter->stats.feedback_sent++;
+      sent++;
+    }
+  }
+
+  return sent;
+}
+
+void
+nanostream_feedback_reporter_get_stats(const nanostream_feedback_reporter* reporter,
+                                       nanostream_feedback_reporter_stats* stats)
+{
+  *stats = reporter->stats;
+}
+
+struct kept
+{
+  int used;
+  uint32_t sequence;
+  int tile;
+  uint64_t sent_us;
+  size_t size;
+  unsigned char* datagram;
+};
+
+struct nanostream_feedback_responder
+{
+  nanostream_feedback_responder_config config;
+
+  /* Guards everything below, as datagrams are stored by the sending thread and feedback handled by another. */
+  pthread_mutex_t lock;
+
+  /* Direct mapped by sequence number. */
+  struct kept* kept;
+  unsigned char* datagrams;
+  uint32_t mask;
+
+  double round_trip_us;
+  int basis_version;
+
+  nanostream_feedback_responder_stats stats;
+};
+
+nanostream_feedback_responder*
+nanostream_feedback_responder_create(const nanostream_feedback_responder_config* config)
+{
+  nanostream_feedback_responder* responder = calloc(1, sizeof(nanostream_feedback_responder));
+  if (!responder)
+    return NULL;
+
+  responder->config = *config;
+  if (responder->config.budget_us == 0)
+    responder->config.budget_us = 100000;
+  if (responder->config.max_datagrams <= 0)
+    responder->config.max_datagrams = 4096;
+
+  uint32_t n = 1;
+  while ((n < (uint32_t)responder->config.max_datagrams) && (n < (1u << 24)))
+    n <<= 1;
+  responder->mask = n - 1;
+
+  responder->kept = calloc(n, sizeof(struct kept));
+  responder->datagrams = malloc((size_t)n * NANOSTREAM_NET_MAX_DATAGRAM_SIZE);
+  if (!responder->kept || !responder->datagrams) {
+    free(responder->kept);
+    free(responder->datagrams);
+    free(responder);
+    return NULL;
+  }
+
+  for (uint32_t i = 0; i < n; i++)
+    responder->kept[i].datagram = responder->datagrams + (size_t)i * NANOSTREAM_NET_MAX_DATAGRAM_SIZE;
+
+  pthread_mutex_init(&responder->lock, NULL);
+  return responder;
+}
+
+void
+nanostream_feedback_responder_destroy(nanostream_feedback_responder* responder)
+{
+  if (!responder)
+    return;
+
+  pthread_mutex_destroy(&responder->lock);
+  free(responder->kept);
+  free(responder->datagrams);
+  free(responder);
+}
+
+/* Takes the entry of a sequence number for a new datagram. Called with the lock held. */
+static struct kept*
+keep(nanostream_feedback_responder* responder, const uint32_t sequence, const int tile, const uint64_t now_us)
+{
+  struct kept* k = &responder->kept[sequence & responder->mask];
+  k->used = 1;
+  k->sequence = sequence;
+  k->tile = tile;
+  k->sent_us = now_us;
+  return k;
+}
+
+void
+nanostream_feedback_responder_store(nanostream_feedback_responder* responder,
+                                    const uint64_t now_us,
+                                    const unsigned char* datagram,
+                                    const size_t size)
+{
+  nanostream_net_header header;
+  if ((size > NANOSTREAM_NET_MAX_DATAGRAM_SIZE) || (nanostream_net_parse_header(datagram, size, &header) != 0))
+    return;
+  if ((header.type != NANOSTREAM_NET_TILE) && (header.type != NANOSTREAM_NET_PARITY))
+    return;
+
+  pthread_mutex_lock(&responder->lock);
+  struct kept* k = keep(responder, header.sequence, (header.type == NANOSTREAM_NET_TILE) ? header.tile : -1, now_us);
+  memcpy(k->datagram, datagram, size);
+  k->size = size;
+  pthread_mutex_unlock(&responder->lock);
+}
+
+void
+nanostream_feedback_responder_store_tiles(nanostream_feedback_responder* responder,
+                                          const uint64_t now_us,
+                                          const nanostream_net_header* header,
+                                          const int* tile_indices,
+                                          const unsigned char* packets,
+                                          const int num_tiles,
+                                          int group_size,
+                                          const int parity_per_group)
+{
+  if (group_size < 1)
+    group_size = 1;
+  if (group_size > NANOSTREAM_FEC_MAX_DATA)
+    group_size = NANOSTREAM_FEC_MAX_DATA;
+  const int parity = (parity_per_group > NANOSTREAM_FEC_MAX_PARITY) ? NANOSTREAM_FEC_MAX_PARITY : parity_per_group;
+
+  nanostream_net_header h = *header;
+  h.type = NANOSTREAM_NET_TILE;
+
+  pthread_mutex_lock(&responder->lock);
+  for (int i = 0; i < num_tiles; i++) {
+    /* The sequence numbers of the parity of every group before this tile are skipped, as the sender does. */
+    const int groups_before = (parity > 0) ? (i / group_size) : 0;
+    h.tile = tile_indices ? tile_indices[i] : i;
+    h.sequence = header->sequence + (uint32_t)i + (uint32_t)(groups_before * parity);
+
+    struct kept* k = keep(responder, h.sequence, h.tile, now_us);
+    nanostream_net_store_header(k->datagram, &h);
+    memcpy(k->datagram + NANOSTREAM_NET_HEADER_SIZE, packets + (size_t)i * NANOSTREAM_PACKET_SIZE,
+           NANOSTREAM_PACKET_SIZE);
+    k->size = NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_PACKET_SIZE;
+    if (h.flags & NANOSTREAM_NET_FLAG_CHECKSUM)
+      k->size = nanostream_net_store_checksum(k->datagram, k->size);
+  }
+  pthread_mutex_unlock(&responder->lock);
+}
+
+/* Adds a tile to the refresh list unless it is there already. Returns the new length. */
+static int
+add_refresh(int* tiles, int count, const int max, const int tile)
+{
+  for (int i = 0; i < count; i++) {
+    if (tiles[i] == tile)
+      return count;
+  }
+  if (count < max)
+    tiles[count++] = tile;
+  return count;
+}
+
+int
+nanostream_feedback_responder_handle(nanostream_feedback_responder* responder,
+                                     const uint64_t now_us,
+                                     const nanostream_net_packet* feedback,
+                                     nanostream_net_sender* sender,
+                                     int* refresh_tiles,
+                                     const int max_refresh)
+{
+  if ((feedback->header.type != NANOSTREAM_NET_FEEDBACK) ||
+      (feedback->payload_size < NANOSTREAM_NET_FEEDBACK_HEADER_SIZE))
+    return 0;
+
+  const unsigned char* payload = feedback->payload;
+  const uint32_t echo_sequence = nanostream_load_u32le(payload);
+  const uint32_t echo_delay_us = nanostream_load_u32le(payload + 4);
+  const int num_ranges = nanostream_load_u16le(payload + 8);
+  const int num_refresh = nanostream_load_u16le(payload + 10);
+  if (feedback->payload_size !=
+      NANOSTREAM_NET_FEEDBACK_HEADER_SIZE + 6 * (size_t)num_ranges + 2 * (size_t)num_refresh)
+    return 0;
+
+  const unsigned char* ranges = payload + NANOSTREAM_NET_FEEDBACK_HEADER_SIZE;
+  const unsigned char* tiles = ranges + 6 * (size_t)num_ranges;
+  int count = 0;
+
+  const unsigned char* resend[64];
+  size_t sizes[64];
+  int num_resend = 0;
+
+  pthread_mutex_lock(&responder->lock);
+
+  responder->stats.feedback_received++;
+  if (feedback->header.frame <= 255)
+    responder->basis_version = (int)feedback->header.frame;
+
+  /* The round trip is the time since the echoed datagram was sent, less the time the receiver held on to it. */
+  const struct kept* echoed = &responder->kept[echo_sequence & responder->mask];
+  if (echoed->used && (echoed->sequence == echo_sequence) && (now_us - echoed->sent_us > echo_delay_us)) {
+    const double sample = (double)(now_us - echoed->sent_us - echo_delay_us);
+    responder->round_trip_us =
+      (responder->round_trip_us > 0.0) ? responder->round_trip_us + (sample - responder->round_trip_us) / 8.0 : sample;
+  }
+  const uint64_t one_way_us = (uint64_t)(responder->round_trip_us / 2.0);
+
+  for (int r = 0; r < num_ranges; r++) {
+    const uint32_t first = nanostream_load_u32le(ranges + 6 * r);
+    const int length = nanostream_load_u16le(ranges + 6 * r + 4);
+
+    for (int i = 0; i < length; i++) {
+      const uint32_t sequence = first + (uint32_t)i;
+      struct kept* k = &responder->kept[sequence & responder->mask];
+      if (!k->used || (k->sequence != sequence)) {
+        responder->stats.forgotten++;
+        continue;
+      }
+
+      if ((now_us - k->sent_us) + one_way_us > responder->config.budget_us) {
+        responder->stats.expired++;
+        if (k->tile >= 0)
+          count = add_refresh(refresh_tiles, count, max_refresh, k->tile);
+        continue;
+      }
+
+      /* The flag is covered by the checksum, if there is one. */
+      unsigned char* flags = k->datagram + 6;
+      const unsigned int f = nanostream_load_u16le(flags);
+      if (!(f & NANOSTREAM_NET_FLAG_RETRANSMITTED)) {
+        nanostream_store_u16le(flags, (uint16_t)(f | NANOSTREAM_NET_FLAG_RETRANSMITTED));
+        if (f & NANOSTREAM_NET_FLAG_CHECKSUM)
+          nanostream_net_store_checksum(k->datagram, k->size - NANOSTREAM_NET_CHECKSUM_SIZE);
+      }
+      resend[num_resend] = k->datagram;
+      sizes[num_resend] = k->size;
+      if (++num_resend == 64) {
+        responder->stats.retransmitted += (uint64_t)nanostream_net_send_datagrams(sender, resend, sizes, num_resend);
+        num_resend = 0;
+      }
+    }
+  }
+
+  if (num_resend > 0)
+    responder->stats.retransmitted += (uint64_t)nanostream_net_send_datagrams(sender, resend, sizes, num_resend);
+
+  for (int i = 0; i < num_refresh; i++)
+    count = add_refresh(refresh_tiles, count, max_refresh, nanostream_load_u16le(tiles + 2 * i));
+  responder->stats.refreshes += (uint64_t)count;
+
+  pthread_mutex_unlock(&responder->lock);
+
+  return count;
+}
+
+void
+nanostream_feedback_responder_get_stats(nanostream_feedback_responder* responder,
+                                        nanostream_feedback_responder_stats* stats)
+{
+  pthread_mutex_lock(&responder->lock);
+  *stats = responder->stats;
+  stats->round_trip_us = (uint64_t)responder->round_trip_us;
+  stats->basis_version = responder->basis_version;
+  pthread_mutex_unlock(&responder->lock);
+}
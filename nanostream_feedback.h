@@ -0,0 +1,151 @@
+#pragma once
+
+#include "nanostream_net.h"
+
+#include <stdint.h>
+
+/* A low-rate back channel from receivers to senders. A reporter on the receiving side watches the sequence numbers of
+ * each stream, and once a gap has had time to be filled by reordering, reports the missing datagrams in a feedback
+ * datagram, together with any tiles the receiver wants refreshed. Each loss is reported once, and a stream sends at
+ * most one feedback datagram per interval. Only a sequence number far ahead or behind, or a frame number far behind,
+ * is taken as the sender starting the stream over; any shorter gap, such as a whole lost frame, is reported.
+ *
+ * A responder on the sending side keeps a copy of the datagrams it sent recently. It sends a reported datagram again
+ * only if it can still arrive within the latency budget, judged from when it was first sent and the measured round
+ * trip time; otherwise a lost tile is better refreshed in a later frame, and the responder hands it back to the caller
+ * for that, as it does the tiles the receiver asked to refresh. With the encode server, refreshing a tile means
+ * encoding it in the next frame even if it did not change (see nanostream_server_refresh_tiles), so a lost tile is
+ * never left stale without sending periodic full frames.
+ *
+ * Feedback also acknowledges the basis a receiver holds, so that a sender adapting its basis to the content (see
+ * nanostream_basis.h) knows when it can switch to a new one.
+ *
+ * Neither side reads clocks: the caller passes the time to every call. Linux only, like nanostream_net.h. */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_feedback_reporter_config
+  {
+    /* The streams 0 to max_streams - 1 are tracked; zero for 64. */
+    int max_streams;
+
+    /* How long a gap in the sequence numbers is left for reordering to fill before it is reported, zero for 2 ms. */
+    uint64_t reorder_delay_us;
+
+    /* The shortest time between feedback datagrams of a stream, zero for 5 ms. */
+    uint64_t interval_us;
+  } nanostream_feedback_reporter_config;
+
+  typedef struct nanostream_feedback_reporter_stats
+  {
+    uint64_t feedback_sent;
+
+    /* Datagrams reported lost, and those of them that arrived afterwards, retransmitted or just late. */
+    uint64_t reported;
+    uint64_t repaired;
+
+    uint64_t refreshes_requested;
+  } nanostream_feedback_reporter_stats;
+
+  typedef struct nanostream_feedback_reporter nanostream_feedback_reporter;
+
+  /* Returns null on failure. */
+  nanostream_feedback_reporter* nanostream_feedback_reporter_create(const nanostream_feedback_reporter_config* config);
+
+  void nanostream_feedback_reporter_destroy(nanostream_feedback_reporter* reporter);
+
+  /* Passes every datagram received at now_us through here, including retransmitted ones. */
+  void nanostream_feedback_reporter_add(nanostream_feedback_reporter* reporter,
+                                        uint64_t now_us,
+                                        const nanostream_net_packet* packet);
+
+  /* Asks for a tile of a stream to be refreshed, for example because it was concealed. */
+  void nanostream_feedback_reporter_request_refresh(nanostream_feedback_reporter* reporter, int stream, int tile);
+
+  /* Acknowledges that the receiver holds the basis 'version' of a stream, zero for the built-in one. The next feedback
+   * datagram of the stream is sent even if there is nothing else to report; it and all later ones carry the version.
+   * Call it whenever nanostream_net_bases_add returns a version, as the acknowledgement may be lost. */
+  void nanostream_feedback_reporter_acknowledge_basis(nanostream_feedback_reporter* reporter, int stream, int version);
+
+  /* Sends the feedback that is due at now_us through 'sender', which is addressed to the responder. Returns the number
+   * of feedback datagrams sent. */
+  int nanostream_feedback_reporter_send(nanostream_feedback_reporter* reporter,
+                                        uint64_t now_us,
+                                        nanostream_net_sender* sender);
+
+  void nanostream_feedback_reporter_get_stats(const nanostream_feedback_reporter* reporter,
+                                              nanostream_feedback_reporter_stats* stats);
+
+  typedef struct nanostream_feedback_responder_config
+  {
+    /* How long after a datagram was first sent a retransmission may still arrive, zero for 100 ms. */
+    uint64_t budget_us;
+
+    /* The number of datagrams kept for retransmission, rounded up to a power of two, zero for 4096. A datagram is
+     * forgotten once another one takes its place. */
+    int max_datagrams;
+  } nanostream_feedback_responder_config;
+
+  typedef struct nanostream_feedback_responder_stats
+  {
+    uint64_t feedback_received;
+
+    /* Reported datagrams that were sent again, that were too old to be worth it, and that were no longer kept. */
+    uint64_t retransmitted;
+    uint64_t expired;
+    uint64_t forgotten;
+
+    /* Tiles handed back to be refreshed, whether the receiver asked for them or their retransmission expired. */
+    uint64_t refreshes;
+
+    /* The smoothed round trip time, zero until measured. */
+    uint64_t round_trip_us;
+
+    /* The version of the basis acknowledged by the latest feedback, zero for the built-in one. */
+    int basis_version;
+  } nanostream_feedback_responder_stats;
+
+  /* Keeps the datagrams of one stream. Its functions may be called from different threads. */
+  typedef struct nanostream_feedback_responder nanostream_feedback_responder;
+
+  /* Returns null on failure. */
+  nanostream_feedback_responder* nanostream_feedback_responder_create(
+    const nanostream_feedback_responder_config* config);
+
+  void nanostream_feedback_responder_destroy(nanostream_feedback_responder* responder);
+
+  /* Keeps a copy of a tile or parity datagram sent at now_us. */
+  void nanostream_feedback_responder_store(nanostream_feedback_responder* responder,
+                                           uint64_t now_us,
+                                           const unsigned char* datagram,
+                                           size_t size);
+
+  /* Keeps copies of the tiles sent at now_us by nanostream_net_send_tiles_with_parity with the same arguments, or by
+   * nanostream_net_send_tiles if 'parity_per_group' is zero. Parity datagrams are not kept. */
+  void nanostream_feedback_responder_store_tiles(nanostream_feedback_responder* responder,
+                                                 uint64_t now_us,
+                                                 const nanostream_net_header* header,
+                                                 const int* tile_indices,
+                                                 const unsigned char* packets,
+                                                 int num_tiles,
+                                                 int group_size,
+                                                 int parity_per_group);
+
+  /* Handles a feedback datagram received at now_us: sends the reported datagrams again through 'sender' if they can
+   * still arrive in time, and returns the tiles to refresh in a later frame, at most 'max_refresh' of them. */
+  int nanostream_feedback_responder_handle(nanostream_feedback_responder* responder,
+                                           uint64_t now_us,
+                                           const nanostream_net_packet* feedback,
+                                           nanostream_net_sender* sender,
+                                           int* refresh_tiles,
+                                           int max_refresh);
+
+  void nanostream_feedback_responder_get_stats(nanostream_feedback_responder* responder,
+                                               nanostream_feedback_responder_stats* stats);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,235 @@
+#include "nanostream_fixed.h"
+
+#include "nanostream.h"
+#include "nanostream_endian.h"
+
+#include <stdint.h>
+
+#define NUM_VALUES_PER_BLOCK 192
+#define NUM_EIGEN_VALUES 8
+#define BLOCK_SIZE 8
+#define BYTES_PER_EV_BLOCK 4
+#define BLOCKS_PER_X (NANOSTREAM_TILE_WIDTH / BLOCK_SIZE)
+#define BLOCKS_PER_Y (NANOSTREAM_TILE_HEIGHT / BLOCK_SIZE)
+
+/* The fractional bits of the reciprocals the encoder quantizes with. */
+#define RECIPROCAL_BITS 48
+
+/* The decoder dequantizes coefficients to Q16. */
+#define DECODE_FRAC_BITS 16
+
+extern const int32_t nanostream_fixed_mean[NUM_VALUES_PER_BLOCK];
+/* The basis has between 15 and 18 fractional bits, depending on its largest entry. */
+extern const int nanostream_fixed_basis_frac_bits;
+extern const int16_t nanostream_fixed_basis[NUM_EIGEN_VALUES][NUM_VALUES_PER_BLOCK];
+extern const int32_t nanostream_fixed_mean_projection[NUM_EIGEN_VALUES];
+
+/* The number of quantization steps of each coefficient, matching the [8,8,4,4,2,2,2,2] bit packing. */
+static const uint32_t resolutions[NUM_EIGEN_VALUES] = { 255, 255, 15, 15, 3, 3, 3, 3 };
+
+/* Projects a block onto the basis, scaled by 255 * 2^nanostream_fixed_basis_frac_bits. Each basis vector has unit
+ * length, so the magnitudes of its 192 entries sum to at most sqrt(192) < 14 and the sums stay below 14 * 255 * 2^18
+ * < 2^31. */
+static void
+block_coefficients(const unsigned char* rgb, const int pitch, int32_t* s)
+{
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+    s[i] = -nanostream_fixed_mean_projection[i];
+
+  for (int c = 0; c < 3; c++) {
+    for (int y = 0; y < BLOCK_SIZE; y++) {
+      const unsigned char* line = rgb + y * pitch + c;
+      for (int x = 0; x < BLOCK_SIZE; x++) {
+        const int32_t p = (int32_t)line[x * 3];
+        const int j = c * (BLOCK_SIZE * BLOCK_SIZE) + y * BLOCK_SIZE + x;
+        for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+          s[i] += p * (int32_t)nanostream_fixed_basis[i][j];
+      }
+    }
+  }
+}
+
+/* Returns the bits of the float nearest to n / d, for d > 0, using integer arithmetic only. */
+static uint32_t
+ratio_to_f32_bits(const int32_t n, const uint32_t d)
+{
+  if (n == 0)
+    return 0;
+
+  const uint32_t sign = (n < 0) ? 0x80000000u : 0;
+  uint64_t num = (n < 0) ? (uint64_t)(-(int64_t)n) : (uint64_t)n;
+  uint64_t den = d;
+
+  /* Scale so that the quotient has 24 significant bits: num / den = m * 2^-k with 2^23 <= m < 2^24. */
+  int k = 0;
+  while (num < (den << 23)) {
+    num <<= 1;
+    k++;
+  }
+  while (num >= (den << 24)) {
+    den <<= 1;
+    k--;
+  }
+
+  uint64_t m = (num + den / 2) / den;
+  if (m >> 24) {
+    m >>= 1;
+    k--;
+  }
+
+  const int exponent = 127 + 23 - k;
+  if (exponent <= 0)
+    return sign;
+  if (exponent >= 255)
+    return sign | 0x7F800000u;
+
+  return sign | ((uint32_t)exponent << 23) | ((uint32_t)m & 0x7FFFFFu);
+}
+
+/* Converts the bits of a float to a fixed point number with DECODE_FRAC_BITS fractional bits, saturating. Denormals
+ * and not-a-number become zero. */
+static int32_t
+f32_bits_to_fixed(const uint32_t bits)
+{
+  const int exponent = (int)((bits >> 23) & 0xFF);
+  const int negative = (bits >> 31) != 0;
+
+  if ((exponent == 0) || ((exponent == 255) && ((bits & 0x7FFFFFu) != 0)))
+    return 0;
+
+  const uint32_t m = (bits & 0x7FFFFFu) | 0x800000u;
+
+  /* value * 2^DECODE_FRAC_BITS = m * 2^shift */
+  const int shift = exponent - 150 + DECODE_FRAC_BITS;
+
+  uint32_t v;
+  if ((exponent == 255) || (shift >= 8)) {
+    v = 0x7FFFFFFFu;
+  } else if (shift >= 0) {
+    v = m << shift;
+    if (v > 0x7FFFFFFFu)
+      v = 0x7FFFFFFFu;
+  } else if (shift > -25) {
+    v = (m + (1u << (-shift - 1))) >> -shift;
+  } else {
+    v = 0;
+  }
+
+  return negative ? -(int32_t)v : (int32_t)v;
+}
+
+void
+nanostream_fixed_encode_tile(const unsigned char* rgb, const int pitch, unsigned char* packet_buffer)
+{
+  int32_t s[NUM_EIGEN_VALUES];
+  int32_t s_min[NUM_EIGEN_VALUES];
+  int32_t s_max[NUM_EIGEN_VALUES];
+
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    s_min[i] = INT32_MAX;
+    s_max[i] = INT32_MIN;
+  }
+
+  /* First pass: the range of each coefficient. */
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      block_coefficients(rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3), pitch, s);
+      for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+        s_min[i] = (s[i] < s_min[i]) ? s[i] : s_min[i];
+        s_max[i] = (s[i] > s_max[i]) ? s[i] : s_max[i];
+      }
+    }
+  }
+
+  const uint32_t scale = 255u << nanostream_fixed_basis_frac_bits;
+
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+    nanostream_store_u32le(packet_buffer + i * 4, ratio_to_f32_bits(s_min[i], scale));
+
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+    nanostream_store_u32le(packet_buffer + (NUM_EIGEN_VALUES + i) * 4, ratio_to_f32_bits(s_max[i], scale));
+
+  packet_buffer += NUM_EIGEN_VALUES * 2 * 4;
+
+  /* q = round((s - s_min) * resolution / (s_max - s_min)), with the division replaced by a reciprocal with
+   * RECIPROCAL_BITS fractional bits. Since s - s_min <= s_max - s_min, the product is below resolution *
+   * 2^RECIPROCAL_BITS and fits in 64 bits, and since the range is below 2^32 the reciprocal keeps at least 16
+   * significant bits more than the quantization needs. */
+  uint64_t reciprocal[NUM_EIGEN_VALUES];
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    const uint32_t range = (uint32_t)(s_max[i] - s_min[i]);
+    reciprocal[i] = (range > 0) ? (((uint64_t)resolutions[i] << RECIPROCAL_BITS) / range) : 0;
+  }
+
+  /* Second pass: quantize. */
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      block_coefficients(rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3), pitch, s);
+
+      uint32_t q[NUM_EIGEN_VALUES];
+      for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+        const uint64_t offset = (uint64_t)(uint32_t)(s[i] - s_min[i]);
+        q[i] = (uint32_t)((offset * reciprocal[i] + ((uint64_t)1 << (RECIPROCAL_BITS - 1))) >> RECIPROCAL_BITS);
+        q[i] = (q[i] > resolutions[i]) ? resolutions[i] : q[i];
+      }
+
+      packet_buffer[0] = (unsigned char)(q[0] & 0xFF);
+      packet_buffer[1] = (unsigned char)(q[1] & 0xFF);
+      packet_buffer[2] = (unsigned char)(((q[2] & 0x0F) << 4) | (q[3] & 0x0F));
+      packet_buffer[3] =
+        (unsigned char)((q[4] & 0x03) | ((q[5] & 0x03) << 2) | ((q[6] & 0x03) << 4) | ((q[7] & 0x03) << 6));
+      packet_buffer += BYTES_PER_EV_BLOCK;
+    }
+  }
+}
+
+void
+nanostream_fixed_decode_tile(const unsigned char* packet_buffer, const int pitch, unsigned char* rgb)
+{
+  int32_t ev_min[NUM_EIGEN_VALUES];
+  int32_t ev_range[NUM_EIGEN_VALUES];
+
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    ev_min[i] = f32_bits_to_fixed(nanostream_load_u32le(packet_buffer + i * 4));
+    const int32_t ev_max = f32_bits_to_fixed(nanostream_load_u32le(packet_buffer + (NUM_EIGEN_VALUES + i) * 4));
+    ev_range[i] = (int32_t)((int64_t)ev_max - (int64_t)ev_min[i]);
+  }
+
+  packet_buffer += NUM_EIGEN_VALUES * 2 * 4;
+
+  /* Q16 coefficients times the basis accumulate with this many fractional bits. */
+  const int acc_frac_bits = DECODE_FRAC_BITS + nanostream_fixed_basis_frac_bits;
+  const int64_t acc_half = (int64_t)1 << (acc_frac_bits - 1);
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      const unsigned char b2 = packet_buffer[2];
+      const unsigned char b3 = packet_buffer[3];
+      const uint32_t q[NUM_EIGEN_VALUES] = { packet_buffer[0],  packet_buffer[1],  (b2 >> 4) & 0x0F, b2 & 0x0F,
+                                             b3 & 0x03,         (b3 >> 2) & 0x03, (b3 >> 4) & 0x03, (b3 >> 6) & 0x03 };
+      packet_buffer += BYTES_PER_EV_BLOCK;
+
+      int32_t ev[NUM_EIGEN_VALUES];
+      for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+        ev[i] = ev_min[i] + (int32_t)(((int64_t)q[i] * ev_range[i]) / (int64_t)resolutions[i]);
+
+      unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
+
+      for (int c = 0; c < 3; c++) {
+        for (int y = 0; y < BLOCK_SIZE; y++) {
+          unsigned char* line = block_rgb_ptr + y * pitch + c;
+          for (int x = 0; x < BLOCK_SIZE; x++) {
+            const int j = c * (BLOCK_SIZE * BLOCK_SIZE) + y * BLOCK_SIZE + x;
+
+            int64_t acc = (int64_t)nanostream_fixed_mean[j] * ((int64_t)1 << (acc_frac_bits - 31));
+            for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+              acc += (int64_t)ev[i] * nanostream_fixed_basis[i][j];
+
+            const int64_t v = (acc > 0) ? ((acc * 255 + acc_half) >> acc_frac_bits) : 0;
+            line[x * 3] = (unsigned char)((v > 255) ? 255 : v);
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+/* An integer-only implementation of the codec for microcontrollers and other targets without an FPU or libm. It
+ * needs nothing but a freestanding C99 environment: the basis is stored in flash as 16-bit fixed point tables
+ * (nanostream_fixed_tables.c, generated by fixed_point_tables.py), the floats of the coefficient ranges in the packet
+ * are packed and unpacked with integer arithmetic, and no static RAM is used.
+ *
+ * The packets are the same as those of nanostream_encode_tile and nanostream_decode_tile, with the floats stored
+ * little-endian, so fixed point and floating point encoders and decoders can be mixed freely. The results differ from
+ * the floating point codec by rounding only.
+ *
+ * The encoder works a block at a time and makes two passes over the tile, one to find the coefficient ranges and one
+ * to quantize, instead of keeping the coefficients of all 300 blocks. Neither function uses more than
+ * NANOSTREAM_FIXED_STACK_BOUND bytes of stack; the nanostream_fixed_footprint target reports the exact stack, flash and
+ * RAM use for the compiler in use. */
+
+#define NANOSTREAM_FIXED_STACK_BOUND 512
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  void nanostream_fixed_encode_tile(const unsigned char* rgb, int pitch, unsigned char* packet_buffer);
+
+  void nanostream_fixed_decode_tile(const unsigned char* packet_buffer, int pitch, unsigned char* rgb);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
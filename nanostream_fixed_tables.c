@@ -0,0 +1,24 @@
+/* Generated by fixed_point_tables.py from nanostream_eigen.c. */
+
+#include <stdint.h>
+
+const int32_t nanostream_fixed_mean[192] = {
+  1010560128, 1010662272, 1010647808, 1010662080, 1010387072, 1010394688, 1010434624, 1010386752, 1010396416, 1010474176, 1010454528, 1010496704, 1010406464, 1010440192, 1010306944, 1010152192, 1010238144, 1010239424, 1010239424, 1010335168, 1010371776, 1010281088, 1010148352, 1010029376, 1010051648, 1010122944, 1010067712, 1010052864, 1010079616, 1010099712, 1009961088, 1009880896, 1009906432, 1009889152, 1009892032, 1009892160, 1009968512, 1010012480, 1009833024, 1009698240, 1009803328, 1009820736, 1009702912, 1009671616, 1009758592, 1009793920, 1009604800, 1009499584, 1009617600, 1009661824, 1009529344, 1009505984, 1009488832, 1009450304, 1009412544, 1009425664, 1009379648, 1009334912, 1009331776, 1009307264, 1009276160, 1009284672, 1009240768, 1009145920, 960596224, 960694144, 960657792, 960658496, 960413376, 960383168, 960438080, 960421760, 960313472, 960379008, 960326016, 960375744, 960322560, 960342016, 960219264, 960068288, 960034240, 960047680, 959993408, 960029056, 960092736, 959991040, 959911232, 959792512, 959676608, 959764608, 959635392, 959633152, 959616320, 959625408, 959512768, 959438464, 959333952, 959347648, 959327232, 959344256, 959350528, 959394432, 959244928, 959102080, 959040384, 959103296, 958965184, 958930240, 959020928, 959072000, 958860864, 958754304, 958746112, 958821440, 958682432, 958658880, 958599872, 958567424, 958516992, 958500096, 958390016, 958390848, 958363520, 958287424, 958248128, 958240832, 958201920, 958111168, 874832064, 874903680, 874860096, 874885376, 874685760, 874645440, 874705600, 874658752, 874421632, 874429312, 874404160, 874434944, 874391296, 874398144, 874298496, 874165824, 873959744, 873921152, 873862912, 873935232, 874020864, 873919744, 873847872, 873740928, 873434752, 873525440, 873426688, 873389120, 873398080, 873410240, 873322944, 873238592, 872979584, 872988736, 872945472, 872916928, 872954176, 873008448, 872903936, 872763392, 872577984, 872586112, 872440448, 872410624, 872488640, 872559296, 872378368, 872258496, 872090944, 872151232, 872003136, 871991424, 871945856, 871906432, 871880384, 871888128, 871574528, 871535360, 871526784, 871446528, 871415552, 871461312, 871400384, 871334976
+};
+
+const int nanostream_fixed_basis_frac_bits = 18;
+
+const int16_t nanostream_fixed_basis[8][192] = {
+  { 17831, 18017, 18134, 18195, 18196, 18137, 18015, 17833, 18049, 18250, 18378, 18446, 18444, 18376, 18245, 18047, 18190, 18400, 18533, 18603, 18601, 18530, 18393, 18189, 18257, 18473, 18609, 18678, 18681, 18611, 18470, 18254, 18252, 18468, 18607, 18679, 18681, 18610, 18468, 18250, 18180, 18392, 18525, 18595, 18597, 18529, 18389, 18176, 18032, 18233, 18362, 18428, 18429, 18363, 18233, 18033, 17809, 17992, 18110, 18173, 18172, 18115, 17998, 17812, 18616, 18806, 18925, 18986, 18988, 18929, 18805, 18619, 18833, 19038, 19168, 19238, 19236, 19165, 19032, 18830, 18972, 19186, 19321, 19392, 19391, 19316, 19176, 18968, 19035, 19254, 19394, 19465, 19468, 19395, 19250, 19031, 19025, 19246, 19386, 19460, 19462, 19390, 19245, 19023, 18946, 19162, 19298, 19370, 19372, 19302, 19160, 18945, 18795, 18999, 19130, 19197, 19196, 19131, 19000, 18796, 18566, 18752, 18871, 18935, 18934, 18877, 18757, 18569, 18908, 19088, 19202, 19259, 19261, 19203, 19084, 18906, 19111, 19306, 19430, 19495, 19493, 19424, 19298, 19105, 19239, 19444, 19572, 19639, 19637, 19566, 19433, 19234, 19297, 19505, 19637, 19705, 19706, 19637, 19499, 19290, 19283, 19492, 19626, 19697, 19697, 19628, 19490, 19278, 19204, 19408, 19537, 19606, 19608, 19542, 19404, 19199, 19055, 19248, 19372, 19436, 19437, 19373, 19248, 19055, 18834, 19008, 19123, 19182, 19181, 19126, 19013, 18835 },
+  { 23130, 23388, 23553, 23630, 23616, 23543, 23359, 23079, 23415, 23707, 23883, 23951, 23950, 23863, 23665, 23373, 23603, 23901, 24093, 24169, 24164, 24064, 23857, 23562, 23692, 23992, 24179, 24275, 24269, 24155, 23949, 23647, 23675, 23976, 24161, 24259, 24244, 24127, 23925, 23624, 23553, 23834, 24014, 24107, 24103, 23997, 23801, 23500, 23344, 23607, 23773, 23858, 23860, 23759, 23564, 23295, 23024, 23264, 23428, 23508, 23491, 23398, 23240, 22988, -9, 66, 110, 120, 110, 95, 34, -55, 64, 156, 203, 209, 210, 180, 118, 33, 121, 210, 266, 275, 264, 234, 166, 78, 141, 230, 274, 299, 287, 249, 182, 91, 125, 212, 254, 282, 267, 218, 152, 66, 72, 144, 182, 206, 199, 166, 105, 12, -2, 67, 101, 117, 117, 82, 22, -50, -110, -44, -8, 5, -10, -42, -76, -150, -22347, -22431, -22489, -22530, -22534, -22499, -22451, -22381, -22447, -22530, -22600, -22652, -22651, -22627, -22563, -22475, -22508, -22604, -22672, -22720, -22729, -22698, -22635, -22537, -22537, -22640, -22716, -22754, -22764, -22740, -22670, -22575, -22534, -22636, -22719, -22756, -22769, -22752, -22680, -22577, -22516, -22620, -22695, -22731, -22743, -22716, -22649, -22554, -22444, -22547, -22621, -22661, -22664, -22646, -22589, -22482, -22339, -22438, -22499, -22532, -22553, -22530, -22462, -22371 },
+  { -23318, -25386, -26609, -27252, -27208, -26530, -25241, -23170, -20665, -22699, -23911, -24505, -24458, -23787, -22553, -20535, -14053, -15467, -16301, -16725, -16716, -16266, -15385, -13939, -5040, -5575, -5860, -6032, -5968, -5810, -5507, -4955, 4904, 5411, 5741, 5904, 5959, 5839, 5539, 5063, 13880, 15334, 16233, 16719, 16768, 16349, 15520, 14068, 20528, 22574, 23820, 24555, 24590, 23960, 22755, 20680, 23198, 25289, 26582, 27256, 27316, 26663, 25359, 23319, -23376, -25496, -26743, -27394, -27349, -26652, -25338, -23226, -20716, -22781, -24021, -24625, -24578, -23905, -22639, -20584, -14064, -15502, -16340, -16777, -16771, -16301, -15393, -13928, -4990, -5538, -5810, -5963, -5907, -5744, -5406, -4873, 5019, 5548, 5898, 6081, 6142, 6014, 5719, 5222, 14062, 15555, 16487, 16991, 17047, 16625, 15775, 14296, 20768, 22869, 24156, 24898, 24941, 24302, 23076, 20947, 23448, 25585, 26923, 27615, 27689, 27014, 25691, 23596, -22476, -24487, -25659, -26287, -26248, -25580, -24323, -22305, -19906, -21868, -23041, -23624, -23583, -22943, -21742, -19777, -13548, -14916, -15723, -16140, -16125, -15690, -14831, -13445, -4902, -5416, -5683, -5835, -5763, -5614, -5298, -4783, 4621, 5119, 5452, 5623, 5686, 5567, 5274, 4796, 13239, 14645, 15519, 15990, 16045, 15646, 14836, 13419, 19612, 21610, 22828, 23518, 23544, 22925, 21762, 19736, 22170, 24197, 25463, 26111, 26166, 25518, 24249, 22254 },
+  { -22709, -19976, -13523, -4741, 4984, 13860, 20297, 22884, -25159, -22336, -15180, -5304, 5616, 15488, 22646, 25319, -26691, -23828, -16223, -5703, 5939, 16443, 23968, 26780, -27508, -24586, -16786, -5986, 6051, 16874, 24649, 27552, -27517, -24593, -16804, -6018, 6015, 16833, 24669, 27527, -26715, -23833, -16274, -5838, 5809, 16265, 23870, 26743, -25222, -22483, -15270, -5465, 5421, 15263, 22446, 25221, -22787, -20116, -13622, -4848, 4789, 13540, 20048, 22707, -23120, -20368, -13830, -4934, 4950, 13955, 20516, 23140, -25601, -22780, -15537, -5522, 5581, 15612, 22892, 25608, -27149, -24285, -16592, -5919, 5906, 16586, 24232, 27085, -27981, -25034, -17146, -6189, 6036, 17022, 24921, 27865, -27985, -25054, -17158, -6209, 6003, 16990, 24930, 27832, -27168, -24272, -16607, -6021, 5801, 16408, 24118, 27027, -25636, -22871, -15573, -5623, 5410, 15394, 22672, 25474, -23141, -20442, -13889, -4996, 4764, 13635, 20215, 22904, -22015, -19332, -13053, -4584, 4790, 13366, 19560, 22062, -24383, -21623, -14679, -5155, 5378, 14939, 21823, 24397, -25848, -23052, -15692, -5536, 5680, 15846, 23093, 25789, -26627, -23777, -16215, -5784, 5819, 16273, 23736, 26521, -26624, -23779, -16222, -5811, 5794, 16230, 23743, 26481, -25834, -23021, -15694, -5628, 5595, 15664, 22971, 25711, -24350, -21676, -14713, -5258, 5222, 14690, 21581, 24224, -21983, -19370, -13110, -4680, 4591, 13013, 19243, 21777 },
+  { -13279, -13257, -13246, -13213, -13192, -13166, -13138, -13094, -13283, -13241, -13241, -13174, -13155, -13144, -13138, -13105, -13238, -13259, -13213, -13135, -13092, -13083, -13103, -13106, -13238, -13242, -13185, -13128, -13124, -13107, -13120, -13087, -13270, -13263, -13217, -13164, -13134, -13158, -13153, -13135, -13334, -13364, -13307, -13255, -13250, -13228, -13252, -13250, -13365, -13420, -13375, -13319, -13329, -13342, -13354, -13340, -13304, -13342, -13361, -13358, -13350, -13375, -13361, -13323, 25392, 25869, 26169, 26351, 26358, 26243, 25966, 25542, 25925, 26466, 26792, 27011, 27002, 26858, 26530, 26053, 26277, 26796, 27187, 27427, 27460, 27311, 26946, 26398, 26479, 26989, 27414, 27655, 27657, 27496, 27103, 26571, 26475, 27001, 27394, 27628, 27660, 27451, 27100, 26547, 26226, 26722, 27115, 27335, 27337, 27174, 26807, 26258, 25846, 26289, 26658, 26866, 26855, 26658, 26313, 25837, 25373, 25789, 26065, 26222, 26229, 26033, 25763, 25345, -13889, -13781, -13721, -13682, -13672, -13667, -13704, -13729, -13844, -13733, -13687, -13644, -13631, -13626, -13686, -13729, -13814, -13777, -13673, -13578, -13548, -13547, -13633, -13712, -13784, -13744, -13625, -13556, -13560, -13546, -13621, -13695, -13827, -13760, -13663, -13601, -13587, -13606, -13633, -13721, -13920, -13885, -13764, -13696, -13708, -13710, -13768, -13845, -14007, -14001, -13906, -13822, -13823, -13886, -13922, -13957, -14003, -13992, -13964, -13926, -13896, -13947, -13967, -13981 },
+  { 25530, 25339, 23200, 21642, 21572, 23106, 25266, 25461, 14913, 12845, 9250, 6839, 6829, 9187, 12827, 14819, -2277, -7333, -12766, -16280, -16294, -12779, -7368, -2414, -14519, -21628, -28326, -32476, -32482, -28326, -21631, -14551, -14595, -21777, -28435, -32526, -32573, -28399, -21685, -14562, -2491, -7545, -12982, -16364, -16359, -12941, -7526, -2483, 14869, 12774, 9100, 6685, 6652, 9026, 12608, 14658, 25427, 25223, 22995, 21450, 21347, 22901, 25044, 25252, 26049, 25862, 23725, 22160, 22072, 23632, 25831, 26021, 15376, 13298, 9670, 7224, 7202, 9617, 13323, 15315, -1932, -7067, -12584, -16135, -16169, -12596, -7081, -2065, -14278, -21503, -28315, -32548, -32556, -28310, -21517, -14327, -14363, -21660, -28417, -32602, -32631, -28371, -21566, -14330, -2144, -7266, -12756, -16195, -16189, -12698, -7210, -2110, 15438, 13343, 9654, 7197, 7147, 9565, 13180, 15234, 26158, 25981, 23755, 22184, 22072, 23640, 25794, 25981, 24142, 23945, 21876, 20405, 20374, 21887, 23959, 24155, 13927, 11900, 8419, 6140, 6174, 8494, 12041, 13957, -2535, -7442, -12687, -16018, -16008, -12596, -7353, -2544, -14179, -21080, -27540, -31532, -31517, -27462, -20983, -14128, -14213, -21148, -27569, -31506, -31494, -27430, -20950, -14088, -2575, -7449, -12668, -15893, -15865, -12552, -7315, -2475, 14158, 12144, 8655, 6355, 6321, 8616, 12037, 13963, 24390, 24200, 22094, 20639, 20556, 22042, 24061, 24218 },
+  { -15264, -3589, 13931, 26126, 26062, 13510, -4358, -15998, -20310, -7216, 13102, 27408, 27408, 12714, -7989, -21142, -26555, -13275, 8300, 23624, 23693, 8113, -13830, -27292, -31118, -17955, 4327, 20206, 20341, 4425, -18132, -31514, -31333, -18147, 4227, 20220, 20428, 4675, -17878, -31312, -27189, -13967, 8007, 23570, 23881, 8746, -13276, -26802, -21194, -8209, 12573, 27187, 27549, 13432, -7290, -20530, -16216, -4573, 13306, 25786, 26147, 14106, -3595, -15528, -15671, -3897, 13870, 26286, 26243, 13539, -4659, -16477, -20771, -7559, 13060, 27625, 27659, 12756, -8314, -21689, -27090, -13672, 8216, 23801, 23927, 8114, -14191, -27892, -31705, -18399, 4178, 20350, 20542, 4385, -18550, -32161, -31908, -18597, 4090, 20374, 20614, 4602, -18306, -31956, -27708, -14342, 7926, 23750, 24120, 8725, -13634, -27370, -21620, -8474, 12561, 27420, 27840, 13470, -7549, -20999, -16557, -4777, 13306, 25973, 26378, 14129, -3822, -15934, -14538, -3292, 13533, 25198, 25014, 12914, -4267, -15415, -19369, -6735, 12790, 26484, 26371, 12202, -7734, -20368, -25338, -12505, 8226, 22871, 22824, 7783, -13309, -26230, -29704, -16973, 4426, 19610, 19606, 4226, -17438, -30251, -29892, -17172, 4326, 19621, 19682, 4463, -17191, -30049, -25886, -13131, 7939, 22797, 23004, 8374, -12773, -25705, -20120, -7582, 12327, 26256, 26524, 12876, -7011, -19658, -15299, -4076, 13025, 24905, 25159, 13534, -3427, -14850 },
+  { 29247, 28680, 20327, 7093, -7931, -20808, -28784, -28855, 29776, 29750, 21171, 7471, -8194, -21505, -29491, -29117, 21605, 21799, 15604, 5506, -5857, -15554, -21378, -20968, 8189, 8256, 5807, 1886, -2400, -5903, -7864, -7615, -7320, -7470, -5639, -2406, 1610, 5350, 7905, 8073, -20704, -21183, -15472, -6059, 5190, 15076, 21455, 21512, -29140, -29586, -21452, -8094, 7404, 20931, 29762, 29831, -28920, -28877, -20791, -7775, 7150, 20429, 29083, 29586, 29766, 29216, 20716, 7266, -8001, -21089, -29206, -29249, 30271, 30316, 21610, 7658, -8249, -21802, -29903, -29477, 21964, 22159, 15915, 5653, -5895, -15759, -21636, -21183, 8290, 8349, 5891, 1931, -2402, -5919, -7863, -7586, -7527, -7717, -5815, -2444, 1695, 5547, 8171, 8395, -21165, -21707, -15876, -6212, 5338, 15464, 21974, 22073, -29801, -30268, -21930, -8279, 7590, 21429, 30423, 30538, -29545, -29517, -21205, -7921, 7282, 20858, 29717, 30244, 28309, 27750, 19626, 6726, -7774, -20210, -27888, -27873, 28741, 28744, 20446, 7130, -7985, -20818, -28440, -27979, 20785, 20948, 15016, 5273, -5674, -15020, -20538, -20058, 7714, 7785, 5458, 1770, -2269, -5563, -7377, -7120, -7392, -7549, -5666, -2356, 1690, 5387, 7913, 8093, -20347, -20817, -15194, -5871, 5217, 14879, 21038, 21073, -28503, -28916, -20915, -7843, 7313, 20524, 29018, 29026, -28227, -28135, -20215, -7553, 6972, 19892, 28248, 28731 },
+};
+
+const int32_t nanostream_fixed_mean_projection[8] = {
+  408031712, 33143412, 82966, 9000, 1286298, 4493012, -2348228, 17443
+};
@@ -0,0 +1,262 @@
+#include "nanostream_frame.h"
+
+#include "nanostream.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define TILE_PITCH (NANOSTREAM_TILE_WIDTH * 3)
+
+int
+nanostream_frame_tiles_x(const int width)
+{
+  return (width + NANOSTREAM_TILE_WIDTH - 1) / NANOSTREAM_TILE_WIDTH;
+}
+
+int
+nanostream_frame_tiles_y(const int height)
+{
+  return (height + NANOSTREAM_TILE_HEIGHT - 1) / NANOSTREAM_TILE_HEIGHT;
+}
+
+/* Copies the part of a tile that lies inside the image and pads the rest. */
+static void
+gather_edge_tile(const unsigned char* rgb,
+                 const int pitch,
+                 const int w,
+                 const int h,
+                 const nanostream_padding padding,
+                 unsigned char* tile)
+{
+  for (int y = 0; y < NANOSTREAM_TILE_HEIGHT; y++) {
+    unsigned char* out = tile + y * TILE_PITCH;
+
+    if ((y >= h) && (padding == NANOSTREAM_PADDING_BLACK)) {
+      memset(out, 0, TILE_PITCH);
+      continue;
+    }
+
+    const unsigned char* in = rgb + ((y < h) ? y : (h - 1)) * pitch;
+    memcpy(out, in, (size_t)w * 3);
+
+    if (padding == NANOSTREAM_PADDING_BLACK) {
+      memset(out + w * 3, 0, (size_t)(NANOSTREAM_TILE_WIDTH - w) * 3);
+    } else {
+      for (int x = w; x < NANOSTREAM_TILE_WIDTH; x++)
+        memcpy(out + x * 3, in + (w - 1) * 3, 3);
+    }
+  }
+}
+
+void
+nanostream_encode_frame(const unsigned char* rgb,
+                        const int width,
+                        const int height,
+                        const int pitch,
+                        const nanostream_padding padding,
+                        const int first_tile,
+                        const int num_tiles,
+                        unsigned char* packets)
+{
+  nanostream_encode_frame_with_basis(NULL, rgb, width, height, pitch, padding, first_tile, num_tiles, packets);
+}
+
+void
+nanostream_encode_frame_with_basis(const nanostream_basis* basis,
+                                   const unsigned char* rgb,
+                                   const int width,
+                                   const int height,
+                                   const int pitch,
+                                   const nanostream_padding padding,
+                                   const int first_tile,
+                                   const int num_tiles,
+                                   unsigned char* packets)
+{
+  nanostream_encode_frame_with_bases(&basis, 1, rgb, width, height, pitch, padding, first_tile, num_tiles, packets);
+}
+
+void
+nanostream_encode_frame_with_bases(const nanostream_basis* const* bases,
+                                   const int num_bases,
+                                   const unsigned char* rgb,
+                                   const int width,
+                                   const int height,
+                                   const int pitch,
+                                   const nanostream_padding padding,
+                                   const int first_tile,
+                                   const int num_tiles,
+                                   unsigned char* packets)
+{
+  const int tiles_x = nanostream_frame_tiles_x(width);
+
+  unsigned char tile[NANOSTREAM_TILE_HEIGHT * TILE_PITCH];
+
+  for (int i = first_tile; i < first_tile + num_tiles; i++) {
+    const int x = (i % tiles_x) * NANOSTREAM_TILE_WIDTH;
+    const int y = (i / tiles_x) * NANOSTREAM_TILE_HEIGHT;
+    const int w = (width - x < NANOSTREAM_TILE_WIDTH) ? (width - x) : NANOSTREAM_TILE_WIDTH;
+    const int h = (height - y < NANOSTREAM_TILE_HEIGHT) ? (height - y) : NANOSTREAM_TILE_HEIGHT;
+    const unsigned char* in = rgb + (ptrdiff_t)y * pitch + x * 3;
+
+    if ((w == NANOSTREAM_TILE_WIDTH) && (h == NANOSTREAM_TILE_HEIGHT)) {
+      nanostream_encode_tile_with_bases(bases, num_bases, in, pitch, packets);
+    } else {
+      gather_edge_tile(in, pitch, w, h, padding, tile);
+      nanostream_encode_tile_with_bases(bases, num_bases, tile, TILE_PITCH, packets);
+    }
+
+    packets += NANOSTREAM_PACKET_SIZE;
+  }
+}
+
+void
+nanostream_decode_frame(const unsigned char* packets,
+                        const int first_tile,
+                        const int num_tiles,
+                        const int width,
+                        const int height,
+                        const int pitch,
+                        unsigned char* rgb)
+{
+  nanostream_decode_frame_with_basis(NULL, packets, first_tile, num_tiles, width, height, pitch, rgb);
+}
+
+void
+nanostream_decode_frame_with_basis(const nanostream_basis* basis,
+                                   const unsigned char* packets,
+                                   const int first_tile,
+                                   const int num_tiles,
+                                   const int width,
+                                   const int height,
+                                   const int pitch,
+                                   unsigned char* rgb)
+{
+  nanostream_decode_frame_with_bases(&basis, 1, packets, first_tile, num_tiles, width, height, pitch, rgb);
+}
+
+void
+nanostream_decode_frame_with_bases(const nanostream_basis* const* bases,
+                                   const int num_bases,
+                                   const unsigned char* packets,
+                                   const int first_tile,
+                                   const int num_tiles,
+                                   const int width,
+                                   const int height,
+                                   const int pitch,
+                                   unsigned char* rgb)
+{
+  const int tiles_x = nanostream_frame_tiles_x(width);
+
+  unsigned char tile[NANOSTREAM_TILE_HEIGHT * TILE_PITCH];
+
+  for (int i = first_tile; i < first_tile + num_tiles; i++) {
+    const int x = (i % tiles_x) * NANOSTREAM_TILE_WIDTH;
+    const int y = (i / tiles_x) * NANOSTREAM_TILE_HEIGHT;
+    const int w = (width - x < NANOSTREAM_TILE_WIDTH) ? (width - x) : NANOSTREAM_TILE_WIDTH;
+    const int h = (height - y < NANOSTREAM_TILE_HEIGHT) ? (height - y) : NANOSTREAM_TILE_HEIGHT;
+    unsigned char* out = rgb + (ptrdiff_t)y * pitch + x * 3;
+
+    if ((w == NANOSTREAM_TILE_WIDTH) && (h == NANOSTREAM_TILE_HEIGHT)) {
+      nanostream_decode_tile_with_bases(bases, num_bases, packets, pitch, out);
+    } else {
+      nanostream_decode_tile_with_bases(bases, num_bases, packets, TILE_PITCH, tile);
+      for (int row = 0; row < h; row++)
+        memcpy(out + row * pitch, tile + row * TILE_PITCH, (size_t)w * 3);
+    }
+
+    packets += NANOSTREAM_PACKET_SIZE;
+  }
+}
+
+int
+nanostream_conceal_frame(const unsigned char* packets,
+                         const unsigned char* present,
+                         const int first_tile,
+                         const int num_tiles,
+                         const int width,
+                         const int height,
+                         const int pitch,
+                         const nanostream_concealment concealment,
+                         unsigned char* rgb)
+{
+  return nanostream_conceal_frame_with_basis(
+    NULL, packets, present, first_tile, num_tiles, width, height, pitch, concealment, rgb);
+}
+
+int
+nanostream_conceal_frame_with_basis(const nanostream_basis* basis,
+                                    const unsigned char* packets,
+                                    const unsigned char* present,
+                                    const int first_tile,
+                                    const int num_tiles,
+                                    const int width,
+                                    const int height,
+                                    const int pitch,
+                                    const nanostream_concealment concealment,
+                                    unsigned char* rgb)
+{
+  return nanostream_conceal_frame_with_bases(
+    &basis, 1, packets, present, first_tile, num_tiles, width, height, pitch, concealment, rgb);
+}
+
+int
+nanostream_conceal_frame_with_bases(const nanostream_basis* const* bases,
+                                    const int num_bases,
+                                    const unsigned char* packets,
+                                    const unsigned char* present,
+                                    const int first_tile,
+                                    const int num_tiles,
+                                    const int width,
+                                    const int height,
+                                    const int pitch,
+                                    const nanostream_concealment concealment,
+                                    unsigned char* rgb)
+{
+  if (concealment == NANOSTREAM_CONCEAL_PREVIOUS)
+    return 0;
+
+  const int tiles_x = nanostream_frame_tiles_x(width);
+  const int tiles_y = nanostream_frame_tiles_y(height);
+
+  unsigned char tile[NANOSTREAM_TILE_HEIGHT * TILE_PITCH];
+  int concealed = 0;
+
+  for (int i = first_tile; i < first_tile + num_tiles; i++) {
+    if (present[i])
+      continue;
+
+    const int tile_x = i % tiles_x;
+    const int tile_y = i / tiles_x;
+
+    /* Left, right, above and below, as nanostream_conceal_tile takes them. */
+    const int around[4] = { (tile_x > 0) ? (i - 1) : -1,
+                            (tile_x + 1 < tiles_x) ? (i + 1) : -1,
+                            (tile_y > 0) ? (i - tiles_x) : -1,
+                            (tile_y + 1 < tiles_y) ? (i + tiles_x) : -1 };
+    const unsigned char* neighbours[4];
+    for (int n = 0; n < 4; n++) {
+      const int j = around[n];
+      neighbours[n] = ((j >= 0) && present[j]) ? (packets + (size_t)j * NANOSTREAM_PACKET_SIZE) : NULL;
+    }
+
+    const int x = tile_x * NANOSTREAM_TILE_WIDTH;
+    const int y = tile_y * NANOSTREAM_TILE_HEIGHT;
+    const int w = (width - x < NANOSTREAM_TILE_WIDTH) ? (width - x) : NANOSTREAM_TILE_WIDTH;
+    const int h = (height - y < NANOSTREAM_TILE_HEIGHT) ? (height - y) : NANOSTREAM_TILE_HEIGHT;
+    unsigned char* out = rgb + (ptrdiff_t)y * pitch + x * 3;
+
+    if ((w == NANOSTREAM_TILE_WIDTH) && (h == NANOSTREAM_TILE_HEIGHT)) {
+      if (nanostream_conceal_tile_with_bases(bases, num_bases, neighbours, pitch, out) != 0)
+        continue;
+    } else {
+      if (nanostream_conceal_tile_with_bases(bases, num_bases, neighbours, TILE_PITCH, tile) != 0)
+        continue;
+      for (int row = 0; row < h; row++)
+        memcpy(out + row * pitch, tile + row * TILE_PITCH, (size_t)w * 3);
+    }
+
+    concealed++;
+  }
+
+  return concealed;
+}
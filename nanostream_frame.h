@@ -0,0 +1,140 @@
+#pragma once
+
+/* Encoding and decoding of images of any size, as a row-major grid of tiles. The tiles along the right and bottom
+ * edges are padded out to the full tile size when encoding, and cropped again when decoding. Any range of tiles may be
+ * processed on its own, so an image can be split across threads.
+ *
+ * When the packets of some tiles are lost, nanostream_conceal_frame fills in their holes without waiting for them, from
+ * the previous frame or from the tiles around them. */
+
+#include "nanostream.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef enum nanostream_padding
+  {
+    /* Repeat the last column and row of the image. */
+    NANOSTREAM_PADDING_EDGE = 0,
+    /* Fill with black. */
+    NANOSTREAM_PADDING_BLACK = 1
+  } nanostream_padding;
+
+  typedef enum nanostream_concealment
+  {
+    /* Keep the pixels of the previous frame where a tile is missing, which suits content that changes little. */
+    NANOSTREAM_CONCEAL_PREVIOUS = 0,
+    /* Blend the edge blocks of the tiles around a missing tile that did arrive, which suits motion and scene changes.
+     * The previous frame is kept only where none of them arrived. */
+    NANOSTREAM_CONCEAL_NEIGHBOURS = 1
+  } nanostream_concealment;
+
+  int nanostream_frame_tiles_x(int width);
+
+  int nanostream_frame_tiles_y(int height);
+
+  /* Encodes the tiles first_tile to first_tile + num_tiles - 1 and writes their packets back to back. */
+  void nanostream_encode_frame(const unsigned char* rgb,
+                               int width,
+                               int height,
+                               int pitch,
+                               nanostream_padding padding,
+                               int first_tile,
+                               int num_tiles,
+                               unsigned char* packets);
+
+  /* Decodes the packets of the tiles first_tile to first_tile + num_tiles - 1, which are stored back to back. */
+  void nanostream_decode_frame(const unsigned char* packets,
+                               int first_tile,
+                               int num_tiles,
+                               int width,
+                               int height,
+                               int pitch,
+                               unsigned char* rgb);
+
+  /* Fills in the tiles first_tile to first_tile + num_tiles - 1 whose packets did not arrive. 'rgb' holds the previous
+   * frame with the tiles of this frame that did arrive decoded over it. 'packets' holds the packets of every tile of
+   * the frame at their tile index, and 'present' says which of them arrived; the packets of the others are not read.
+   * Returns the number of tiles that were filled in from their neighbours. */
+  int nanostream_conceal_frame(const unsigned char* packets,
+                               const unsigned char* present,
+                               int first_tile,
+                               int num_tiles,
+                               int width,
+                               int height,
+                               int pitch,
+                               nanostream_concealment concealment,
+                               unsigned char* rgb);
+
+  /* Like the functions above, with the given basis, or the built-in one if it is null. */
+  void nanostream_encode_frame_with_basis(const nanostream_basis* basis,
+                                          const unsigned char* rgb,
+                                          int width,
+                                          int height,
+                                          int pitch,
+                                          nanostream_padding padding,
+                                          int first_tile,
+                                          int num_tiles,
+                                          unsigned char* packets);
+
+  void nanostream_decode_frame_with_basis(const nanostream_basis* basis,
+                                          const unsigned char* packets,
+                                          int first_tile,
+                                          int num_tiles,
+                                          int width,
+                                          int height,
+                                          int pitch,
+                                          unsigned char* rgb);
+
+  int nanostream_conceal_frame_with_basis(const nanostream_basis* basis,
+                                          const unsigned char* packets,
+                                          const unsigned char* present,
+                                          int first_tile,
+                                          int num_tiles,
+                                          int width,
+                                          int height,
+                                          int pitch,
+                                          nanostream_concealment concealment,
+                                          unsigned char* rgb);
+
+  /* Like nanostream_encode_frame, nanostream_decode_frame and nanostream_conceal_frame, choosing one of 'bases' for
+   * each tile (see nanostream_encode_tile_with_bases). Frames encoded with several bases must not be decoded or
+   * concealed with the functions above. */
+  void nanostream_encode_frame_with_bases(const nanostream_basis* const* bases,
+                                          int num_bases,
+                                          const unsigned char* rgb,
+                                          int width,
+                                          int height,
+                                          int pitch,
+                                          nanostream_padding padding,
+                                          int first_tile,
+                                          int num_tiles,
+                                          unsigned char* packets);
+
+  void nanostream_decode_frame_with_bases(const nanostream_basis* const* bases,
+                                          int num_bases,
+                                          const unsigned char* packets,
+                                          int first_tile,
+                                          int num_tiles,
+                                          int width,
+                                          int height,
+                                          int pitch,
+                                          unsigned char* rgb);
+
+  int nanostream_conceal_frame_with_bases(const nanostream_basis* const* bases,
+                                          int num_bases,
+                                          const unsigned char* packets,
+                                          const unsigned char* present,
+                                          int first_tile,
+                                          int num_tiles,
+                                          int width,
+                                          int height,
+                                          int pitch,
+                                          nanostream_concealment concealment,
+                                          unsigned char* rgb);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
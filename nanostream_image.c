@@ -0,0 +1,69 @@
+#include "nanostream_image.h"
+
+#include "nanostream.h"
+#include "nanostream_endian.h"
+
+#include <limits.h>
+#include <string.h>
+
+static const unsigned char image_magic[8] = { 'N', 'S', 'T', 'M', 'I', 'M', 'G', '1' };
+
+size_t
+nanostream_image_file_size(const int width, const int height)
+{
+  const size_t num_tiles = (size_t)nanostream_frame_tiles_x(width) * (size_t)nanostream_frame_tiles_y(height);
+  return NANOSTREAM_IMAGE_HEADER_SIZE + num_tiles * NANOSTREAM_PACKET_SIZE;
+}
+
+void
+nanostream_image_store_header(unsigned char* out, const int width, const int height, const nanostream_padding padding)
+{
+  memset(out, 0, NANOSTREAM_IMAGE_HEADER_SIZE);
+  memcpy(out, image_magic, sizeof(image_magic));
+  nanostream_store_u32le(out + 8, NANOSTREAM_IMAGE_VERSION);
+  nanostream_store_u32le(out + 12, (uint32_t)width);
+  nanostream_store_u32le(out + 16, (uint32_t)height);
+  nanostream_store_u16le(out + 20, NANOSTREAM_TILE_WIDTH);
+  nanostream_store_u16le(out + 22, NANOSTREAM_TILE_HEIGHT);
+  nanostream_store_u32le(out + 24, (uint32_t)NANOSTREAM_PACKET_SIZE);
+  out[28] = (unsigned char)padding;
+}
+
+int
+nanostream_image_parse_header(const unsigned char* data, const size_t size, nanostream_image_info* info)
+{
+  if ((size < NANOSTREAM_IMAGE_HEADER_SIZE) || (memcmp(data, image_magic, sizeof(image_magic)) != 0))
+    return -1;
+
+  const uint32_t width = nanostream_load_u32le(data + 12);
+  const uint32_t height = nanostream_load_u32le(data + 16);
+
+  /* The frame functions take the pitch of a row of pixels and the number of tiles as an int, so a larger image could
+   * not be decoded, and rounding the size up to whole tiles must not overflow either. */
+  if ((nanostream_load_u32le(data + 8) != NANOSTREAM_IMAGE_VERSION) ||
+      (nanostream_load_u16le(data + 20) != NANOSTREAM_TILE_WIDTH) ||
+      (nanostream_load_u16le(data + 22) != NANOSTREAM_TILE_HEIGHT) ||
+      (nanostream_load_u32le(data + 24) != NANOSTREAM_PACKET_SIZE) || (width == 0) || (height == 0) ||
+      (width > INT_MAX / 3 - NANOSTREAM_TILE_WIDTH) || (height > INT_MAX - NANOSTREAM_TILE_HEIGHT) ||
+      (data[28] > NANOSTREAM_PADDING_BLACK))
+    return -1;
+
+  const uint64_t num_tiles =
+    (uint64_t)nanostream_frame_tiles_x((int)width) * (uint64_t)nanostream_frame_tiles_y((int)height);
+  if ((num_tiles > INT_MAX) || ((uint64_t)size < NANOSTREAM_IMAGE_HEADER_SIZE + num_tiles * NANOSTREAM_PACKET_SIZE))
+    return -1;
+
+  info->width = (int)width;
+  info->height = (int)height;
+  info->padding = (nanostream_padding)data[28];
+  info->tiles_x = nanostream_frame_tiles_x(info->width);
+  info->tiles_y = nanostream_frame_tiles_y(info->height);
+  return 0;
+}
+
+const unsigned char*
+nanostream_image_tile(const unsigned char* data, const nanostream_image_info* info, const int tile_x, const int tile_y)
+{
+  const size_t tile = (size_t)tile_y * (size_t)info->tiles_x + (size_t)tile_x;
+  return data + NANOSTREAM_IMAGE_HEADER_SIZE + tile * NANOSTREAM_PACKET_SIZE;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "nanostream_frame.h"
+
+#include <stddef.h>
+
+/* A still image file is a header followed by the packets of every tile, in row-major order. Since every packet has the
+ * same size, the file size follows from the image size and any tile can be located directly. */
+
+#define NANOSTREAM_IMAGE_VERSION 1
+
+#define NANOSTREAM_IMAGE_HEADER_SIZE 32
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_image_info
+  {
+    int width;
+    int height;
+    nanostream_padding padding;
+    int tiles_x;
+    int tiles_y;
+  } nanostream_image_info;
+
+  size_t nanostream_image_file_size(int width, int height);
+
+  void nanostream_image_store_header(unsigned char* out, int width, int height, nanostream_padding padding);
+
+  /* Reads the header and checks that the file holds every packet. Returns zero on success, and fails for images too big
+   * for the frame functions: rows of over INT_MAX bytes, or over INT_MAX tiles. */
+  int nanostream_image_parse_header(const unsigned char* data, size_t size, nanostream_image_info* info);
+
+  /* Returns the packet of a tile, given a pointer to the start of the file. */
+  const unsigned char* nanostream_image_tile(const unsigned char* data,
+                                             const nanostream_image_info* info,
+                                             int tile_x,
+                                             int tile_y);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
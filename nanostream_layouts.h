@@ -0,0 +1,33 @@
+#pragma once
+
+/* Internal: the basis rearranged for the kernels in nanostream.c, generated by basis_layouts.py (see there for the
+ * layouts). All of them are in the interleaved order of packed RGB pixels. */
+
+/* The number of consecutive values the encoder processes at once, sized for 256-bit vectors of floats. */
+#define NANOSTREAM_BASIS_LANES 8
+
+#define NANOSTREAM_BASIS_GROUPS (192 / NANOSTREAM_BASIS_LANES)
+
+extern const float nanostream_basis_aosoa[NANOSTREAM_BASIS_GROUPS][8 * NANOSTREAM_BASIS_LANES];
+extern const float nanostream_mean_projection[8];
+
+extern const float nanostream_basis_interleaved[8][192];
+extern const float nanostream_mean_interleaved[192];
+
+extern const float nanostream_basis_half[8][48];
+extern const float nanostream_mean_half[48];
+
+/* A basis built at run time, in the same layouts (see nanostream_basis.h). */
+struct nanostream_basis
+{
+  float aosoa[NANOSTREAM_BASIS_GROUPS][8 * NANOSTREAM_BASIS_LANES];
+  float mean_projection[8];
+  float interleaved[8][192];
+  float mean_interleaved[192];
+  float half[8][48];
+  float mean_half[48];
+
+  /* The mean and the basis vectors it was built from, in the planar order and units of nanostream_eigen.c. */
+  float mean[192];
+  float vectors[8][192];
+};
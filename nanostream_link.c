@@ -0,0 +1,466 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "nanostream_link.h"
+
+#include "nanostream_net.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The number of datagrams the relay moves at once. */
+#define RELAY_BATCH 64
+
+struct pending
+{
+  uint64_t due_us;
+  /* Breaks ties between datagrams that are due at the same time, in the order they were sent. */
+  uint64_t order;
+  uint64_t sent_us;
+  int slot;
+};
+
+struct nanostream_link
+{
+  nanostream_link_config config;
+  uint64_t rng;
+
+  /* Gilbert-Elliott state, and the length of the current run of losses. */
+  int bad;
+  uint64_t loss_run;
+
+  /* The token bucket: the tokens in bytes at tokens_us, and when the last queued datagram leaves the queue. */
+  double tokens;
+  uint64_t tokens_us;
+  uint64_t last_departure_us;
+
+  /* The latest due time of a datagram that was not reordered, so that jitter alone never reorders. */
+  uint64_t last_due_us;
+
+  /* Datagram storage: one slot of NANOSTREAM_NET_MAX_DATAGRAM_SIZE bytes per datagram in flight. */
+  unsigned char* slots;
+  size_t* slot_sizes;
+  int* free_slots;
+  int num_free;
+
+  /* Slots handed out by the last receive, freed by the next one. */
+  int* released;
+  int num_released;
+
+  /* A binary min-heap of the datagrams in flight, by due time. */
+  struct pending* heap;
+  int heap_size;
+  uint64_t next_order;
+
+  nanostream_link_stats stats;
+};
+
+struct nanostream_link_relay
+{
+  nanostream_link* link;
+  nanostream_net_receiver* receiver;
+  nanostream_net_sender* sender;
+
+  /* Guards the link statistics and 'stopping'. */
+  pthread_mutex_t lock;
+  int stopping;
+  pthread_t thread;
+};
+
+/* xorshift64*, seeded through splitmix64 so that small seeds give unrelated sequences. */
+static uint64_t
+next_random(nanostream_link* link)
+{
+  uint64_t x = link->rng;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  link->rng = x;
+  return x * 0x2545F4914F6CDD1Du;
+}
+
+static double
+next_uniform(nanostream_link* link)
+{
+  return (double)(next_random(link) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static uint64_t
+seed_random(const uint64_t seed)
+{
+  uint64_t z = seed + 0x9E3779B97F4A7C15u;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+  z ^= z >> 31;
+  return z ? z : 1;
+}
+
+static int
+pending_before(const struct pending* a, const struct pending* b)
+{
+  return (a->due_us < b->due_us) || ((a->due_us == b->due_us) && (a->order < b->order));
+}
+
+static void
+heap_push(nanostream_link* link, const struct pending* entry)
+{
+  int i = link->heap_size++;
+  while (i > 0) {
+    const int parent = (i - 1) / 2;
+    if (!pending_before(entry, &link->heap[parent]))
+      break;
+    link->heap[i] = link->heap[parent];
+    i = parent;
+  }
+  link->heap[i] = *entry;
+}
+
+static struct pending
+heap_pop(nanostream_link* link)
+{
+  const struct pending top = link->heap[0];
+  const struct pending last = link->heap[--link->heap_size];
+  int i = 0;
+  for (;;) {
+    const int child = 2 * i + 1;
+    if (child >= link->heap_size)
+      break;
+    const int smaller =
+      ((child + 1 < link->heap_size) && pending_before(&link->heap[child + 1], &link->heap[child])) ? child + 1 : child;
+    if (!pending_before(&link->heap[smaller], &last))
+      break;
+    link->heap[i] = link->heap[smaller];
+    i = smaller;
+  }
+  if (link->heap_size > 0)
+    link->heap[i] = last;
+  return top;
+}
+
+nanostream_link*
+nanostream_link_create(const nanostream_link_config* config)
+{
+  nanostream_link* link = calloc(1, sizeof(nanostream_link));
+  if (!link)
+    return NULL;
+
+  link->config = *config;
+  if (link->config.bucket_size == 0)
+    link->config.bucket_size = 64 * 1024;
+  if (link->config.max_queue_us == 0)
+    link->config.max_queue_us = 100000;
+  if (link->config.reorder_delay_us == 0)
+    link->config.reorder_delay_us = 5000;
+  if (link->config.max_datagrams <= 0)
+    link->config.max_datagrams = 8192;
+
+  const int n = link->config.max_datagrams;
+  link->rng = seed_random(config->seed);
+  link->tokens = (double)link->config.bucket_size;
+  link->slots = malloc((size_t)n * NANOSTREAM_NET_MAX_DATAGRAM_SIZE);
+  link->slot_sizes = calloc((size_t)n, sizeof(size_t));
+  link->free_slots = malloc((size_t)n * sizeof(int));
+  link->released = malloc((size_t)n * sizeof(int));
+  link->heap = malloc((size_t)n * sizeof(struct pending));
+  if (!link->slots || !link->slot_sizes || !link->free_slots || !link->released || !link->heap) {
+    nanostream_link_destroy(link);
+    return NULL;
+  }
+
+  for (int i = 0; i < n; i++)
+    link->free_slots[i] = n - 1 - i;
+  link->num_free = n;
+
+  return link;
+}
+
+void
+nanostream_link_destroy(nanostream_link* link)
+{
+  if (!link)
+    return;
+
+  free(link->slots);
+  free(link->slot_sizes);
+  free(link->free_slots);
+  free(link->released);
+  free(link->heap);
+  free(link);
+}
+
+static int
+decide_loss(nanostream_link* link)
+{
+  const nanostream_link_config* c = &link->config;
+
+  switch (c->loss_model) {
+    case NANOSTREAM_LOSS_RANDOM:
+      return next_uniform(link) < c->loss_rate;
+    case NANOSTREAM_LOSS_GILBERT_ELLIOTT: {
+      const int lost = next_uniform(link) < (link->bad ? c->loss_bad : c->loss_good);
+      if (next_uniform(link) < (link->bad ? c->bad_to_good : c->good_to_bad))
+        link->bad = !link->bad;
+      return lost;
+    }
+    case NANOSTREAM_LOSS_NONE:
+      break;
+  }
+  return 0;
+}
+
+int
+nanostream_link_send(nanostream_link* link, const uint64_t now_us, const unsigned char* datagram, const size_t size)
+{
+  const nanostream_link_config* c = &link->config;
+  nanostream_link_stats* stats = &link->stats;
+
+  stats->datagrams_in++;
+  stats->bytes_in += size;
+
+  if ((link->num_free == 0) || (size > NANOSTREAM_NET_MAX_DATAGRAM_SIZE)) {
+    stats->overflow_drops++;
+    return -1;
+  }
+
+  /* The token bucket serves datagrams in order: each one starts waiting for tokens when the one before it left. */
+  uint64_t departure_us = now_us;
+  if (c->rate_bps > 0) {
+    const double bytes_per_us = (double)c->rate_bps / 8.0e6;
+    const uint64_t start_us = (link->last_departure_us > now_us) ? link->last_departure_us : now_us;
+    double tokens = link->tokens + (double)(start_us - link->tokens_us) * bytes_per_us;
+    if (tokens > (double)c->bucket_size)
+      tokens = (double)c->bucket_size;
+
+    departure_us = start_us;
+    if (tokens >= (double)size) {
+      tokens -= (double)size;
+    } else {
+      departure_us += (uint64_t)(((double)size - tokens) / bytes_per_us + 0.999);
+      tokens = 0.0;
+    }
+
+    if (departure_us - now_us > c->max_queue_us) {
+      stats->queue_drops++;
+      return -1;
+    }
+
+    link->tokens = tokens;
+    link->tokens_us = departure_us;
+    link->last_departure_us = departure_us;
+  }
+
+  if (decide_loss(link)) {
+    stats->lost++;
+    if (link->loss_run++ == 0)
+      stats->loss_bursts++;
+    if (link->loss_run > stats->longest_loss_burst)
+      stats->longest_loss_burst = link->loss_run;
+    return -1;
+  }
+  link->loss_run = 0;
+
+  uint64_t due_us = departure_us + c->delay_us;
+  if (c->jitter_us > 0)
+    due_us += next_random(link) % (c->jitter_us + 1);
+  if (due_us < link->last_due_us)
+    due_us = link->last_due_us;
+  link->last_due_us = due_us;
+
+  if ((c->reorder_rate > 0.0) && (next_uniform(link) < c->reorder_rate)) {
+    due_us += c->reorder_delay_us;
+    stats->reordered++;
+  }
+
+  const int slot = link->free_slots[--link->num_free];
+  memcpy(link->slots + (size_t)slot * NANOSTREAM_NET_MAX_DATAGRAM_SIZE, datagram, size);
+  link->slot_sizes[slot] = size;
+
+  struct pending entry;
+  entry.due_us = due_us;
+  entry.order = link->next_order++;
+  entry.sent_us = now_us;
+  entry.slot = slot;
+  heap_push(link, &entry);
+
+  return 0;
+}
+
+int
+nanostream_link_receive(nanostream_link* link,
+                        const uint64_t now_us,
+                        const unsigned char** datagrams,
+                        size_t* sizes,
+                        const int max_datagrams)
+{
+  for (int i = 0; i < link->num_released; i++)
+    link->free_slots[link->num_free++] = link->released[i];
+  link->num_released = 0;
+
+  int n = 0;
+  while ((n < max_datagrams) && (link->heap_size > 0) && (link->heap[0].due_us <= now_us)) {
+    const struct pending entry = heap_pop(link);
+    datagrams[n] = link->slots + (size_t)entry.slot * NANOSTREAM_NET_MAX_DATAGRAM_SIZE;
+    sizes[n] = link->slot_sizes[entry.slot];
+    link->released[link->num_released++] = entry.slot;
+
+    const uint64_t delay_us = entry.due_us - entry.sent_us;
+    link->stats.datagrams_out++;
+    link->stats.bytes_out += sizes[n];
+    link->stats.total_delay_us += delay_us;
+    if (delay_us > link->stats.max_delay_us)
+      link->stats.max_delay_us = delay_us;
+    n++;
+  }
+
+  return n;
+}
+
+uint64_t
+nanostream_link_next_due(const nanostream_link* link)
+{
+  return (link->heap_size > 0) ? link->heap[0].due_us : UINT64_MAX;
+}
+
+void
+nanostream_link_get_stats(const nanostream_link* link, nanostream_link_stats* stats)
+{
+  *stats = link->stats;
+}
+
+static uint64_t
+monotonic_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void*
+relay_thread(void* arg)
+{
+  nanostream_link_relay* relay = arg;
+  nanostream_net_packet packets[RELAY_BATCH];
+  const unsigned char* datagrams[RELAY_BATCH];
+  size_t sizes[RELAY_BATCH];
+
+  for (;;) {
+    pthread_mutex_lock(&relay->lock);
+    const int stopping = relay->stopping;
+    const uint64_t next_due_us = nanostream_link_next_due(relay->link);
+    pthread_mutex_unlock(&relay->lock);
+    if (stopping)
+      break;
+
+    /* Wait for datagrams until the next one is due, in whole milliseconds as poll does, and sleep away the last
+     * fraction of a millisecond so that datagrams leave on time. */
+    const uint64_t now_us = monotonic_us();
+    int timeout_ms = 10;
+    if (next_due_us != UINT64_MAX) {
+      const uint64_t wait_us = (next_due_us > now_us) ? (next_due_us - now_us) : 0;
+      timeout_ms = (wait_us / 1000u < 10u) ? (int)(wait_us / 1000u) : 10;
+      if ((timeout_ms == 0) && (wait_us > 0)) {
+        struct timespec ts;
+        ts.tv_sec = (time_t)(next_due_us / 1000000u);
+        ts.tv_nsec = (long)(next_due_us % 1000000u) * 1000;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+      }
+    }
+
+    const int n = nanostream_net_receive(relay->receiver, packets, RELAY_BATCH, timeout_ms);
+
+    pthread_mutex_lock(&relay->lock);
+    const uint64_t t = monotonic_us();
+    for (int i = 0; i < n; i++) {
+      /* The receiver keeps each datagram in one piece, with the payload right after the header and the checksum, if
+       * any, right after the payload. */
+      const unsigned char* datagram = packets[i].payload - NANOSTREAM_NET_HEADER_SIZE;
+      const size_t checksum =
+        (packets[i].header.flags & NANOSTREAM_NET_FLAG_CHECKSUM) ? NANOSTREAM_NET_CHECKSUM_SIZE : 0;
+      nanostream_link_send(relay->link, t, datagram, NANOSTREAM_NET_HEADER_SIZE + packets[i].payload_size + checksum);
+    }
+    int m = nanostream_link_receive(relay->link, t, datagrams, sizes, RELAY_BATCH);
+    pthread_mutex_unlock(&relay->lock);
+
+    while (m > 0) {
+      nanostream_net_send_datagrams(relay->sender, datagrams, sizes, m);
+      if (m < RELAY_BATCH)
+        break;
+      pthread_mutex_lock(&relay->lock);
+      m = nanostream_link_receive(relay->link, monotonic_us(), datagrams, sizes, RELAY_BATCH);
+      pthread_mutex_unlock(&relay->lock);
+    }
+  }
+
+  return NULL;
+}
+
+nanostream_link_relay*
+nanostream_link_relay_create(const nanostream_link_config* config,
+                             const char* listen_host,
+                             const int listen_port,
+                             const char* forward_host,
+                             const int forward_port)
+{
+  nanostream_link_relay* relay = calloc(1, sizeof(nanostream_link_relay));
+  if (!relay)
+    return NULL;
+
+  relay->link = nanostream_link_create(config);
+  relay->receiver = nanostream_net_receiver_create(listen_host, listen_port, 0);
+  relay->sender = nanostream_net_sender_create(forward_host, forward_port, 0);
+  if (!relay->link || !relay->receiver || !relay->sender) {
+    nanostream_link_destroy(relay->link);
+    nanostream_net_receiver_destroy(relay->receiver);
+    nanostream_net_sender_destroy(relay->sender);
+    free(relay);
+    return NULL;
+  }
+
+  pthread_mutex_init(&relay->lock, NULL);
+
+  if (pthread_create(&relay->thread, NULL, relay_thread, relay) != 0) {
+    pthread_mutex_destroy(&relay->lock);
+    nanostream_link_destroy(relay->link);
+    nanostream_net_receiver_destroy(relay->receiver);
+    nanostream_net_sender_destroy(relay->sender);
+    free(relay);
+    return NULL;
+  }
+
+  return relay;
+}
+
+void
+nanostream_link_relay_destroy(nanostream_link_relay* relay)
+{
+  if (!relay)
+    return;
+
+  pthread_mutex_lock(&relay->lock);
+  relay->stopping = 1;
+  pthread_mutex_unlock(&relay->lock);
+  pthread_join(relay->thread, NULL);
+
+  pthread_mutex_destroy(&relay->lock);
+  nanostream_link_destroy(relay->link);
+  nanostream_net_receiver_destroy(relay->receiver);
+  nanostream_net_sender_destroy(relay->sender);
+  free(relay);
+}
+
+int
+nanostream_link_relay_port(const nanostream_link_relay* relay)
+{
+  return nanostream_net_receiver_port(relay->receiver);
+}
+
+void
+nanostream_link_relay_get_stats(nanostream_link_relay* relay, nanostream_link_stats* stats)
+{
+  pthread_mutex_lock(&relay->lock);
+  nanostream_link_get_stats(relay->link, stats);
+  pthread_mutex_unlock(&relay->lock);
+}
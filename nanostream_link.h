@@ -0,0 +1,132 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A link emulator puts the impairments of a real network between a sender and a receiver of datagrams, so transport
+ * behaviour can be tuned on one machine. Datagrams pass, in order, through:
+ *
+ *   - a token bucket that caps the bandwidth and queues datagrams beyond the burst size, dropping those that would
+ *     wait longer than the queue allows;
+ *   - random or bursty (Gilbert-Elliott) loss;
+ *   - a fixed delay plus random jitter, which keeps datagrams in order;
+ *   - reordering, which holds a datagram back so that the ones behind it overtake it.
+ *
+ * The emulator does not read clocks: the caller passes the time to every call, and all randomness comes from a
+ * seeded generator, so the same inputs always give the same outputs. A relay runs an emulator between two UDP
+ * sockets on a thread of its own, so unmodified senders and receivers can be put on either side of it.
+ *
+ * The relay is Linux only. */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef enum nanostream_loss_model
+  {
+    NANOSTREAM_LOSS_NONE = 0,
+    /* Every datagram is lost with probability loss_rate. */
+    NANOSTREAM_LOSS_RANDOM = 1,
+    /* A two state Markov chain: in the good state datagrams are lost with probability loss_good, in the bad state with
+     * loss_bad, and the state changes after each datagram with probability good_to_bad or bad_to_good. */
+    NANOSTREAM_LOSS_GILBERT_ELLIOTT = 2
+  } nanostream_loss_model;
+
+  typedef struct nanostream_link_config
+  {
+    uint64_t seed;
+
+    nanostream_loss_model loss_model;
+    double loss_rate;
+    double good_to_bad;
+    double bad_to_good;
+    double loss_good;
+    double loss_bad;
+
+    /* Every datagram is delayed by delay_us plus a uniformly random time of up to jitter_us. */
+    uint64_t delay_us;
+    uint64_t jitter_us;
+
+    /* The bandwidth in bits per second, or zero for no limit, and the size of the token bucket in bytes, zero for
+     * 64 KB. A datagram that would queue for longer than max_queue_us is dropped; zero allows 100 ms. */
+    uint64_t rate_bps;
+    size_t bucket_size;
+    uint64_t max_queue_us;
+
+    /* The probability that a datagram is held back by another reorder_delay_us, zero for 5 ms. */
+    double reorder_rate;
+    uint64_t reorder_delay_us;
+
+    /* The number of datagrams that can be in flight, zero for 8192. Datagrams beyond this are dropped. */
+    int max_datagrams;
+  } nanostream_link_config;
+
+  typedef struct nanostream_link_stats
+  {
+    uint64_t datagrams_in;
+    uint64_t datagrams_out;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+
+    /* Datagrams lost by the loss model, and the number and longest run of consecutive losses. */
+    uint64_t lost;
+    uint64_t loss_bursts;
+    uint64_t longest_loss_burst;
+
+    /* Datagrams dropped because the queue of the token bucket was full, or too many were in flight. */
+    uint64_t queue_drops;
+    uint64_t overflow_drops;
+
+    /* Datagrams that were held back to be reordered. */
+    uint64_t reordered;
+
+    /* The time from a datagram entering the link to it being due, summed and at most, over the delivered ones. */
+    uint64_t total_delay_us;
+    uint64_t max_delay_us;
+  } nanostream_link_stats;
+
+  typedef struct nanostream_link nanostream_link;
+
+  /* Returns null on failure. */
+  nanostream_link* nanostream_link_create(const nanostream_link_config* config);
+
+  void nanostream_link_destroy(nanostream_link* link);
+
+  /* Puts a datagram of at most NANOSTREAM_NET_MAX_DATAGRAM_SIZE bytes on the link at time now_us. The datagram is
+   * copied. Returns zero if it will be delivered, or -1 if it is lost or dropped. */
+  int nanostream_link_send(nanostream_link* link, uint64_t now_us, const unsigned char* datagram, size_t size);
+
+  /* Takes up to 'max_datagrams' datagrams that are due at now_us, in the order they are due. They are valid until the
+   * next call. Returns their number. */
+  int nanostream_link_receive(nanostream_link* link,
+                              uint64_t now_us,
+                              const unsigned char** datagrams,
+                              size_t* sizes,
+                              int max_datagrams);
+
+  /* The time the next datagram is due, or UINT64_MAX if the link is empty. */
+  uint64_t nanostream_link_next_due(const nanostream_link* link);
+
+  void nanostream_link_get_stats(const nanostream_link* link, nanostream_link_stats* stats);
+
+  typedef struct nanostream_link_relay nanostream_link_relay;
+
+  /* Starts a relay that receives datagrams on the given address (a port of zero picks a free one) and forwards them
+   * through an emulated link to the destination. Returns null on failure. */
+  nanostream_link_relay* nanostream_link_relay_create(const nanostream_link_config* config,
+                                                      const char* listen_host,
+                                                      int listen_port,
+                                                      const char* forward_host,
+                                                      int forward_port);
+
+  /* Stops the relay. Datagrams still on the link are discarded. */
+  void nanostream_link_relay_destroy(nanostream_link_relay* relay);
+
+  int nanostream_link_relay_port(const nanostream_link_relay* relay);
+
+  void nanostream_link_relay_get_stats(nanostream_link_relay* relay, nanostream_link_stats* stats);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
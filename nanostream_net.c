@@ -0,0 +1,1171 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "nanostream_net.h"
+
+#include "nanostream_crc32c.h"
+#include "nanostream_endian.h"
+#include "nanostream_frame.h"
+
+#include <errno.h>
+#include <linux/net_tstamp.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The number of datagrams moved by one sendmmsg or recvmmsg call. */
+#define BATCH_SIZE 64
+
+/* The part of a parity payload before the tile indices. */
+#define PARITY_HEADER_SIZE 4
+
+/* The number of frames of each stream that recovery keeps tiles and parity of. */
+#define RECOVERY_FRAMES 4
+
+struct nanostream_net_sender
+{
+  int fd;
+  struct sockaddr_storage address;
+  socklen_t address_size;
+};
+
+struct nanostream_net_receiver
+{
+  int fd;
+  int port;
+  unsigned char* buffers;
+  uint64_t invalid;
+  uint64_t corrupted;
+};
+
+void
+nanostream_net_store_header(unsigned char* out, const nanostream_net_header* header)
+{
+  out[0] = 'N';
+  out[1] = 'S';
+  out[2] = NANOSTREAM_NET_VERSION;
+  out[3] = (unsigned char)header->type;
+  nanostream_store_u16le(out + 4, (uint16_t)header->stream);
+  nanostream_store_u16le(out + 6, (uint16_t)header->flags);
+  nanostream_store_u32le(out + 8, header->frame);
+  nanostream_store_u32le(out + 12, header->sequence);
+  nanostream_store_u16le(out + 16, (uint16_t)header->tile);
+  nanostream_store_u16le(out + 18, (uint16_t)header->num_tiles);
+  nanostream_store_u16le(out + 20, (uint16_t)header->width);
+  nanostream_store_u16le(out + 22, (uint16_t)header->height);
+  nanostream_store_u64le(out + 24, header->timestamp_us);
+}
+
+int
+nanostream_net_check_size(const int width, const int height)
+{
+  if ((width < 1) || (height < 1) || (width > NANOSTREAM_NET_MAX_SIZE) || (height > NANOSTREAM_NET_MAX_SIZE))
+    return -1;
+
+  const int num_tiles = nanostream_frame_tiles_x(width) * nanostream_frame_tiles_y(height);
+  return (num_tiles <= NANOSTREAM_NET_MAX_TILES) ? 0 : -1;
+}
+
+int
+nanostream_net_parse_header(const unsigned char* datagram, size_t size, nanostream_net_header* header)
+{
+  if ((size < NANOSTREAM_NET_HEADER_SIZE) || (datagram[0] != 'N') || (datagram[1] != 'S') ||
+      (datagram[2] != NANOSTREAM_NET_VERSION))
+    return -1;
+
+  header->type = (nanostream_net_type)datagram[3];
+  header->stream = nanostream_load_u16le(datagram + 4);
+  header->flags = nanostream_load_u16le(datagram + 6);
+  header->frame = nanostream_load_u32le(datagram + 8);
+  header->sequence = nanostream_load_u32le(datagram + 12);
+  header->tile = nanostream_load_u16le(datagram + 16);
+  header->num_tiles = nanostream_load_u16le(datagram + 18);
+  header->width = nanostream_load_u16le(datagram + 20);
+  header->height = nanostream_load_u16le(datagram + 22);
+  header->timestamp_us = nanostream_load_u64le(datagram + 24);
+
+  /* The sizes below are those of the datagram without its checksum. */
+  if (header->flags & NANOSTREAM_NET_FLAG_CHECKSUM) {
+    if (size < NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_NET_CHECKSUM_SIZE)
+      return -1;
+    size -= NANOSTREAM_NET_CHECKSUM_SIZE;
+  }
+
+  if ((header->type == NANOSTREAM_NET_TILE) && (size != NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_PACKET_SIZE))
+    return -1;
+
+  if (header->type == NANOSTREAM_NET_PARITY) {
+    if (size < NANOSTREAM_NET_HEADER_SIZE + PARITY_HEADER_SIZE)
+      return -1;
+    const unsigned char* payload = datagram + NANOSTREAM_NET_HEADER_SIZE;
+    const int k = payload[0];
+    const int m = payload[1];
+    if ((k < 1) || (k > NANOSTREAM_FEC_MAX_DATA) || (m < 1) || (m > NANOSTREAM_FEC_MAX_PARITY) || (payload[2] >= m) ||
+        (size != nanostream_net_parity_size(k)))
+      return -1;
+  }
+
+  if (header->type == NANOSTREAM_NET_BASIS) {
+    if ((size <= NANOSTREAM_NET_HEADER_SIZE) || (size > NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_PACKET_SIZE) ||
+        (header->frame < 1) || (header->frame > 255) || (header->num_tiles != NANOSTREAM_NET_BASIS_PARTS) ||
+        (header->tile >= header->num_tiles))
+      return -1;
+  }
+
+  if (header->type == NANOSTREAM_NET_FEEDBACK) {
+    if (size < NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_NET_FEEDBACK_HEADER_SIZE)
+      return -1;
+    const unsigned char* payload = datagram + NANOSTREAM_NET_HEADER_SIZE;
+    const size_t n = nanostream_load_u16le(payload + 8);
+    const size_t r = nanostream_load_u16le(payload + 10);
+    if (size != NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_NET_FEEDBACK_HEADER_SIZE + 6 * n + 2 * r)
+      return -1;
+  }
+
+  return 0;
+}
+
+size_t
+nanostream_net_store_checksum(unsigned char* datagram, const size_t size)
+{
+  nanostream_store_u16le(datagram + 6, (uint16_t)(nanostream_load_u16le(datagram + 6) | NANOSTREAM_NET_FLAG_CHECKSUM));
+  nanostream_store_u32le(datagram + size, nanostream_crc32c(0, datagram, size));
+  return size + NANOSTREAM_NET_CHECKSUM_SIZE;
+}
+
+int
+nanostream_net_verify_checksum(const unsigned char* datagram, const size_t size)
+{
+  if ((size < NANOSTREAM_NET_HEADER_SIZE) || !(nanostream_load_u16le(datagram + 6) & NANOSTREAM_NET_FLAG_CHECKSUM))
+    return 0;
+  if (size < NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_NET_CHECKSUM_SIZE)
+    return -1;
+
+  const size_t body = size - NANOSTREAM_NET_CHECKSUM_SIZE;
+  return (nanostream_crc32c(0, datagram, body) == nanostream_load_u32le(datagram + body)) ? 0 : -1;
+}
+
+size_t
+nanostream_net_parity_size(const int k)
+{
+  return NANOSTREAM_NET_HEADER_SIZE + PARITY_HEADER_SIZE + 2 * (size_t)k + NANOSTREAM_PACKET_SIZE;
+}
+
+void
+nanostream_net_store_parity(unsigned char* out,
+                            const nanostream_net_header* header,
+                            const int* tile_indices,
+                            const unsigned char* packets,
+                            const int k,
+                            const int m)
+{
+  const size_t size = nanostream_net_parity_size(k);
+  const size_t packet_offset = size - NANOSTREAM_PACKET_SIZE;
+  const int checksum = (header->flags & NANOSTREAM_NET_FLAG_CHECKSUM) != 0;
+  const size_t stride = size + (checksum ? NANOSTREAM_NET_CHECKSUM_SIZE : 0);
+
+  const unsigned char* data[NANOSTREAM_FEC_MAX_DATA];
+  unsigned char* parity[NANOSTREAM_FEC_MAX_PARITY] = { 0 };
+  for (int i = 0; i < k; i++)
+    data[i] = packets + (size_t)i * NANOSTREAM_PACKET_SIZE;
+
+  nanostream_net_header h = *header;
+  h.type = NANOSTREAM_NET_PARITY;
+  h.tile = tile_indices[0];
+
+  for (int j = 0; j < m; j++) {
+    unsigned char* datagram = out + (size_t)j * stride;
+    h.sequence = header->sequence + (uint32_t)j;
+    nanostream_net_store_header(datagram, &h);
+
+    unsigned char* payload = datagram + NANOSTREAM_NET_HEADER_SIZE;
+    payload[0] = (unsigned char)k;
+    payload[1] = (unsigned char)m;
+    payload[2] = (unsigned char)j;
+    payload[3] = 0;
+    for (int i = 0; i < k; i++)
+      nanostream_store_u16le(payload + PARITY_HEADER_SIZE + 2 * i, (uint16_t)tile_indices[i]);
+
+    parity[j] = datagram + packet_offset;
+  }
+
+  nanostream_fec_encode(data, k, parity, m, NANOSTREAM_PACKET_SIZE);
+
+  if (checksum) {
+    for (int j = 0; j < m; j++)
+      nanostream_net_store_checksum(out + (size_t)j * stride, size);
+  }
+}
+
+static int
+resolve(const char* host, const int port, const int passive, struct sockaddr_storage* address, socklen_t* size)
+{
+  char service[16];
+  snprintf(service, sizeof(service), "%d", port);
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+  struct addrinfo* result = NULL;
+  if ((getaddrinfo(host, service, &hints, &result) != 0) || !result)
+    return -1;
+
+  memcpy(address, result->ai_addr, result->ai_addrlen);
+  *size = result->ai_addrlen;
+  freeaddrinfo(result);
+  return 0;
+}
+
+nanostream_net_sender*
+nanostream_net_sender_create(const char* host, const int port, const int buffer_size)
+{
+  nanostream_net_sender* sender = calloc(1, sizeof(nanostream_net_sender));
+  if (!sender)
+    return NULL;
+
+  if (resolve(host, port, 0, &sender->address, &sender->address_size) != 0) {
+    free(sender);
+    return NULL;
+  }
+
+  sender->fd = socket(sender->address.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (sender->fd < 0) {
+    free(sender);
+    return NULL;
+  }
+
+  const int size = (buffer_size > 0) ? buffer_size : (4 << 20);
+  setsockopt(sender->fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+  return sender;
+}
+
+void
+nanostream_net_sender_destroy(nanostream_net_sender* sender)
+{
+  if (!sender)
+    return;
+
+  close(sender->fd);
+  free(sender);
+}
+
+/* Sends a batch of prepared messages, retrying after interruptions. Returns the number sent. */
+static int
+send_batch(nanostream_net_sender* sender, struct mmsghdr* messages, const int count)
+{
+  int sent = 0;
+  while (sent < count) {
+    const int result = sendmmsg(sender->fd, messages + sent, (unsigned)(count - sent), 0);
+    if (result < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    sent += result;
+  }
+  return sent;
+}
+
+int
+nanostream_net_send_tiles(nanostream_net_sender* sender,
+                          const nanostream_net_header* header,
+                          const int* tile_indices,
+                          const unsigned char* packets,
+                          const int num_tiles)
+{
+  unsigned char headers[BATCH_SIZE][NANOSTREAM_NET_HEADER_SIZE];
+  unsigned char checksums[BATCH_SIZE][NANOSTREAM_NET_CHECKSUM_SIZE];
+  struct iovec iov[BATCH_SIZE][3];
+  struct mmsghdr messages[BATCH_SIZE];
+
+  /* The header would carry a truncated geometry. */
+  if (nanostream_net_check_size(header->width, header->height) != 0)
+    return 0;
+
+  nanostream_net_header h = *header;
+  h.type = NANOSTREAM_NET_TILE;
+  const int checksum = (header->flags & NANOSTREAM_NET_FLAG_CHECKSUM) != 0;
+
+  int total = 0;
+
+  for (int first = 0; first < num_tiles; first += BATCH_SIZE) {
+    const int count = (num_tiles - first < BATCH_SIZE) ? (num_tiles - first) : BATCH_SIZE;
+
+    memset(messages, 0, sizeof(messages[0]) * (size_t)count);
+
+    for (int i = 0; i < count; i++) {
+      const int k = first + i;
+      h.tile = tile_indices ? tile_indices[k] : k;
+      h.sequence = header->sequence + (uint32_t)k;
+      nanostream_net_store_header(headers[i], &h);
+
+      const unsigned char* packet = packets + (size_t)k * NANOSTREAM_PACKET_SIZE;
+      iov[i][0].iov_base = headers[i];
+      iov[i][0].iov_len = NANOSTREAM_NET_HEADER_SIZE;
+      iov[i][1].iov_base = (void*)packet;
+      iov[i][1].iov_len = NANOSTREAM_PACKET_SIZE;
+
+      if (checksum) {
+        const uint32_t crc = nanostream_crc32c(nanostream_crc32c(0, headers[i], NANOSTREAM_NET_HEADER_SIZE),
+                                               packet,
+                                               NANOSTREAM_PACKET_SIZE);
+        nanostream_store_u32le(checksums[i], crc);
+        iov[i][2].iov_base = checksums[i];
+        iov[i][2].iov_len = NANOSTREAM_NET_CHECKSUM_SIZE;
+      }
+
+      messages[i].msg_hdr.msg_name = &sender->address;
+      messages[i].msg_hdr.msg_namelen = sender->address_size;
+      messages[i].msg_hdr.msg_iov = iov[i];
+      messages[i].msg_hdr.msg_iovlen = checksum ? 3 : 2;
+    }
+
+    const int sent = send_batch(sender, messages, count);
+    total += sent;
+    if (sent < count)
+      break;
+  }
+
+  return total;
+}
+
+int
+nanostream_net_send_tiles_with_parity(nanostream_net_sender* sender,
+                                      const nanostream_net_header* header,
+                                      const int* tile_indices,
+                                      const unsigned char* packets,
+                                      const int num_tiles,
+                                      int group_size,
+                                      int parity_per_group)
+{
+  if (parity_per_group <= 0)
+    return nanostream_net_send_tiles(sender, header, tile_indices, packets, num_tiles);
+
+  group_size = (group_size < 1) ? 1 : (group_size > NANOSTREAM_FEC_MAX_DATA) ? NANOSTREAM_FEC_MAX_DATA : group_size;
+  parity_per_group = (parity_per_group > NANOSTREAM_FEC_MAX_PARITY) ? NANOSTREAM_FEC_MAX_PARITY : parity_per_group;
+
+  unsigned char parity[NANOSTREAM_FEC_MAX_PARITY * NANOSTREAM_NET_MAX_DATAGRAM_SIZE];
+  const unsigned char* datagrams[NANOSTREAM_FEC_MAX_PARITY];
+  size_t sizes[NANOSTREAM_FEC_MAX_PARITY];
+  int indices[NANOSTREAM_FEC_MAX_DATA];
+
+  nanostream_net_header h = *header;
+  int total = 0;
+
+  for (int first = 0; first < num_tiles; first += group_size) {
+    const int k = (num_tiles - first < group_size) ? (num_tiles - first) : group_size;
+    for (int i = 0; i < k; i++)
+      indices[i] = tile_indices ? tile_indices[first + i] : first + i;
+
+    const unsigned char* group = packets + (size_t)first * NANOSTREAM_PACKET_SIZE;
+    const int sent = nanostream_net_send_tiles(sender, &h, indices, group, k);
+    h.sequence += (uint32_t)sent;
+    total += sent;
+    if (sent < k)
+      break;
+
+    nanostream_net_store_parity(parity, &h, indices, group, k, parity_per_group);
+    for (int j = 0; j < parity_per_group; j++) {
+      sizes[j] = nanostream_net_parity_size(k) +
+                 ((h.flags & NANOSTREAM_NET_FLAG_CHECKSUM) ? NANOSTREAM_NET_CHECKSUM_SIZE : 0);
+      datagrams[j] = parity + (size_t)j * sizes[j];
+    }
+
+    const int sent_parity = nanostream_net_send_datagrams(sender, datagrams, sizes, parity_per_group);
+    h.sequence += (uint32_t)sent_parity;
+    total += sent_parity;
+    if (sent_parity < parity_per_group)
+      break;
+  }
+
+  return total;
+}
+
+int
+nanostream_net_send(nanostream_net_sender* sender,
+                    const nanostream_net_header* header,
+                    const unsigned char* payload,
+                    const size_t payload_size)
+{
+  unsigned char head[NANOSTREAM_NET_HEADER_SIZE];
+  nanostream_net_store_header(head, header);
+
+  struct iovec iov[3];
+  iov[0].iov_base = head;
+  iov[0].iov_len = sizeof(head);
+  iov[1].iov_base = (void*)payload;
+  iov[1].iov_len = payload_size;
+
+  unsigned char checksum[NANOSTREAM_NET_CHECKSUM_SIZE];
+  const int has_checksum = (header->flags & NANOSTREAM_NET_FLAG_CHECKSUM) != 0;
+  if (has_checksum) {
+    const uint32_t crc = nanostream_crc32c(nanostream_crc32c(0, head, sizeof(head)), payload, payload_size);
+    nanostream_store_u32le(checksum, crc);
+    iov[2].iov_base = checksum;
+    iov[2].iov_len = sizeof(checksum);
+  }
+
+  struct mmsghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_hdr.msg_name = &sender->address;
+  message.msg_hdr.msg_namelen = sender->address_size;
+  message.msg_hdr.msg_iov = iov;
+  message.msg_hdr.msg_iovlen = has_checksum ? 3 : 2;
+
+  return (send_batch(sender, &message, 1) == 1) ? 0 : -1;
+}
+
+int
+nanostream_net_send_basis(nanostream_net_sender* sender,
+                          const nanostream_net_header* header,
+                          const nanostream_basis* basis,
+                          const int version)
+{
+  unsigned char data[NANOSTREAM_BASIS_SIZE];
+  nanostream_basis_store(basis, data);
+
+  nanostream_net_header h;
+  memset(&h, 0, sizeof(h));
+  h.type = NANOSTREAM_NET_BASIS;
+  h.stream = header->stream;
+  h.flags = header->flags & NANOSTREAM_NET_FLAG_CHECKSUM;
+  h.frame = (uint32_t)version;
+  h.num_tiles = NANOSTREAM_NET_BASIS_PARTS;
+  h.timestamp_us = header->timestamp_us;
+
+  int sent = 0;
+  for (int part = 0; part < NANOSTREAM_NET_BASIS_PARTS; part++) {
+    const size_t offset = (size_t)part * NANOSTREAM_PACKET_SIZE;
+    const size_t size = (NANOSTREAM_BASIS_SIZE - offset < NANOSTREAM_PACKET_SIZE) ? (NANOSTREAM_BASIS_SIZE - offset)
+                                                                                  : NANOSTREAM_PACKET_SIZE;
+    h.tile = part;
+    if (nanostream_net_send(sender, &h, data + offset, size) != 0)
+      break;
+    sent++;
+  }
+  return sent;
+}
+
+int
+nanostream_net_send_datagrams(nanostream_net_sender* sender,
+                              const unsigned char* const* datagrams,
+                              const size_t* sizes,
+                              const int count)
+{
+  struct iovec iov[BATCH_SIZE];
+  struct mmsghdr messages[BATCH_SIZE];
+
+  int total = 0;
+
+  for (int first = 0; first < count; first += BATCH_SIZE) {
+    const int n = (count - first < BATCH_SIZE) ? (count - first) : BATCH_SIZE;
+
+    memset(messages, 0, sizeof(messages[0]) * (size_t)n);
+
+    for (int i = 0; i < n; i++) {
+      iov[i].iov_base = (void*)datagrams[first + i];
+      iov[i].iov_len = sizes[first + i];
+
+      messages[i].msg_hdr.msg_name = &sender->address;
+      messages[i].msg_hdr.msg_namelen = sender->address_size;
+      messages[i].msg_hdr.msg_iov = &iov[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const int sent = send_batch(sender, messages, n);
+    total += sent;
+    if (sent < n)
+      break;
+  }
+
+  return total;
+}
+
+int
+nanostream_net_sender_enable_txtime(nanostream_net_sender* sender)
+{
+#ifdef SO_TXTIME
+  struct sock_txtime txtime;
+  memset(&txtime, 0, sizeof(txtime));
+  txtime.clockid = CLOCK_MONOTONIC;
+  return (setsockopt(sender->fd, SOL_SOCKET, SO_TXTIME, &txtime, sizeof(txtime)) == 0) ? 0 : -1;
+#else
+  (void)sender;
+  return -1;
+#endif
+}
+
+int
+nanostream_net_sender_set_pacing_rate(nanostream_net_sender* sender, const uint64_t bytes_per_second)
+{
+#ifdef SO_MAX_PACING_RATE
+  /* The kernel takes an unsigned long, and ~0 for no cap. */
+  unsigned long rate = bytes_per_second ? (unsigned long)bytes_per_second : ~0ul;
+  return (setsockopt(sender->fd, SOL_SOCKET, SO_MAX_PACING_RATE, &rate, sizeof(rate)) == 0) ? 0 : -1;
+#else
+  (void)sender;
+  (void)bytes_per_second;
+  return -1;
+#endif
+}
+
+int
+nanostream_net_sender_set_multicast(nanostream_net_sender* sender, const char* interface, const int hops)
+{
+  const unsigned int index = interface ? if_nametoindex(interface) : 0;
+  if (interface && (index == 0))
+    return -1;
+
+  /* Datagrams also loop back to members on the sending host, so a sender and its viewers can share one. */
+  const int ttl = (hops > 0) ? hops : 1;
+  const int loop = 1;
+
+  if (sender->address.ss_family == AF_INET6) {
+    const int if_index = (int)index;
+    return ((setsockopt(sender->fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, &if_index, sizeof(if_index)) == 0) &&
+            (setsockopt(sender->fd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &ttl, sizeof(ttl)) == 0) &&
+            (setsockopt(sender->fd, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &loop, sizeof(loop)) == 0))
+             ? 0
+             : -1;
+  }
+
+  struct ip_mreqn request;
+  memset(&request, 0, sizeof(request));
+  request.imr_ifindex = (int)index;
+  const unsigned char ttl_byte = (unsigned char)((ttl > 255) ? 255 : ttl);
+  const unsigned char loop_byte = 1;
+  return ((setsockopt(sender->fd, IPPROTO_IP, IP_MULTICAST_IF, &request, sizeof(request)) == 0) &&
+          (setsockopt(sender->fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl_byte, sizeof(ttl_byte)) == 0) &&
+          (setsockopt(sender->fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop_byte, sizeof(loop_byte)) == 0))
+           ? 0
+           : -1;
+}
+
+int
+nanostream_net_send_datagrams_at(nanostream_net_sender* sender,
+                                 const unsigned char* const* datagrams,
+                                 const size_t* sizes,
+                                 const uint64_t* times_ns,
+                                 const int count)
+{
+#ifdef SO_TXTIME
+  struct iovec iov[BATCH_SIZE];
+  struct mmsghdr messages[BATCH_SIZE];
+  union
+  {
+    char buffer[CMSG_SPACE(sizeof(uint64_t))];
+    struct cmsghdr align;
+  } controls[BATCH_SIZE];
+
+  int total = 0;
+
+  for (int first = 0; first < count; first += BATCH_SIZE) {
+    const int n = (count - first < BATCH_SIZE) ? (count - first) : BATCH_SIZE;
+
+    memset(messages, 0, sizeof(messages[0]) * (size_t)n);
+    memset(controls, 0, sizeof(controls[0]) * (size_t)n);
+
+    for (int i = 0; i < n; i++) {
+      iov[i].iov_base = (void*)datagrams[first + i];
+      iov[i].iov_len = sizes[first + i];
+
+      messages[i].msg_hdr.msg_name = &sender->address;
+      messages[i].msg_hdr.msg_namelen = sender->address_size;
+      messages[i].msg_hdr.msg_iov = &iov[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+      messages[i].msg_hdr.msg_control = controls[i].buffer;
+      messages[i].msg_hdr.msg_controllen = sizeof(controls[i].buffer);
+
+      struct cmsghdr* control = CMSG_FIRSTHDR(&messages[i].msg_hdr);
+      control->cmsg_level = SOL_SOCKET;
+      control->cmsg_type = SCM_TXTIME;
+      control->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+      memcpy(CMSG_DATA(control), &times_ns[first + i], sizeof(uint64_t));
+    }
+
+    const int sent = send_batch(sender, messages, n);
+    total += sent;
+    if (sent < n)
+      break;
+  }
+
+  return total;
+#else
+  (void)times_ns;
+  return nanostream_net_send_datagrams(sender, datagrams, sizes, count);
+#endif
+}
+
+/* Joins the group a receiver is bound to on the interface with the given index, or the one the kernel picks if it is
+ * zero. */
+static int
+join(nanostream_net_receiver* receiver, const struct sockaddr_storage* group, const unsigned int index)
+{
+  if (group->ss_family == AF_INET6) {
+    struct ipv6_mreq request;
+    memset(&request, 0, sizeof(request));
+    request.ipv6mr_multiaddr = ((const struct sockaddr_in6*)group)->sin6_addr;
+    request.ipv6mr_interface = index;
+    return (setsockopt(receiver->fd, IPPROTO_IPV6, IPV6_JOIN_GROUP, &request, sizeof(request)) == 0) ? 0 : -1;
+  }
+
+  struct ip_mreqn request;
+  memset(&request, 0, sizeof(request));
+  request.imr_multiaddr = ((const struct sockaddr_in*)group)->sin_addr;
+  request.imr_ifindex = (int)index;
+  return (setsockopt(receiver->fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) == 0) ? 0 : -1;
+}
+
+static int
+is_multicast(const struct sockaddr_storage* address)
+{
+  if (address->ss_family == AF_INET6)
+    return IN6_IS_ADDR_MULTICAST(&((const struct sockaddr_in6*)address)->sin6_addr);
+  if (address->ss_family == AF_INET)
+    return IN_MULTICAST(ntohl(((const struct sockaddr_in*)address)->sin_addr.s_addr));
+  return 0;
+}
+
+/* Creates a receiver bound to the given address, and if 'multicast' is set, a member of the group it names. */
+static nanostream_net_receiver*
+open_receiver(const char* host, const int port, const int buffer_size, const int multicast, const char* interface)
+{
+  nanostream_net_receiver* receiver = calloc(1, sizeof(nanostream_net_receiver));
+  if (!receiver)
+    return NULL;
+
+  struct sockaddr_storage address;
+  socklen_t address_size = 0;
+  const unsigned int index = interface ? if_nametoindex(interface) : 0;
+  if ((resolve(host, port, 1, &address, &address_size) != 0) || (multicast && !is_multicast(&address)) ||
+      (interface && (index == 0))) {
+    free(receiver);
+    return NULL;
+  }
+
+  /* Binding to a link-local group takes the interface too. */
+  if (multicast && (address.ss_family == AF_INET6) && (((struct sockaddr_in6*)&address)->sin6_scope_id == 0))
+    ((struct sockaddr_in6*)&address)->sin6_scope_id = index;
+
+  receiver->fd = socket(address.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  receiver->buffers = malloc((size_t)BATCH_SIZE * NANOSTREAM_NET_MAX_DATAGRAM_SIZE);
+  if ((receiver->fd < 0) || !receiver->buffers) {
+    nanostream_net_receiver_destroy(receiver);
+    return NULL;
+  }
+
+  /* Bound to the group address, a receiver only gets the datagrams of its group, and any number of them can share
+   * the port. */
+  const int reuse = 1;
+  if ((multicast && (setsockopt(receiver->fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0)) ||
+      (bind(receiver->fd, (struct sockaddr*)&address, address_size) != 0) ||
+      (multicast && (join(receiver, &address, index) != 0))) {
+    nanostream_net_receiver_destroy(receiver);
+    return NULL;
+  }
+
+  const int size = (buffer_size > 0) ? buffer_size : (8 << 20);
+  setsockopt(receiver->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+  struct sockaddr_storage bound;
+  socklen_t bound_size = sizeof(bound);
+  if (getsockname(receiver->fd, (struct sockaddr*)&bound, &bound_size) == 0) {
+    char service[NI_MAXSERV];
+    if (getnameinfo((struct sockaddr*)&bound, bound_size, NULL, 0, service, sizeof(service), NI_NUMERICSERV) == 0)
+      receiver->port = atoi(service);
+  }
+
+  return receiver;
+}
+
+nanostream_net_receiver*
+nanostream_net_receiver_create(const char* host, const int port, const int buffer_size)
+{
+  return open_receiver(host, port, buffer_size, 0, NULL);
+}
+
+nanostream_net_receiver*
+nanostream_net_receiver_join(const char* group, const int port, const char* interface, const int buffer_size)
+{
+  return open_receiver(group, port, buffer_size, 1, interface);
+}
+
+void
+nanostream_net_receiver_destroy(nanostream_net_receiver* receiver)
+{
+  if (!receiver)
+    return;
+
+  if (receiver->fd >= 0)
+    close(receiver->fd);
+  free(receiver->buffers);
+  free(receiver);
+}
+
+int
+nanostream_net_receiver_port(const nanostream_net_receiver* receiver)
+{
+  return receiver->port;
+}
+
+int
+nanostream_net_receive(nanostream_net_receiver* receiver,
+                       nanostream_net_packet* packets,
+                       const int max_packets,
+                       const int timeout_ms)
+{
+  struct pollfd pfd;
+  pfd.fd = receiver->fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  const int ready = poll(&pfd, 1, timeout_ms);
+  if (ready < 0)
+    return (errno == EINTR) ? 0 : -1;
+  if (ready == 0)
+    return 0;
+
+  const int count = (max_packets < BATCH_SIZE) ? max_packets : BATCH_SIZE;
+
+  struct iovec iov[BATCH_SIZE];
+  struct mmsghdr messages[BATCH_SIZE];
+  memset(messages, 0, sizeof(messages[0]) * (size_t)count);
+
+  for (int i = 0; i < count; i++) {
+    iov[i].iov_base = receiver->buffers + (size_t)i * NANOSTREAM_NET_MAX_DATAGRAM_SIZE;
+    iov[i].iov_len = NANOSTREAM_NET_MAX_DATAGRAM_SIZE;
+    messages[i].msg_hdr.msg_iov = &iov[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  const int received = recvmmsg(receiver->fd, messages, (unsigned)count, MSG_DONTWAIT, NULL);
+  if (received < 0)
+    return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? 0 : -1;
+
+  int n = 0;
+  for (int i = 0; i < received; i++) {
+    const unsigned char* datagram = iov[i].iov_base;
+    const size_t size = messages[i].msg_len;
+    if ((messages[i].msg_hdr.msg_flags & MSG_TRUNC) ||
+        (nanostream_net_parse_header(datagram, size, &packets[n].header) != 0)) {
+      receiver->invalid++;
+      continue;
+    }
+    const int has_checksum = (packets[n].header.flags & NANOSTREAM_NET_FLAG_CHECKSUM) != 0;
+    if (has_checksum && (nanostream_net_verify_checksum(datagram, size) != 0)) {
+      receiver->invalid++;
+      receiver->corrupted++;
+      continue;
+    }
+    packets[n].payload = datagram + NANOSTREAM_NET_HEADER_SIZE;
+    packets[n].payload_size = size - NANOSTREAM_NET_HEADER_SIZE - (has_checksum ? NANOSTREAM_NET_CHECKSUM_SIZE : 0);
+    n++;
+  }
+
+  return n;
+}
+
+uint64_t
+nanostream_net_receiver_invalid(const nanostream_net_receiver* receiver)
+{
+  return receiver->invalid;
+}
+
+uint64_t
+nanostream_net_receiver_corrupted(const nanostream_net_receiver* receiver)
+{
+  return receiver->corrupted;
+}
+
+struct recovery_parity
+{
+  int k;
+  int m;
+  int j;
+  int tiles[NANOSTREAM_FEC_MAX_DATA];
+  unsigned char packet[NANOSTREAM_PACKET_SIZE];
+  /* Set while counting the groups that could not be rebuilt. */
+  int counted;
+};
+
+/* The tiles and parity received for one frame of a stream. */
+struct recovery_frame
+{
+  int in_use;
+  uint32_t frame;
+  nanostream_net_header header;
+
+  int num_grid_tiles;
+  unsigned char* packets;
+  unsigned char* have;
+
+  struct recovery_parity* parities;
+  int num_parities;
+  int parity_capacity;
+};
+
+struct recovery_stream
+{
+  struct recovery_frame frames[RECOVERY_FRAMES];
+};
+
+struct nanostream_net_recovery
+{
+  struct recovery_stream* streams;
+  int max_streams;
+  uint64_t recovered;
+  uint64_t unrecoverable;
+};
+
+nanostream_net_recovery*
+nanostream_net_recovery_create(const int max_streams)
+{
+  nanostream_net_recovery* recovery = calloc(1, sizeof(nanostream_net_recovery));
+  if (!recovery)
+    return NULL;
+
+  recovery->max_streams = (max_streams > 0) ? max_streams : 1;
+  recovery->streams = calloc((size_t)recovery->max_streams, sizeof(struct recovery_stream));
+  if (!recovery->streams) {
+    free(recovery);
+    return NULL;
+  }
+
+  return recovery;
+}
+
+void
+nanostream_net_recovery_destroy(nanostream_net_recovery* recovery)
+{
+  if (!recovery)
+    return;
+
+  for (int s = 0; s < recovery->max_streams; s++) {
+    for (int f = 0; f < RECOVERY_FRAMES; f++) {
+      struct recovery_frame* frame = &recovery->streams[s].frames[f];
+      free(frame->packets);
+      free(frame->have);
+      free(frame->parities);
+    }
+  }
+  free(recovery->streams);
+  free(recovery);
+}
+
+static int
+same_group(const struct recovery_parity* a, const struct recovery_parity* b)
+{
+  return (a->k == b->k) && (a->m == b->m) && (memcmp(a->tiles, b->tiles, sizeof(int) * (size_t)a->k) == 0);
+}
+
+static int
+group_missing(const struct recovery_frame* frame, const struct recovery_parity* parity)
+{
+  int missing = 0;
+  for (int i = 0; i < parity->k; i++)
+    missing += !frame->have[parity->tiles[i]];
+  return missing;
+}
+
+/* Counts the groups of a frame that are about to be forgotten with tiles still missing. */
+static void
+count_unrecoverable(nanostream_net_recovery* recovery, struct recovery_frame* frame)
+{
+  for (int p = 0; p < frame->num_parities; p++)
+    frame->parities[p].counted = 0;
+
+  for (int p = 0; p < frame->num_parities; p++) {
+    struct recovery_parity* parity = &frame->parities[p];
+    if (parity->counted)
+      continue;
+    for (int q = p; q < frame->num_parities; q++) {
+      if (same_group(parity, &frame->parities[q]))
+        frame->parities[q].counted = 1;
+    }
+    if (group_missing(frame, parity) > 0)
+      recovery->unrecoverable++;
+  }
+}
+
+/* Returns the state of the frame of a datagram, starting it if the datagram is of a newer frame, or null if the
+ * datagram is of a frame that was already forgotten. */
+static struct recovery_frame*
+recovery_frame_of(nanostream_net_recovery* recovery, const nanostream_net_header* header)
+{
+  struct recovery_frame* frame = &recovery->streams[header->stream].frames[header->frame % RECOVERY_FRAMES];
+  if (frame->in_use && (frame->frame == header->frame))
+    return frame;
+  if (frame->in_use && ((int32_t)(header->frame - frame->frame) < 0))
+    return NULL;
+
+  if (frame->in_use)
+    count_unrecoverable(recovery, frame);
+
+  const int num_grid_tiles = nanostream_frame_tiles_x(header->width) * nanostream_frame_tiles_y(header->height);
+  if (num_grid_tiles != frame->num_grid_tiles) {
+    free(frame->packets);
+    free(frame->have);
+    frame->packets = malloc((size_t)num_grid_tiles * NANOSTREAM_PACKET_SIZE);
+    frame->have = malloc((size_t)num_grid_tiles);
+    frame->num_grid_tiles = frame->packets && frame->have ? num_grid_tiles : 0;
+    if (!frame->num_grid_tiles) {
+      frame->in_use = 0;
+      return NULL;
+    }
+  }
+
+  frame->in_use = 1;
+  frame->frame = header->frame;
+  frame->header = *header;
+  frame->num_parities = 0;
+  memset(frame->have, 0, (size_t)num_grid_tiles);
+  return frame;
+}
+
+/* Rebuilds the missing tiles of the group of a parity packet, if enough of the group has arrived. */
+static int
+recover_group(nanostream_net_recovery* recovery,
+              struct recovery_frame* frame,
+              const struct recovery_parity* parity,
+              nanostream_net_packet* recovered,
+              const int max_recovered)
+{
+  const int k = parity->k;
+  const int m = parity->m;
+  const int missing = group_missing(frame, parity);
+  if (missing == 0)
+    return 0;
+
+  unsigned char* blocks[NANOSTREAM_FEC_MAX_DATA + NANOSTREAM_FEC_MAX_PARITY];
+  unsigned char present[NANOSTREAM_FEC_MAX_DATA + NANOSTREAM_FEC_MAX_PARITY];
+  memset(present, 0, sizeof(present));
+
+  int num_parity = 0;
+  for (int p = 0; p < frame->num_parities; p++) {
+    struct recovery_parity* other = &frame->parities[p];
+    if (same_group(parity, other) && !present[k + other->j]) {
+      blocks[k + other->j] = other->packet;
+      present[k + other->j] = 1;
+      num_parity++;
+    }
+  }
+  if (num_parity < missing)
+    return 0;
+
+  for (int i = 0; i < k; i++) {
+    blocks[i] = frame->packets + (size_t)parity->tiles[i] * NANOSTREAM_PACKET_SIZE;
+    present[i] = frame->have[parity->tiles[i]];
+  }
+
+  if (nanostream_fec_decode(blocks, present, k, m, NANOSTREAM_PACKET_SIZE) != 0)
+    return 0;
+
+  int n = 0;
+  for (int i = 0; i < k; i++) {
+    const int tile = parity->tiles[i];
+    if (present[i])
+      continue;
+    frame->have[tile] = 1;
+    recovery->recovered++;
+    if (n == max_recovered)
+      continue;
+    recovered[n].header = frame->header;
+    recovered[n].header.type = NANOSTREAM_NET_TILE;
+    recovered[n].header.flags |= NANOSTREAM_NET_FLAG_RECOVERED;
+    recovered[n].header.sequence = 0;
+    recovered[n].header.tile = tile;
+    recovered[n].payload = blocks[i];
+    recovered[n].payload_size = NANOSTREAM_PACKET_SIZE;
+    n++;
+  }
+
+  return n;
+}
+
+int
+nanostream_net_recovery_add(nanostream_net_recovery* recovery,
+                            const nanostream_net_packet* packet,
+                            nanostream_net_packet* recovered,
+                            const int max_recovered)
+{
+  const nanostream_net_header* header = &packet->header;
+  if ((header->stream < 0) || (header->stream >= recovery->max_streams))
+    return 0;
+
+  struct recovery_frame* frame = recovery_frame_of(recovery, header);
+  if (!frame)
+    return 0;
+
+  if (header->type == NANOSTREAM_NET_TILE) {
+    if ((header->tile >= frame->num_grid_tiles) || frame->have[header->tile])
+      return 0;
+    memcpy(frame->packets + (size_t)header->tile * NANOSTREAM_PACKET_SIZE, packet->payload, NANOSTREAM_PACKET_SIZE);
+    frame->have[header->tile] = 1;
+
+    /* The tile may complete what a parity packet of its group needs. */
+    for (int p = 0; p < frame->num_parities; p++) {
+      const struct recovery_parity* parity = &frame->parities[p];
+      for (int i = 0; i < parity->k; i++) {
+        if (parity->tiles[i] == header->tile)
+          return recover_group(recovery, frame, parity, recovered, max_recovered);
+      }
+    }
+    return 0;
+  }
+
+  if (header->type != NANOSTREAM_NET_PARITY)
+    return 0;
+
+  const unsigned char* payload = packet->payload;
+  struct recovery_parity parity;
+  parity.k = payload[0];
+  parity.m = payload[1];
+  parity.j = payload[2];
+  parity.counted = 0;
+  for (int i = 0; i < parity.k; i++) {
+    parity.tiles[i] = nanostream_load_u16le(payload + PARITY_HEADER_SIZE + 2 * i);
+    if (parity.tiles[i] >= frame->num_grid_tiles)
+      return 0;
+  }
+
+  for (int p = 0; p < frame->num_parities; p++) {
+    if ((frame->parities[p].j == parity.j) && same_group(&frame->parities[p], &parity))
+      return 0;
+  }
+
+  if (frame->num_parities == frame->parity_capacity) {
+    const int capacity = frame->parity_capacity ? frame->parity_capacity * 2 : 16;
+    struct recovery_parity* parities = realloc(frame->parities, (size_t)capacity * sizeof(struct recovery_parity));
+    if (!parities)
+      return 0;
+    frame->parities = parities;
+    frame->parity_capacity = capacity;
+  }
+
+  struct recovery_parity* stored = &frame->parities[frame->num_parities++];
+  *stored = parity;
+  memcpy(stored->packet, payload + PARITY_HEADER_SIZE + 2 * (size_t)parity.k, NANOSTREAM_PACKET_SIZE);
+
+  return recover_group(recovery, frame, stored, recovered, max_recovered);
+}
+
+uint64_t
+nanostream_net_recovery_recovered(const nanostream_net_recovery* recovery)
+{
+  return recovery->recovered;
+}
+
+uint64_t
+nanostream_net_recovery_unrecoverable(const nanostream_net_recovery* recovery)
+{
+  return recovery->unrecoverable;
+}
+
+struct nanostream_net_bases
+{
+  /* The latest two bases, the latest first. */
+  nanostream_basis* held[2];
+  int held_versions[2];
+
+  /* The parts of the basis being collected. */
+  int version;
+  unsigned int parts;
+  unsigned char data[NANOSTREAM_BASIS_SIZE];
+};
+
+nanostream_net_bases*
+nanostream_net_bases_create(void)
+{
+  return calloc(1, sizeof(nanostream_net_bases));
+}
+
+void
+nanostream_net_bases_destroy(nanostream_net_bases* bases)
+{
+  if (!bases)
+    return;
+
+  nanostream_basis_destroy(bases->held[0]);
+  nanostream_basis_destroy(bases->held[1]);
+  free(bases);
+}
+
+int
+nanostream_net_bases_add(nanostream_net_bases* bases, const nanostream_net_packet* packet)
+{
+  const nanostream_net_header* header = &packet->header;
+  if ((header->type != NANOSTREAM_NET_BASIS) || (header->num_tiles != NANOSTREAM_NET_BASIS_PARTS) ||
+      (header->tile < 0) || (header->tile >= NANOSTREAM_NET_BASIS_PARTS))
+    return -1;
+
+  const int version = (int)header->frame;
+  const size_t offset = (size_t)header->tile * NANOSTREAM_PACKET_SIZE;
+  const size_t size = (NANOSTREAM_BASIS_SIZE - offset < NANOSTREAM_PACKET_SIZE) ? (NANOSTREAM_BASIS_SIZE - offset)
+                                                                                : NANOSTREAM_PACKET_SIZE;
+  if (packet->payload_size != size)
+    return -1;
+
+  for (int i = 0; i < 2; i++) {
+    if (bases->held[i] && (bases->held_versions[i] == version))
+      return version;
+  }
+
+  /* Parts of another version replace those collected so far. */
+  if (bases->version != version) {
+    bases->version = version;
+    bases->parts = 0;
+  }
+
+  memcpy(bases->data + offset, packet->payload, size);
+  bases->parts |= 1u << header->tile;
+  if (bases->parts != (1u << NANOSTREAM_NET_BASIS_PARTS) - 1)
+    return 0;
+
+  nanostream_basis* basis = nanostream_basis_load(bases->data);
+  bases->version = 0;
+  bases->parts = 0;
+  if (!basis)
+    return -1;
+
+  nanostream_basis_destroy(bases->held[1]);
+  bases->held[1] = bases->held[0];
+  bases->held_versions[1] = bases->held_versions[0];
+  bases->held[0] = basis;
+  bases->held_versions[0] = version;
+  return version;
+}
+
+int
+nanostream_net_bases_find(const nanostream_net_bases* bases, const int version, const nanostream_basis** basis)
+{
+  if (version == 0) {
+    *basis = NULL;
+    return 0;
+  }
+
+  for (int i = 0; i < 2; i++) {
+    if (bases->held[i] && (bases->held_versions[i] == version)) {
+      *basis = bases->held[i];
+      return 0;
+    }
+  }
+  return -1;
+}
+
+int
+nanostream_net_bases_latest(const nanostream_net_bases* bases)
+{
+  return bases->held[0] ? bases->held_versions[0] : 0;
+}
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "nanostream.h"
+#include "nanostream_basis.h"
+#include "nanostream_fec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Transport of tile packets over UDP. Every datagram carries one tile packet behind a small header that says which
+ * stream, frame and tile it belongs to, so datagrams can be lost or reordered and each one is still decodable on its
+ * own. Senders and receivers move datagrams in batches (sendmmsg and recvmmsg) to keep the system call cost per tile
+ * low.
+ *
+ * Optionally, the tiles of a frame are sent in groups, each followed by parity datagrams (see nanostream_fec.h) from
+ * which a receiver rebuilds lost tiles of the group without waiting for a retransmission.
+ *
+ * A sender can also send to a multicast group, so that viewers of the same stream on a LAN share one copy of each
+ * datagram rather than the sender copying every tile packet once per viewer. Each viewer joins the group with its own
+ * receiver and assembles and decodes the frames on its own; the datagrams are the same as with unicast.
+ *
+ * Feedback datagrams go the other way, from a receiver back to a sender, to ask for lost datagrams again or for tiles
+ * to be refreshed (see nanostream_feedback.h).
+ *
+ * All fields are little-endian:
+ *
+ *   offset  size  field
+ *        0     2  magic, "NS"
+ *        2     1  version
+ *        3     1  type
+ *        4     2  stream
+ *        6     2  flags
+ *        8     4  frame
+ *       12     4  sequence, counting the datagrams of the stream
+ *       16     2  tile index
+ *       18     2  number of tiles the frame carries
+ *       20     2  image width
+ *       22     2  image height
+ *       24     8  timestamp of the frame in microseconds
+ *
+ * A parity datagram has the tile field set to the first tile of its group, and its payload is:
+ *
+ *   offset  size  field
+ *        0     1  k, the number of tiles in the group
+ *        1     1  m, the number of parity datagrams of the group
+ *        2     1  the index of this parity datagram, below m
+ *        3     1  reserved, zero
+ *        4    2k  the indices of the tiles of the group, in the order they were encoded
+ *     4+2k  1264  the parity packet
+ *
+ * The tiles of a stream may be encoded with a basis derived from its content rather than the built-in one (see
+ * nanostream_basis.h). The upper byte of the flags of tile and parity datagrams holds the version of that basis, from
+ * 1 to 255 and then 1 again, or zero for the built-in basis. The basis itself is sent in basis datagrams, before any
+ * tile encoded with it, and again until a receiver acknowledges it. A basis datagram has the frame field set to the
+ * version, the tile field to the index of the part of the basis it carries, the num_tiles field to the number of
+ * parts, and the sequence zero, as basis datagrams are not reported lost. Its payload is the next
+ * NANOSTREAM_PACKET_SIZE bytes of the basis as nanostream_basis_store writes it, fewer in the last part.
+ *
+ * A feedback datagram has the stream field set to the stream it reports on, the frame field to the version of the
+ * latest basis the receiver holds, which acknowledges it, the sequence field counting the feedback datagrams of that
+ * stream, and the other fields zero. Its payload is:
+ *
+ *   offset  size  field
+ *        0     4  the sequence of the latest datagram received, echoed for the sender to measure the round trip
+ *        4     4  microseconds from receiving that datagram to sending this one
+ *        8     2  n, the number of ranges of lost sequence numbers
+ *       10     2  r, the number of tiles to refresh
+ *       12    6n  the ranges: the first sequence number (4 bytes) and the number of datagrams (2 bytes)
+ *    12+6n    2r  the indices of the tiles to refresh
+ *
+ * A datagram with the checksum flag set ends with 4 more bytes: the CRC32C (see nanostream_crc32c.h) of everything
+ * before them, header included. Receivers drop a datagram whose checksum does not match, so a damaged packet never
+ * reaches the decoder, where a bad eigenvalue range would wreck the whole tile. The sender sets the flag in the header
+ * it passes to the send functions.
+ *
+ * Linux only. */
+
+#define NANOSTREAM_NET_VERSION 1
+
+#define NANOSTREAM_NET_HEADER_SIZE 32
+
+#define NANOSTREAM_NET_CHECKSUM_SIZE 4
+
+/* The largest datagram: a parity datagram of the largest group, with a checksum. */
+#define NANOSTREAM_NET_MAX_DATAGRAM_SIZE                                                                               \
+  (NANOSTREAM_NET_HEADER_SIZE + 4 + 2 * NANOSTREAM_FEC_MAX_DATA + NANOSTREAM_PACKET_SIZE + NANOSTREAM_NET_CHECKSUM_SIZE)
+
+/* The largest image width and height, and the most tiles a frame may have, as the header holds them in 16 bits. */
+#define NANOSTREAM_NET_MAX_SIZE 0xFFFF
+#define NANOSTREAM_NET_MAX_TILES 0xFFFF
+
+/* Set in the header of a tile that was rebuilt from parity rather than received. */
+#define NANOSTREAM_NET_FLAG_RECOVERED 0x1u
+
+/* Set in the header of a datagram that is sent again because a receiver reported it lost. */
+#define NANOSTREAM_NET_FLAG_RETRANSMITTED 0x2u
+
+/* Set in the header of a datagram that ends with a checksum. */
+#define NANOSTREAM_NET_FLAG_CHECKSUM 0x4u
+
+/* The version of the basis in the flags of a tile or parity datagram, and the flags that hold a version. */
+#define NANOSTREAM_NET_BASIS_VERSION(flags) (((flags) >> 8) & 0xFFu)
+#define NANOSTREAM_NET_FLAGS_BASIS(version) (((unsigned int)(version) & 0xFFu) << 8)
+
+/* The number of basis datagrams a basis is sent in. */
+#define NANOSTREAM_NET_BASIS_PARTS                                                                                     \
+  ((int)((NANOSTREAM_BASIS_SIZE + NANOSTREAM_PACKET_SIZE - 1) / NANOSTREAM_PACKET_SIZE))
+
+/* The part of a feedback payload before the ranges. */
+#define NANOSTREAM_NET_FEEDBACK_HEADER_SIZE 12
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef enum nanostream_net_type
+  {
+    /* A tile packet. */
+    NANOSTREAM_NET_TILE = 0,
+    /* A parity packet over a group of tiles of the frame. */
+    NANOSTREAM_NET_PARITY = 1,
+    /* Losses and refresh requests reported by a receiver. */
+    NANOSTREAM_NET_FEEDBACK = 2,
+    /* A part of a basis derived from the content of the stream. */
+    NANOSTREAM_NET_BASIS = 3
+  } nanostream_net_type;
+
+  typedef struct nanostream_net_header
+  {
+    nanostream_net_type type;
+    int stream;
+    unsigned int flags;
+    uint32_t frame;
+    uint32_t sequence;
+    int tile;
+    int num_tiles;
+    int width;
+    int height;
+    uint64_t timestamp_us;
+  } nanostream_net_header;
+
+  typedef struct nanostream_net_packet
+  {
+    nanostream_net_header header;
+    const unsigned char* payload;
+    size_t payload_size;
+  } nanostream_net_packet;
+
+  typedef struct nanostream_net_sender nanostream_net_sender;
+
+  typedef struct nanostream_net_receiver nanostream_net_receiver;
+
+  typedef struct nanostream_net_recovery nanostream_net_recovery;
+
+  typedef struct nanostream_net_bases nanostream_net_bases;
+
+  void nanostream_net_store_header(unsigned char* out, const nanostream_net_header* header);
+
+  /* Parses the header of a datagram. Returns zero if it is a valid datagram of this version. The checksum is not
+   * verified. */
+  int nanostream_net_parse_header(const unsigned char* datagram, size_t size, nanostream_net_header* header);
+
+  /* Returns zero if frames of the given size fit the header: a width and a height from 1 to NANOSTREAM_NET_MAX_SIZE,
+   * and at most NANOSTREAM_NET_MAX_TILES tiles. Returns -1 otherwise. */
+  int nanostream_net_check_size(int width, int height);
+
+  /* Sets the checksum flag of a datagram of 'size' bytes and appends its checksum, for which there must be room.
+   * Returns the new size. */
+  size_t nanostream_net_store_checksum(unsigned char* datagram, size_t size);
+
+  /* Returns zero if a datagram has no checksum or its checksum matches, and -1 otherwise. */
+  int nanostream_net_verify_checksum(const unsigned char* datagram, size_t size);
+
+  /* Creates a sender for the given destination. 'buffer_size' is the socket send buffer size, zero for 4 MB. Returns
+   * null on failure. */
+  nanostream_net_sender* nanostream_net_sender_create(const char* host, int port, int buffer_size);
+
+  void nanostream_net_sender_destroy(nanostream_net_sender* sender);
+
+  /* Sends the tile packets of a frame, one datagram each. 'header' describes the frame: its tile is ignored and its
+   * sequence is that of the first datagram, the rest following on. 'tile_indices' may be null if the packets are the
+   * tiles 0 to num_tiles - 1. Returns the number of datagrams sent, which is less than 'num_tiles' if the socket
+   * failed, and zero if the width and height of 'header' fail nanostream_net_check_size. */
+  int nanostream_net_send_tiles(nanostream_net_sender* sender,
+                                const nanostream_net_header* header,
+                                const int* tile_indices,
+                                const unsigned char* packets,
+                                int num_tiles);
+
+  /* Like nanostream_net_send_tiles, but sends the tiles in groups of 'group_size' (at most NANOSTREAM_FEC_MAX_DATA),
+   * each followed by 'parity_per_group' parity datagrams (at most NANOSTREAM_FEC_MAX_PARITY). One parity datagram per
+   * group of a tile row is XOR parity across the row. Returns the number of datagrams sent, tiles and parity. */
+  int nanostream_net_send_tiles_with_parity(nanostream_net_sender* sender,
+                                            const nanostream_net_header* header,
+                                            const int* tile_indices,
+                                            const unsigned char* packets,
+                                            int num_tiles,
+                                            int group_size,
+                                            int parity_per_group);
+
+  /* The size of a parity datagram for a group of k tiles, without a checksum. */
+  size_t nanostream_net_parity_size(int k);
+
+  /* Builds the m parity datagrams of a group of k tiles, whose packets are back to back, into 'out', one after the
+   * other. 'header' describes the frame; its sequence is that of the first parity datagram. With the checksum flag
+   * set, each datagram takes NANOSTREAM_NET_CHECKSUM_SIZE more bytes. */
+  void nanostream_net_store_parity(unsigned char* out,
+                                   const nanostream_net_header* header,
+                                   const int* tile_indices,
+                                   const unsigned char* packets,
+                                   int k,
+                                   int m);
+
+  /* Sends one datagram, a header followed by a payload. Returns zero on success. */
+  int nanostream_net_send(nanostream_net_sender* sender,
+                          const nanostream_net_header* header,
+                          const unsigned char* payload,
+                          size_t payload_size);
+
+  /* Sends a basis of version 1 to 255 in NANOSTREAM_NET_BASIS_PARTS basis datagrams. 'header' gives the stream, the
+   * timestamp and the checksum flag; the other fields are filled in. Returns the number of datagrams sent. */
+  int nanostream_net_send_basis(nanostream_net_sender* sender,
+                                const nanostream_net_header* header,
+                                const nanostream_basis* basis,
+                                int version);
+
+  /* Sends whole datagrams as they are, for example ones replayed from a capture. Returns the number sent, which is
+   * less than 'count' if the socket failed. */
+  int nanostream_net_send_datagrams(nanostream_net_sender* sender,
+                                    const unsigned char* const* datagrams,
+                                    const size_t* sizes,
+                                    int count);
+
+  /* Lets the kernel hold each datagram passed to nanostream_net_send_datagrams_at until its time (SO_TXTIME). Only
+   * interfaces whose queueing discipline honours it, such as fq or etf, do; others send the datagrams at once.
+   * Returns zero on success, or -1 if the kernel does not support it. */
+  int nanostream_net_sender_enable_txtime(nanostream_net_sender* sender);
+
+  /* Caps the rate at which the kernel sends the datagrams of the sender (SO_MAX_PACING_RATE), in bytes per second,
+   * zero for no cap. Only the fq queueing discipline enforces it. Returns zero on success. */
+  int nanostream_net_sender_set_pacing_rate(nanostream_net_sender* sender, uint64_t bytes_per_second);
+
+  /* Sets up a sender whose destination is a multicast group, so that one copy of each datagram reaches every receiver
+   * that joined it (see nanostream_net_receiver_join). 'interface' names the interface to send on, or is null for the
+   * one the routes pick, such as "lo" to keep the group on the host. 'hops' is the number of routers the datagrams
+   * may cross, zero for 1, which keeps them on the local network. Datagrams are also delivered to members on the
+   * sending host. Returns zero on success. */
+  int nanostream_net_sender_set_multicast(nanostream_net_sender* sender, const char* interface, int hops);
+
+  /* Like nanostream_net_send_datagrams, with the time in nanoseconds of CLOCK_MONOTONIC at which each datagram is to
+   * leave, for a sender with nanostream_net_sender_enable_txtime. */
+  int nanostream_net_send_datagrams_at(nanostream_net_sender* sender,
+                                       const unsigned char* const* datagrams,
+                                       const size_t* sizes,
+                                       const uint64_t* times_ns,
+                                       int count);
+
+  /* Creates a receiver bound to the given address; a port of zero picks a free one. 'buffer_size' is the socket
+   * receive buffer size, zero for 8 MB. Returns null on failure. */
+  nanostream_net_receiver* nanostream_net_receiver_create(const char* host, int port, int buffer_size);
+
+  /* Creates a receiver that joins a multicast group on the given port, on the named interface or, if it is null, on
+   * the one the routes pick. Any number of receivers on a host can join the same group and port, and each gets every
+   * datagram; a port of zero picks a free one, for the others to join. Returns null on failure, including if 'group'
+   * is not a multicast address. */
+  nanostream_net_receiver* nanostream_net_receiver_join(const char* group,
+                                                        int port,
+                                                        const char* interface,
+                                                        int buffer_size);
+
+  void nanostream_net_receiver_destroy(nanostream_net_receiver* receiver);
+
+  int nanostream_net_receiver_port(const nanostream_net_receiver* receiver);
+
+  /* Waits up to 'timeout_ms' milliseconds (forever if negative) for datagrams and returns up to 'max_packets' of them,
+   * or -1 on error. Datagrams that are not valid or fail their checksum are skipped and counted. The payloads, which
+   * do not include the checksum, are valid until the next call. */
+  int nanostream_net_receive(nanostream_net_receiver* receiver,
+                             nanostream_net_packet* packets,
+                             int max_packets,
+                             int timeout_ms);
+
+  /* The number of datagrams that were received but not valid, and of those, the ones that failed their checksum. */
+  uint64_t nanostream_net_receiver_invalid(const nanostream_net_receiver* receiver);
+
+  uint64_t nanostream_net_receiver_corrupted(const nanostream_net_receiver* receiver);
+
+  /* Creates the state for rebuilding lost tiles from parity, for streams 0 to max_streams - 1. The tiles and parity of
+   * the latest few frames of each stream are kept. Returns null on failure. */
+  nanostream_net_recovery* nanostream_net_recovery_create(int max_streams);
+
+  void nanostream_net_recovery_destroy(nanostream_net_recovery* recovery);
+
+  /* Passes every received datagram through here. Returns the tiles that could be rebuilt because of it, up to
+   * 'max_recovered' (which should be at least NANOSTREAM_FEC_MAX_PARITY), with NANOSTREAM_NET_FLAG_RECOVERED set and
+   * a sequence of zero. Their payloads are valid until the next call. */
+  int nanostream_net_recovery_add(nanostream_net_recovery* recovery,
+                                  const nanostream_net_packet* packet,
+                                  nanostream_net_packet* recovered,
+                                  int max_recovered);
+
+  /* The tiles that were rebuilt, and the groups that still missed tiles when their frame was forgotten. */
+  uint64_t nanostream_net_recovery_recovered(const nanostream_net_recovery* recovery);
+
+  uint64_t nanostream_net_recovery_unrecoverable(const nanostream_net_recovery* recovery);
+
+  /* Creates the state for collecting the bases of one stream from its basis datagrams. The latest two are kept, so
+   * that the tiles of frames encoded before a switch to a new basis still decode. Returns null on failure. */
+  nanostream_net_bases* nanostream_net_bases_create(void);
+
+  void nanostream_net_bases_destroy(nanostream_net_bases* bases);
+
+  /* Passes a basis datagram through here. Returns the version of its basis once all of its parts arrived, including
+   * when it was complete already, for the receiver to acknowledge it again in case the acknowledgement was lost; zero
+   * while parts are missing; or -1 if it is not a valid basis datagram. */
+  int nanostream_net_bases_add(nanostream_net_bases* bases, const nanostream_net_packet* packet);
+
+  /* Looks up the basis of a version, which is null for version zero, the built-in basis. Returns zero if it is held,
+   * or -1 if the tiles of that version cannot be decoded (yet). */
+  int nanostream_net_bases_find(const nanostream_net_bases* bases, int version, const nanostream_basis** basis);
+
+  /* The version of the latest basis held, zero if none. */
+  int nanostream_net_bases_latest(const nanostream_net_bases* bases);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,364 @@
+#include "nanostream_pacer.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The number of datagrams handed to the sender at once. */
+#define SEND_BATCH 64
+
+/* The size the burst is counted in: a tile datagram with a checksum. */
+#define DATAGRAM_SIZE (NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_PACKET_SIZE + NANOSTREAM_NET_CHECKSUM_SIZE)
+
+struct entry
+{
+  size_t size;
+  uint64_t queued_us;
+  uint64_t depart_us;
+};
+
+struct nanostream_pacer
+{
+  nanostream_pacer_config config;
+  nanostream_net_sender* sender;
+  nanostream_pacing pacing;
+
+  pthread_mutex_t lock;
+
+  /* A ring of the datagrams held, in the order they leave, each in a slot of NANOSTREAM_NET_MAX_DATAGRAM_SIZE bytes. */
+  struct entry* entries;
+  unsigned char* slots;
+  int head;
+  int count;
+
+  /* The token bucket, in bytes and microseconds, as it was when the last datagram left. */
+  double depth;
+  double rate;
+  double tokens;
+  double last_us;
+
+  nanostream_pacer_stats stats;
+};
+
+nanostream_pacer*
+nanostream_pacer_create(const nanostream_pacer_config* config, nanostream_net_sender* sender)
+{
+  nanostream_pacer* pacer = calloc(1, sizeof(nanostream_pacer));
+  if (!pacer)
+    return NULL;
+
+  pacer->config = *config;
+  if (pacer->config.max_delay_us == 0)
+    pacer->config.max_delay_us = 10000;
+  if (pacer->config.burst <= 0)
+    pacer->config.burst = 4;
+  if (pacer->config.max_datagrams <= 0)
+    pacer->config.max_datagrams = 4096;
+  pacer->sender = sender;
+
+  const int n = pacer->config.max_datagrams;
+  pacer->entries = calloc((size_t)n, sizeof(struct entry));
+  pacer->slots = malloc((size_t)n * NANOSTREAM_NET_MAX_DATAGRAM_SIZE);
+  if (!pacer->entries || !pacer->slots) {
+    free(pacer->entries);
+    free(pacer->slots);
+    free(pacer);
+    return NULL;
+  }
+
+  pacer->depth = (double)pacer->config.burst * DATAGRAM_SIZE;
+  pacer->rate = pacer->depth / (double)pacer->config.max_delay_us;
+  pacer->tokens = pacer->depth;
+
+  pacer->pacing = NANOSTREAM_PACING_USER;
+  if (pacer->config.kernel) {
+    if (nanostream_net_sender_enable_txtime(sender) == 0)
+      pacer->pacing = NANOSTREAM_PACING_TXTIME;
+    else if (nanostream_net_sender_set_pacing_rate(sender, 0) == 0)
+      pacer->pacing = NANOSTREAM_PACING_RATE;
+  }
+  pacer->stats.pacing = pacer->pacing;
+
+  pthread_mutex_init(&pacer->lock, NULL);
+  return pacer;
+}
+
+void
+nanostream_pacer_destroy(nanostream_pacer* pacer)
+{
+  if (!pacer)
+    return;
+
+  pthread_mutex_destroy(&pacer->lock);
+  free(pacer->entries);
+  free(pacer->slots);
+  free(pacer);
+}
+
+static int
+ring_index(const nanostream_pacer* pacer, const int i)
+{
+  return (pacer->head + i) % pacer->config.max_datagrams;
+}
+
+static unsigned char*
+slot(const nanostream_pacer* pacer, const int index)
+{
+  return pacer->slots + (size_t)index * NANOSTREAM_NET_MAX_DATAGRAM_SIZE;
+}
+
+/* Takes the slot for the next datagram, or returns null if the pacer is full. Called with the lock held. */
+static unsigned char*
+push(nanostream_pacer* pacer, const uint64_t now_us, const size_t size)
+{
+  if (pacer->count == pacer->config.max_datagrams) {
+    pacer->stats.datagrams_dropped++;
+    return NULL;
+  }
+
+  const int index = ring_index(pacer, pacer->count++);
+  pacer->entries[index].size = size;
+  pacer->entries[index].queued_us = now_us;
+  return slot(pacer, index);
+}
+
+/* Schedules the datagrams held so that each leaves at most the pacing delay after it was queued: the rate is the
+ * lowest that drains what the bucket cannot send at once in time. Datagrams already handed to the kernel cannot be
+ * moved, so with kernel pacing only the new ones are scheduled, after them. Called with the lock held. */
+static void
+schedule(nanostream_pacer* pacer, const uint64_t now_us)
+{
+  if (pacer->count == 0)
+    return;
+
+  /* The bucket when the first of them can leave. */
+  const double now = (double)now_us;
+  const double start = (pacer->last_us > now) ? pacer->last_us : now;
+  double tokens = pacer->tokens + pacer->rate * (start - pacer->last_us);
+  if (tokens > pacer->depth)
+    tokens = pacer->depth;
+
+  double rate = pacer->depth / (double)pacer->config.max_delay_us;
+  double bytes = 0.0;
+  for (int i = 0; i < pacer->count; i++) {
+    const struct entry* e = &pacer->entries[ring_index(pacer, i)];
+    bytes += (double)e->size;
+    if (bytes <= tokens)
+      continue;
+    double time_left = (double)(e->queued_us + pacer->config.max_delay_us) - start;
+    if (time_left < 1.0)
+      time_left = 1.0;
+    if ((bytes - tokens) / time_left > rate)
+      rate = (bytes - tokens) / time_left;
+  }
+  pacer->rate = rate;
+  pacer->tokens = tokens;
+  pacer->last_us = start;
+
+  double t = start;
+  for (int i = 0; i < pacer->count; i++) {
+    struct entry* e = &pacer->entries[ring_index(pacer, i)];
+    if (tokens < (double)e->size) {
+      t += ((double)e->size - tokens) / rate;
+      tokens = (double)e->size;
+    }
+    tokens -= (double)e->size;
+    e->depart_us = (uint64_t)(t + 0.5);
+
+    const uint64_t delay = (e->depart_us > e->queued_us) ? e->depart_us - e->queued_us : 0;
+    if (delay > pacer->stats.longest_delay_us)
+      pacer->stats.longest_delay_us = delay;
+  }
+  pacer->stats.rate_bytes_per_second = (uint64_t)(rate * 1.0e6);
+}
+
+/* Sends the held datagrams due at now_us, or all of them. Returns the number sent. Called with the lock held. */
+static int
+flush(nanostream_pacer* pacer, const uint64_t now_us, const int all)
+{
+  const unsigned char* datagrams[SEND_BATCH];
+  size_t sizes[SEND_BATCH];
+  uint64_t times_ns[SEND_BATCH];
+  int total = 0;
+
+  while (pacer->count > 0) {
+    int n = 0;
+    while ((n < SEND_BATCH) && (n < pacer->count)) {
+      const int index = ring_index(pacer, n);
+      const struct entry* e = &pacer->entries[index];
+      if (!all && (e->depart_us > now_us))
+        break;
+      datagrams[n] = slot(pacer, index);
+      sizes[n] = e->size;
+      times_ns[n] = e->depart_us * 1000u;
+      n++;
+    }
+    if (n == 0)
+      break;
+
+    const int sent = (pacer->pacing == NANOSTREAM_PACING_TXTIME)
+                       ? nanostream_net_send_datagrams_at(pacer->sender, datagrams, sizes, times_ns, n)
+                       : nanostream_net_send_datagrams(pacer->sender, datagrams, sizes, n);
+
+    /* The bucket drains as the datagrams leave, whether the socket takes them or not. */
+    for (int i = 0; i < n; i++) {
+      const double depart = (double)pacer->entries[ring_index(pacer, i)].depart_us;
+      if (depart > pacer->last_us) {
+        pacer->tokens += pacer->rate * (depart - pacer->last_us);
+        if (pacer->tokens > pacer->depth)
+          pacer->tokens = pacer->depth;
+        pacer->last_us = depart;
+      }
+      pacer->tokens -= (double)sizes[i];
+    }
+
+    /* Datagrams the socket refused are not retried, as if the network had lost them. */
+    pacer->stats.datagrams_sent += (uint64_t)sent;
+    pacer->stats.datagrams_dropped += (uint64_t)(n - sent);
+    total += sent;
+    pacer->head = ring_index(pacer, n);
+    pacer->count -= n;
+  }
+
+  return total;
+}
+
+/* Schedules the datagrams queued and, with kernel pacing, hands them over. Called with the lock held. */
+static void
+queued(nanostream_pacer* pacer, const uint64_t now_us)
+{
+  schedule(pacer, now_us);
+
+  if (pacer->pacing == NANOSTREAM_PACING_RATE)
+    nanostream_net_sender_set_pacing_rate(pacer->sender, pacer->stats.rate_bytes_per_second);
+  if (pacer->pacing != NANOSTREAM_PACING_USER)
+    flush(pacer, now_us, 1);
+}
+
+int
+nanostream_pacer_submit(nanostream_pacer* pacer,
+                        const uint64_t now_us,
+                        const unsigned char* const* datagrams,
+                        const size_t* sizes,
+                        const int count)
+{
+  pthread_mutex_lock(&pacer->lock);
+
+  int n = 0;
+  for (int i = 0; i < count; i++) {
+    if (sizes[i] > NANOSTREAM_NET_MAX_DATAGRAM_SIZE) {
+      pacer->stats.datagrams_dropped++;
+      continue;
+    }
+    unsigned char* datagram = push(pacer, now_us, sizes[i]);
+    if (!datagram)
+      continue;
+    memcpy(datagram, datagrams[i], sizes[i]);
+    n++;
+  }
+  queued(pacer, now_us);
+
+  pthread_mutex_unlock(&pacer->lock);
+
+  return n;
+}
+
+int
+nanostream_pacer_submit_tiles(nanostream_pacer* pacer,
+                              const uint64_t now_us,
+                              const nanostream_net_header* header,
+                              const int* tile_indices,
+                              const unsigned char* packets,
+                              const int num_tiles,
+                              int group_size,
+                              int parity_per_group)
+{
+  if (nanostream_net_check_size(header->width, header->height) != 0)
+    return 0;
+
+  group_size = (group_size < 1) ? 1 : (group_size > NANOSTREAM_FEC_MAX_DATA) ? NANOSTREAM_FEC_MAX_DATA : group_size;
+  parity_per_group = (parity_per_group > NANOSTREAM_FEC_MAX_PARITY) ? NANOSTREAM_FEC_MAX_PARITY : parity_per_group;
+  if (parity_per_group <= 0) {
+    parity_per_group = 0;
+    group_size = NANOSTREAM_FEC_MAX_DATA;
+  }
+
+  const size_t checksum = (header->flags & NANOSTREAM_NET_FLAG_CHECKSUM) ? NANOSTREAM_NET_CHECKSUM_SIZE : 0;
+  const size_t tile_size = NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_PACKET_SIZE;
+
+  unsigned char parity[NANOSTREAM_FEC_MAX_PARITY * NANOSTREAM_NET_MAX_DATAGRAM_SIZE];
+  int indices[NANOSTREAM_FEC_MAX_DATA];
+
+  nanostream_net_header h = *header;
+  h.type = NANOSTREAM_NET_TILE;
+  uint32_t sequence = header->sequence;
+
+  pthread_mutex_lock(&pacer->lock);
+
+  /* Datagrams that do not fit use up their sequence numbers too, so the receivers see them as lost. */
+  int n = 0;
+  for (int first = 0; first < num_tiles; first += group_size) {
+    const int k = (num_tiles - first < group_size) ? (num_tiles - first) : group_size;
+    const unsigned char* group = packets + (size_t)first * NANOSTREAM_PACKET_SIZE;
+
+    for (int i = 0; i < k; i++) {
+      indices[i] = tile_indices ? tile_indices[first + i] : first + i;
+      h.tile = indices[i];
+      h.sequence = sequence++;
+      unsigned char* datagram = push(pacer, now_us, tile_size + checksum);
+      if (!datagram)
+        continue;
+      nanostream_net_store_header(datagram, &h);
+      memcpy(datagram + NANOSTREAM_NET_HEADER_SIZE, group + (size_t)i * NANOSTREAM_PACKET_SIZE, NANOSTREAM_PACKET_SIZE);
+      if (checksum)
+        nanostream_net_store_checksum(datagram, tile_size);
+      n++;
+    }
+
+    if (parity_per_group == 0)
+      continue;
+
+    const size_t parity_size = nanostream_net_parity_size(k) + checksum;
+    h.sequence = sequence;
+    nanostream_net_store_parity(parity, &h, indices, group, k, parity_per_group);
+    sequence += (uint32_t)parity_per_group;
+    for (int j = 0; j < parity_per_group; j++) {
+      unsigned char* datagram = push(pacer, now_us, parity_size);
+      if (!datagram)
+        continue;
+      memcpy(datagram, parity + (size_t)j * parity_size, parity_size);
+      n++;
+    }
+  }
+  queued(pacer, now_us);
+
+  pthread_mutex_unlock(&pacer->lock);
+
+  return n;
+}
+
+int
+nanostream_pacer_send(nanostream_pacer* pacer, const uint64_t now_us)
+{
+  pthread_mutex_lock(&pacer->lock);
+  const int sent = flush(pacer, now_us, 0);
+  pthread_mutex_unlock(&pacer->lock);
+  return sent;
+}
+
+uint64_t
+nanostream_pacer_next_send(nanostream_pacer* pacer)
+{
+  pthread_mutex_lock(&pacer->lock);
+  const uint64_t next = (pacer->count > 0) ? pacer->entries[pacer->head].depart_us : UINT64_MAX;
+  pthread_mutex_unlock(&pacer->lock);
+  return next;
+}
+
+void
+nanostream_pacer_get_stats(nanostream_pacer* pacer, nanostream_pacer_stats* stats)
+{
+  pthread_mutex_lock(&pacer->lock);
+  *stats = pacer->stats;
+  pthread_mutex_unlock(&pacer->lock);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "nanostream_net.h"
+
+#include <stdint.h>
+
+/* A pacer spreads the datagrams of each frame over time instead of sending them in one burst. A 4K frame is 432 tile
+ * packets; sent back to back, they overflow shallow switch buffers and NIC queues, and the tail of the burst is lost.
+ *
+ * Datagrams leave through a token bucket. Its depth is the burst, the number of datagrams that may still go back to
+ * back, and its rate is set whenever datagrams are queued so that they all leave within the pacing delay. The delay is
+ * the knob: a short one gets frames out sooner in bigger bursts, a long one sends them more smoothly but later. A
+ * delay of about the frame interval spreads each frame until the next one arrives.
+ *
+ * The pacer holds the datagrams itself, and nanostream_pacer_send releases them when they are due. With kernel pacing,
+ * it hands them to the kernel at once instead, with the time each should leave (SO_TXTIME), or, if the kernel lacks
+ * that, with a pacing rate (SO_MAX_PACING_RATE). That saves waking up for every few datagrams, but only interfaces
+ * whose queueing discipline honours it (fq, or etf for SO_TXTIME) pace; others send the datagrams at once. Datagrams
+ * handed to the kernel cannot be rescheduled when more are queued, so a frame is best queued in one call.
+ *
+ * The pacer does not read clocks: the caller passes the time to every call, which must be CLOCK_MONOTONIC for kernel
+ * pacing. Its functions may be called from different threads. Linux only, like nanostream_net.h. */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_pacer_config
+  {
+    /* The longest a datagram is held back, zero for 10 ms. */
+    uint64_t max_delay_us;
+
+    /* The number of datagrams that may leave back to back, zero for 4. */
+    int burst;
+
+    /* The number of datagrams that can be held, zero for 4096. Datagrams queued beyond it are dropped. */
+    int max_datagrams;
+
+    /* Nonzero to leave the pacing to the kernel if it supports it. */
+    int kernel;
+  } nanostream_pacer_config;
+
+  typedef enum nanostream_pacing
+  {
+    NANOSTREAM_PACING_USER = 0,
+    NANOSTREAM_PACING_TXTIME = 1,
+    NANOSTREAM_PACING_RATE = 2
+  } nanostream_pacing;
+
+  typedef struct nanostream_pacer_stats
+  {
+    uint64_t datagrams_sent;
+    uint64_t datagrams_dropped;
+
+    /* The longest time a datagram was held back or scheduled to leave after it was queued. */
+    uint64_t longest_delay_us;
+
+    /* The pacing rate set for the latest datagrams queued, in bytes per second. */
+    uint64_t rate_bytes_per_second;
+
+    /* How the datagrams are paced. */
+    nanostream_pacing pacing;
+  } nanostream_pacer_stats;
+
+  typedef struct nanostream_pacer nanostream_pacer;
+
+  /* Creates a pacer sending through 'sender', which it does not own. Returns null on failure. */
+  nanostream_pacer* nanostream_pacer_create(const nanostream_pacer_config* config, nanostream_net_sender* sender);
+
+  void nanostream_pacer_destroy(nanostream_pacer* pacer);
+
+  /* Queues copies of whole datagrams at now_us. Returns the number queued, which is less than 'count' if the pacer is
+   * full. */
+  int nanostream_pacer_submit(nanostream_pacer* pacer,
+                              uint64_t now_us,
+                              const unsigned char* const* datagrams,
+                              const size_t* sizes,
+                              int count);
+
+  /* Queues the datagrams that nanostream_net_send_tiles_with_parity would send with the same arguments, or
+   * nanostream_net_send_tiles if 'parity_per_group' is zero. Returns the number queued, tiles and parity. */
+  int nanostream_pacer_submit_tiles(nanostream_pacer* pacer,
+                                    uint64_t now_us,
+                                    const nanostream_net_header* header,
+                                    const int* tile_indices,
+                                    const unsigned char* packets,
+                                    int num_tiles,
+                                    int group_size,
+                                    int parity_per_group);
+
+  /* Sends the datagrams that are due at now_us. Returns the number sent. */
+  int nanostream_pacer_send(nanostream_pacer* pacer, uint64_t now_us);
+
+  /* The time at which the next datagram is due, or UINT64_MAX if none is held. */
+  uint64_t nanostream_pacer_next_send(nanostream_pacer* pacer);
+
+  void nanostream_pacer_get_stats(nanostream_pacer* pacer, nanostream_pacer_stats* stats);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
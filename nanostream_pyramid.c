@@ -0,0 +1,136 @@
+#include "nanostream_pyramid.h"
+
+#include "nanostream.h"
+#include "nanostream_endian.h"
+
+#include <string.h>
+
+static const unsigned char pyramid_magic[8] = { 'N', 'S', 'T', 'M', 'P', 'Y', 'R', '1' };
+
+static void
+set_level(nanostream_pyramid_level* level, const int width, const int height, const uint64_t first_tile)
+{
+  level->width = width;
+  level->height = height;
+  level->tiles_x = nanostream_frame_tiles_x(width);
+  level->tiles_y = nanostream_frame_tiles_y(height);
+  level->first_tile = first_tile;
+}
+
+void
+nanostream_pyramid_layout(const int width,
+                          const int height,
+                          const nanostream_padding padding,
+                          nanostream_pyramid_info* info)
+{
+  memset(info, 0, sizeof(*info));
+  info->padding = padding;
+
+  int w = width;
+  int h = height;
+  uint64_t first_tile = 0;
+
+  for (;;) {
+    nanostream_pyramid_level* level = &info->levels[info->num_levels++];
+    set_level(level, w, h, first_tile);
+    first_tile += (uint64_t)level->tiles_x * (uint64_t)level->tiles_y;
+
+    if (((level->tiles_x == 1) && (level->tiles_y == 1)) || (info->num_levels == NANOSTREAM_PYRAMID_MAX_LEVELS))
+      break;
+
+    w = (w + 1) / 2;
+    h = (h + 1) / 2;
+  }
+}
+
+size_t
+nanostream_pyramid_packets_offset(const nanostream_pyramid_info* info)
+{
+  return NANOSTREAM_PYRAMID_HEADER_SIZE + (size_t)info->num_levels * NANOSTREAM_PYRAMID_LEVEL_ENTRY_SIZE;
+}
+
+size_t
+nanostream_pyramid_file_size(const nanostream_pyramid_info* info)
+{
+  const nanostream_pyramid_level* last = &info->levels[info->num_levels - 1];
+  const uint64_t num_tiles = last->first_tile + (uint64_t)last->tiles_x * (uint64_t)last->tiles_y;
+  return nanostream_pyramid_packets_offset(info) + (size_t)num_tiles * NANOSTREAM_PACKET_SIZE;
+}
+
+void
+nanostream_pyramid_store_header(unsigned char* out, const nanostream_pyramid_info* info)
+{
+  memset(out, 0, NANOSTREAM_PYRAMID_HEADER_SIZE);
+  memcpy(out, pyramid_magic, sizeof(pyramid_magic));
+  nanostream_store_u32le(out + 8, NANOSTREAM_PYRAMID_VERSION);
+  nanostream_store_u32le(out + 12, (uint32_t)info->num_levels);
+  nanostream_store_u16le(out + 16, NANOSTREAM_TILE_WIDTH);
+  nanostream_store_u16le(out + 18, NANOSTREAM_TILE_HEIGHT);
+  nanostream_store_u32le(out + 20, (uint32_t)NANOSTREAM_PACKET_SIZE);
+  out[24] = (unsigned char)info->padding;
+
+  unsigned char* entry = out + NANOSTREAM_PYRAMID_HEADER_SIZE;
+  for (int i = 0; i < info->num_levels; i++) {
+    nanostream_store_u32le(entry, (uint32_t)info->levels[i].width);
+    nanostream_store_u32le(entry + 4, (uint32_t)info->levels[i].height);
+    nanostream_store_u64le(entry + 8, info->levels[i].first_tile);
+    entry += NANOSTREAM_PYRAMID_LEVEL_ENTRY_SIZE;
+  }
+}
+
+int
+nanostream_pyramid_parse_header(const unsigned char* data, const size_t size, nanostream_pyramid_info* info)
+{
+  if ((size < NANOSTREAM_PYRAMID_HEADER_SIZE) || (memcmp(data, pyramid_magic, sizeof(pyramid_magic)) != 0))
+    return -1;
+
+  const uint32_t num_levels = nanostream_load_u32le(data + 12);
+
+  if ((nanostream_load_u32le(data + 8) != NANOSTREAM_PYRAMID_VERSION) || (num_levels == 0) ||
+      (num_levels > NANOSTREAM_PYRAMID_MAX_LEVELS) || (nanostream_load_u16le(data + 16) != NANOSTREAM_TILE_WIDTH) ||
+      (nanostream_load_u16le(data + 18) != NANOSTREAM_TILE_HEIGHT) ||
+      (nanostream_load_u32le(data + 20) != NANOSTREAM_PACKET_SIZE) || (data[24] > NANOSTREAM_PADDING_BLACK))
+    return -1;
+
+  memset(info, 0, sizeof(*info));
+  info->num_levels = (int)num_levels;
+  info->padding = (nanostream_padding)data[24];
+
+  if (size < nanostream_pyramid_packets_offset(info))
+    return -1;
+
+  /* The levels must be laid out back to back, so that no packet is shared or out of bounds. */
+  uint64_t first_tile = 0;
+  const unsigned char* entry = data + NANOSTREAM_PYRAMID_HEADER_SIZE;
+  for (int i = 0; i < info->num_levels; i++) {
+    const uint32_t width = nanostream_load_u32le(entry);
+    const uint32_t height = nanostream_load_u32le(entry + 4);
+    if ((width == 0) || (height == 0) || (width > 0x7FFFFFFF) || (height > 0x7FFFFFFF) ||
+        (nanostream_load_u64le(entry + 8) != first_tile))
+      return -1;
+
+    set_level(&info->levels[i], (int)width, (int)height, first_tile);
+    first_tile += (uint64_t)info->levels[i].tiles_x * (uint64_t)info->levels[i].tiles_y;
+    entry += NANOSTREAM_PYRAMID_LEVEL_ENTRY_SIZE;
+  }
+
+  return (size < nanostream_pyramid_file_size(info)) ? -1 : 0;
+}
+
+const unsigned char*
+nanostream_pyramid_tile(const unsigned char* data,
+                        const nanostream_pyramid_info* info,
+                        const int level,
+                        const int tile_x,
+                        const int tile_y)
+{
+  if ((level < 0) || (level >= info->num_levels))
+    return NULL;
+
+  const nanostream_pyramid_level* l = &info->levels[level];
+  if ((tile_x < 0) || (tile_x >= l->tiles_x) || (tile_y < 0) || (tile_y >= l->tiles_y))
+    return NULL;
+
+  const uint64_t tile = l->first_tile + (uint64_t)tile_y * (uint64_t)l->tiles_x + (uint64_t)tile_x;
+  return data + nanostream_pyramid_packets_offset(info) + (size_t)tile * NANOSTREAM_PACKET_SIZE;
+}
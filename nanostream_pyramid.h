@@ -0,0 +1,64 @@
+#pragma once
+
+#include "nanostream_frame.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A pyramid file holds an image at successively halved resolutions, each level encoded as a grid of tiles. Level 0 is
+ * the full resolution and the last level fits in a single tile. The header is followed by a table of levels and then
+ * the packets of every level in row-major order, so the packet of any level/x/y is found with one lookup. */
+
+#define NANOSTREAM_PYRAMID_VERSION 1
+
+#define NANOSTREAM_PYRAMID_HEADER_SIZE 32
+
+#define NANOSTREAM_PYRAMID_LEVEL_ENTRY_SIZE 16
+
+#define NANOSTREAM_PYRAMID_MAX_LEVELS 32
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_pyramid_level
+  {
+    int width;
+    int height;
+    int tiles_x;
+    int tiles_y;
+    /* The index of the first packet of this level, counting from the first packet of level 0. */
+    uint64_t first_tile;
+  } nanostream_pyramid_level;
+
+  typedef struct nanostream_pyramid_info
+  {
+    int num_levels;
+    nanostream_padding padding;
+    nanostream_pyramid_level levels[NANOSTREAM_PYRAMID_MAX_LEVELS];
+  } nanostream_pyramid_info;
+
+  /* Lays out the levels of a pyramid for an image of the given size. */
+  void nanostream_pyramid_layout(int width, int height, nanostream_padding padding, nanostream_pyramid_info* info);
+
+  size_t nanostream_pyramid_file_size(const nanostream_pyramid_info* info);
+
+  /* Returns the offset of the first packet in the file. */
+  size_t nanostream_pyramid_packets_offset(const nanostream_pyramid_info* info);
+
+  void nanostream_pyramid_store_header(unsigned char* out, const nanostream_pyramid_info* info);
+
+  /* Reads the header and checks that the file holds every packet. Returns zero on success. */
+  int nanostream_pyramid_parse_header(const unsigned char* data, size_t size, nanostream_pyramid_info* info);
+
+  /* Returns the packet of a tile given a pointer to the start of the file, or null if there is no such tile. */
+  const unsigned char* nanostream_pyramid_tile(const unsigned char* data,
+                                               const nanostream_pyramid_info* info,
+                                               int level,
+                                               int tile_x,
+                                               int tile_y);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,1040 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "nanostream_recorder.h"
+
+#include "nanostream.h"
+#include "nanostream_recording.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define ALIGN_UP(x) (((x) + (NANOSTREAM_RECORDER_ALIGNMENT - 1)) & ~((size_t)NANOSTREAM_RECORDER_ALIGNMENT - 1))
+#define ALIGN_DOWN(x) ((x) & ~((size_t)NANOSTREAM_RECORDER_ALIGNMENT - 1))
+
+/* The user data of the eventfd read that wakes up the I/O thread. */
+#define WAKE_USER_DATA 0
+
+/* How long the writes in flight on a ring that failed get to complete before they are counted as failed. */
+#define FALLBACK_DRAIN_MS 1000
+
+struct segment
+{
+  /* Only accessed by the I/O thread. */
+  int fd;
+  /* Set if 'fd' was opened with O_DIRECT, and the buffered descriptor for the rest of a short write, or -1. */
+  int direct;
+  int buffered_fd;
+  int inflight;
+  int finished;
+  uint64_t final_size;
+  uint64_t sequence;
+  char* path;
+};
+
+struct job
+{
+  /* Links the queued jobs, and while the job is in flight on the ring, the jobs in flight along with 'prev'. */
+  struct job* next;
+  struct job* prev;
+  struct segment* segment;
+  unsigned char* data;
+  size_t size;
+  size_t done;
+  uint64_t offset;
+  /* Cleared when the write completes, or null if 'data' is freed instead. */
+  atomic_int* busy;
+  /* Set on the write of the index, which is the last write of a segment. */
+  uint64_t final_size;
+};
+
+struct staging
+{
+  unsigned char* data;
+  atomic_int busy;
+  struct job job;
+};
+
+struct frame_entry
+{
+  uint64_t offset;
+  uint64_t timestamp_us;
+  uint32_t flags;
+  int keyframe_index;
+};
+
+struct stream
+{
+  pthread_mutex_t lock;
+  char* name;
+  int tiles_x;
+  int tiles_y;
+  struct staging staging[2];
+  int active;
+  /* The bytes staged in the active buffer, which will be written at 'base' in the segment. */
+  size_t fill;
+  uint64_t base;
+  struct segment* segment;
+  uint64_t next_sequence;
+  struct frame_entry* frames;
+  int num_frames;
+  int frames_capacity;
+  int last_keyframe;
+};
+
+struct uring
+{
+  int fd;
+  unsigned entries;
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_array;
+  struct io_uring_sqe* sqes;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  struct io_uring_cqe* cqes;
+  void* sq_ring;
+  size_t sq_ring_size;
+  void* cq_ring;
+  size_t cq_ring_size;
+  size_t sqes_size;
+};
+
+struct nanostream_recorder
+{
+  char* directory;
+  size_t segment_size;
+  size_t staging_size;
+  int max_streams;
+
+  struct stream** streams;
+  atomic_int num_streams;
+  pthread_mutex_t streams_lock;
+
+  pthread_mutex_t queue_lock;
+  struct job* queue_head;
+  struct job* queue_tail;
+  int wake_fd;
+  atomic_int stopping;
+
+  struct uring ring;
+  int have_ring;
+  pthread_t thread;
+  int thread_started;
+
+  atomic_uint_least64_t frames_written;
+  atomic_uint_least64_t frames_dropped;
+  atomic_uint_least64_t bytes_written;
+  atomic_uint_least64_t segments_closed;
+  atomic_uint_least64_t writes;
+  atomic_uint_least64_t submits;
+  atomic_uint_least64_t write_errors;
+  atomic_uint_least64_t preallocation_errors;
+};
+
+/* IORING_OP_READ and IORING_OP_WRITE came in Linux 5.6, after io_uring itself, and on older kernels each of them
+ * completes with -EINVAL. The probe came in the same release, so a kernel that cannot answer it has neither. */
+static int
+uring_supports_ops(const int fd)
+{
+  static const int ops[] = { IORING_OP_NOP, IORING_OP_READ, IORING_OP_WRITE };
+
+  struct io_uring_probe* probe = calloc(1, sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op));
+  if (!probe)
+    return 0;
+
+  int supported = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+  for (size_t i = 0; supported && (i < sizeof(ops) / sizeof(ops[0])); i++)
+    supported = (ops[i] <= probe->last_op) && (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED);
+
+  free(probe);
+  return supported;
+}
+
+static int
+uring_setup(struct uring* ring, const unsigned entries)
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  const int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (fd < 0)
+    return -1;
+
+  if (!uring_supports_ops(fd)) {
+    close(fd);
+    return -1;
+  }
+
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = fd;
+  ring->entries = params.sq_entries;
+  ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+  ring->sq_ring =
+    mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  ring->cq_ring =
+    mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+  ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+  if ((ring->sq_ring == MAP_FAILED) || (ring->cq_ring == MAP_FAILED) || (ring->sqes == MAP_FAILED)) {
+    if (ring->sq_ring != MAP_FAILED)
+      munmap(ring->sq_ring, ring->sq_ring_size);
+    if (ring->cq_ring != MAP_FAILED)
+      munmap(ring->cq_ring, ring->cq_ring_size);
+    if (ring->sqes != MAP_FAILED)
+      munmap(ring->sqes, ring->sqes_size);
+    close(fd);
+    return -1;
+  }
+
+  unsigned char* sq = ring->sq_ring;
+  ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+  ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+  ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+
+  unsigned char* cq = ring->cq_ring;
+  ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+  ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+  ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+  return 0;
+}
+
+static void
+uring_teardown(struct uring* ring)
+{
+  munmap(ring->sqes, ring->sqes_size);
+  munmap(ring->cq_ring, ring->cq_ring_size);
+  munmap(ring->sq_ring, ring->sq_ring_size);
+  close(ring->fd);
+}
+
+/* Returns a cleared submission queue entry, or null if the queue is full. Only the I/O thread submits. */
+static struct io_uring_sqe*
+uring_get_sqe(struct uring* ring, unsigned* tail)
+{
+  const unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+  if (*tail - head >= ring->entries)
+    return NULL;
+
+  const unsigned index = *tail & *ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring->sq_array[index] = index;
+  (*tail)++;
+  return sqe;
+}
+
+static int
+uring_enter(struct uring* ring, const unsigned to_submit, const unsigned min_complete)
+{
+  const unsigned flags = (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0;
+  return (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void
+push_job(nanostream_recorder* recorder, struct job* job)
+{
+  job->next = NULL;
+
+  pthread_mutex_lock(&recorder->queue_lock);
+  const int was_empty = recorder->queue_head == NULL;
+  if (recorder->queue_tail)
+    recorder->queue_tail->next = job;
+  else
+    recorder->queue_head = job;
+  recorder->queue_tail = job;
+  pthread_mutex_unlock(&recorder->queue_lock);
+
+  /* The I/O thread drains the whole queue after every wake up, so only the first job needs to wake it. */
+  if (was_empty) {
+    const uint64_t one = 1;
+    ssize_t unused = write(recorder->wake_fd, &one, sizeof(one));
+    (void)unused;
+  }
+}
+
+static struct job*
+take_jobs(nanostream_recorder* recorder)
+{
+  pthread_mutex_lock(&recorder->queue_lock);
+  struct job* jobs = recorder->queue_head;
+  recorder->queue_head = NULL;
+  recorder->queue_tail = NULL;
+  pthread_mutex_unlock(&recorder->queue_lock);
+  return jobs;
+}
+
+static void
+open_segment(nanostream_recorder* recorder, struct segment* segment)
+{
+  int fd = open(segment->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+  segment->direct = fd >= 0;
+  if ((fd < 0) && (errno == EINVAL))
+    fd = open(segment->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+  /* Without the preallocation the segment is still written, only with more fragmentation and metadata updates, so
+   * file systems without fallocate are fine. Running out of space is not, and the writes will likely fail too. */
+  if (fd >= 0) {
+    int result;
+    do {
+      result = fallocate(fd, 0, 0, (off_t)recorder->segment_size);
+    } while ((result != 0) && (errno == EINTR));
+    if ((result != 0) && (errno != EOPNOTSUPP) && (errno != ENOSYS))
+      atomic_fetch_add(&recorder->preallocation_errors, 1);
+  }
+
+  segment->fd = fd;
+  segment->buffered_fd = -1;
+}
+
+static void
+close_segment_if_done(nanostream_recorder* recorder, struct segment* segment)
+{
+  if (!segment->finished || (segment->inflight > 0))
+    return;
+
+  if (segment->fd >= 0) {
+    /* Release the preallocated space past the trailer. */
+    if (ftruncate(segment->fd, (off_t)segment->final_size) != 0)
+      atomic_fetch_add(&recorder->write_errors, 1);
+    close(segment->fd);
+  }
+  if (segment->buffered_fd >= 0)
+    close(segment->buffered_fd);
+
+  atomic_fetch_add(&recorder->segments_closed, 1);
+  free(segment->path);
+  free(segment);
+}
+
+static void
+complete_job(nanostream_recorder* recorder, struct job* job, const int result)
+{
+  struct segment* segment = job->segment;
+
+  if (result < 0) {
+    atomic_fetch_add(&recorder->write_errors, 1);
+  } else {
+    atomic_fetch_add(&recorder->bytes_written, (uint64_t)result);
+  }
+
+  segment->inflight--;
+
+  if (job->final_size) {
+    segment->finished = 1;
+    segment->final_size = job->final_size;
+  }
+
+  if (job->busy) {
+    atomic_store_explicit(job->busy, 0, memory_order_release);
+  } else {
+    free(job->data);
+    free(job);
+  }
+
+  close_segment_if_done(recorder, segment);
+}
+
+/* Handles the result of a write, the number of bytes written or a negative errno. Returns a job that must be
+ * resubmitted after a short or interrupted write, or null. */
+static struct job*
+handle_result(nanostream_recorder* recorder, struct job* job, const int result)
+{
+  if ((result == -EINTR) || (result == -EAGAIN))
+    return job;
+
+  if ((result > 0) && (job->done + (size_t)result < job->size)) {
+    job->done += (size_t)result;
+    atomic_fetch_add(&recorder->bytes_written, (uint64_t)result);
+    return job;
+  }
+
+  /* No job is empty, so writing nothing is a failure too. */
+  complete_job(recorder, job, (result == 0) ? -EIO : result);
+  return NULL;
+}
+
+/* Returns the descriptor to write the rest of a job through. O_DIRECT needs the buffer, the offset and the size
+ * aligned, which they are unless a short write left them unaligned, so the rest then goes through a second, buffered
+ * descriptor. The ranges of the two never overlap. */
+static int
+job_fd(struct job* job)
+{
+  struct segment* segment = job->segment;
+  if (!segment->direct || ((job->done & (NANOSTREAM_RECORDER_ALIGNMENT - 1)) == 0))
+    return segment->fd;
+
+  if (segment->buffered_fd < 0)
+    segment->buffered_fd = open(segment->path, O_WRONLY | O_CLOEXEC);
+  return segment->buffered_fd;
+}
+
+static void
+prepare_job(nanostream_recorder* recorder, struct job* job)
+{
+  if (job->done == 0) {
+    job->segment->inflight++;
+    if (job->segment->fd == -2)
+      open_segment(recorder, job->segment);
+  }
+}
+
+/* Writes a job with pwrite until it completes or fails. */
+static void
+write_job(nanostream_recorder* recorder, struct job* job)
+{
+  prepare_job(recorder, job);
+  for (;;) {
+    atomic_fetch_add(&recorder->writes, 1);
+    const int fd = job_fd(job);
+    int result = -EBADF;
+    if (fd >= 0) {
+      const size_t done = job->done;
+      const ssize_t written = pwrite(fd, job->data + done, job->size - done, (off_t)(job->offset + done));
+      result = (written >= 0) ? (int)written : -errno;
+    }
+    if (!handle_result(recorder, job, result))
+      break;
+  }
+}
+
+static void
+run_pwrite(nanostream_recorder* recorder)
+{
+  for (;;) {
+    /* Check for stopping first, since the last jobs are queued before it is set. */
+    const int stopping = atomic_load(&recorder->stopping);
+    struct job* jobs = take_jobs(recorder);
+
+    if (!jobs) {
+      if (stopping)
+        break;
+      uint64_t value = 0;
+      ssize_t unused = read(recorder->wake_fd, &value, sizeof(value));
+      (void)unused;
+      continue;
+    }
+
+    while (jobs) {
+      struct job* job = jobs;
+      jobs = jobs->next;
+      write_job(recorder, job);
+    }
+  }
+}
+
+/* The state of the I/O thread with a ring. */
+struct uring_loop
+{
+  unsigned tail;
+  unsigned to_submit;
+  int wake_armed;
+  uint64_t wake_value;
+
+  /* Set when the wake up read failed, which would otherwise be armed again and fail again without end. */
+  int failed;
+
+  /* The jobs waiting for a free entry, in order. */
+  struct job* pending;
+  struct job* pending_tail;
+
+  /* The jobs whose writes are queued or submitted, linked through 'next' and 'prev'. */
+  struct job* inflight;
+  int num_inflight;
+};
+
+static void
+push_pending_front(struct uring_loop* loop, struct job* job)
+{
+  job->next = loop->pending;
+  loop->pending = job;
+  if (!loop->pending_tail)
+    loop->pending_tail = job;
+}
+
+static void
+link_inflight(struct uring_loop* loop, struct job* job)
+{
+  job->prev = NULL;
+  job->next = loop->inflight;
+  if (loop->inflight)
+    loop->inflight->prev = job;
+  loop->inflight = job;
+  loop->num_inflight++;
+}
+
+static void
+unlink_inflight(struct uring_loop* loop, struct job* job)
+{
+  if (job->prev)
+    job->prev->next = job->next;
+  else
+    loop->inflight = job->next;
+  if (job->next)
+    job->next->prev = job->prev;
+  loop->num_inflight--;
+}
+
+/* Handles the completions posted so far. */
+static void
+reap_completions(nanostream_recorder* recorder, struct uring_loop* loop)
+{
+  struct uring* ring = &recorder->ring;
+  unsigned head = *ring->cq_head;
+  const unsigned cq_tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+  while (head != cq_tail) {
+    const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+    head++;
+
+    if (cqe->user_data == WAKE_USER_DATA) {
+      loop->wake_armed = 0;
+      if ((cqe->res < 0) && (cqe->res != -EINTR) && (cqe->res != -EAGAIN))
+        loop->failed = 1;
+      continue;
+    }
+
+    struct job* job = (struct job*)(uintptr_t)cqe->user_data;
+    unlink_inflight(loop, job);
+
+    const int result = (job->segment->fd < 0) ? -EBADF : cqe->res;
+    struct job* again = handle_result(recorder, job, result);
+    if (again)
+      push_pending_front(loop, again);
+  }
+  __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/* Gives up on a ring that failed, and writes the remaining and all later jobs with pwrite. The writes that the kernel
+ * has not taken yet are written again, and those it has get a while to complete. Any that are still in flight after
+ * that are counted as failed, so that their staging buffers are released and their segments finished, and the ring is
+ * closed, which cancels the wake up read. */
+static void
+fall_back_to_pwrite(nanostream_recorder* recorder, struct uring_loop* loop)
+{
+  struct uring* ring = &recorder->ring;
+  atomic_fetch_add(&recorder->write_errors, 1);
+
+  const unsigned sq_head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+  for (unsigned i = loop->tail; i != sq_head; i--) {
+    const struct io_uring_sqe* sqe = &ring->sqes[ring->sq_array[(i - 1) & *ring->sq_mask]];
+    if (sqe->user_data == WAKE_USER_DATA) {
+      loop->wake_armed = 0;
+      continue;
+    }
+
+    /* Undo prepare_job, which write_job does again. */
+    struct job* job = (struct job*)(uintptr_t)sqe->user_data;
+    unlink_inflight(loop, job);
+    if (job->done == 0)
+      job->segment->inflight--;
+    push_pending_front(loop, job);
+  }
+  __atomic_store_n(ring->sq_tail, sq_head, __ATOMIC_RELEASE);
+
+  for (int waited_ms = 0; (loop->num_inflight > 0) && (waited_ms < FALLBACK_DRAIN_MS); waited_ms++) {
+    usleep(1000);
+    reap_completions(recorder, loop);
+  }
+  while (loop->inflight) {
+    struct job* job = loop->inflight;
+    unlink_inflight(loop, job);
+    complete_job(recorder, job, -1);
+  }
+
+  uring_teardown(ring);
+  recorder->have_ring = 0;
+
+  while (loop->pending) {
+    struct job* job = loop->pending;
+    loop->pending = job->next;
+    write_job(recorder, job);
+  }
+  run_pwrite(recorder);
+}
+
+static void
+run_uring(nanostream_recorder* recorder)
+{
+  struct uring* ring = &recorder->ring;
+  struct uring_loop loop;
+  memset(&loop, 0, sizeof(loop));
+  loop.tail = *ring->sq_tail;
+
+  for (;;) {
+    /* Check for stopping first, since the last jobs are queued before it is set. */
+    const int stopping = atomic_load(&recorder->stopping);
+    struct job* jobs = take_jobs(recorder);
+    if (jobs) {
+      if (loop.pending_tail)
+        loop.pending_tail->next = jobs;
+      else
+        loop.pending = jobs;
+      for (loop.pending_tail = jobs; loop.pending_tail->next; loop.pending_tail = loop.pending_tail->next) {
+      }
+    }
+
+    if (stopping && !loop.pending && (loop.num_inflight == 0))
+      break;
+
+    if (!loop.wake_armed && !stopping) {
+      struct io_uring_sqe* sqe = uring_get_sqe(ring, &loop.tail);
+      if (sqe) {
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = recorder->wake_fd;
+        sqe->addr = (uint64_t)(uintptr_t)&loop.wake_value;
+        sqe->len = sizeof(loop.wake_value);
+        sqe->user_data = WAKE_USER_DATA;
+        loop.wake_armed = 1;
+        loop.to_submit++;
+      }
+    }
+
+    /* Queue as many writes as there are free entries, then submit them all with one system call. */
+    while (loop.pending) {
+      struct io_uring_sqe* sqe = uring_get_sqe(ring, &loop.tail);
+      if (!sqe)
+        break;
+
+      struct job* job = loop.pending;
+      loop.pending = loop.pending->next;
+      if (!loop.pending)
+        loop.pending_tail = NULL;
+
+      prepare_job(recorder, job);
+      const int fd = job_fd(job);
+      if (fd < 0) {
+        /* The segment could not be opened. Give the entry back as a no-op so the ring stays consistent. */
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = (uint64_t)(uintptr_t)job;
+      } else {
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t)(uintptr_t)(job->data + job->done);
+        sqe->len = (unsigned)(job->size - job->done);
+        sqe->off = job->offset + job->done;
+        sqe->user_data = (uint64_t)(uintptr_t)job;
+      }
+      link_inflight(&loop, job);
+      loop.to_submit++;
+      atomic_fetch_add(&recorder->writes, 1);
+    }
+
+    __atomic_store_n(ring->sq_tail, loop.tail, __ATOMIC_RELEASE);
+
+    /* Block for a completion, since either everything is submitted or the ring is full. The armed eventfd read wakes
+     * us up for new jobs. */
+    const unsigned min_complete = ((loop.num_inflight > 0) || loop.wake_armed) ? 1 : 0;
+    if ((loop.to_submit > 0) || (min_complete > 0)) {
+      const int submitted = uring_enter(ring, loop.to_submit, min_complete);
+      if (submitted >= 0) {
+        loop.to_submit -= (unsigned)submitted;
+        if (submitted > 0)
+          atomic_fetch_add(&recorder->submits, 1);
+      } else if ((errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY)) {
+        reap_completions(recorder, &loop);
+        fall_back_to_pwrite(recorder, &loop);
+        return;
+      }
+    }
+
+    reap_completions(recorder, &loop);
+    if (loop.failed) {
+      fall_back_to_pwrite(recorder, &loop);
+      return;
+    }
+  }
+}
+
+static void*
+io_thread(void* arg)
+{
+  nanostream_recorder* recorder = arg;
+  if (recorder->have_ring)
+    run_uring(recorder);
+  else
+    run_pwrite(recorder);
+  return NULL;
+}
+
+nanostream_recorder*
+nanostream_recorder_create(const nanostream_recorder_config* config)
+{
+  nanostream_recorder* recorder = calloc(1, sizeof(nanostream_recorder));
+  if (!recorder)
+    return NULL;
+
+  recorder->directory = strdup(config->directory ? config->directory : ".");
+  recorder->segment_size = ALIGN_UP(config->segment_size ? config->segment_size : ((size_t)256 << 20));
+  recorder->staging_size = ALIGN_UP(config->staging_size ? config->staging_size : ((size_t)1 << 20));
+  if (recorder->staging_size < 2 * NANOSTREAM_RECORDER_ALIGNMENT)
+    recorder->staging_size = 2 * NANOSTREAM_RECORDER_ALIGNMENT;
+  recorder->max_streams = (config->max_streams > 0) ? config->max_streams : 1024;
+  recorder->streams = calloc((size_t)recorder->max_streams, sizeof(struct stream*));
+  recorder->wake_fd = eventfd(0, EFD_CLOEXEC);
+
+  pthread_mutex_init(&recorder->streams_lock, NULL);
+  pthread_mutex_init(&recorder->queue_lock, NULL);
+
+  if (!recorder->directory || !recorder->streams || (recorder->wake_fd < 0)) {
+    nanostream_recorder_destroy(recorder);
+    return NULL;
+  }
+
+  const unsigned queue_depth = (config->queue_depth > 0) ? (unsigned)config->queue_depth : 256;
+  recorder->have_ring = uring_setup(&recorder->ring, queue_depth) == 0;
+
+  if (pthread_create(&recorder->thread, NULL, io_thread, recorder) != 0) {
+    nanostream_recorder_destroy(recorder);
+    return NULL;
+  }
+
+  recorder->thread_started = 1;
+
+  return recorder;
+}
+
+static void
+free_stream(struct stream* stream)
+{
+  pthread_mutex_destroy(&stream->lock);
+  free(stream->staging[0].data);
+  free(stream->staging[1].data);
+  free(stream->frames);
+  free(stream->name);
+  free(stream);
+}
+
+int
+nanostream_recorder_add_stream(nanostream_recorder* recorder, const char* name, const int tiles_x, const int tiles_y)
+{
+  if ((tiles_x <= 0) || (tiles_y <= 0) || (tiles_x > 0xFFFF) || (tiles_y > 0xFFFF))
+    return -1;
+
+  struct stream* stream = calloc(1, sizeof(struct stream));
+  if (!stream)
+    return -1;
+
+  pthread_mutex_init(&stream->lock, NULL);
+  stream->name = strdup(name);
+  stream->tiles_x = tiles_x;
+  stream->tiles_y = tiles_y;
+  stream->last_keyframe = -1;
+  for (int i = 0; i < 2; i++) {
+    stream->staging[i].data = aligned_alloc(NANOSTREAM_RECORDER_ALIGNMENT, recorder->staging_size);
+    atomic_init(&stream->staging[i].busy, 0);
+  }
+
+  if (!stream->name || !stream->staging[0].data || !stream->staging[1].data) {
+    free_stream(stream);
+    return -1;
+  }
+
+  pthread_mutex_lock(&recorder->streams_lock);
+  const int id = atomic_load(&recorder->num_streams);
+  if (id < recorder->max_streams) {
+    recorder->streams[id] = stream;
+    atomic_store_explicit(&recorder->num_streams, id + 1, memory_order_release);
+  }
+  pthread_mutex_unlock(&recorder->streams_lock);
+
+  if (id >= recorder->max_streams) {
+    free_stream(stream);
+    return -1;
+  }
+
+  return id;
+}
+
+/* Makes sure the active staging buffer is owned by the producer. */
+static int
+acquire_active(struct stream* stream)
+{
+  if (!atomic_load_explicit(&stream->staging[stream->active].busy, memory_order_acquire))
+    return 0;
+
+  /* The active buffer was handed off whole at the end of a segment, so start over in the other one. */
+  const int other = 1 - stream->active;
+  if (atomic_load_explicit(&stream->staging[other].busy, memory_order_acquire))
+    return -1;
+
+  stream->active = other;
+  stream->fill = 0;
+  return 0;
+}
+
+static void
+submit_staging(nanostream_recorder* recorder, struct stream* stream, const size_t size)
+{
+  struct staging* staging = &stream->staging[stream->active];
+  atomic_store_explicit(&staging->busy, 1, memory_order_relaxed);
+
+  struct job* job = &staging->job;
+  job->segment = stream->segment;
+  job->data = staging->data;
+  job->size = size;
+  job->done = 0;
+  job->offset = stream->base;
+  job->busy = &staging->busy;
+  job->final_size = 0;
+  push_job(recorder, job);
+}
+
+static int
+start_segment(nanostream_recorder* recorder, struct stream* stream)
+{
+  if (acquire_active(stream) != 0)
+    return -1;
+
+  struct segment* segment = calloc(1, sizeof(struct segment));
+  if (!segment)
+    return -1;
+
+  const size_t path_size = strlen(recorder->directory) + strlen(stream->name) + 32;
+  segment->path = malloc(path_size);
+  if (!segment->path) {
+    free(segment);
+    return -1;
+  }
+
+  segment->sequence = stream->next_sequence++;
+  snprintf(segment->path,
+           path_size,
+           "%s/%s-%06llu.nsrec",
+           recorder->directory,
+           stream->name,
+           (unsigned long long)segment->sequence);
+  /* Opened by the I/O thread on its first write. */
+  segment->fd = -2;
+  segment->buffered_fd = -1;
+
+  stream->segment = segment;
+  stream->base = 0;
+  stream->num_frames = 0;
+  stream->last_keyframe = -1;
+  nanostream_recording_store_header(stream->staging[stream->active].data, stream->tiles_x, stream->tiles_y);
+  stream->fill = NANOSTREAM_RECORDING_HEADER_SIZE;
+  return 0;
+}
+
+static size_t
+index_size(const int num_frames)
+{
+  return ALIGN_UP((size_t)num_frames * NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE + NANOSTREAM_RECORDING_TRAILER_SIZE);
+}
+
+/* Writes out the staged data, padded to the alignment, followed by the index and the trailer. */
+static int
+finish_segment(nanostream_recorder* recorder, struct stream* stream)
+{
+  const size_t size = index_size(stream->num_frames);
+  struct job* job = malloc(sizeof(struct job));
+  unsigned char* data = aligned_alloc(NANOSTREAM_RECORDER_ALIGNMENT, size);
+  if (!job || !data) {
+    free(job);
+    free(data);
+    return -1;
+  }
+
+  const size_t padded = ALIGN_UP(stream->fill);
+  unsigned char* staged = stream->staging[stream->active].data;
+  memset(staged + stream->fill, 0, padded - stream->fill);
+
+  const uint64_t index_offset = stream->base + padded;
+
+  memset(data, 0, size);
+  for (int i = 0; i < stream->num_frames; i++) {
+    const struct frame_entry* e = &stream->frames[i];
+    unsigned char* entry = data + (size_t)i * NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE;
+    nanostream_recording_store_index_entry(entry, e->offset, e->timestamp_us, e->flags, e->keyframe_index);
+  }
+  nanostream_recording_store_trailer(
+    data + size - NANOSTREAM_RECORDING_TRAILER_SIZE, index_offset, (uint64_t)stream->num_frames);
+
+  if (padded > 0)
+    submit_staging(recorder, stream, padded);
+
+  job->segment = stream->segment;
+  job->data = data;
+  job->size = size;
+  job->done = 0;
+  job->offset = index_offset;
+  job->busy = NULL;
+  job->final_size = index_offset + size;
+  push_job(recorder, job);
+
+  stream->segment = NULL;
+  stream->fill = 0;
+  return 0;
+}
+
+/* Hands off the aligned part of a full staging buffer and carries the rest over to the other buffer. */
+static int
+rotate_staging(nanostream_recorder* recorder, struct stream* stream)
+{
+  const int other = 1 - stream->active;
+  if (atomic_load_explicit(&stream->staging[other].busy, memory_order_acquire))
+    return -1;
+
+  const size_t aligned = ALIGN_DOWN(stream->fill);
+  const size_t tail = stream->fill - aligned;
+  memcpy(stream->staging[other].data, stream->staging[stream->active].data + aligned, tail);
+
+  submit_staging(recorder, stream, aligned);
+
+  stream->base += aligned;
+  stream->fill = tail;
+  stream->active = other;
+  return 0;
+}
+
+static int
+stage_frame(nanostream_recorder* recorder,
+            struct stream* stream,
+            const uint64_t timestamp_us,
+            const int* tile_indices,
+            const unsigned char* packets,
+            const int num_tiles)
+{
+  const size_t head_size = nanostream_recording_frame_head_size(num_tiles);
+  const size_t block_size = head_size + (size_t)num_tiles * NANOSTREAM_PACKET_SIZE;
+
+  /* The block must fit into a staging buffer after a carried over tail, and a segment must fit its header. */
+  if ((num_tiles < 0) || (block_size > recorder->staging_size - NANOSTREAM_RECORDER_ALIGNMENT) ||
+      (NANOSTREAM_RECORDING_HEADER_SIZE + block_size + NANOSTREAM_RECORDER_ALIGNMENT + index_size(1) >
+       recorder->segment_size))
+    return -1;
+
+  if (stream->num_frames == stream->frames_capacity) {
+    const int capacity = stream->frames_capacity ? stream->frames_capacity * 2 : 1024;
+    struct frame_entry* frames = realloc(stream->frames, (size_t)capacity * sizeof(struct frame_entry));
+    if (!frames)
+      return -1;
+    stream->frames = frames;
+    stream->frames_capacity = capacity;
+  }
+
+  if (stream->segment) {
+    const uint64_t end = stream->base + ALIGN_UP(stream->fill + block_size) + index_size(stream->num_frames + 1);
+    if ((end > recorder->segment_size) && (finish_segment(recorder, stream) != 0))
+      return -1;
+  }
+
+  if (!stream->segment && (start_segment(recorder, stream) != 0))
+    return -1;
+
+  if ((stream->fill + block_size > recorder->staging_size) && (rotate_staging(recorder, stream) != 0))
+    return -1;
+
+  unsigned char* out = stream->staging[stream->active].data + stream->fill;
+  const int flags =
+    nanostream_recording_store_frame_head(out, stream->tiles_x, stream->tiles_y, timestamp_us, tile_indices, num_tiles);
+  if (flags < 0)
+    return -1;
+
+  memcpy(out + head_size, packets, block_size - head_size);
+
+  if (flags & NANOSTREAM_RECORDING_FLAG_KEYFRAME)
+    stream->last_keyframe = stream->num_frames;
+
+  struct frame_entry* e = &stream->frames[stream->num_frames++];
+  e->offset = stream->base + stream->fill;
+  e->timestamp_us = timestamp_us;
+  e->flags = (uint32_t)flags;
+  e->keyframe_index = stream->last_keyframe;
+
+  stream->fill += block_size;
+  return 0;
+}
+
+int
+nanostream_recorder_write_frame(nanostream_recorder* recorder,
+                                const int stream_id,
+                                const uint64_t timestamp_us,
+                                const int* tile_indices,
+                                const unsigned char* packets,
+                                const int num_tiles)
+{
+  if ((stream_id < 0) || (stream_id >= atomic_load_explicit(&recorder->num_streams, memory_order_acquire)))
+    return -1;
+
+  struct stream* stream = recorder->streams[stream_id];
+
+  pthread_mutex_lock(&stream->lock);
+  const int result = stage_frame(recorder, stream, timestamp_us, tile_indices, packets, num_tiles);
+  pthread_mutex_unlock(&stream->lock);
+
+  atomic_fetch_add((result == 0) ? &recorder->frames_written : &recorder->frames_dropped, 1);
+  return result;
+}
+
+void
+nanostream_recorder_get_stats(const nanostream_recorder* recorder, nanostream_recorder_stats* stats)
+{
+  nanostream_recorder* r = (nanostream_recorder*)recorder;
+  stats->frames_written = atomic_load(&r->frames_written);
+  stats->frames_dropped = atomic_load(&r->frames_dropped);
+  stats->bytes_written = atomic_load(&r->bytes_written);
+  stats->segments_closed = atomic_load(&r->segments_closed);
+  stats->writes = atomic_load(&r->writes);
+  stats->submits = atomic_load(&r->submits);
+  stats->write_errors = atomic_load(&r->write_errors);
+  stats->preallocation_errors = atomic_load(&r->preallocation_errors);
+}
+
+void
+nanostream_recorder_destroy(nanostream_recorder* recorder)
+{
+  if (!recorder)
+    return;
+
+  const int num_streams = atomic_load(&recorder->num_streams);
+
+  if (recorder->thread_started) {
+    for (int i = 0; i < num_streams; i++) {
+      struct stream* stream = recorder->streams[i];
+      pthread_mutex_lock(&stream->lock);
+      if (stream->segment)
+        finish_segment(recorder, stream);
+      pthread_mutex_unlock(&stream->lock);
+    }
+
+    atomic_store(&recorder->stopping, 1);
+    const uint64_t one = 1;
+    ssize_t unused = write(recorder->wake_fd, &one, sizeof(one));
+    (void)unused;
+    pthread_join(recorder->thread, NULL);
+  }
+
+  if (recorder->have_ring)
+    uring_teardown(&recorder->ring);
+
+  for (int i = 0; i < num_streams; i++)
+    free_stream(recorder->streams[i]);
+
+  if (recorder->wake_fd >= 0)
+    close(recorder->wake_fd);
+
+  pthread_mutex_destroy(&recorder->queue_lock);
+  pthread_mutex_destroy(&recorder->streams_lock);
+  free(recorder->streams);
+  free(recorder->directory);
+  free(recorder);
+}
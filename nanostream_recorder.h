@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A recorder writes frames from many streams into preallocated segment files in the recording format (see
+ * nanostream_recording.h). Each stream fills one of two aligned staging buffers while the other is being written, and
+ * a single I/O thread submits the full buffers in batches through io_uring with O_DIRECT, so the page cache is
+ * bypassed. Writing a frame never waits for the disk: if both staging buffers of a stream are busy, the frame is
+ * dropped and counted instead.
+ *
+ * Linux only. Falls back to pwrite when io_uring is not available or older than Linux 5.6, which added its read and
+ * write operations, and to buffered I/O when the file system does not support O_DIRECT. */
+
+/* The alignment of staging buffers, file offsets and write sizes. */
+#define NANOSTREAM_RECORDER_ALIGNMENT 4096
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_recorder nanostream_recorder;
+
+  typedef struct nanostream_recorder_config
+  {
+    /* The directory to create segment files in. */
+    const char* directory;
+
+    /* The size each segment file is preallocated to. Zero selects 256 MB. */
+    size_t segment_size;
+
+    /* The size of each of the two staging buffers of a stream, rounded up to the alignment. This bounds how long
+     * written frames may sit in memory. Zero selects 1 MB. */
+    size_t staging_size;
+
+    /* The number of io_uring submission queue entries. Zero selects 256. */
+    int queue_depth;
+
+    /* The maximum number of streams. Zero selects 1024. */
+    int max_streams;
+  } nanostream_recorder_config;
+
+  typedef struct nanostream_recorder_stats
+  {
+    uint64_t frames_written;
+
+    /* Frames that were not recorded because both staging buffers were busy, or the frame was too big. */
+    uint64_t frames_dropped;
+
+    uint64_t bytes_written;
+
+    uint64_t segments_closed;
+
+    /* The number of write operations, and the number of io_uring_enter calls that submitted them. */
+    uint64_t writes;
+    uint64_t submits;
+
+    uint64_t write_errors;
+
+    /* Segments that could not be preallocated to the segment size, usually for lack of space (ENOSPC). File systems
+     * that do not support preallocation are not counted. */
+    uint64_t preallocation_errors;
+  } nanostream_recorder_stats;
+
+  nanostream_recorder* nanostream_recorder_create(const nanostream_recorder_config* config);
+
+  /* Adds a stream. Its segments are named "<name>-<sequence>.nsrec". Returns the stream id, or -1 on failure. */
+  int nanostream_recorder_add_stream(nanostream_recorder* recorder, const char* name, int tiles_x, int tiles_y);
+
+  /* Records a frame; see nanostream_recording_writer_add_frame for the meaning of the arguments. Safe to call from a
+   * different thread for each stream. Returns zero if the frame was staged, or -1 if it was dropped. */
+  int nanostream_recorder_write_frame(nanostream_recorder* recorder,
+                                      int stream,
+                                      uint64_t timestamp_us,
+                                      const int* tile_indices,
+                                      const unsigned char* packets,
+                                      int num_tiles);
+
+  void nanostream_recorder_get_stats(const nanostream_recorder* recorder, nanostream_recorder_stats* stats);
+
+  /* Flushes the staged frames, finishes the open segments and stops the I/O thread. */
+  void nanostream_recorder_destroy(nanostream_recorder* recorder);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
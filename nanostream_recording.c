@@ -0,0 +1,556 @@
+#include "nanostream_recording.h"
+
+#include "nanostream.h"
+#include "nanostream_endian.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NANOSTREAM_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const unsigned char file_magic[8] = { 'N', 'S', 'T', 'M', 'R', 'E', 'C', '1' };
+
+static const unsigned char trailer_magic[8] = { 'N', 'S', 'T', 'M', 'I', 'D', 'X', '1' };
+
+#define FRAME_MAGIC 0x52464E53u /* "NSFR" */
+
+/* The bytes of the bitmap of tiles on the stack, enough for grids of up to 8192 tiles. Larger grids allocate it. */
+#define GRID_BITMAP_SIZE 1024
+
+struct index_entry
+{
+  uint64_t block_offset;
+  uint64_t timestamp_us;
+  uint32_t flags;
+  int32_t keyframe_index;
+};
+
+struct nanostream_recording_writer
+{
+  FILE* file;
+  int tiles_x;
+  int tiles_y;
+  uint64_t offset;
+  struct index_entry* index;
+  int num_frames;
+  int capacity;
+  int last_keyframe;
+};
+
+struct nanostream_recording
+{
+  const unsigned char* data;
+  size_t size;
+  int mapped;
+  int tiles_x;
+  int tiles_y;
+  /* Points into the mapping when the trailer is intact, otherwise to 'rebuilt_index'. */
+  const unsigned char* index;
+  unsigned char* rebuilt_index;
+  int num_frames;
+};
+
+void
+nanostream_recording_store_header(unsigned char* out, const int tiles_x, const int tiles_y)
+{
+  memset(out, 0, NANOSTREAM_RECORDING_HEADER_SIZE);
+  memcpy(out, file_magic, sizeof(file_magic));
+  nanostream_store_u32le(out + 8, NANOSTREAM_RECORDING_VERSION);
+  nanostream_store_u32le(out + 12, (uint32_t)NANOSTREAM_PACKET_SIZE);
+  nanostream_store_u16le(out + 16, NANOSTREAM_TILE_WIDTH);
+  nanostream_store_u16le(out + 18, NANOSTREAM_TILE_HEIGHT);
+  nanostream_store_u16le(out + 20, (uint16_t)tiles_x);
+  nanostream_store_u16le(out + 22, (uint16_t)tiles_y);
+}
+
+size_t
+nanostream_recording_frame_head_size(const int num_tiles)
+{
+  return NANOSTREAM_RECORDING_FRAME_HEADER_SIZE + (size_t)num_tiles * NANOSTREAM_RECORDING_TILE_ENTRY_SIZE;
+}
+
+/* Whether the tiles of a frame are each tile of the grid exactly once, so that the frame shows a whole image. The
+ * indices are known to be in the grid. */
+static int
+covers_grid(const int* tile_indices, const int num_tiles, const int num_grid_tiles)
+{
+  if (num_tiles != num_grid_tiles)
+    return 0;
+  if (!tile_indices)
+    return 1;
+
+  unsigned char small[GRID_BITMAP_SIZE];
+  const size_t size = ((size_t)num_grid_tiles + 7) / 8;
+  unsigned char* seen = (size <= sizeof(small)) ? small : malloc(size);
+  if (!seen)
+    return 0;
+  memset(seen, 0, size);
+
+  int covers = 1;
+  for (int i = 0; (i < num_tiles) && covers; i++) {
+    const int tile = tile_indices[i];
+    covers = (seen[tile / 8] & (1u << (tile % 8))) == 0;
+    seen[tile / 8] |= (unsigned char)(1u << (tile % 8));
+  }
+
+  if (seen != small)
+    free(seen);
+  return covers;
+}
+
+int
+nanostream_recording_store_frame_head(unsigned char* out,
+                                      const int tiles_x,
+                                      const int tiles_y,
+                                      const uint64_t timestamp_us,
+                                      const int* tile_indices,
+                                      const int num_tiles)
+{
+  const int num_grid_tiles = tiles_x * tiles_y;
+  if ((num_tiles < 0) || (num_tiles > num_grid_tiles))
+    return -1;
+
+  const size_t head_size = nanostream_recording_frame_head_size(num_tiles);
+
+  unsigned char* entry = out + NANOSTREAM_RECORDING_FRAME_HEADER_SIZE;
+  for (int i = 0; i < num_tiles; i++) {
+    const int tile = tile_indices ? tile_indices[i] : i;
+    if ((tile < 0) || (tile >= num_grid_tiles))
+      return -1;
+    const uint32_t packet_offset = (uint32_t)(head_size + (size_t)i * NANOSTREAM_PACKET_SIZE);
+    nanostream_store_u16le(entry, (uint16_t)(tile % tiles_x));
+    nanostream_store_u16le(entry + 2, (uint16_t)(tile / tiles_x));
+    nanostream_store_u32le(entry + 4, packet_offset);
+    entry += NANOSTREAM_RECORDING_TILE_ENTRY_SIZE;
+  }
+
+  const uint32_t flags = covers_grid(tile_indices, num_tiles, num_grid_tiles) ? NANOSTREAM_RECORDING_FLAG_KEYFRAME : 0;
+
+  nanostream_store_u32le(out, FRAME_MAGIC);
+  nanostream_store_u32le(out + 4, (uint32_t)num_tiles);
+  nanostream_store_u64le(out + 8, timestamp_us);
+  nanostream_store_u32le(out + 16, flags);
+  nanostream_store_u32le(out + 20, 0);
+  return (int)flags;
+}
+
+void
+nanostream_recording_store_index_entry(unsigned char* out,
+                                       const uint64_t block_offset,
+                                       const uint64_t timestamp_us,
+                                       const uint32_t flags,
+                                       const int keyframe_index)
+{
+  nanostream_store_u64le(out, block_offset);
+  nanostream_store_u64le(out + 8, timestamp_us);
+  nanostream_store_u32le(out + 16, flags);
+  nanostream_store_u32le(out + 20, (uint32_t)keyframe_index);
+}
+
+void
+nanostream_recording_store_trailer(unsigned char* out, const uint64_t index_offset, const uint64_t num_frames)
+{
+  nanostream_store_u64le(out, index_offset);
+  nanostream_store_u64le(out + 8, num_frames);
+  memcpy(out + 16, trailer_magic, sizeof(trailer_magic));
+}
+
+nanostream_recording_writer*
+nanostream_recording_writer_open(const char* filename, const int tiles_x, const int tiles_y)
+{
+  if ((tiles_x <= 0) || (tiles_y <= 0) || (tiles_x > 0xFFFF) || (tiles_y > 0xFFFF))
+    return NULL;
+
+  FILE* file = fopen(filename, "wb");
+  if (!file)
+    return NULL;
+
+  unsigned char header[NANOSTREAM_RECORDING_HEADER_SIZE];
+  nanostream_recording_store_header(header, tiles_x, tiles_y);
+  if (fwrite(header, sizeof(header), 1, file) != 1) {
+    fclose(file);
+    return NULL;
+  }
+
+  nanostream_recording_writer* writer = calloc(1, sizeof(nanostream_recording_writer));
+  if (!writer) {
+    fclose(file);
+    return NULL;
+  }
+
+  writer->file = file;
+  writer->tiles_x = tiles_x;
+  writer->tiles_y = tiles_y;
+  writer->offset = sizeof(header);
+  writer->last_keyframe = -1;
+  return writer;
+}
+
+int
+nanostream_recording_writer_add_frame(nanostream_recording_writer* writer,
+                                      const uint64_t timestamp_us,
+                                      const int* tile_indices,
+                                      const unsigned char* packets,
+                                      const int num_tiles)
+{
+  if ((num_tiles < 0) || (num_tiles > writer->tiles_x * writer->tiles_y))
+    return -1;
+
+  if (writer->num_frames == writer->capacity) {
+    const int capacity = writer->capacity ? writer->capacity * 2 : 256;
+    struct index_entry* index = realloc(writer->index, (size_t)capacity * sizeof(struct index_entry));
+    if (!index)
+      return -1;
+    writer->index = index;
+    writer->capacity = capacity;
+  }
+
+  const size_t head_size = nanostream_recording_frame_head_size(num_tiles);
+  unsigned char* head = malloc(head_size);
+  if (!head)
+    return -1;
+
+  const int flags = nanostream_recording_store_frame_head(
+    head, writer->tiles_x, writer->tiles_y, timestamp_us, tile_indices, num_tiles);
+
+  const size_t packets_size = (size_t)num_tiles * NANOSTREAM_PACKET_SIZE;
+  const int ok = (flags >= 0) && (fwrite(head, head_size, 1, writer->file) == 1) &&
+                 ((packets_size == 0) || (fwrite(packets, packets_size, 1, writer->file) == 1));
+  free(head);
+  if (!ok)
+    return -1;
+
+  if (flags & NANOSTREAM_RECORDING_FLAG_KEYFRAME)
+    writer->last_keyframe = writer->num_frames;
+
+  struct index_entry* e = &writer->index[writer->num_frames];
+  e->block_offset = writer->offset;
+  e->timestamp_us = timestamp_us;
+  e->flags = (uint32_t)flags;
+  e->keyframe_index = writer->last_keyframe;
+
+  writer->offset += head_size + packets_size;
+  writer->num_frames++;
+  return 0;
+}
+
+int
+nanostream_recording_writer_close(nanostream_recording_writer* writer)
+{
+  int ok = 1;
+
+  unsigned char buffer[NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE];
+  for (int i = 0; (i < writer->num_frames) && ok; i++) {
+    const struct index_entry* e = &writer->index[i];
+    nanostream_recording_store_index_entry(buffer, e->block_offset, e->timestamp_us, e->flags, e->keyframe_index);
+    ok = fwrite(buffer, sizeof(buffer), 1, writer->file) == 1;
+  }
+
+  unsigned char trailer[NANOSTREAM_RECORDING_TRAILER_SIZE];
+  nanostream_recording_store_trailer(trailer, writer->offset, (uint64_t)writer->num_frames);
+  if (ok)
+    ok = fwrite(trailer, sizeof(trailer), 1, writer->file) == 1;
+
+  if (fclose(writer->file) != 0)
+    ok = 0;
+
+  free(writer->index);
+  free(writer);
+  return ok ? 0 : -1;
+}
+
+static int
+map_file(const char* filename, nanostream_recording* recording)
+{
+#ifdef NANOSTREAM_HAVE_MMAP
+  const int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return -1;
+
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+    close(fd);
+    return -1;
+  }
+
+  void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return -1;
+
+  recording->data = data;
+  recording->size = (size_t)st.st_size;
+  recording->mapped = 1;
+  return 0;
+#else
+  FILE* file = fopen(filename, "rb");
+  if (!file)
+    return -1;
+
+  fseek(file, 0, SEEK_END);
+  const long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  unsigned char* data = (size > 0) ? malloc((size_t)size) : NULL;
+  if (!data || (fread(data, (size_t)size, 1, file) != 1)) {
+    free(data);
+    fclose(file);
+    return -1;
+  }
+
+  fclose(file);
+  recording->data = data;
+  recording->size = (size_t)size;
+  recording->mapped = 0;
+  return 0;
+#endif
+}
+
+/* Checks that a frame block lies within the file and that its tile table points at packets inside it. Returns the
+ * size of the block, or zero if it is invalid. */
+static size_t
+check_frame_block(const nanostream_recording* recording, const uint64_t offset)
+{
+  if ((offset > recording->size) || (recording->size - offset < NANOSTREAM_RECORDING_FRAME_HEADER_SIZE))
+    return 0;
+
+  const unsigned char* block = recording->data + offset;
+  if (nanostream_load_u32le(block) != FRAME_MAGIC)
+    return 0;
+
+  const size_t available = recording->size - (size_t)offset;
+  const uint32_t num_tiles = nanostream_load_u32le(block + 4);
+  if (num_tiles > (uint32_t)(recording->tiles_x * recording->tiles_y))
+    return 0;
+
+  const size_t head_size = NANOSTREAM_RECORDING_FRAME_HEADER_SIZE + num_tiles * NANOSTREAM_RECORDING_TILE_ENTRY_SIZE;
+  if (head_size > available)
+    return 0;
+
+  size_t end = head_size;
+  for (uint32_t i = 0; i < num_tiles; i++) {
+    const unsigned char* entry =
+      block + NANOSTREAM_RECORDING_FRAME_HEADER_SIZE + i * NANOSTREAM_RECORDING_TILE_ENTRY_SIZE;
+    const size_t packet_offset = nanostream_load_u32le(entry + 4);
+    if ((nanostream_load_u16le(entry) >= recording->tiles_x) ||
+        (nanostream_load_u16le(entry + 2) >= recording->tiles_y))
+      return 0;
+    if ((packet_offset < head_size) || (packet_offset + NANOSTREAM_PACKET_SIZE > available))
+      return 0;
+    if (packet_offset + NANOSTREAM_PACKET_SIZE > end)
+      end = packet_offset + NANOSTREAM_PACKET_SIZE;
+  }
+
+  return end;
+}
+
+static int
+load_index(nanostream_recording* recording)
+{
+  if (recording->size < NANOSTREAM_RECORDING_HEADER_SIZE + NANOSTREAM_RECORDING_TRAILER_SIZE)
+    return -1;
+
+  const unsigned char* trailer = recording->data + recording->size - NANOSTREAM_RECORDING_TRAILER_SIZE;
+  if (memcmp(trailer + 16, trailer_magic, sizeof(trailer_magic)) != 0)
+    return -1;
+
+  const uint64_t index_offset = nanostream_load_u64le(trailer);
+  const uint64_t num_frames = nanostream_load_u64le(trailer + 8);
+  const uint64_t index_end = recording->size - NANOSTREAM_RECORDING_TRAILER_SIZE;
+  if ((index_offset > index_end) || (num_frames > (index_end - index_offset) / NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE))
+    return -1;
+
+  recording->index = recording->data + index_offset;
+  recording->num_frames = (int)num_frames;
+  return 0;
+}
+
+/* Rebuilds the index of a recording that has no trailer, for example because the recorder was killed. */
+static int
+rebuild_index(nanostream_recording* recording)
+{
+  int capacity = 256;
+  unsigned char* index = malloc((size_t)capacity * NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE);
+  if (!index)
+    return -1;
+
+  int num_frames = 0;
+  int last_keyframe = -1;
+  uint64_t offset = NANOSTREAM_RECORDING_HEADER_SIZE;
+
+  for (;;) {
+    const size_t block_size = check_frame_block(recording, offset);
+    if (block_size == 0)
+      break;
+
+    if (num_frames == capacity) {
+      capacity *= 2;
+      unsigned char* grown = realloc(index, (size_t)capacity * NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE);
+      if (!grown) {
+        free(index);
+        return -1;
+      }
+      index = grown;
+    }
+
+    const unsigned char* block = recording->data + offset;
+    const uint32_t flags = nanostream_load_u32le(block + 16);
+    if (flags & NANOSTREAM_RECORDING_FLAG_KEYFRAME)
+      last_keyframe = num_frames;
+    nanostream_recording_store_index_entry(index + (size_t)num_frames * NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE,
+                                           offset,
+                                           nanostream_load_u64le(block + 8),
+                                           flags,
+                                           last_keyframe);
+
+    num_frames++;
+    offset += block_size;
+  }
+
+  recording->rebuilt_index = index;
+  recording->index = index;
+  recording->num_frames = num_frames;
+  return 0;
+}
+
+nanostream_recording*
+nanostream_recording_open(const char* filename)
+{
+  nanostream_recording* recording = calloc(1, sizeof(nanostream_recording));
+  if (!recording)
+    return NULL;
+
+  if (map_file(filename, recording) != 0) {
+    free(recording);
+    return NULL;
+  }
+
+  const unsigned char* header = recording->data;
+  if ((recording->size < NANOSTREAM_RECORDING_HEADER_SIZE) || (memcmp(header, file_magic, sizeof(file_magic)) != 0) ||
+      (nanostream_load_u32le(header + 8) != NANOSTREAM_RECORDING_VERSION) ||
+      (nanostream_load_u32le(header + 12) != NANOSTREAM_PACKET_SIZE) ||
+      (nanostream_load_u16le(header + 16) != NANOSTREAM_TILE_WIDTH) ||
+      (nanostream_load_u16le(header + 18) != NANOSTREAM_TILE_HEIGHT)) {
+    nanostream_recording_close(recording);
+    return NULL;
+  }
+
+  recording->tiles_x = nanostream_load_u16le(header + 20);
+  recording->tiles_y = nanostream_load_u16le(header + 22);
+
+  if ((load_index(recording) != 0) && (rebuild_index(recording) != 0)) {
+    nanostream_recording_close(recording);
+    return NULL;
+  }
+
+  return recording;
+}
+
+void
+nanostream_recording_close(nanostream_recording* recording)
+{
+  if (!recording)
+    return;
+
+#ifdef NANOSTREAM_HAVE_MMAP
+  if (recording->mapped)
+    munmap((void*)recording->data, recording->size);
+#else
+  free((void*)recording->data);
+#endif
+
+  free(recording->rebuilt_index);
+  free(recording);
+}
+
+int
+nanostream_recording_num_frames(const nanostream_recording* recording)
+{
+  return recording->num_frames;
+}
+
+int
+nanostream_recording_tiles_x(const nanostream_recording* recording)
+{
+  return recording->tiles_x;
+}
+
+int
+nanostream_recording_tiles_y(const nanostream_recording* recording)
+{
+  return recording->tiles_y;
+}
+
+int
+nanostream_recording_get_frame(const nanostream_recording* recording,
+                               const int frame_index,
+                               nanostream_recording_frame* frame)
+{
+  if ((frame_index < 0) || (frame_index >= recording->num_frames))
+    return -1;
+
+  const unsigned char* e = recording->index + (size_t)frame_index * NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE;
+  const uint64_t block_offset = nanostream_load_u64le(e);
+  if (check_frame_block(recording, block_offset) == 0)
+    return -1;
+
+  const unsigned char* block = recording->data + block_offset;
+  frame->timestamp_us = nanostream_load_u64le(e + 8);
+  frame->keyframe = (nanostream_load_u32le(e + 16) & NANOSTREAM_RECORDING_FLAG_KEYFRAME) != 0;
+  frame->keyframe_index = (int)(int32_t)nanostream_load_u32le(e + 20);
+  frame->num_tiles = (int)nanostream_load_u32le(block + 4);
+  frame->block = block;
+  return 0;
+}
+
+int
+nanostream_recording_find_frame(const nanostream_recording* recording, const uint64_t timestamp_us)
+{
+  int lo = 0;
+  int hi = recording->num_frames;
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    const unsigned char* e = recording->index + (size_t)mid * NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE;
+    if (nanostream_load_u64le(e + 8) <= timestamp_us)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo - 1;
+}
+
+const unsigned char*
+nanostream_recording_tile(const nanostream_recording_frame* frame, const int tile, int* tile_x, int* tile_y)
+{
+  if ((tile < 0) || (tile >= frame->num_tiles))
+    return NULL;
+
+  const unsigned char* entry =
+    frame->block + NANOSTREAM_RECORDING_FRAME_HEADER_SIZE + (size_t)tile * NANOSTREAM_RECORDING_TILE_ENTRY_SIZE;
+
+  if (tile_x)
+    *tile_x = nanostream_load_u16le(entry);
+  if (tile_y)
+    *tile_y = nanostream_load_u16le(entry + 2);
+
+  return frame->block + nanostream_load_u32le(entry + 4);
+}
+
+void
+nanostream_recording_decode_frame(const nanostream_recording_frame* frame, const int pitch, unsigned char* rgb)
+{
+  for (int i = 0; i < frame->num_tiles; i++) {
+    int tile_x = 0;
+    int tile_y = 0;
+    const unsigned char* packet = nanostream_recording_tile(frame, i, &tile_x, &tile_y);
+    unsigned char* out = rgb + (tile_y * NANOSTREAM_TILE_HEIGHT) * pitch + (tile_x * NANOSTREAM_TILE_WIDTH * 3);
+    nanostream_decode_tile(packet, pitch, out);
+  }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A recording is a sequence of frames, each holding some or all of the tile packets of a tiles_x by tiles_y grid.
+ * Frames are stored as self-describing blocks (so a truncated file can still be scanned), followed by a frame index
+ * and a trailer. A frame that carries every tile of the grid is a keyframe; every index entry records the latest
+ * keyframe at or before it, so seeking to any frame is a constant time lookup. */
+
+#define NANOSTREAM_RECORDING_VERSION 1
+
+/* Size of the file header at the start of every recording. */
+#define NANOSTREAM_RECORDING_HEADER_SIZE 32
+
+/* Size of the fixed part of a frame block, before its tile table. */
+#define NANOSTREAM_RECORDING_FRAME_HEADER_SIZE 24
+
+/* Size of one tile table entry in a frame block. */
+#define NANOSTREAM_RECORDING_TILE_ENTRY_SIZE 8
+
+/* Size of one frame index entry. */
+#define NANOSTREAM_RECORDING_INDEX_ENTRY_SIZE 24
+
+/* Size of the trailer at the end of a finished recording. */
+#define NANOSTREAM_RECORDING_TRAILER_SIZE 24
+
+/* Set on frames that carry every tile of the grid exactly once, which seeking can start from. */
+#define NANOSTREAM_RECORDING_FLAG_KEYFRAME 0x1u
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_recording_writer nanostream_recording_writer;
+
+  typedef struct nanostream_recording nanostream_recording;
+
+  typedef struct nanostream_recording_frame
+  {
+    uint64_t timestamp_us;
+
+    /* Nonzero if this frame carries every tile of the grid. */
+    int keyframe;
+
+    /* The index of the latest keyframe at or before this frame, or -1 if there is none. */
+    int keyframe_index;
+
+    int num_tiles;
+
+    const unsigned char* block;
+  } nanostream_recording_frame;
+
+  nanostream_recording_writer* nanostream_recording_writer_open(const char* filename, int tiles_x, int tiles_y);
+
+  /* Appends a frame. The packets are stored back to back in 'packets'. If 'tile_indices' is null, the packets are
+   * the tiles 0 to num_tiles - 1 in row-major order. The tiles of a frame must be distinct, and a frame with as many
+   * tiles as the grid is marked as a keyframe. Returns zero on success. */
+  int nanostream_recording_writer_add_frame(nanostream_recording_writer* writer,
+                                            uint64_t timestamp_us,
+                                            const int* tile_indices,
+                                            const unsigned char* packets,
+                                            int num_tiles);
+
+  /* Writes the frame index and closes the file. Returns zero on success. */
+  int nanostream_recording_writer_close(nanostream_recording_writer* writer);
+
+  /* Low level serialization, for writers that do their own I/O. A frame block is its head followed by its packets
+   * back to back. The index entries start at 'index_offset' and the trailer must end the file. */
+
+  void nanostream_recording_store_header(unsigned char* out, int tiles_x, int tiles_y);
+
+  size_t nanostream_recording_frame_head_size(int num_tiles);
+
+  /* Returns the frame flags, or -1 if the tile indices are invalid. */
+  int nanostream_recording_store_frame_head(unsigned char* out,
+                                            int tiles_x,
+                                            int tiles_y,
+                                            uint64_t timestamp_us,
+                                            const int* tile_indices,
+                                            int num_tiles);
+
+  void nanostream_recording_store_index_entry(unsigned char* out,
+                                              uint64_t block_offset,
+                                              uint64_t timestamp_us,
+                                              uint32_t flags,
+                                              int keyframe_index);
+
+  void nanostream_recording_store_trailer(unsigned char* out, uint64_t index_offset, uint64_t num_frames);
+
+  /* Memory maps a recording. If the recording was not closed properly, the frame index is rebuilt by scanning the
+   * frame blocks. */
+  nanostream_recording* nanostream_recording_open(const char* filename);
+
+  void nanostream_recording_close(nanostream_recording* recording);
+
+  int nanostream_recording_num_frames(const nanostream_recording* recording);
+
+  int nanostream_recording_tiles_x(const nanostream_recording* recording);
+
+  int nanostream_recording_tiles_y(const nanostream_recording* recording);
+
+  /* Returns zero on success. */
+  int nanostream_recording_get_frame(const nanostream_recording* recording,
+                                     int frame_index,
+                                     nanostream_recording_frame* frame);
+
+  /* Returns the index of the last frame with a timestamp at or before 'timestamp_us', or -1 if there is none. */
+  int nanostream_recording_find_frame(const nanostream_recording* recording, uint64_t timestamp_us);
+
+  /* Returns a pointer into the mapped file, which may be passed directly to nanostream_decode_tile. */
+  const unsigned char* nanostream_recording_tile(const nanostream_recording_frame* frame,
+                                                 int tile,
+                                                 int* tile_x,
+                                                 int* tile_y);
+
+  /* Decodes the tiles of a frame into an image of tiles_x by tiles_y tiles. Tiles not present in the frame are left
+   * untouched, so decoding from 'keyframe_index' up to a frame reproduces it. */
+  void nanostream_recording_decode_frame(const nanostream_recording_frame* frame, int pitch, unsigned char* rgb);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,981 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "nanostream_server.h"
+
+#include "nanostream.h"
+#include "nanostream_basis.h"
+#include "nanostream_buffer_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The virtual time a stream of weight one is charged for a tile. */
+#define TILE_COST 65536u
+
+/* A derived basis is only offered if it leaves at most this share of the squared error of the basis in use, so that
+ * receivers are not sent a new basis for a marginal gain. */
+#define ADAPT_MIN_GAIN 0.9
+
+/* What happened to each tile of a frame. */
+#define TILE_PENDING 0
+#define TILE_ENCODED 1
+#define TILE_SKIPPED 2
+
+/* A basis that frames of a stream are encoded with or that is on offer. */
+struct basis
+{
+  nanostream_basis* basis;
+  int version;
+  /* One while it is the stream's current basis or the one on offer, plus one for each frame encoding with it or
+   * callback offering it. */
+  int users;
+};
+
+/* The trainer of a stream, which the workers skip sampling into while the adapter derives from it. */
+struct trainer
+{
+  pthread_mutex_t lock;
+  nanostream_basis_trainer* trainer;
+};
+
+struct frame
+{
+  const unsigned char* rgb;
+  int pitch;
+  uint64_t timestamp_us;
+  /* Increases by one with every frame submitted to the stream. */
+  uint64_t sequence;
+  /* The sequence number of the frame that started encoding before this one, or zero. */
+  uint64_t previous_sequence;
+  uint64_t submit_ns;
+  /* Zero if there is no deadline. */
+  uint64_t deadline_ns;
+  uint64_t done_ns;
+  nanostream_drop_reason drop_reason;
+  /* Null once the frame is dropped. */
+  unsigned char* packets;
+  unsigned char* tile_states;
+  int* tile_indices;
+  /* The basis the frame is encoded with once it starts, null for the built-in one. */
+  struct basis* basis;
+  /* The next tile to hand out, and the number of tiles encoded or skipped. */
+  int next_tile;
+  int tiles_done;
+};
+
+struct stream
+{
+  int in_use;
+  int removing;
+  nanostream_server_stream_config config;
+  int num_tiles;
+  nanostream_buffer_pool* packets_pool;
+
+  /* The frames that are queued, being encoded, or waiting to be delivered, as a ring of 'capacity' entries starting at
+   * 'head'. At most config.max_frames_in_flight of them are not dropped ('live'); the rest of the ring holds dropped
+   * frames until the frames before them are delivered. The first 'dispatched' frames have handed out all their tiles
+   * or were dropped. */
+  struct frame* frames;
+  int capacity;
+  int head;
+  int count;
+  int live;
+  int dispatched;
+
+  /* Set while a worker delivers frames, so that frames are delivered in order. */
+  int delivering;
+
+  uint64_t next_sequence;
+  uint64_t last_started_sequence;
+
+  /* For each tile, the hash of its pixels in the latest frame that was hashed, and the sequence number of that frame.
+   * Only used when shedding unchanged tiles. */
+  uint64_t* tile_hashes;
+  uint64_t* tile_hash_sequences;
+
+  /* For each tile, nonzero if it must not be left out of the next frame, because a receiver asked for it. */
+  unsigned char* tile_refresh;
+
+  /* The tiles handed out so far, weighted by the inverse of the weight. */
+  uint64_t virtual_time;
+
+  /* Only with basis adaptation. The basis frames start encoding with (null for the built-in one), the one on offer
+   * until the receivers acknowledge it, and the version they acknowledged last. While a basis is on offer, no other
+   * is derived, so that receivers never need more than the current basis and the one before. */
+  struct trainer* trainer;
+  struct basis* current;
+  struct basis* offered;
+  int acknowledged;
+  uint64_t next_derive_ns;
+  /* Set while the adapter derives a basis for the stream. */
+  int deriving;
+
+  nanostream_server_stream_stats stats;
+  uint64_t cpu_time_ns;
+};
+
+struct nanostream_server
+{
+  pthread_mutex_t lock;
+  /* Signaled when tiles are queued, when frames are dropped, or when stopping. */
+  pthread_cond_t work;
+  /* Signaled when frames are delivered, or a basis is derived. */
+  pthread_cond_t idle;
+  /* Signaled when a stream adapting its basis is added, or when stopping. Waits on CLOCK_MONOTONIC. */
+  pthread_cond_t adapt;
+
+  struct stream* streams;
+  int max_streams;
+
+  /* The virtual time of the stream that was served last. Streams that had no pending tiles start from here, so that
+   * being idle does not earn them credit over the busy ones. */
+  uint64_t virtual_time;
+
+  int stopping;
+
+  pthread_t* threads;
+  int num_threads;
+
+  /* The thread that derives bases, started with the first stream that adapts its basis. */
+  pthread_t adapter;
+  int adapter_started;
+};
+
+static uint64_t
+clock_ns(const clockid_t clock)
+{
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static struct frame*
+frame_at(struct stream* stream, const int offset)
+{
+  return &stream->frames[(stream->head + offset) % stream->capacity];
+}
+
+static int
+frame_is_done(const struct stream* stream, const struct frame* frame)
+{
+  return (frame->drop_reason != NANOSTREAM_DROP_NONE) || (frame->tiles_done == stream->num_tiles);
+}
+
+/* Hashes the pixels of a tile that lie inside the image. Never returns zero, which stands for an unknown hash. */
+static uint64_t
+hash_tile(const struct stream* stream, const struct frame* frame, const int tile)
+{
+  const int tiles_x = nanostream_frame_tiles_x(stream->config.width);
+  const int x0 = (tile % tiles_x) * NANOSTREAM_TILE_WIDTH;
+  const int y0 = (tile / tiles_x) * NANOSTREAM_TILE_HEIGHT;
+  const int w = (stream->config.width - x0 < NANOSTREAM_TILE_WIDTH) ? (stream->config.width - x0)
+                                                                    : NANOSTREAM_TILE_WIDTH;
+  const int h = (stream->config.height - y0 < NANOSTREAM_TILE_HEIGHT) ? (stream->config.height - y0)
+                                                                      : NANOSTREAM_TILE_HEIGHT;
+  const size_t row_size = (size_t)w * 3;
+
+  uint64_t hash = 0x9E3779B97F4A7C15u;
+  for (int y = 0; y < h; y++) {
+    const unsigned char* row = frame->rgb + (size_t)(y0 + y) * (size_t)frame->pitch + (size_t)x0 * 3;
+    size_t i = 0;
+    for (; i + 8 <= row_size; i += 8) {
+      uint64_t word;
+      memcpy(&word, row + i, sizeof(word));
+      hash = (hash ^ word) * 0x100000001B3u;
+      hash ^= hash >> 29;
+    }
+    for (; i < row_size; i++)
+      hash = (hash ^ row[i]) * 0x100000001B3u;
+  }
+
+  return hash | 1u;
+}
+
+/* Drops a reference to a basis. Called with the lock held. */
+static void
+release_basis(struct basis* basis)
+{
+  if (basis && (--basis->users == 0)) {
+    nanostream_basis_destroy(basis->basis);
+    free(basis);
+  }
+}
+
+/* Drops a frame that has not started encoding. Called with the lock held. */
+static void
+drop_frame(struct stream* stream, struct frame* frame, const nanostream_drop_reason reason)
+{
+  frame->drop_reason = reason;
+  frame->done_ns = clock_ns(CLOCK_MONOTONIC);
+  nanostream_buffer_pool_release(stream->packets_pool, frame->packets);
+  frame->packets = NULL;
+  stream->live--;
+
+  if (reason == NANOSTREAM_DROP_SUPERSEDED)
+    stream->stats.frames_superseded++;
+  else
+    stream->stats.frames_expired++;
+}
+
+/* Drops the queued frames of a stream whose deadline has passed, and moves past the dropped frames to the first frame
+ * with tiles to hand out. Called with the lock held. */
+static void
+expire_frames(struct stream* stream, const uint64_t now)
+{
+  while (stream->dispatched < stream->count) {
+    struct frame* frame = frame_at(stream, stream->dispatched);
+    if ((frame->drop_reason == NANOSTREAM_DROP_NONE) && (frame->next_tile == 0) && frame->deadline_ns &&
+        (now > frame->deadline_ns))
+      drop_frame(stream, frame, NANOSTREAM_DROP_EXPIRED);
+
+    if (frame->drop_reason == NANOSTREAM_DROP_NONE)
+      break;
+
+    stream->dispatched++;
+  }
+}
+
+/* Returns the stream with pending tiles that is furthest behind its share, or null. Ties go to the earlier deadline.
+ * Called with the lock held. */
+static struct stream*
+pick_stream(nanostream_server* server)
+{
+  struct stream* best = NULL;
+  uint64_t best_deadline = 0;
+
+  for (int i = 0; i < server->max_streams; i++) {
+    struct stream* stream = &server->streams[i];
+    if (!stream->in_use || (stream->dispatched == stream->count))
+      continue;
+
+    const uint64_t deadline = frame_at(stream, stream->dispatched)->deadline_ns;
+    if (!best || (stream->virtual_time < best->virtual_time) ||
+        ((stream->virtual_time == best->virtual_time) && deadline && (!best_deadline || deadline < best_deadline))) {
+      best = stream;
+      best_deadline = deadline;
+    }
+  }
+
+  return best;
+}
+
+/* Moves the packets of the encoded tiles of a frame together and lists their indices. Returns their number. */
+static int
+gather_tiles(const struct stream* stream, struct frame* frame)
+{
+  int n = 0;
+  for (int tile = 0; tile < stream->num_tiles; tile++) {
+    if (frame->tile_states[tile] != TILE_ENCODED)
+      continue;
+    if (n != tile) {
+      memmove(frame->packets + (size_t)n * NANOSTREAM_PACKET_SIZE,
+              frame->packets + (size_t)tile * NANOSTREAM_PACKET_SIZE,
+              NANOSTREAM_PACKET_SIZE);
+    }
+    frame->tile_indices[n++] = tile;
+  }
+  return n;
+}
+
+/* Delivers the finished frames at the head of a stream, in order. Called with the lock held, which is released
+ * around the callbacks. */
+static void
+deliver_frames(nanostream_server* server, struct stream* stream)
+{
+  if (stream->delivering)
+    return;
+
+  stream->delivering = 1;
+
+  while ((stream->count > 0) && frame_is_done(stream, frame_at(stream, 0))) {
+    struct frame* f = frame_at(stream, 0);
+    const int dropped = f->drop_reason != NANOSTREAM_DROP_NONE;
+
+    nanostream_server_frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.stream = (int)(stream - server->streams);
+    frame.timestamp_us = f->timestamp_us;
+    frame.rgb = f->rgb;
+    frame.drop_reason = f->drop_reason;
+    frame.latency_us = (f->done_ns - f->submit_ns) / 1000u;
+
+    struct basis* offered = stream->offered;
+    if (offered) {
+      offered->users++;
+      frame.new_basis = offered->basis;
+      frame.new_basis_version = offered->version;
+    }
+
+    if (!dropped) {
+      frame.late = (f->deadline_ns != 0) && (f->done_ns > f->deadline_ns);
+      frame.basis_version = f->basis ? f->basis->version : 0;
+
+      stream->stats.frames_encoded++;
+      stream->stats.frames_late += frame.late ? 1 : 0;
+      stream->stats.total_latency_us += frame.latency_us;
+      if (frame.latency_us > stream->stats.max_latency_us)
+        stream->stats.max_latency_us = frame.latency_us;
+    }
+
+    pthread_mutex_unlock(&server->lock);
+
+    if (!dropped) {
+      frame.num_tiles = gather_tiles(stream, f);
+      frame.num_skipped_tiles = stream->num_tiles - frame.num_tiles;
+      frame.packets = f->packets;
+      frame.tile_indices = f->tile_indices;
+    }
+
+    stream->config.callback(stream->config.user_data, &frame);
+
+    pthread_mutex_lock(&server->lock);
+
+    release_basis(offered);
+    release_basis(f->basis);
+    f->basis = NULL;
+
+    if (!dropped) {
+      stream->stats.tiles_skipped += (uint64_t)frame.num_skipped_tiles;
+      stream->stats.frames_shed += (frame.num_skipped_tiles > 0) ? 1 : 0;
+      nanostream_buffer_pool_release(stream->packets_pool, f->packets);
+      stream->live--;
+    }
+
+    stream->head = (stream->head + 1) % stream->capacity;
+    stream->count--;
+    if (stream->dispatched > 0)
+      stream->dispatched--;
+  }
+
+  stream->delivering = 0;
+  pthread_cond_broadcast(&server->idle);
+}
+
+/* Expires frames and delivers the finished ones of every stream. Returns nonzero if the lock was released. */
+static int
+update_streams(nanostream_server* server)
+{
+  const uint64_t now = clock_ns(CLOCK_MONOTONIC);
+  int released = 0;
+
+  for (int i = 0; i < server->max_streams; i++) {
+    struct stream* stream = &server->streams[i];
+    if (!stream->in_use)
+      continue;
+
+    expire_frames(stream, now);
+
+    if ((stream->count > 0) && !stream->delivering && frame_is_done(stream, frame_at(stream, 0))) {
+      deliver_frames(server, stream);
+      released = 1;
+    }
+  }
+
+  return released;
+}
+
+/* Encodes a tile, or leaves it out if shedding is allowed and it did not change since 'previous_hash'. Encoded tiles
+ * that lie wholly inside the image are sampled for the trainer, unless it is busy. Returns the hash of the tile, or
+ * zero if it was not hashed. */
+static uint64_t
+process_tile(const struct stream* stream,
+             struct frame* frame,
+             const int tile,
+             const int shed,
+             const uint64_t previous_hash)
+{
+  uint64_t hash = 0;
+  if (stream->config.shed_unchanged_tiles) {
+    hash = hash_tile(stream, frame, tile);
+    if (shed && (hash == previous_hash)) {
+      frame->tile_states[tile] = TILE_SKIPPED;
+      return hash;
+    }
+  }
+
+  nanostream_encode_frame_with_basis(frame->basis ? frame->basis->basis : NULL,
+                                     frame->rgb,
+                                     stream->config.width,
+                                     stream->config.height,
+                                     frame->pitch,
+                                     stream->config.padding,
+                                     tile,
+                                     1,
+                                     frame->packets + (size_t)tile * NANOSTREAM_PACKET_SIZE);
+  frame->tile_states[tile] = TILE_ENCODED;
+
+  if (stream->trainer) {
+    const int tiles_x = nanostream_frame_tiles_x(stream->config.width);
+    const int x = (tile % tiles_x) * NANOSTREAM_TILE_WIDTH;
+    const int y = (tile / tiles_x) * NANOSTREAM_TILE_HEIGHT;
+    if ((x + NANOSTREAM_TILE_WIDTH <= stream->config.width) && (y + NANOSTREAM_TILE_HEIGHT <= stream->config.height) &&
+        (pthread_mutex_trylock(&stream->trainer->lock) == 0)) {
+      nanostream_basis_trainer_add_tile(
+        stream->trainer->trainer, frame->rgb + (size_t)y * (size_t)frame->pitch + (size_t)x * 3, frame->pitch);
+      pthread_mutex_unlock(&stream->trainer->lock);
+    }
+  }
+
+  return hash;
+}
+
+static void*
+run_worker(void* arg)
+{
+  nanostream_server* server = arg;
+
+  pthread_mutex_lock(&server->lock);
+
+  for (;;) {
+    if (update_streams(server))
+      continue;
+
+    struct stream* stream = pick_stream(server);
+    if (!stream) {
+      if (server->stopping)
+        break;
+      pthread_cond_wait(&server->work, &server->lock);
+      continue;
+    }
+
+    struct frame* frame = frame_at(stream, stream->dispatched);
+    const uint64_t now = clock_ns(CLOCK_MONOTONIC);
+
+    if (frame->next_tile == 0) {
+      frame->previous_sequence = stream->last_started_sequence;
+      stream->last_started_sequence = frame->sequence;
+
+      /* Bases only change between frames, so that all the tiles of a frame decode with the same one. */
+      if (stream->offered && (stream->acknowledged == stream->offered->version)) {
+        release_basis(stream->current);
+        stream->current = stream->offered;
+        stream->offered = NULL;
+        stream->stats.bases_adopted++;
+      }
+      frame->basis = stream->current;
+      if (frame->basis)
+        frame->basis->users++;
+    }
+
+    const int tile = frame->next_tile++;
+    if (frame->next_tile == stream->num_tiles)
+      stream->dispatched++;
+
+    /* Unchanged tiles are only left out once the frame is late or the stream is backed up, and only when the pixels of
+     * the tile are known for the frame before, so that a decoder is left with what this frame would have shown. A tile
+     * a receiver asked to refresh is encoded once regardless. */
+    const int shed = (frame->deadline_ns && ((now - frame->submit_ns) * 2 > (frame->deadline_ns - frame->submit_ns))) ||
+                     (stream->live == stream->config.max_frames_in_flight);
+    uint64_t previous_hash =
+      (stream->tile_hash_sequences && (stream->tile_hash_sequences[tile] == frame->previous_sequence))
+        ? stream->tile_hashes[tile]
+        : 0;
+    if (stream->tile_refresh && stream->tile_refresh[tile]) {
+      stream->tile_refresh[tile] = 0;
+      previous_hash = 0;
+    }
+
+    server->virtual_time = stream->virtual_time;
+    stream->virtual_time += TILE_COST / (unsigned)stream->config.weight;
+
+    pthread_mutex_unlock(&server->lock);
+
+    const uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    const uint64_t hash = process_tile(stream, frame, tile, shed, previous_hash);
+    const uint64_t cpu_time = clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+
+    pthread_mutex_lock(&server->lock);
+
+    stream->cpu_time_ns += cpu_time;
+
+    /* A tile that was left out is still charged in full: giving the share back would put the stream behind the
+     * virtual time that streams becoming busy start from, ahead of them. */
+    if (frame->tile_states[tile] == TILE_ENCODED)
+      stream->stats.tiles_encoded++;
+
+    if (hash && (stream->tile_hash_sequences[tile] < frame->sequence)) {
+      stream->tile_hashes[tile] = hash;
+      stream->tile_hash_sequences[tile] = frame->sequence;
+    }
+
+    if (++frame->tiles_done == stream->num_tiles) {
+      frame->done_ns = clock_ns(CLOCK_MONOTONIC);
+      deliver_frames(server, stream);
+    }
+  }
+
+  pthread_mutex_unlock(&server->lock);
+  return NULL;
+}
+
+/* Derives a basis for each stream adapting its basis whose time has come, without the lock held, and offers it if it
+ * is enough of an improvement. Called with the lock held. Returns the time of the next derivation, or zero if the lock
+ * was released. */
+static uint64_t
+adapt_streams(nanostream_server* server)
+{
+  const uint64_t now = clock_ns(CLOCK_MONOTONIC);
+  uint64_t next = UINT64_MAX;
+
+  for (int i = 0; i < server->max_streams; i++) {
+    struct stream* stream = &server->streams[i];
+    if (!stream->in_use || stream->removing || !stream->trainer || stream->offered)
+      continue;
+    if (now < stream->next_derive_ns) {
+      if (stream->next_derive_ns < next)
+        next = stream->next_derive_ns;
+      continue;
+    }
+
+    struct basis* current = stream->current;
+    if (current)
+      current->users++;
+    stream->deriving = 1;
+
+    pthread_mutex_unlock(&server->lock);
+
+    double current_error = 0.0;
+    double derived_error = 0.0;
+    pthread_mutex_lock(&stream->trainer->lock);
+    nanostream_basis* derived = nanostream_basis_trainer_derive(
+      stream->trainer->trainer, current ? current->basis : NULL, &current_error, &derived_error);
+    pthread_mutex_unlock(&stream->trainer->lock);
+
+    struct basis* offered = NULL;
+    if (derived && (derived_error < current_error * ADAPT_MIN_GAIN))
+      offered = malloc(sizeof(struct basis));
+    if (offered) {
+      offered->basis = derived;
+      offered->version = current ? (current->version % 255 + 1) : 1;
+      offered->users = 1;
+    } else {
+      nanostream_basis_destroy(derived);
+    }
+
+    pthread_mutex_lock(&server->lock);
+
+    release_basis(current);
+    stream->offered = offered;
+    stream->stats.bases_offered += offered ? 1 : 0;
+    stream->next_derive_ns = clock_ns(CLOCK_MONOTONIC) + stream->config.adapt_basis_interval_us * 1000u;
+    stream->deriving = 0;
+    pthread_cond_broadcast(&server->idle);
+    return 0;
+  }
+
+  return next;
+}
+
+static void*
+run_adapter(void* arg)
+{
+  nanostream_server* server = arg;
+
+  pthread_mutex_lock(&server->lock);
+
+  while (!server->stopping) {
+    const uint64_t next = adapt_streams(server);
+    if (next == 0)
+      continue;
+
+    if (next == UINT64_MAX) {
+      pthread_cond_wait(&server->adapt, &server->lock);
+    } else {
+      struct timespec until;
+      until.tv_sec = (time_t)(next / 1000000000u);
+      until.tv_nsec = (long)(next % 1000000000u);
+      pthread_cond_timedwait(&server->adapt, &server->lock, &until);
+    }
+  }
+
+  pthread_mutex_unlock(&server->lock);
+  return NULL;
+}
+
+/* Waits until a stream has no frames in flight and no basis being derived. Called with the lock held. */
+static void
+wait_for_stream(nanostream_server* server, struct stream* stream)
+{
+  while ((stream->count > 0) || stream->deriving)
+    pthread_cond_wait(&server->idle, &server->lock);
+}
+
+static void
+free_stream(struct stream* stream)
+{
+  nanostream_buffer_pool_destroy(stream->packets_pool);
+  if (stream->frames) {
+    for (int i = 0; i < stream->capacity; i++) {
+      free(stream->frames[i].tile_states);
+      free(stream->frames[i].tile_indices);
+    }
+  }
+  free(stream->frames);
+  free(stream->tile_hashes);
+  free(stream->tile_hash_sequences);
+  free(stream->tile_refresh);
+
+  if (stream->trainer) {
+    nanostream_basis_trainer_destroy(stream->trainer->trainer);
+    pthread_mutex_destroy(&stream->trainer->lock);
+    free(stream->trainer);
+  }
+  release_basis(stream->current);
+  release_basis(stream->offered);
+}
+
+nanostream_server*
+nanostream_server_create(const nanostream_server_config* config)
+{
+  nanostream_server* server = calloc(1, sizeof(nanostream_server));
+  if (!server)
+    return NULL;
+
+  server->max_streams = (config->max_streams > 0) ? config->max_streams : 64;
+  server->num_threads = config->num_threads;
+  if (server->num_threads <= 0) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    server->num_threads = (cpus > 0) ? (int)cpus : 1;
+  }
+
+  server->streams = calloc((size_t)server->max_streams, sizeof(struct stream));
+  server->threads = calloc((size_t)server->num_threads, sizeof(pthread_t));
+  if (!server->streams || !server->threads) {
+    free(server->streams);
+    free(server->threads);
+    free(server);
+    return NULL;
+  }
+
+  pthread_mutex_init(&server->lock, NULL);
+  pthread_cond_init(&server->work, NULL);
+  pthread_cond_init(&server->idle, NULL);
+
+  pthread_condattr_t adapt_attr;
+  pthread_condattr_init(&adapt_attr);
+  pthread_condattr_setclock(&adapt_attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&server->adapt, &adapt_attr);
+  pthread_condattr_destroy(&adapt_attr);
+
+  for (int i = 0; i < server->num_threads; i++) {
+    if (pthread_create(&server->threads[i], NULL, run_worker, server) != 0) {
+      server->num_threads = i;
+      nanostream_server_destroy(server);
+      return NULL;
+    }
+  }
+
+  return server;
+}
+
+void
+nanostream_server_destroy(nanostream_server* server)
+{
+  if (!server)
+    return;
+
+  pthread_mutex_lock(&server->lock);
+  for (int i = 0; i < server->max_streams; i++)
+    wait_for_stream(server, &server->streams[i]);
+  server->stopping = 1;
+  pthread_cond_broadcast(&server->work);
+  pthread_cond_broadcast(&server->adapt);
+  pthread_mutex_unlock(&server->lock);
+
+  for (int i = 0; i < server->num_threads; i++)
+    pthread_join(server->threads[i], NULL);
+  if (server->adapter_started)
+    pthread_join(server->adapter, NULL);
+
+  for (int i = 0; i < server->max_streams; i++) {
+    if (server->streams[i].in_use)
+      free_stream(&server->streams[i]);
+  }
+
+  pthread_cond_destroy(&server->adapt);
+  pthread_cond_destroy(&server->idle);
+  pthread_cond_destroy(&server->work);
+  pthread_mutex_destroy(&server->lock);
+  free(server->threads);
+  free(server->streams);
+  free(server);
+}
+
+int
+nanostream_server_num_threads(const nanostream_server* server)
+{
+  return server->num_threads;
+}
+
+int
+nanostream_server_add_stream(nanostream_server* server, const nanostream_server_stream_config* config)
+{
+  if ((config->width <= 0) || (config->height <= 0) || !config->callback)
+    return -1;
+
+  struct stream s;
+  memset(&s, 0, sizeof(s));
+  s.in_use = 1;
+  s.config = *config;
+  if (s.config.weight <= 0)
+    s.config.weight = 1;
+  if (s.config.max_frames_in_flight <= 0)
+    s.config.max_frames_in_flight = 2;
+
+  s.num_tiles = nanostream_frame_tiles_x(s.config.width) * nanostream_frame_tiles_y(s.config.height);
+
+  /* Each frame that is not dropped may be followed by a dropped one that waits to be delivered. */
+  s.capacity = s.config.max_frames_in_flight * 2;
+  s.next_sequence = 1;
+
+  /* Allocated outside of the lock, since faulting in the pool takes a while for large streams. */
+  s.packets_pool =
+    nanostream_buffer_pool_create((size_t)s.num_tiles * NANOSTREAM_PACKET_SIZE, s.config.max_frames_in_flight);
+  s.frames = calloc((size_t)s.capacity, sizeof(struct frame));
+  int ok = s.packets_pool && s.frames;
+
+  for (int i = 0; ok && (i < s.capacity); i++) {
+    s.frames[i].tile_states = calloc((size_t)s.num_tiles, 1);
+    s.frames[i].tile_indices = calloc((size_t)s.num_tiles, sizeof(int));
+    ok = s.frames[i].tile_states && s.frames[i].tile_indices;
+  }
+
+  if (ok && s.config.shed_unchanged_tiles) {
+    s.tile_hashes = calloc((size_t)s.num_tiles, sizeof(uint64_t));
+    s.tile_hash_sequences = calloc((size_t)s.num_tiles, sizeof(uint64_t));
+    s.tile_refresh = calloc((size_t)s.num_tiles, 1);
+    ok = s.tile_hashes && s.tile_hash_sequences && s.tile_refresh;
+  }
+
+  if (ok && s.config.adapt_basis_interval_us) {
+    nanostream_basis_trainer_config trainer_config;
+    memset(&trainer_config, 0, sizeof(trainer_config));
+    s.trainer = malloc(sizeof(struct trainer));
+    ok = s.trainer && ((s.trainer->trainer = nanostream_basis_trainer_create(&trainer_config)) != NULL);
+    if (ok) {
+      pthread_mutex_init(&s.trainer->lock, NULL);
+    } else {
+      free(s.trainer);
+      s.trainer = NULL;
+    }
+  }
+
+  if (!ok) {
+    free_stream(&s);
+    return -1;
+  }
+
+  pthread_mutex_lock(&server->lock);
+
+  int id = -1;
+  for (int i = 0; i < server->max_streams; i++) {
+    if (!server->streams[i].in_use) {
+      id = i;
+      break;
+    }
+  }
+
+  if ((id >= 0) && s.trainer && !server->adapter_started) {
+    if (pthread_create(&server->adapter, NULL, run_adapter, server) == 0)
+      server->adapter_started = 1;
+    else
+      id = -1;
+  }
+
+  if (id >= 0) {
+    s.virtual_time = server->virtual_time;
+    if (s.trainer)
+      s.next_derive_ns = clock_ns(CLOCK_MONOTONIC) + s.config.adapt_basis_interval_us * 1000u;
+    server->streams[id] = s;
+    pthread_cond_broadcast(&server->adapt);
+  }
+
+  pthread_mutex_unlock(&server->lock);
+
+  if (id < 0)
+    free_stream(&s);
+
+  return id;
+}
+
+void
+nanostream_server_remove_stream(nanostream_server* server, const int stream_id)
+{
+  if ((stream_id < 0) || (stream_id >= server->max_streams))
+    return;
+
+  pthread_mutex_lock(&server->lock);
+
+  struct stream* stream = &server->streams[stream_id];
+  if (!stream->in_use || stream->removing) {
+    pthread_mutex_unlock(&server->lock);
+    return;
+  }
+
+  stream->removing = 1;
+  wait_for_stream(server, stream);
+
+  struct stream removed = *stream;
+  stream->in_use = 0;
+  stream->removing = 0;
+
+  pthread_mutex_unlock(&server->lock);
+
+  free_stream(&removed);
+}
+
+/* Returns the newest frame of a stream that has not started encoding and was not dropped, or null. Called with the
+ * lock held. */
+static struct frame*
+newest_queued_frame(struct stream* stream)
+{
+  for (int i = stream->count - 1; i >= stream->dispatched; i--) {
+    struct frame* frame = frame_at(stream, i);
+    if (frame->drop_reason == NANOSTREAM_DROP_NONE)
+      return (frame->next_tile == 0) ? frame : NULL;
+  }
+  return NULL;
+}
+
+int
+nanostream_server_submit_frame(nanostream_server* server,
+                               const int stream_id,
+                               const unsigned char* rgb,
+                               const int pitch,
+                               const uint64_t timestamp_us)
+{
+  if ((stream_id < 0) || (stream_id >= server->max_streams))
+    return -1;
+
+  pthread_mutex_lock(&server->lock);
+
+  struct stream* stream = &server->streams[stream_id];
+  if (!stream->in_use || stream->removing) {
+    pthread_mutex_unlock(&server->lock);
+    return -1;
+  }
+
+  stream->stats.frames_submitted++;
+
+  /* The newest frame is the one worth encoding, so it takes the place of a queued frame if the stream is full. */
+  if (stream->live == stream->config.max_frames_in_flight) {
+    struct frame* queued = newest_queued_frame(stream);
+    if (queued)
+      drop_frame(stream, queued, NANOSTREAM_DROP_SUPERSEDED);
+  }
+
+  if ((stream->live == stream->config.max_frames_in_flight) || (stream->count == stream->capacity)) {
+    stream->stats.frames_rejected++;
+    pthread_mutex_unlock(&server->lock);
+    return -1;
+  }
+
+  /* There is one packet buffer for each frame that is not dropped. */
+  struct frame* frame = frame_at(stream, stream->count);
+  frame->rgb = rgb;
+  frame->pitch = pitch;
+  frame->timestamp_us = timestamp_us;
+  frame->sequence = stream->next_sequence++;
+  frame->previous_sequence = 0;
+  frame->submit_ns = clock_ns(CLOCK_MONOTONIC);
+  frame->deadline_ns = stream->config.deadline_us ? (frame->submit_ns + stream->config.deadline_us * 1000u) : 0;
+  frame->done_ns = 0;
+  frame->drop_reason = NANOSTREAM_DROP_NONE;
+  frame->packets = nanostream_buffer_pool_acquire(stream->packets_pool);
+  frame->basis = NULL;
+  memset(frame->tile_states, TILE_PENDING, (size_t)stream->num_tiles);
+  frame->next_tile = 0;
+  frame->tiles_done = 0;
+
+  if ((stream->dispatched == stream->count) && (stream->virtual_time < server->virtual_time))
+    stream->virtual_time = server->virtual_time;
+
+  stream->count++;
+  stream->live++;
+
+  pthread_mutex_unlock(&server->lock);
+
+  pthread_cond_broadcast(&server->work);
+  return 0;
+}
+
+const char*
+nanostream_drop_reason_name(const nanostream_drop_reason reason)
+{
+  switch (reason) {
+    case NANOSTREAM_DROP_NONE:
+      return "none";
+    case NANOSTREAM_DROP_SUPERSEDED:
+      return "superseded";
+    case NANOSTREAM_DROP_EXPIRED:
+      return "expired";
+  }
+  return "unknown";
+}
+
+int
+nanostream_server_refresh_tiles(nanostream_server* server, const int stream_id, const int* tiles, const int num_tiles)
+{
+  if ((stream_id < 0) || (stream_id >= server->max_streams))
+    return -1;
+
+  pthread_mutex_lock(&server->lock);
+
+  struct stream* stream = &server->streams[stream_id];
+  const int in_use = stream->in_use && !stream->removing;
+  if (in_use && stream->tile_refresh) {
+    for (int i = 0; i < num_tiles; i++) {
+      if ((tiles[i] >= 0) && (tiles[i] < stream->num_tiles))
+        stream->tile_refresh[tiles[i]] = 1;
+    }
+  }
+
+  pthread_mutex_unlock(&server->lock);
+
+  return in_use ? 0 : -1;
+}
+
+int
+nanostream_server_acknowledge_basis(nanostream_server* server, const int stream_id, const int version)
+{
+  if ((stream_id < 0) || (stream_id >= server->max_streams))
+    return -1;
+
+  pthread_mutex_lock(&server->lock);
+
+  struct stream* stream = &server->streams[stream_id];
+  const int in_use = stream->in_use && !stream->removing;
+  if (in_use)
+    stream->acknowledged = version;
+
+  pthread_mutex_unlock(&server->lock);
+
+  return in_use ? 0 : -1;
+}
+
+int
+nanostream_server_get_stream_stats(nanostream_server* server,
+                                   const int stream_id,
+                                   nanostream_server_stream_stats* stats)
+{
+  if ((stream_id < 0) || (stream_id >= server->max_streams))
+    return -1;
+
+  pthread_mutex_lock(&server->lock);
+
+  const struct stream* stream = &server->streams[stream_id];
+  const int in_use = stream->in_use;
+  if (in_use) {
+    *stats = stream->stats;
+    stats->cpu_time_us = stream->cpu_time_ns / 1000u;
+  }
+
+  pthread_mutex_unlock(&server->lock);
+
+  return in_use ? 0 : -1;
+}
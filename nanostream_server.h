@@ -0,0 +1,195 @@
+#pragma once
+
+#include "nanostream_frame.h"
+
+#include <stdint.h>
+
+/* A server encodes frames from many independent streams (cameras, screens) of any size and frame rate with one shared
+ * pool of worker threads. Work is handed out one tile at a time, and streams with pending tiles are served in
+ * proportion to their weights (weighted fair queueing on tiles), so a large stream cannot hold back the frames of
+ * small ones: a small stream waits for at most a few tiles of a large one, never for a whole frame. The thread CPU
+ * time spent on each stream is measured, and each frame's latency is checked against the deadline of its stream.
+ *
+ * Under overload, latency stays bounded instead of frames queueing up. A frame is never dropped once its encoding has
+ * started, but before that it is dropped when its deadline passes, or when a newer frame of the stream arrives while
+ * the stream has its maximum number of frames in flight. Before dropping whole frames, a stream can shed load by
+ * tile: once a frame is late (half its deadline has passed) or the stream is backed up, tiles that did not change
+ * since the previous frame are left out. Every frame is reported to the callback with the tiles it carries, or with
+ * the reason it was dropped.
+ *
+ * A stream can also adapt its basis to its content (see nanostream_basis.h). The workers sample the tiles they encode,
+ * and a background thread derives a new basis every so often. When it beats the one in use by enough, it is offered
+ * with every frame delivered to the callback, to be sent to the receivers, until they acknowledge it; the frames that
+ * start encoding after that use it. Every frame says which basis its tiles were encoded with.
+ *
+ * POSIX threads only. */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_server nanostream_server;
+
+  typedef struct nanostream_server_config
+  {
+    /* The number of worker threads. Zero selects the number of online processors. */
+    int num_threads;
+
+    /* The maximum number of streams. Zero selects 64. */
+    int max_streams;
+  } nanostream_server_config;
+
+  typedef enum nanostream_drop_reason
+  {
+    NANOSTREAM_DROP_NONE = 0,
+    /* A newer frame was submitted while the stream had its maximum number of frames in flight. */
+    NANOSTREAM_DROP_SUPERSEDED = 1,
+    /* The deadline passed before encoding of the frame started. */
+    NANOSTREAM_DROP_EXPIRED = 2
+  } nanostream_drop_reason;
+
+  typedef struct nanostream_server_frame
+  {
+    int stream;
+
+    /* As passed to nanostream_server_submit_frame. */
+    uint64_t timestamp_us;
+    const unsigned char* rgb;
+
+    /* The packets of the tiles the frame carries, back to back, and the indices of those tiles in increasing order.
+     * That is every tile of the frame, unless unchanged tiles were shed. Empty if the frame was dropped. */
+    const unsigned char* packets;
+    const int* tile_indices;
+    int num_tiles;
+
+    /* The unchanged tiles that were left out. */
+    int num_skipped_tiles;
+
+    nanostream_drop_reason drop_reason;
+
+    /* The time from submitting the frame to its last tile being encoded, or to it being dropped. */
+    uint64_t latency_us;
+
+    /* Nonzero if the frame was encoded after its deadline. */
+    int late;
+
+    /* The version of the basis the tiles were encoded with, zero for the built-in one, for the flags of their
+     * datagrams (see NANOSTREAM_NET_FLAGS_BASIS). */
+    int basis_version;
+
+    /* A basis derived from the content of the stream and its version, to be sent to the receivers before the tiles,
+     * until they acknowledge it (see nanostream_server_acknowledge_basis). Null if there is none. */
+    const nanostream_basis* new_basis;
+    int new_basis_version;
+  } nanostream_server_frame;
+
+  /* Called on a worker thread for every queued frame once it is encoded or dropped, in the order the frames of a stream
+   * were submitted. The packets are only valid during the call. Once it returns, the image of the frame is no longer
+   * used. */
+  typedef void (*nanostream_server_callback)(void* user_data, const nanostream_server_frame* frame);
+
+  typedef struct nanostream_server_stream_config
+  {
+    int width;
+    int height;
+    nanostream_padding padding;
+
+    /* The share of the workers the stream gets relative to the other streams, when they have more work than there
+     * are workers. Zero selects 1. */
+    int weight;
+
+    /* How long after being submitted a frame should be encoded, in microseconds. Zero means no deadline. */
+    uint64_t deadline_us;
+
+    /* The number of frames that may be queued or being encoded at once. Zero selects 2. */
+    int max_frames_in_flight;
+
+    /* Nonzero to leave out unchanged tiles when the stream falls behind. A decoder then keeps the previous contents of
+     * those tiles, as nanostream_surface does for partial frames. */
+    int shed_unchanged_tiles;
+
+    /* How often a basis is derived from the content of the stream, zero to always encode with the built-in basis. */
+    uint64_t adapt_basis_interval_us;
+
+    nanostream_server_callback callback;
+    void* user_data;
+  } nanostream_server_stream_config;
+
+  typedef struct nanostream_server_stream_stats
+  {
+    uint64_t frames_submitted;
+
+    /* Frames that were encoded, and those of them that missed their deadline. */
+    uint64_t frames_encoded;
+    uint64_t frames_late;
+
+    /* Frames that were dropped, by reason. */
+    uint64_t frames_superseded;
+    uint64_t frames_expired;
+
+    /* Frames that were refused because the stream had its maximum number of frames in flight, all of which had
+     * started encoding. */
+    uint64_t frames_rejected;
+
+    uint64_t tiles_encoded;
+
+    /* Unchanged tiles that were left out, and the number of frames they were left out of. */
+    uint64_t tiles_skipped;
+    uint64_t frames_shed;
+
+    /* The thread CPU time spent encoding the tiles of the stream. */
+    uint64_t cpu_time_us;
+
+    /* Bases that were derived and offered to the receivers, and those of them that frames were encoded with. */
+    uint64_t bases_offered;
+    uint64_t bases_adopted;
+
+    uint64_t total_latency_us;
+    uint64_t max_latency_us;
+  } nanostream_server_stream_stats;
+
+  /* Creates a server and starts its workers. Returns null on failure. */
+  nanostream_server* nanostream_server_create(const nanostream_server_config* config);
+
+  /* Encodes the frames that were already submitted, then stops the workers. */
+  void nanostream_server_destroy(nanostream_server* server);
+
+  int nanostream_server_num_threads(const nanostream_server* server);
+
+  /* Adds a stream and returns its id, or -1 on failure. */
+  int nanostream_server_add_stream(nanostream_server* server, const nanostream_server_stream_config* config);
+
+  /* Waits for the frames of a stream that are in flight to be delivered, then removes it. Must not be called from the
+   * callback of that stream. */
+  void nanostream_server_remove_stream(nanostream_server* server, int stream);
+
+  /* Queues a frame for encoding. The image must stay valid until the frame is delivered to the callback. Returns zero
+   * if the frame was queued, or -1 if it was refused because the stream has its maximum number of frames in flight
+   * and none of them can be dropped. */
+  int nanostream_server_submit_frame(nanostream_server* server,
+                                     int stream,
+                                     const unsigned char* rgb,
+                                     int pitch,
+                                     uint64_t timestamp_us);
+
+  /* Returns a short description of a drop reason, for reports. */
+  const char* nanostream_drop_reason_name(nanostream_drop_reason reason);
+
+  /* Makes sure the given tiles are encoded in the next frame of the stream that reaches them, even if they did not
+   * change, for example because a receiver lost them. Only matters when the stream sheds unchanged tiles. Returns zero,
+   * or -1 if there is no such stream. */
+  int nanostream_server_refresh_tiles(nanostream_server* server, int stream, const int* tiles, int num_tiles);
+
+  /* Tells the server that the receivers of a stream hold the basis 'version', for example from the feedback they sent
+   * (see nanostream_feedback_responder_stats). If it is the basis on offer, the frames that start encoding from now on
+   * use it. With several receivers, only acknowledge a version once all of them have it. Returns zero, or -1 if there
+   * is no such stream. */
+  int nanostream_server_acknowledge_basis(nanostream_server* server, int stream, int version);
+
+  /* Returns -1 if there is no such stream. */
+  int nanostream_server_get_stream_stats(nanostream_server* server, int stream, nanostream_server_stream_stats* stats);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,872 @@
+/* Generated by amalgamate.py from nanostream.h, nanostream.c and nanostream_layouts.c.
+ *
+ * Single header version of the nanostream codec. In exactly one source file, write
+ *
+ *   #define NANOSTREAM_IMPLEMENTATION
+ *   #include "nanostream_single.h"
+ *
+ * Define NANOSTREAM_STATIC as well to make every function static inline, so the codec can be inlined into the
+ * including file without link time optimization. In that case, each file that uses the codec defines both. */
+
+#ifndef NANOSTREAM_SINGLE_H
+#define NANOSTREAM_SINGLE_H
+
+#ifdef NANOSTREAM_STATIC
+#define NANOSTREAM_DEF static inline
+#else
+#define NANOSTREAM_DEF extern
+#endif
+
+#define NANOSTREAM_TILE_WIDTH 160
+
+#define NANOSTREAM_TILE_HEIGHT 120
+
+#define NANOSTREAM_PACKET_SIZE (1200 + (8 * 2 * sizeof(float)))
+
+/* The most bases a tile can be chosen to be encoded with (see nanostream_encode_tile_with_bases). */
+#define NANOSTREAM_MAX_BASES 16
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  NANOSTREAM_DEF void nanostream_encode_tile(const unsigned char* rgb, int pitch, unsigned char* packet_buffer);
+
+  NANOSTREAM_DEF void nanostream_decode_tile(const unsigned char* packet_buffer, int pitch, unsigned char* rgb);
+
+  /* Decodes a tile at half resolution, (NANOSTREAM_TILE_WIDTH / 2) x (NANOSTREAM_TILE_HEIGHT / 2), where each pixel is
+   * the mean of a 2x2 group of the full resolution tile. The means are computed from the coefficients directly,
+   * without reconstructing the full resolution pixels. */
+  NANOSTREAM_DEF void nanostream_decode_tile_half(const unsigned char* packet_buffer, int pitch, unsigned char* rgb);
+
+  /* Fills in a tile whose packet was lost from the packets of the tiles around it: 'neighbours' holds the packets of
+   * the tiles to the left, to the right, above and below, any of which may be NULL. Each block gets the coefficients
+   * of the nearest edge block of each of those tiles, weighted by the inverse of its distance, so the tile blends
+   * smoothly into its surroundings. Returns -1, leaving the pixels as they are, if every neighbour is NULL. */
+  NANOSTREAM_DEF int nanostream_conceal_tile(const unsigned char* const* neighbours, int pitch, unsigned char* rgb);
+
+  /* A basis other than the built-in one, such as one derived from the content of a stream (see nanostream_basis.h). */
+  typedef struct nanostream_basis nanostream_basis;
+
+  /* Like the functions above, with the given basis, or the built-in one if it is null. A packet does not say which
+   * basis it was encoded with: it must be decoded with the same one. Packets encoded with several bases (see
+   * nanostream_encode_tile_with_bases) must not be decoded or concealed with these, nor with the functions above. */
+  NANOSTREAM_DEF void nanostream_encode_tile_with_basis(const nanostream_basis* basis,
+                                         const unsigned char* rgb,
+                                         int pitch,
+                                         unsigned char* packet_buffer);
+
+  NANOSTREAM_DEF void nanostream_decode_tile_with_basis(const nanostream_basis* basis,
+                                         const unsigned char* packet_buffer,
+                                         int pitch,
+                                         unsigned char* rgb);
+
+  NANOSTREAM_DEF int nanostream_conceal_tile_with_basis(const nanostream_basis* basis,
+                                         const unsigned char* const* neighbours,
+                                         int pitch,
+                                         unsigned char* rgb);
+
+  NANOSTREAM_DEF void nanostream_decode_tile_half_with_basis(const nanostream_basis* basis,
+                                              const unsigned char* packet_buffer,
+                                              int pitch,
+                                              unsigned char* rgb);
+
+  /* Encodes a tile with whichever of 'bases', a bank of up to NANOSTREAM_MAX_BASES such as one trained with
+   * nanostream_basis_bank_train, suits it best, and records its index in the packet, in the lowest bits of the first
+   * lower eigenvalue bound. A null entry stands for the built-in basis. The choice costs about 7% of encoding the tile
+   * per basis; with a single basis there is none, and the packet is that of nanostream_encode_tile_with_basis. */
+  NANOSTREAM_DEF void nanostream_encode_tile_with_bases(const nanostream_basis* const* bases,
+                                         int num_bases,
+                                         const unsigned char* rgb,
+                                         int pitch,
+                                         unsigned char* packet_buffer);
+
+  /* Decode a packet with the basis it names, of the same bases it was encoded with, at the same cost as with one. A
+   * packet that names a basis beyond 'num_bases' is decoded with the first. */
+  NANOSTREAM_DEF void nanostream_decode_tile_with_bases(const nanostream_basis* const* bases,
+                                         int num_bases,
+                                         const unsigned char* packet_buffer,
+                                         int pitch,
+                                         unsigned char* rgb);
+
+  NANOSTREAM_DEF void nanostream_decode_tile_half_with_bases(const nanostream_basis* const* bases,
+                                              int num_bases,
+                                              const unsigned char* packet_buffer,
+                                              int pitch,
+                                              unsigned char* rgb);
+
+  /* Conceals a lost tile from neighbours that may name different bases. Neighbours of the same basis are blended as
+   * nanostream_conceal_tile blends them, and those of different bases after reconstruction. */
+  NANOSTREAM_DEF int nanostream_conceal_tile_with_bases(const nanostream_basis* const* bases,
+                                         int num_bases,
+                                         const unsigned char* const* neighbours,
+                                         int pitch,
+                                         unsigned char* rgb);
+
+  /* The index of the basis nanostream_encode_tile_with_bases encodes a tile with: the one that leaves the least error
+   * on a sample of its blocks, counting both what the eigenvalues do not capture and their quantization. */
+  NANOSTREAM_DEF int nanostream_choose_basis(const nanostream_basis* const* bases, int num_bases, const unsigned char* rgb, int pitch);
+
+  /* The index of the basis a packet encoded with several was encoded with. */
+  NANOSTREAM_DEF int nanostream_packet_basis(const unsigned char* packet_buffer);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NANOSTREAM_SINGLE_H */
+
+#if defined(NANOSTREAM_IMPLEMENTATION) && !defined(NANOSTREAM_SINGLE_IMPLEMENTATION)
+#define NANOSTREAM_SINGLE_IMPLEMENTATION
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Internal: the basis rearranged for the kernels in nanostream.c, generated by basis_layouts.py (see there for the
+ * layouts). All of them are in the interleaved order of packed RGB pixels. */
+
+/* The number of consecutive values the encoder processes at once, sized for 256-bit vectors of floats. */
+#define NANOSTREAM_BASIS_LANES 8
+
+#define NANOSTREAM_BASIS_GROUPS (192 / NANOSTREAM_BASIS_LANES)
+
+/* A basis built at run time, in the same layouts (see nanostream_basis.h). */
+struct nanostream_basis
+{
+  float aosoa[NANOSTREAM_BASIS_GROUPS][8 * NANOSTREAM_BASIS_LANES];
+  float mean_projection[8];
+  float interleaved[8][192];
+  float mean_interleaved[192];
+  float half[8][48];
+  float mean_half[48];
+
+  /* The mean and the basis vectors it was built from, in the planar order and units of nanostream_eigen.c. */
+  float mean[192];
+  float vectors[8][192];
+};
+
+static const float nanostream__basis_aosoa[NANOSTREAM_BASIS_GROUPS][8 * NANOSTREAM_BASIS_LANES] = {
+  { 2.667380314e-04f, 2.784879769e-04f, 2.828597438e-04f, 2.695216852e-04f, 2.813235802e-04f, 2.855541367e-04f, 2.712732729e-04f, 2.831050286e-04f, 3.460168546e-04f, -1.373220727e-07f, -3.343088370e-04f, 3.498765184e-04f, 9.804130898e-07f, -3.355520613e-04f, 3.523480074e-04f, 1.643528573e-06f, -3.488271552e-04f, -3.496984933e-04f, -3.362335411e-04f, -3.797653551e-04f, -3.814128392e-04f, -3.663184012e-04f, -3.980599780e-04f, -4.000693561e-04f, -3.397154750e-04f, -3.458724302e-04f, -3.293312648e-04f, -2.988398660e-04f, -3.046931882e-04f, -2.891955422e-04f, -2.022984127e-04f, -2.068979191e-04f, -1.986497758e-04f, 3.798535057e-04f, -2.077765325e-04f, -1.983121330e-04f, 3.869827179e-04f, -2.061584563e-04f, -1.981506161e-04f, 3.914825472e-04f, 3.819151836e-04f, 3.896770232e-04f, 3.611536587e-04f, 3.790612022e-04f, 3.868829970e-04f, 3.582066181e-04f, 3.470585335e-04f, 3.549216717e-04f, -2.283363950e-04f, -2.344282235e-04f, -2.174871225e-04f, -5.368668514e-05f, -5.829026741e-05f, -4.925213243e-05f, 2.084031117e-04f, 2.074970480e-04f, 4.375249439e-04f, 4.452850306e-04f, 4.234879333e-04f, 4.290445176e-04f, 4.370633294e-04f, 4.151316541e-04f, 3.040876459e-04f, 3.098958847e-04f },
+  { 2.872545929e-04f, 2.721829742e-04f, 2.840266508e-04f, 2.880996349e-04f, 2.722092411e-04f, 2.840581478e-04f, 2.881336446e-04f, 2.713289331e-04f, -3.364322524e-04f, 3.534900791e-04f, 1.791280845e-06f, -3.370429955e-04f, 3.532909295e-04f, 1.638825051e-06f, -3.371017236e-04f, 3.521979440e-04f, -3.838440075e-04f, -4.076761067e-04f, -4.098100404e-04f, -3.932468737e-04f, -4.070254518e-04f, -4.091331478e-04f, -3.926647059e-04f, -3.968833710e-04f, -1.952712881e-04f, -7.092759161e-05f, -7.380982678e-05f, -6.856789776e-05f, 7.456520608e-05f, 7.404838416e-05f, 7.165816486e-05f, 2.073424120e-04f, -2.052566292e-04f, -1.976561167e-04f, 3.942070639e-04f, -2.046722407e-04f, -1.973536377e-04f, 3.943017008e-04f, -2.045298762e-04f, -1.969560689e-04f, 3.272545688e-04f, 3.237610354e-04f, 3.315085289e-04f, 3.052475405e-04f, 3.227113801e-04f, 3.301832314e-04f, 3.047907762e-04f, 3.456525358e-04f, 2.024452184e-04f, 3.908354278e-04f, 3.932225353e-04f, 3.769452665e-04f, 3.898798835e-04f, 3.925854671e-04f, 3.742030146e-04f, 2.020971009e-04f, 2.936002963e-04f, 1.061041200e-04f, 1.087032916e-04f, 1.006115301e-04f, -1.186490789e-04f, -1.196850384e-04f, -1.162981724e-04f, -3.112791216e-04f },
+  { 2.831744797e-04f, 2.872691435e-04f, 2.694993919e-04f, 2.813135584e-04f, 2.854878704e-04f, 2.667673955e-04f, 2.785261063e-04f, 2.828203288e-04f, 1.418709472e-06f, -3.365797739e-04f, 3.494444431e-04f, 5.160602765e-07f, -3.358539997e-04f, 3.452511979e-04f, -8.299930235e-07f, -3.348118534e-04f, -3.987031533e-04f, -3.826737112e-04f, -3.775983464e-04f, -3.790408665e-04f, -3.638632742e-04f, -3.466189200e-04f, -3.474476583e-04f, -3.336803586e-04f, 2.087537272e-04f, 1.999564031e-04f, 3.036388287e-04f, 3.069072670e-04f, 2.926169073e-04f, 3.423314176e-04f, 3.461696646e-04f, 3.300419625e-04f, 3.925795063e-04f, -2.044542309e-04f, -1.965466083e-04f, 3.884397009e-04f, -2.050040399e-04f, -1.958839887e-04f, 3.820918647e-04f, -2.053764813e-04f, 3.535314518e-04f, 3.274182771e-04f, 3.779759302e-04f, 3.864182269e-04f, 3.584104426e-04f, 3.808864776e-04f, 3.892619528e-04f, 3.613469355e-04f, 2.025405420e-04f, 1.931924154e-04f, -6.519416529e-05f, -6.970397251e-05f, -6.382707871e-05f, -2.393180249e-04f, -2.464845776e-04f, -2.305987857e-04f, -3.154766326e-04f, -3.023267084e-04f, -4.306001992e-04f, -4.369165675e-04f, -4.171906733e-04f, -4.316596424e-04f, -4.375586031e-04f, -4.169620722e-04f },
+  { 2.700085149e-04f, 2.817353197e-04f, 2.858933865e-04f, 2.730135824e-04f, 2.848013067e-04f, 2.888139849e-04f, 2.749257228e-04f, 2.867417885e-04f, 3.502827065e-04f, 9.527901306e-07f, -3.357963527e-04f, 3.546526619e-04f, 2.341035653e-06f, -3.370429663e-04f, 3.572866905e-04f, 3.030395144e-06f, -3.091328284e-04f, -3.099001798e-04f, -2.977883407e-04f, -3.395610288e-04f, -3.407958091e-04f, -3.271386320e-04f, -3.576949823e-04f, -3.593467906e-04f, -3.763688253e-04f, -3.829826619e-04f, -3.647666936e-04f, -3.341313086e-04f, -3.407785705e-04f, -3.234768323e-04f, -2.270875608e-04f, -2.324253905e-04f, -1.987128135e-04f, 3.878314413e-04f, -2.071070759e-04f, -1.980794557e-04f, 3.959147953e-04f, -2.054408631e-04f, -1.980768845e-04f, 4.007998925e-04f, 2.230947362e-04f, 2.300173190e-04f, 2.083366408e-04f, 1.921594435e-04f, 1.989311593e-04f, 1.780128508e-04f, 1.383702691e-04f, 1.446576680e-04f, -3.038294175e-04f, -3.107249445e-04f, -2.897591275e-04f, -1.079418642e-04f, -1.130759935e-04f, -1.007509290e-04f, 1.960028328e-04f, 1.953650047e-04f, 4.454404992e-04f, 4.528349522e-04f, 4.299599749e-04f, 4.450498843e-04f, 4.535136271e-04f, 4.299952118e-04f, 3.167046636e-04f, 3.232829127e-04f },
+  { 2.906619626e-04f, 2.759487605e-04f, 2.877854249e-04f, 2.916394788e-04f, 2.759173805e-04f, 2.877601514e-04f, 2.916053522e-04f, 2.748967094e-04f, -3.380926509e-04f, 3.582902983e-04f, 3.131091887e-06f, -3.388697902e-04f, 3.582794584e-04f, 3.144507269e-06f, -3.388499805e-04f, 3.569858039e-04f, -3.446853628e-04f, -3.665834373e-04f, -3.683795824e-04f, -3.534033310e-04f, -3.658830827e-04f, -3.676817113e-04f, -3.527940196e-04f, -3.558366030e-04f, -2.195979596e-04f, -7.934883675e-05f, -8.260725322e-05f, -7.711889259e-05f, 8.400678635e-05f, 8.349670643e-05f, 8.045811863e-05f, 2.316892585e-04f, -2.047506618e-04f, -1.970845402e-04f, 4.040691490e-04f, -2.041112997e-04f, -1.967929596e-04f, 4.039415835e-04f, -2.039203311e-04f, -1.966265925e-04f, 1.259431097e-04f, 1.023139731e-04f, 1.080626220e-04f, 9.185569545e-05f, 1.021565979e-04f, 1.077460746e-04f, 9.236747729e-05f, 1.374368136e-04f, 1.913315233e-04f, 4.100058886e-04f, 4.132660875e-04f, 3.961870776e-04f, 4.100067357e-04f, 4.137630557e-04f, 3.944948314e-04f, 1.901937174e-04f, 3.058622865e-04f, 1.117569047e-04f, 1.145549630e-04f, 1.066665877e-04f, -1.225717074e-04f, -1.234072096e-04f, -1.194567292e-04f, -3.217134698e-04f },
+  { 2.867059380e-04f, 2.905824021e-04f, 2.729376449e-04f, 2.847134775e-04f, 2.886914447e-04f, 2.699804656e-04f, 2.816918726e-04f, 2.858011162e-04f, 2.697613045e-06f, -3.384835287e-04f, 3.540239498e-04f, 1.771406467e-06f, -3.375356396e-04f, 3.496505758e-04f, 4.918438349e-07f, -3.362143449e-04f, -3.576084679e-04f, -3.432135956e-04f, -3.373900465e-04f, -3.386765134e-04f, -3.252495738e-04f, -3.071910026e-04f, -3.079350380e-04f, -2.958520370e-04f, 2.335551176e-04f, 2.234799020e-04f, 3.387806755e-04f, 3.424513574e-04f, 3.264611551e-04f, 3.787653119e-04f, 3.830778833e-04f, 3.649761572e-04f, 4.017852102e-04f, -2.038449195e-04f, -1.965437742e-04f, 3.968746929e-04f, -2.047415896e-04f, -1.960478869e-04f, 3.897446920e-04f, -2.053829093e-04f, 1.438665478e-04f, 1.270620846e-04f, 1.918912811e-04f, 1.993057336e-04f, 1.801317229e-04f, 2.216881105e-04f, 2.291086696e-04f, 2.087899429e-04f, 1.908203404e-04f, 1.825425116e-04f, -1.195108774e-04f, -1.243705551e-04f, -1.156952744e-04f, -3.162708937e-04f, -3.244601336e-04f, -3.046917857e-04f, -3.261498961e-04f, -3.114345904e-04f, -4.411759914e-04f, -4.473376800e-04f, -4.254523447e-04f, -4.355732718e-04f, -4.409614145e-04f, -4.185607329e-04f },
+  { 2.721126173e-04f, 2.838127461e-04f, 2.878080104e-04f, 2.752574343e-04f, 2.870113534e-04f, 2.908675986e-04f, 2.772431163e-04f, 2.890322431e-04f, 3.530947601e-04f, 1.809549148e-06f, -3.367045054e-04f, 3.575424938e-04f, 3.135328720e-06f, -3.381481650e-04f, 3.604266573e-04f, 3.981261114e-06f, -2.102293074e-04f, -2.103920661e-04f, -2.026725049e-04f, -2.313812135e-04f, -2.319107599e-04f, -2.231342682e-04f, -2.438538361e-04f, -2.444408542e-04f, -3.992874541e-04f, -4.061419588e-04f, -3.866809548e-04f, -3.564617213e-04f, -3.632944589e-04f, -3.448557036e-04f, -2.426958113e-04f, -2.482127325e-04f, -1.980381561e-04f, 3.930881325e-04f, -2.066550448e-04f, -1.983484217e-04f, 4.008631494e-04f, -2.060964704e-04f, -1.976622086e-04f, 4.067079400e-04f, -3.406855405e-05f, -2.890273783e-05f, -3.792047501e-05f, -1.096969434e-04f, -1.057191587e-04f, -1.113255965e-04f, -1.909814045e-04f, -1.882552955e-04f, -3.972499686e-04f, -4.052499055e-04f, -3.790536347e-04f, -1.985812304e-04f, -2.045217098e-04f, -1.870664604e-04f, 1.241715954e-04f, 1.229146824e-04f, 3.231962230e-04f, 3.285702245e-04f, 3.109418002e-04f, 3.261049296e-04f, 3.314869076e-04f, 3.133712154e-04f, 2.334361421e-04f, 2.380748151e-04f },
+  { 2.927946109e-04f, 2.782888856e-04f, 2.900983773e-04f, 2.937970500e-04f, 2.782690175e-04f, 2.900832132e-04f, 2.937569045e-04f, 2.771947606e-04f, -3.391613563e-04f, 3.615532436e-04f, 4.107102424e-06f, -3.398760277e-04f, 3.614806369e-04f, 3.941980757e-06f, -3.400232278e-04f, 3.599941438e-04f, -2.352080509e-04f, -2.501996417e-04f, -2.509742391e-04f, -2.414416156e-04f, -2.500613823e-04f, -2.508869358e-04f, -2.412250959e-04f, -2.433349251e-04f, -2.347466408e-04f, -8.531692710e-05f, -8.855015039e-05f, -8.282094608e-05f, 8.884371788e-05f, 8.835519353e-05f, 8.496818149e-05f, 2.459789608e-04f, -2.045374875e-04f, -1.964927158e-04f, 4.103004349e-04f, -2.031188093e-04f, -1.958500959e-04f, 4.107888714e-04f, -2.026666613e-04f, -1.957184398e-04f, -1.897961047e-04f, -2.435397576e-04f, -2.413761528e-04f, -2.396190722e-04f, -2.437470152e-04f, -2.418884898e-04f, -2.394773066e-04f, -1.911713212e-04f, 1.230559659e-04f, 3.534062236e-04f, 3.560526991e-04f, 3.421454161e-04f, 3.544335564e-04f, 3.579405301e-04f, 3.414424027e-04f, 1.213708710e-04f, 2.246292637e-04f, 8.237409388e-05f, 8.456814376e-05f, 7.888538871e-05f, -8.761562114e-05f, -8.818282216e-05f, -8.487685345e-05f, -2.326866867e-04f },
+  { 2.889593150e-04f, 2.926992143e-04f, 2.751454127e-04f, 2.868721298e-04f, 2.907026924e-04f, 2.720935380e-04f, 2.837476777e-04f, 2.877266384e-04f, 3.497071984e-06f, -3.395482021e-04f, 3.568952282e-04f, 2.480834933e-06f, -3.386035269e-04f, 3.524848644e-04f, 1.161787362e-06f, -3.371452584e-04f, -2.438593437e-04f, -2.347143404e-04f, -2.301488145e-04f, -2.302746270e-04f, -2.218708542e-04f, -2.085288658e-04f, -2.083512644e-04f, -2.011388394e-04f, 2.481164301e-04f, 2.370567152e-04f, 3.585472411e-04f, 3.624971006e-04f, 3.454609536e-04f, 4.006166082e-04f, 4.051872035e-04f, 3.857971699e-04f, 4.085614694e-04f, -2.026550180e-04f, -1.960157325e-04f, 4.030978565e-04f, -2.039483219e-04f, -1.960663819e-04f, 3.949032988e-04f, -2.051312257e-04f, -1.884267903e-04f, -1.884365053e-04f, -1.102268842e-04f, -1.059322892e-04f, -1.100008540e-04f, -3.611597725e-05f, -3.089740434e-05f, -3.806468391e-05f, 1.213874668e-04f, 1.164347006e-04f, -2.068913304e-04f, -2.122925485e-04f, -1.990992211e-04f, -4.082819412e-04f, -4.172473561e-04f, -3.923923361e-04f, -2.357424036e-04f, -2.246885469e-04f, -3.198060919e-04f, -3.236595906e-04f, -3.072410822e-04f, -3.136654987e-04f, -3.168919215e-04f, -3.000632513e-04f },
+  { 2.731220103e-04f, 2.847621546e-04f, 2.886691514e-04f, 2.763451607e-04f, 2.880344204e-04f, 2.917882566e-04f, 2.783805424e-04f, 2.901195311e-04f, 3.544256091e-04f, 2.109991414e-06f, -3.371511020e-04f, 3.589044307e-04f, 3.434598273e-06f, -3.386816265e-04f, 3.617095012e-04f, 4.091683557e-06f, -7.539590200e-05f, -7.464502227e-05f, -7.332453831e-05f, -8.339663494e-05f, -8.284430584e-05f, -8.102515894e-05f, -8.766220918e-05f, -8.691462376e-05f, -4.115031922e-04f, -4.185839902e-04f, -3.983255988e-04f, -3.677892335e-04f, -3.744911329e-04f, -3.556955679e-04f, -2.511051356e-04f, -2.564988884e-04f, -1.980280905e-04f, 3.961163992e-04f, -2.062034958e-04f, -1.980979799e-04f, 4.037376714e-04f, -2.056044545e-04f, -1.972373064e-04f, 4.100984220e-04f, -2.172017215e-04f, -2.135968968e-04f, -2.121114556e-04f, -3.235435077e-04f, -3.216693799e-04f, -3.153497682e-04f, -4.237421588e-04f, -4.235779247e-04f, -4.655107565e-04f, -4.742889427e-04f, -4.443618890e-04f, -2.685988358e-04f, -2.752470912e-04f, -2.539086868e-04f, 6.472971655e-05f, 6.250138667e-05f, 1.225000211e-04f, 1.240169739e-04f, 1.154057024e-04f, 1.235096624e-04f, 1.248935420e-04f, 1.164591269e-04f, 8.686707153e-05f, 8.812703047e-05f },
+  { 2.937605276e-04f, 2.794214616e-04f, 2.911930283e-04f, 2.947757057e-04f, 2.794650255e-04f, 2.912268919e-04f, 2.947897888e-04f, 2.784144353e-04f, -3.398249839e-04f, 3.631411522e-04f, 4.474509635e-06f, -3.403919585e-04f, 3.630481806e-04f, 4.297560627e-06f, -3.405364413e-04f, 3.613494775e-04f, -8.501663949e-05f, -9.023078953e-05f, -8.919666357e-05f, -8.728330333e-05f, -8.928420059e-05f, -8.836008753e-05f, -8.621903902e-05f, -8.691002196e-05f, -2.425671646e-04f, -8.955500729e-05f, -9.258524608e-05f, -8.652260635e-05f, 9.051615408e-05f, 9.030312592e-05f, 8.704301482e-05f, 2.524307545e-04f, -2.038194560e-04f, -1.963832069e-04f, 4.137017565e-04f, -2.027967397e-04f, -1.963323676e-04f, 4.137419604e-04f, -2.028561690e-04f, -1.960744753e-04f, -4.119888533e-04f, -4.858295416e-04f, -4.869096710e-04f, -4.717106329e-04f, -4.859237110e-04f, -4.870228322e-04f, -4.714752235e-04f, -4.237480898e-04f, 6.620614408e-05f, 3.022711943e-04f, 3.044268080e-04f, 2.933523234e-04f, 3.042935449e-04f, 3.073052156e-04f, 2.933033541e-04f, 6.619439114e-05f, 8.165054753e-05f, 2.821961820e-05f, 2.889048454e-05f, 2.648448571e-05f, -3.590408859e-05f, -3.593925240e-05f, -3.395019209e-05f, -8.830584439e-05f },
+  { 2.901361853e-04f, 2.937568169e-04f, 2.763016551e-04f, 2.879763058e-04f, 2.916975641e-04f, 2.730733039e-04f, 2.846893435e-04f, 2.885655445e-04f, 3.724071590e-06f, -3.401825825e-04f, 3.582612849e-04f, 2.720503949e-06f, -3.391337745e-04f, 3.537445092e-04f, 1.357201094e-06f, -3.377192453e-04f, -8.592171706e-05f, -8.398825486e-05f, -8.237703757e-05f, -8.087779816e-05f, -7.925681478e-05f, -7.413114404e-05f, -7.289752510e-05f, -7.155876533e-05f, 2.546388145e-04f, 2.434399344e-04f, 3.687322140e-04f, 3.728095807e-04f, 3.550851754e-04f, 4.121670827e-04f, 4.168529427e-04f, 3.967400275e-04f, 4.113288486e-04f, -2.026371365e-04f, -1.962693737e-04f, 4.054532333e-04f, -2.037574994e-04f, -1.957827047e-04f, 3.974930620e-04f, -2.048760653e-04f, -4.235007016e-04f, -4.108185863e-04f, -3.235971811e-04f, -3.218794570e-04f, -3.139007910e-04f, -2.176751255e-04f, -2.143305306e-04f, -2.113425995e-04f, 6.559236231e-05f, 6.322672263e-05f, -2.712440549e-04f, -2.774994163e-04f, -2.608592019e-04f, -4.714293514e-04f, -4.811089122e-04f, -4.525457525e-04f, -8.854745502e-05f, -8.322639647e-05f, -1.176424398e-04f, -1.176310959e-04f, -1.103598916e-04f, -1.139141838e-04f, -1.134858777e-04f, -1.065161006e-04f },
+  { 2.730386514e-04f, 2.846047282e-04f, 2.884595125e-04f, 2.762790696e-04f, 2.879077313e-04f, 2.915924086e-04f, 2.783525808e-04f, 2.900123304e-04f, 3.541750943e-04f, 1.863041075e-06f, -3.370938932e-04f, 3.586694890e-04f, 3.168513706e-06f, -3.386256157e-04f, 3.614336544e-04f, 3.794390781e-06f, 7.336407024e-05f, 7.507725820e-05f, 6.912803533e-05f, 8.094329024e-05f, 8.299441314e-05f, 7.657671675e-05f, 8.588274027e-05f, 8.822645918e-05f, -4.116405169e-04f, -4.186437702e-04f, -3.982840800e-04f, -3.678950025e-04f, -3.747926039e-04f, -3.557269187e-04f, -2.513853358e-04f, -2.566702518e-04f, -1.985109612e-04f, 3.960498114e-04f, -2.068528942e-04f, -1.984020805e-04f, 4.039210141e-04f, -2.058454735e-04f, -1.977215357e-04f, 4.097983824e-04f, -2.183337130e-04f, -2.148699673e-04f, -2.126186356e-04f, -3.257721955e-04f, -3.240198773e-04f, -3.163629303e-04f, -4.253715863e-04f, -4.251054690e-04f, -4.687342867e-04f, -4.773292765e-04f, -4.471788220e-04f, -2.714694131e-04f, -2.781972581e-04f, -2.568870783e-04f, 6.323694890e-05f, 6.118185600e-05f, -1.094982393e-04f, -1.125954822e-04f, -1.105817218e-04f, -1.117552028e-04f, -1.154405010e-04f, -1.129240528e-04f, -8.435269780e-05f, -8.698679945e-05f },
+  { 2.935964395e-04f, 2.794310451e-04f, 2.911203340e-04f, 2.946568763e-04f, 2.794590943e-04f, 2.911385952e-04f, 2.946599734e-04f, 2.784038876e-04f, -3.398719956e-04f, 3.629032303e-04f, 4.222163220e-06f, -3.404212056e-04f, 3.626851182e-04f, 3.999555667e-06f, -3.406160018e-04f, 3.609334721e-04f, 8.156268180e-05f, 8.832089165e-05f, 9.096930278e-05f, 8.412181016e-05f, 8.914896525e-05f, 9.187442416e-05f, 8.505617141e-05f, 8.734728337e-05f, -2.426773164e-04f, -9.002800957e-05f, -9.288555561e-05f, -8.693627427e-05f, 8.998272173e-05f, 8.980449945e-05f, 8.667329071e-05f, 2.518216769e-04f, -2.043974312e-04f, -1.969269970e-04f, 4.133080443e-04f, -2.034660940e-04f, -1.964763099e-04f, 4.137840341e-04f, -2.032535187e-04f, -1.968412423e-04f, -4.124173345e-04f, -4.865717071e-04f, -4.877180737e-04f, -4.713160443e-04f, -4.872848004e-04f, -4.881393090e-04f, -4.711365290e-04f, -4.248387090e-04f, 6.471263133e-05f, 3.024886052e-04f, 3.047795272e-04f, 2.935224012e-04f, 3.055989450e-04f, 3.083748853e-04f, 2.944366897e-04f, 6.993913329e-05f, -8.475659231e-05f, -3.598682655e-05f, -3.656313627e-05f, -3.524634476e-05f, 2.408026005e-05f, 2.535633633e-05f, 2.527652016e-05f, 8.003115655e-05f },
+  { 2.900639293e-04f, 2.936204859e-04f, 2.762796540e-04f, 2.879013325e-04f, 2.915553310e-04f, 2.730080018e-04f, 2.845764745e-04f, 2.883899738e-04f, 3.265063780e-06f, -3.403552315e-04f, 3.579118088e-04f, 2.275777561e-06f, -3.392881330e-04f, 3.534085610e-04f, 9.823094039e-07f, -3.377483464e-04f, 8.996565114e-05f, 8.327889384e-05f, 8.286064600e-05f, 8.555021796e-05f, 7.889374506e-05f, 7.573803706e-05f, 7.811737996e-05f, 7.174302843e-05f, 2.541625616e-04f, 2.427890458e-04f, 3.690416030e-04f, 3.729495348e-04f, 3.551847210e-04f, 4.117966576e-04f, 4.163545722e-04f, 3.961523373e-04f, 4.106580043e-04f, -2.035399424e-04f, -1.967585408e-04f, 4.054124447e-04f, -2.039515505e-04f, -1.964942644e-04f, 3.971334475e-04f, -2.052587914e-04f, -4.244235800e-04f, -4.103394992e-04f, -3.244041520e-04f, -3.226221192e-04f, -3.133968687e-04f, -2.178440199e-04f, -2.143713189e-04f, -2.107565456e-04f, 6.884803227e-05f, 6.676433133e-05f, -2.674446094e-04f, -2.738507647e-04f, -2.571775925e-04f, -4.684074835e-04f, -4.780436557e-04f, -4.495218690e-04f, 8.298046157e-05f, 8.058663384e-05f, 1.182601221e-04f, 1.222399082e-04f, 1.183768844e-04f, 1.207650146e-04f, 1.255919098e-04f, 1.210660181e-04f },
+  { 2.719658847e-04f, 2.834291727e-04f, 2.872787854e-04f, 2.751301024e-04f, 2.866577284e-04f, 2.903329099e-04f, 2.771256309e-04f, 2.886919414e-04f, 3.523428066e-04f, 1.084088353e-06f, -3.368300842e-04f, 3.565427719e-04f, 2.156494542e-06f, -3.383864959e-04f, 3.592451121e-04f, 2.726709799e-06f, 2.076449347e-04f, 2.103634471e-04f, 1.980482509e-04f, 2.293914264e-04f, 2.326951892e-04f, 2.190849798e-04f, 2.428317479e-04f, 2.466446921e-04f, -3.996460753e-04f, -4.064173384e-04f, -3.864595703e-04f, -3.565294193e-04f, -3.630993413e-04f, -3.443914009e-04f, -2.434501461e-04f, -2.484280397e-04f, -1.994687845e-04f, 3.923282902e-04f, -2.082389067e-04f, -1.999151911e-04f, 3.997448027e-04f, -2.077162266e-04f, -1.990641741e-04f, 4.056249471e-04f, -3.726826798e-05f, -3.207753248e-05f, -3.852343150e-05f, -1.128735349e-04f, -1.086924225e-04f, -1.114273188e-04f, -1.942084993e-04f, -1.908318815e-04f, -4.067321035e-04f, -4.145048122e-04f, -3.872408002e-04f, -2.089458207e-04f, -2.145435442e-04f, -1.964282025e-04f, 1.197745622e-04f, 1.185745001e-04f, -3.097237325e-04f, -3.166258627e-04f, -3.043842374e-04f, -3.168934116e-04f, -3.247263093e-04f, -3.114071255e-04f, -2.314609932e-04f, -2.374941374e-04f },
+  { 2.922701777e-04f, 2.781725689e-04f, 2.897635102e-04f, 2.933013381e-04f, 2.782044750e-04f, 2.897958253e-04f, 2.933325721e-04f, 2.771807067e-04f, -3.395035863e-04f, 3.606296930e-04f, 3.081418610e-06f, -3.400509264e-04f, 3.605696208e-04f, 2.983841570e-06f, -3.402251531e-04f, 3.589810986e-04f, 2.321641235e-04f, 2.501027257e-04f, 2.541729048e-04f, 2.391972962e-04f, 2.508468196e-04f, 2.550204011e-04f, 2.400193583e-04f, 2.445779887e-04f, -2.347728785e-04f, -8.734075318e-05f, -9.006906812e-05f, -8.419984404e-05f, 8.689467522e-05f, 8.678064482e-05f, 8.369969094e-05f, 2.433157581e-04f, -2.058989569e-04f, -1.982867425e-04f, 4.089141592e-04f, -2.048811930e-04f, -1.982219809e-04f, 4.089555612e-04f, -2.050656606e-04f, -1.978889546e-04f, -1.895052837e-04f, -2.447914113e-04f, -2.422649486e-04f, -2.377545571e-04f, -2.447243122e-04f, -2.421758631e-04f, -2.373365795e-04f, -1.935957986e-04f, 1.187703408e-04f, 3.525949869e-04f, 3.552874806e-04f, 3.410278290e-04f, 3.572492623e-04f, 3.608296023e-04f, 3.441244072e-04f, 1.308321369e-04f, -2.273002384e-04f, -9.063759855e-05f, -9.292314451e-05f, -8.783165878e-05f, 7.763611627e-05f, 7.984785765e-05f, 7.804618310e-05f, 2.255235525e-04f },
+  { 2.887542341e-04f, 2.923353045e-04f, 2.750860418e-04f, 2.866276631e-04f, 2.902809019e-04f, 2.719083253e-04f, 2.834065580e-04f, 2.872105615e-04f, 2.484336066e-06f, -3.398178255e-04f, 3.560517056e-04f, 1.577179144e-06f, -3.388146559e-04f, 3.515539508e-04f, 1.798896775e-07f, -3.374038082e-04f, 2.486963190e-04f, 2.340519107e-04f, 2.321735901e-04f, 2.359871625e-04f, 2.219360103e-04f, 2.104501222e-04f, 2.138698364e-04f, 2.007396052e-04f, 2.454623288e-04f, 2.343293791e-04f, 3.570918067e-04f, 3.607886095e-04f, 3.436357367e-04f, 4.000697357e-04f, 4.043073047e-04f, 3.846313439e-04f, 4.065151600e-04f, -2.050919714e-04f, -1.982378317e-04f, 4.010160471e-04f, -2.059672977e-04f, -1.982168094e-04f, 3.928029655e-04f, -2.071173314e-04f, -1.899508285e-04f, -1.877750398e-04f, -1.125865123e-04f, -1.078619530e-04f, -1.094234340e-04f, -3.713884701e-05f, -3.156668927e-05f, -3.702843598e-05f, 1.305275980e-04f, 1.252671521e-04f, -1.986027787e-04f, -2.039657212e-04f, -1.910812276e-04f, -4.009430898e-04f, -4.094370149e-04f, -3.845329962e-04f, 2.313393004e-04f, 2.225845614e-04f, 3.209525756e-04f, 3.287236188e-04f, 3.147150956e-04f, 3.218043961e-04f, 3.302042975e-04f, 3.152477098e-04f },
+  { 2.697521565e-04f, 2.811595505e-04f, 2.850541882e-04f, 2.727613145e-04f, 2.842172980e-04f, 2.879473216e-04f, 2.746838273e-04f, 2.861735283e-04f, 3.492103780e-04f, -2.625630241e-08f, -3.357584278e-04f, 3.531451611e-04f, 9.963783098e-07f, -3.373001720e-04f, 3.556305287e-04f, 1.505812443e-06f, 3.070952261e-04f, 3.106862015e-04f, 2.933828270e-04f, 3.376986758e-04f, 3.421079295e-04f, 3.232758711e-04f, 3.563346232e-04f, 3.613617490e-04f, -3.773102865e-04f, -3.835047869e-04f, -3.642723841e-04f, -3.363434006e-04f, -3.421364169e-04f, -3.242646070e-04f, -2.284311196e-04f, -2.329656160e-04f, -1.999330579e-04f, 3.866494286e-04f, -2.095442923e-04f, -2.007647034e-04f, 3.932777282e-04f, -2.094460031e-04f, -2.000772193e-04f, 3.987991635e-04f, 2.224344249e-04f, 2.309523523e-04f, 2.117919717e-04f, 1.911009205e-04f, 1.996006598e-04f, 1.816703262e-04f, 1.361285793e-04f, 1.444245524e-04f, -3.170594281e-04f, -3.234327132e-04f, -3.009804031e-04f, -1.228030552e-04f, -1.267666910e-04f, -1.134253381e-04f, 1.880878473e-04f, 1.879145702e-04f, -4.359176055e-04f, -4.458124145e-04f, -4.263905333e-04f, -4.425999580e-04f, -4.527916510e-04f, -4.325688176e-04f, -3.209195593e-04f, -3.280644908e-04f },
+  { 2.897979874e-04f, 2.756726800e-04f, 2.871734839e-04f, 2.907518078e-04f, 2.756836367e-04f, 2.871704160e-04f, 2.907670596e-04f, 2.747063835e-04f, -3.384011925e-04f, 3.569008673e-04f, 1.755675333e-06f, -3.390065303e-04f, 3.569395811e-04f, 1.750279711e-06f, -3.390476984e-04f, 3.554244836e-04f, 3.414928621e-04f, 3.673292550e-04f, 3.724571536e-04f, 3.518182857e-04f, 3.678527825e-04f, 3.731063476e-04f, 3.522051024e-04f, 3.584319762e-04f, -2.201043069e-04f, -8.176070655e-05f, -8.411419157e-05f, -7.865858427e-05f, 8.109017624e-05f, 8.092676745e-05f, 7.811303376e-05f, 2.283223558e-04f, -2.080277485e-04f, -1.992439669e-04f, 4.019111686e-04f, -2.067718436e-04f, -1.993898814e-04f, 4.017370004e-04f, -2.067817631e-04f, -1.995894108e-04f, 1.294722160e-04f, 1.000029857e-04f, 1.076670327e-04f, 9.507149749e-05f, 9.950590776e-05f, 1.069125957e-04f, 9.456322180e-05f, 1.350297647e-04f, 1.844031115e-04f, 4.067019506e-04f, 4.101874490e-04f, 3.927723157e-04f, 4.121175875e-04f, 4.164682882e-04f, 3.967876820e-04f, 2.009299602e-04f, -3.128803536e-04f, -1.210760398e-04f, -1.238514395e-04f, -1.173239859e-04f, 1.107599732e-04f, 1.135398579e-04f, 1.094010312e-04f, 3.131238561e-04f },
+  { 2.861896566e-04f, 2.898098791e-04f, 2.727611976e-04f, 2.842312642e-04f, 2.879363649e-04f, 2.697720539e-04f, 2.811858759e-04f, 2.850602947e-04f, 1.221189307e-06f, -3.387675858e-04f, 3.525049955e-04f, 3.220235265e-07f, -3.379281537e-04f, 3.484781758e-04f, -7.551041882e-07f, -3.363149715e-04f, 3.635524242e-04f, 3.429469233e-04f, 3.404122942e-04f, 3.452095331e-04f, 3.255551644e-04f, 3.093580989e-04f, 3.133606677e-04f, 2.952422582e-04f, 2.302936771e-04f, 2.197530047e-04f, 3.357832631e-04f, 3.391666740e-04f, 3.228472728e-04f, 3.772928726e-04f, 3.810849552e-04f, 3.623825955e-04f, 3.987957157e-04f, -2.077256786e-04f, -1.997745797e-04f, 3.936257141e-04f, -2.082739244e-04f, -1.995580745e-04f, 3.865102635e-04f, -2.087934198e-04f, 1.430892185e-04f, 1.288852709e-04f, 1.886081170e-04f, 1.971703096e-04f, 1.800659387e-04f, 2.192711421e-04f, 2.278932462e-04f, 2.088850474e-04f, 2.015006455e-04f, 1.926190275e-04f, -1.090602986e-04f, -1.129330154e-04f, -1.048857310e-04f, -3.071215223e-04f, -3.141357618e-04f, -2.940818667e-04f, 3.205636845e-04f, 3.070363227e-04f, 4.452273251e-04f, 4.551095122e-04f, 4.340937910e-04f, 4.462588067e-04f, 4.568378129e-04f, 4.342168863e-04f },
+  { 2.664189128e-04f, 2.777466879e-04f, 2.817501332e-04f, 2.691590026e-04f, 2.805157619e-04f, 2.843564924e-04f, 2.709214009e-04f, 2.823067646e-04f, 3.444354908e-04f, -1.639534500e-06f, -3.341872610e-04f, 3.480234859e-04f, -6.656809573e-07f, -3.356708323e-04f, 3.504716298e-04f, -1.129569593e-07f, 3.470401846e-04f, 3.507750291e-04f, 3.316516093e-04f, 3.783067944e-04f, 3.827398314e-04f, 3.619841209e-04f, 3.976599843e-04f, 4.027561231e-04f, -3.408855667e-04f, -3.461825205e-04f, -3.288526161e-04f, -3.009243923e-04f, -3.057976856e-04f, -2.897745546e-04f, -2.037823200e-04f, -2.077757874e-04f, -1.990200258e-04f, 3.795747371e-04f, -2.094808309e-04f, -1.995934575e-04f, 3.857965271e-04f, -2.093129444e-04f, -1.998688076e-04f, 3.899148574e-04f, 3.803732641e-04f, 3.913190727e-04f, 3.648573862e-04f, 3.773253338e-04f, 3.886620496e-04f, 3.620158808e-04f, 3.439938613e-04f, 3.553669242e-04f, -2.425920876e-04f, -2.476789788e-04f, -2.288643198e-04f, -6.840929533e-05f, -7.146239718e-05f, -6.096973722e-05f, 1.990565190e-04f, 1.990573664e-04f, -4.326313733e-04f, -4.419751318e-04f, -4.222627655e-04f, -4.319862992e-04f, -4.415569937e-04f, -4.208947220e-04f, -3.110208348e-04f, -3.172166207e-04f },
+  { 2.860667367e-04f, 2.718536877e-04f, 2.832632731e-04f, 2.869606602e-04f, 2.718453606e-04f, 2.832426160e-04f, 2.869364678e-04f, 2.709981565e-04f, -3.365686127e-04f, 3.516632552e-04f, 7.468207675e-08f, -3.370692917e-04f, 3.514135293e-04f, -1.500488496e-07f, -3.373770737e-04f, 3.500297081e-04f, 3.809200198e-04f, 4.077341333e-04f, 4.131075800e-04f, 3.906075569e-04f, 4.086290506e-04f, 4.142149408e-04f, 3.914277051e-04f, 3.988675918e-04f, -1.961179516e-04f, -7.252514945e-05f, -7.473443655e-05f, -7.000996494e-05f, 7.164013008e-05f, 7.126957325e-05f, 6.867378365e-05f, 2.025583211e-04f, -2.088984876e-04f, -1.998286183e-04f, 3.922677800e-04f, -2.083249098e-04f, -1.997168742e-04f, 3.923681729e-04f, -2.078756398e-04f, -2.000873287e-04f, 3.305134820e-04f, 3.208868644e-04f, 3.318580342e-04f, 3.087456320e-04f, 3.193379909e-04f, 3.301871173e-04f, 3.075110269e-04f, 3.425946715e-04f, 1.948559693e-04f, 3.857479960e-04f, 3.885404152e-04f, 3.725751650e-04f, 3.911430637e-04f, 3.946083435e-04f, 3.763708122e-04f, 2.110141749e-04f, -3.024035517e-04f, -1.163085886e-04f, -1.184995925e-04f, -1.129894061e-04f, 1.069672406e-04f, 1.089389929e-04f, 1.042969379e-04f, 3.056107783e-04f },
+  { 2.823903572e-04f, 2.861246175e-04f, 2.692362549e-04f, 2.806021302e-04f, 2.844267324e-04f, 2.664651064e-04f, 2.777921511e-04f, 2.817589863e-04f, -6.314414420e-07f, -3.370432585e-04f, 3.476645140e-04f, -1.142039215e-06f, -3.360224705e-04f, 3.438952799e-04f, -2.240820779e-06f, -3.346593649e-04f, 4.041136188e-04f, 3.817387656e-04f, 3.793538201e-04f, 3.843195590e-04f, 3.627600623e-04f, 3.488480460e-04f, 3.529923804e-04f, 3.329045048e-04f, 2.039806224e-04f, 1.946724513e-04f, 2.999169862e-04f, 3.024013019e-04f, 2.878624435e-04f, 3.396889158e-04f, 3.426365700e-04f, 3.257705885e-04f, 3.894392182e-04f, -2.086474031e-04f, -1.998693482e-04f, 3.854067010e-04f, -2.089414380e-04f, -1.993032501e-04f, 3.791533556e-04f, -2.091500397e-04f, 3.536442331e-04f, 3.297410467e-04f, 3.746548120e-04f, 3.858625304e-04f, 3.599366136e-04f, 3.777527342e-04f, 3.886657895e-04f, 3.622978633e-04f, 2.113603932e-04f, 2.024690602e-04f, -5.377869616e-05f, -5.718106220e-05f, -5.126801847e-05f, -2.322997387e-04f, -2.383649495e-04f, -2.221566351e-04f, 3.120309290e-04f, 2.975733549e-04f, 4.350659894e-04f, 4.445487376e-04f, 4.225838420e-04f, 4.426014188e-04f, 4.524353380e-04f, 4.297999192e-04f },
+};
+
+static const float nanostream__mean_projection[8] = {
+  6.103981904e+00f, 4.958044292e-01f, 1.228390050e-03f, 1.350174013e-04f, 1.923992454e-02f, 6.720505107e-02f, -3.512344672e-02f, 2.625587125e-04f
+};
+
+static const float nanostream__basis_interleaved[8][192] = {
+  { 1.734464049e+01f, 1.810868070e+01f, 1.839295484e+01f, 1.752564758e+01f, 1.829306580e+01f, 1.856815774e+01f, 1.763954457e+01f, 1.840890449e+01f, 1.867872991e+01f, 1.769869789e+01f, 1.846883297e+01f, 1.873367876e+01f, 1.770040590e+01f, 1.847088106e+01f, 1.873589024e+01f, 1.764316387e+01f, 1.841342054e+01f, 1.867967606e+01f, 1.752419796e+01f, 1.829241414e+01f, 1.856384877e+01f, 1.734654989e+01f, 1.811116006e+01f, 1.839039188e+01f, 1.755730368e+01f, 1.831983917e+01f, 1.859021746e+01f, 1.775270820e+01f, 1.851920497e+01f, 1.878012937e+01f, 1.787704512e+01f, 1.864538480e+01f, 1.890029412e+01f, 1.794356815e+01f, 1.871324725e+01f, 1.896385711e+01f, 1.794152767e+01f, 1.871160384e+01f, 1.896163803e+01f, 1.787515853e+01f, 1.864305362e+01f, 1.889512070e+01f, 1.774777036e+01f, 1.851349387e+01f, 1.877216119e+01f, 1.755547978e+01f, 1.831701402e+01f, 1.858421758e+01f, 1.769412294e+01f, 1.845492382e+01f, 1.871471588e+01f, 1.789861467e+01f, 1.866291326e+01f, 1.891366560e+01f, 1.802773364e+01f, 1.879432160e+01f, 1.903896958e+01f, 1.809573479e+01f, 1.886364698e+01f, 1.910415318e+01f, 1.809444286e+01f, 1.886266094e+01f, 1.910154272e+01f, 1.802458931e+01f, 1.878957946e+01f, 1.903276641e+01f, 1.789133046e+01f, 1.865386024e+01f, 1.890294258e+01f, 1.769288231e+01f, 1.845069274e+01f, 1.870942466e+01f, 1.775975872e+01f, 1.851665910e+01f, 1.877071157e+01f, 1.796934407e+01f, 1.872943819e+01f, 1.897353139e+01f, 1.810169477e+01f, 1.886502251e+01f, 1.910177831e+01f, 1.816938054e+01f, 1.893482666e+01f, 1.916779026e+01f, 1.817221329e+01f, 1.893702865e+01f, 1.916870602e+01f, 1.810389865e+01f, 1.886610545e+01f, 1.910153702e+01f, 1.796651512e+01f, 1.872565929e+01f, 1.896763410e+01f, 1.775659159e+01f, 1.851192456e+01f, 1.876397453e+01f, 1.775433831e+01f, 1.850642245e+01f, 1.875707980e+01f, 1.796504650e+01f, 1.872120023e+01f, 1.896079637e+01f, 1.809987657e+01f, 1.885805178e+01f, 1.909110848e+01f, 1.817000370e+01f, 1.893009972e+01f, 1.916006338e+01f, 1.817182761e+01f, 1.893128715e+01f, 1.916026477e+01f, 1.810321279e+01f, 1.886140700e+01f, 1.909267209e+01f, 1.796508450e+01f, 1.872078415e+01f, 1.895838540e+01f, 1.775234532e+01f, 1.850458525e+01f, 1.875255804e+01f, 1.768458165e+01f, 1.842998196e+01f, 1.868030302e+01f, 1.789033491e+01f, 1.863991879e+01f, 1.887889747e+01f, 1.802009415e+01f, 1.877219349e+01f, 1.900486831e+01f, 1.808817130e+01f, 1.884187225e+01f, 1.907191951e+01f, 1.809024599e+01f, 1.884397354e+01f, 1.907395050e+01f, 1.802367546e+01f, 1.877624407e+01f, 1.900910318e+01f, 1.788746987e+01f, 1.863796379e+01f, 1.887551565e+01f, 1.768083885e+01f, 1.842851143e+01f, 1.867586676e+01f, 1.754063398e+01f, 1.828239977e+01f, 1.853564858e+01f, 1.773630448e+01f, 1.848122981e+01f, 1.872377459e+01f, 1.786131587e+01f, 1.860843368e+01f, 1.884411413e+01f, 1.792561602e+01f, 1.867345579e+01f, 1.890613631e+01f, 1.792632848e+01f, 1.867325630e+01f, 1.890712805e+01f, 1.786278259e+01f, 1.860948242e+01f, 1.884488739e+01f, 1.773629688e+01f, 1.848213796e+01f, 1.872306213e+01f, 1.754192781e+01f, 1.828411158e+01f, 1.853604566e+01f, 1.732388981e+01f, 1.806047838e+01f, 1.832080241e+01f, 1.750206415e+01f, 1.824053742e+01f, 1.849028092e+01f, 1.761666410e+01f, 1.835699737e+01f, 1.860148955e+01f, 1.767728604e+01f, 1.841919433e+01f, 1.865961693e+01f, 1.767674457e+01f, 1.841785111e+01f, 1.865804382e+01f, 1.762165513e+01f, 1.836243298e+01f, 1.860525325e+01f, 1.750708748e+01f, 1.824615352e+01f, 1.849484827e+01f, 1.732689355e+01f, 1.806343462e+01f, 1.832137808e+01f },
+  { 2.249974597e+01f, -8.929367778e-03f, -2.173843212e+01f, 2.275072061e+01f, 6.375136116e-02f, -2.181927279e+01f, 2.291142918e+01f, 1.068704455e-01f, -2.187650721e+01f, 2.298569240e+01f, 1.164780370e-01f, -2.191622078e+01f, 2.297274269e+01f, 1.065645990e-01f, -2.192003958e+01f, 2.290167131e+01f, 9.225158340e-02f, -2.188609980e+01f, 2.272262491e+01f, 3.355681948e-02f, -2.183890633e+01f, 2.244995914e+01f, -5.397029636e-02f, -2.177114077e+01f, 2.277713299e+01f, 6.195517824e-02f, -2.183515783e+01f, 2.306128934e+01f, 1.522258433e-01f, -2.191621888e+01f, 2.323256705e+01f, 1.970514443e-01f, -2.198447462e+01f, 2.329782665e+01f, 2.035992500e-01f, -2.203500811e+01f, 2.329712178e+01f, 2.044715852e-01f, -2.203371998e+01f, 2.321300190e+01f, 1.754122882e-01f, -2.200989146e+01f, 2.302040733e+01f, 1.151857055e-01f, -2.194825497e+01f, 2.273602869e+01f, 3.198214536e-02f, -2.186233777e+01f, 2.295998678e+01f, 1.176659334e-01f, -2.189421046e+01f, 2.324920066e+01f, 2.038747500e-01f, -2.198808443e+01f, 2.343674339e+01f, 2.588815039e-01f, -2.205396719e+01f, 2.350999966e+01f, 2.670643351e-01f, -2.210043870e+01f, 2.350527842e+01f, 2.563272987e-01f, -2.211001039e+01f, 2.340861920e+01f, 2.273971058e-01f, -2.207912184e+01f, 2.320711222e+01f, 1.613162915e-01f, -2.201769434e+01f, 2.292032830e+01f, 7.554522324e-02f, -2.192287043e+01f, 2.304652523e+01f, 1.372021917e-01f, -2.192325041e+01f, 2.333776060e+01f, 2.233347527e-01f, -2.202277277e+01f, 2.352016032e+01f, 2.660617233e-01f, -2.209711958e+01f, 2.361325342e+01f, 2.909549890e-01f, -2.213398710e+01f, 2.360720795e+01f, 2.794488798e-01f, -2.214338210e+01f, 2.349674977e+01f, 2.421577551e-01f, -2.212037243e+01f, 2.329594005e+01f, 1.769007693e-01f, -2.205217369e+01f, 2.300223671e+01f, 8.825200114e-02f, -2.196019393e+01f, 2.303023551e+01f, 1.211442459e-01f, -2.191953041e+01f, 2.332248352e+01f, 2.060326038e-01f, -2.201913066e+01f, 2.350222338e+01f, 2.467302605e-01f, -2.210017651e+01f, 2.359778255e+01f, 2.745461634e-01f, -2.213588890e+01f, 2.358359981e+01f, 2.600711072e-01f, -2.214855552e+01f, 2.346969902e+01f, 2.123107723e-01f, -2.213159893e+01f, 2.327321537e+01f, 1.479824359e-01f, -2.206221085e+01f, 2.298039168e+01f, 6.387466899e-02f, -2.196208622e+01f, 2.291109100e+01f, 7.049284512e-02f, -2.190237623e+01f, 2.318419374e+01f, 1.402260576e-01f, -2.200358190e+01f, 2.335991342e+01f, 1.773043047e-01f, -2.207622070e+01f, 2.344994579e+01f, 2.003692451e-01f, -2.211181149e+01f, 2.344603959e+01f, 1.940242981e-01f, -2.212314058e+01f, 2.334274594e+01f, 1.615439527e-01f, -2.209665410e+01f, 2.315226216e+01f, 1.025560738e-01f, -2.203142300e+01f, 2.285979565e+01f, 1.169732628e-02f, -2.193968263e+01f, 2.270740483e+01f, -1.707316064e-03f, -2.183269177e+01f, 2.296326410e+01f, 6.478949960e-02f, -2.193294369e+01f, 2.312487513e+01f, 9.791545409e-02f, -2.200453755e+01f, 2.320747890e+01f, 1.141627885e-01f, -2.204389963e+01f, 2.320999626e+01f, 1.138119382e-01f, -2.204657659e+01f, 2.311147705e+01f, 7.940783472e-02f, -2.202836227e+01f, 2.292163733e+01f, 2.093957981e-02f, -2.197377820e+01f, 2.265979338e+01f, -4.910064984e-02f, -2.186888102e+01f, 2.239691779e+01f, -1.066107309e-01f, -2.173052665e+01f, 2.263022717e+01f, -4.328590425e-02f, -2.182699587e+01f, 2.278941773e+01f, -7.345026278e-03f, -2.188537404e+01f, 2.286690317e+01f, 4.856202040e-03f, -2.191793069e+01f, 2.285066474e+01f, -9.756926448e-03f, -2.193794422e+01f, 2.276068177e+01f, -4.105947976e-02f, -2.191623788e+01f, 2.260688502e+01f, -7.426109995e-02f, -2.184986114e+01f, 2.236179057e+01f, -1.457093711e-01f, -2.176122520e+01f },
+  { -2.268248577e+01f, -2.273914453e+01f, -2.186358601e+01f, -2.469424222e+01f, -2.480136987e+01f, -2.381985404e+01f, -2.588385007e+01f, -2.601450988e+01f, -2.495945658e+01f, -2.650913884e+01f, -2.664789788e+01f, -2.557087796e+01f, -2.646683000e+01f, -2.660388294e+01f, -2.553302250e+01f, -2.580734120e+01f, -2.592567255e+01f, -2.488335807e+01f, -2.455333248e+01f, -2.464713234e+01f, -2.366020940e+01f, -2.253889527e+01f, -2.259278398e+01f, -2.169756532e+01f, -2.010136217e+01f, -2.015125919e+01f, -1.936368685e+01f, -2.207995590e+01f, -2.216024749e+01f, -2.127218954e+01f, -2.325911622e+01f, -2.336652506e+01f, -2.241316572e+01f, -2.383708801e+01f, -2.395388235e+01f, -2.298005160e+01f, -2.379154746e+01f, -2.390850328e+01f, -2.294043112e+01f, -2.313827511e+01f, -2.325349063e+01f, -2.231746405e+01f, -2.193878777e+01f, -2.202244028e+01f, -2.114935353e+01f, -1.997509494e+01f, -2.002347585e+01f, -1.923777871e+01f, -1.367016071e+01f, -1.368074410e+01f, -1.317877963e+01f, -1.504556341e+01f, -1.507999716e+01f, -1.450930579e+01f, -1.585659569e+01f, -1.589476654e+01f, -1.529440351e+01f, -1.626923170e+01f, -1.631959990e+01f, -1.569974106e+01f, -1.626024138e+01f, -1.631392300e+01f, -1.568566186e+01f, -1.582285350e+01f, -1.585695382e+01f, -1.526229998e+01f, -1.496542666e+01f, -1.497360762e+01f, -1.442715229e+01f, -1.355958950e+01f, -1.354804097e+01f, -1.307905303e+01f, -4.902618528e+00f, -4.853792573e+00f, -4.767928104e+00f, -5.422866187e+00f, -5.386950987e+00f, -5.268660960e+00f, -5.700235152e+00f, -5.651623410e+00f, -5.528206983e+00f, -5.867257089e+00f, -5.800013049e+00f, -5.675596799e+00f, -5.805705143e+00f, -5.745614692e+00f, -5.606393012e+00f, -5.651324178e+00f, -5.587059652e+00f, -5.461336272e+00f, -5.356566868e+00f, -5.259078825e+00f, -5.153674381e+00f, -4.820377641e+00f, -4.740161569e+00f, -4.653108716e+00f, 4.770498667e+00f, 4.881898714e+00f, 4.495050498e+00f, 5.263337448e+00f, 5.396711714e+00f, 4.979401006e+00f, 5.584525186e+00f, 5.736925508e+00f, 5.303613384e+00f, 5.743065979e+00f, 5.915278914e+00f, 5.470020705e+00f, 5.796911466e+00f, 5.974134431e+00f, 5.530777546e+00f, 5.679757101e+00f, 5.850016465e+00f, 5.415210072e+00f, 5.388013506e+00f, 5.562902923e+00f, 5.130065772e+00f, 4.924865860e+00f, 5.079582632e+00f, 4.665090424e+00f, 1.350211188e+01f, 1.367888315e+01f, 1.287808752e+01f, 1.491617750e+01f, 1.513100468e+01f, 1.424600081e+01f, 1.579013441e+01f, 1.603807110e+01f, 1.509647213e+01f, 1.626292974e+01f, 1.652759314e+01f, 1.555380419e+01f, 1.631131444e+01f, 1.658270158e+01f, 1.560725877e+01f, 1.590368372e+01f, 1.617147814e+01f, 1.521922549e+01f, 1.509708770e+01f, 1.534506524e+01f, 1.443138907e+01f, 1.368451919e+01f, 1.390688611e+01f, 1.305309283e+01f, 1.996886708e+01f, 2.020237025e+01f, 1.907721832e+01f, 2.195885640e+01f, 2.224556811e+01f, 2.102101352e+01f, 2.317065887e+01f, 2.349754773e+01f, 2.220557336e+01f, 2.388558481e+01f, 2.421902642e+01f, 2.287698403e+01f, 2.391962718e+01f, 2.426124025e+01f, 2.290213678e+01f, 2.330703925e+01f, 2.363999639e+01f, 2.230012368e+01f, 2.213530943e+01f, 2.244724989e+01f, 2.116922457e+01f, 2.011601038e+01f, 2.037627742e+01f, 1.919812784e+01f, 2.256628800e+01f, 2.280914627e+01f, 2.156564590e+01f, 2.459939931e+01f, 2.488765754e+01f, 2.353801746e+01f, 2.585784048e+01f, 2.618921691e+01f, 2.476932429e+01f, 2.651291202e+01f, 2.686232039e+01f, 2.539925638e+01f, 2.657110401e+01f, 2.693432652e+01f, 2.545258652e+01f, 2.593636515e+01f, 2.627748806e+01f, 2.482256323e+01f, 2.466748215e+01f, 2.499037933e+01f, 2.358847305e+01f, 2.268384419e+01f, 2.295332953e+01f, 2.164711542e+01f },
+  { -2.208999876e+01f, -2.249035478e+01f, -2.141476549e+01f, -1.943206228e+01f, -1.981267456e+01f, -1.880494013e+01f, -1.315445429e+01f, -1.345353719e+01f, -1.269751551e+01f, -4.612066644e+00f, -4.799483987e+00f, -4.458627552e+00f, 4.848602525e+00f, 4.814996180e+00f, 4.659572170e+00f, 1.348244034e+01f, 1.357421111e+01f, 1.300216511e+01f, 1.974411484e+01f, 1.995664504e+01f, 1.902741440e+01f, 2.226010043e+01f, 2.250968244e+01f, 2.146097861e+01f, -2.447338287e+01f, -2.490344759e+01f, -2.371895425e+01f, -2.172688834e+01f, -2.215912655e+01f, -2.103408102e+01f, -1.476636864e+01f, -1.511346102e+01f, -1.427935733e+01f, -5.159658109e+00f, -5.371536640e+00f, -5.014655991e+00f, 5.462541283e+00f, 5.429373336e+00f, 5.231789164e+00f, 1.506559404e+01f, 1.518692152e+01f, 1.453178063e+01f, 2.202921342e+01f, 2.226789951e+01f, 2.122813661e+01f, 2.462921441e+01f, 2.490963936e+01f, 2.373257462e+01f, -2.596366670e+01f, -2.640938087e+01f, -2.514392909e+01f, -2.317892343e+01f, -2.362322219e+01f, -2.242424212e+01f, -1.578129513e+01f, -1.614003293e+01f, -1.526440032e+01f, -5.547733185e+00f, -5.757973529e+00f, -5.385432019e+00f, 5.777062755e+00f, 5.745296459e+00f, 5.525056001e+00f, 1.599478192e+01f, 1.613377087e+01f, 1.541461291e+01f, 2.331453435e+01f, 2.357137397e+01f, 2.246359851e+01f, 2.605009495e+01f, 2.634729791e+01f, 2.508646097e+01f, -2.675799507e+01f, -2.721842396e+01f, -2.590112206e+01f, -2.391549491e+01f, -2.435128592e+01f, -2.312910430e+01f, -1.632811144e+01f, -1.667884022e+01f, -1.577292988e+01f, -5.823314349e+00f, -6.020355626e+00f, -5.626132478e+00f, 5.885812919e+00f, 5.871960763e+00f, 5.659972039e+00f, 1.641430981e+01f, 1.655788891e+01f, 1.582968174e+01f, 2.397681221e+01f, 2.424194299e+01f, 2.308941353e+01f, 2.680116456e+01f, 2.710586260e+01f, 2.579802028e+01f, -2.676692461e+01f, -2.722231116e+01f, -2.589842230e+01f, -2.392237254e+01f, -2.437088907e+01f, -2.313114289e+01f, -1.634633146e+01f, -1.668998312e+01f, -1.578009250e+01f, -5.854071322e+00f, -6.039883253e+00f, -5.653031235e+00f, 5.851126480e+00f, 5.839537577e+00f, 5.635930728e+00f, 1.637470454e+01f, 1.652692057e+01f, 1.578735771e+01f, 2.399693023e+01f, 2.425104350e+01f, 2.309588648e+01f, 2.677707766e+01f, 2.707345605e+01f, 2.575980573e+01f, -2.598698605e+01f, -2.642728743e+01f, -2.512953356e+01f, -2.318332549e+01f, -2.361053467e+01f, -2.239405084e+01f, -1.583034575e+01f, -1.615403328e+01f, -1.526610643e+01f, -5.679332475e+00f, -5.856741154e+00f, -5.475094859e+00f, 5.650326256e+00f, 5.642911430e+00f, 5.442572403e+00f, 1.582160717e+01f, 1.596118793e+01f, 1.523726787e+01f, 2.321989473e+01f, 2.346027933e+01f, 2.234491378e+01f, 2.601453456e+01f, 2.629008249e+01f, 2.501065314e+01f, -2.453460138e+01f, -2.493739877e+01f, -2.368681177e+01f, -2.187072963e+01f, -2.224742051e+01f, -2.108530607e+01f, -1.485373356e+01f, -1.514858918e+01f, -1.431228256e+01f, -5.316489943e+00f, -5.469525307e+00f, -5.114774442e+00f, 5.272888710e+00f, 5.262263053e+00f, 5.079300021e+00f, 1.484666118e+01f, 1.497484636e+01f, 1.428943913e+01f, 2.183430668e+01f, 2.205431297e+01f, 2.099314392e+01f, 2.453346904e+01f, 2.478004921e+01f, 2.356392827e+01f, -2.216608398e+01f, -2.251051839e+01f, -2.138364136e+01f, -1.956760861e+01f, -1.988449451e+01f, -1.884259041e+01f, -1.325094536e+01f, -1.351062058e+01f, -1.275256980e+01f, -4.715947843e+00f, -4.859606737e+00f, -4.552397970e+00f, 4.658399458e+00f, 4.634304001e+00f, 4.465512782e+00f, 1.317135483e+01f, 1.326383997e+01f, 1.265857615e+01f, 1.950210202e+01f, 1.966364466e+01f, 1.871825539e+01f, 2.208827175e+01f, 2.227994297e+01f, 2.118323252e+01f },
+  { -1.291720167e+01f, 2.469997421e+01f, -1.351066902e+01f, -1.289524645e+01f, 2.516355123e+01f, -1.340545362e+01f, -1.288474381e+01f, 2.545615263e+01f, -1.334681231e+01f, -1.285258899e+01f, 2.563331433e+01f, -1.330881245e+01f, -1.283292029e+01f, 2.563946809e+01f, -1.329955520e+01f, -1.280706838e+01f, 2.552748240e+01f, -1.329463636e+01f, -1.278044321e+01f, 2.525829155e+01f, -1.333038770e+01f, -1.273735637e+01f, 2.484552350e+01f, -1.335460570e+01f, -1.292130070e+01f, 2.521873947e+01f, -1.346713761e+01f, -1.288011661e+01f, 2.574435956e+01f, -1.335879212e+01f, -1.287994942e+01f, 2.606201301e+01f, -1.331391178e+01f, -1.281542223e+01f, 2.627459642e+01f, -1.327233726e+01f, -1.279646220e+01f, 2.626630147e+01f, -1.325991953e+01f, -1.278564418e+01f, 2.612608329e+01f, -1.325501589e+01f, -1.278025892e+01f, 2.580677691e+01f, -1.331332186e+01f, -1.274801385e+01f, 2.534314860e+01f, -1.335502367e+01f, -1.287743110e+01f, 2.556055582e+01f, -1.343774429e+01f, -1.289760612e+01f, 2.606612629e+01f, -1.340142298e+01f, -1.285298511e+01f, 2.644618380e+01f, -1.330005012e+01f, -1.277693885e+01f, 2.667978578e+01f, -1.320780057e+01f, -1.273515249e+01f, 2.671154636e+01f, -1.317839965e+01f, -1.272659155e+01f, 2.656670955e+01f, -1.317764254e+01f, -1.274592301e+01f, 2.621143812e+01f, -1.326173963e+01f, -1.274921648e+01f, 2.567858701e+01f, -1.333865795e+01f, -1.287677659e+01f, 2.575746886e+01f, -1.340838231e+01f, -1.288132114e+01f, 2.625304208e+01f, -1.336942965e+01f, -1.282535585e+01f, 2.666664989e+01f, -1.325336013e+01f, -1.276981803e+01f, 2.690095671e+01f, -1.318685800e+01f, -1.276651220e+01f, 2.690357097e+01f, -1.319072239e+01f, -1.274974275e+01f, 2.674665838e+01f, -1.317647980e+01f, -1.276241602e+01f, 2.636459650e+01f, -1.324933140e+01f, -1.273077037e+01f, 2.584698635e+01f, -1.332206614e+01f, -1.290817525e+01f, 2.575313898e+01f, -1.345060945e+01f, -1.290109528e+01f, 2.626496394e+01f, -1.338510191e+01f, -1.285684286e+01f, 2.664713981e+01f, -1.329094296e+01f, -1.280517798e+01f, 2.687535558e+01f, -1.323038276e+01f, -1.277587205e+01f, 2.690630682e+01f, -1.321656005e+01f, -1.279960178e+01f, 2.670303673e+01f, -1.323518475e+01f, -1.279422412e+01f, 2.636194422e+01f, -1.326194957e+01f, -1.277703954e+01f, 2.582360242e+01f, -1.334695291e+01f, -1.297045771e+01f, 2.551114707e+01f, -1.354073491e+01f, -1.299948530e+01f, 2.599340580e+01f, -1.350674763e+01f, -1.294414792e+01f, 2.637576218e+01f, -1.338857968e+01f, -1.289359543e+01f, 2.658964320e+01f, -1.332239958e+01f, -1.288938431e+01f, 2.659233537e+01f, -1.333439458e+01f, -1.286772927e+01f, 2.643364828e+01f, -1.333610544e+01f, -1.289041501e+01f, 2.607606846e+01f, -1.339302353e+01f, -1.288904803e+01f, 2.554201283e+01f, -1.346780447e+01f, -1.300064709e+01f, 2.514187910e+01f, -1.362561761e+01f, -1.305472484e+01f, 2.557288428e+01f, -1.361922635e+01f, -1.301002119e+01f, 2.593191561e+01f, -1.352700435e+01f, -1.295583895e+01f, 2.613427374e+01f, -1.344533913e+01f, -1.296532704e+01f, 2.612294845e+01f, -1.344598414e+01f, -1.297830144e+01f, 2.593169141e+01f, -1.350736225e+01f, -1.299034204e+01f, 2.559551206e+01f, -1.354301194e+01f, -1.297626380e+01f, 2.513282988e+01f, -1.357679213e+01f, -1.294127718e+01f, 2.468184728e+01f, -1.362149103e+01f, -1.297856458e+01f, 2.508641917e+01f, -1.361057421e+01f, -1.299646921e+01f, 2.535421360e+01f, -1.358362416e+01f, -1.299385591e+01f, 2.550721239e+01f, -1.354632726e+01f, -1.298658974e+01f, 2.551374045e+01f, -1.351711348e+01f, -1.301067855e+01f, 2.532328516e+01f, -1.356729738e+01f, -1.299650436e+01f, 2.506107073e+01f, -1.358641701e+01f, -1.295969384e+01f, 2.465444695e+01f, -1.359998133e+01f },
+  { 2.483403482e+01f, 2.533874843e+01f, 2.348401666e+01f, 2.464845467e+01f, 2.515706688e+01f, 2.329238534e+01f, 2.256748114e+01f, 2.307878170e+01f, 2.127972834e+01f, 2.105256133e+01f, 2.155634209e+01f, 1.984872132e+01f, 2.098430749e+01f, 2.147016462e+01f, 1.981902022e+01f, 2.247605614e+01f, 2.298838265e+01f, 2.129037347e+01f, 2.457788486e+01f, 2.512684520e+01f, 2.330563903e+01f, 2.476714320e+01f, 2.531175848e+01f, 2.349658448e+01f, 1.450673522e+01f, 1.495687617e+01f, 1.354709007e+01f, 1.249516781e+01f, 1.293549864e+01f, 1.157528562e+01f, 8.997526746e+00f, 9.406364859e+00f, 8.189450707e+00f, 6.652966103e+00f, 7.026771996e+00f, 5.972916597e+00f, 6.642732777e+00f, 7.006188500e+00f, 6.006195211e+00f, 8.936828802e+00f, 9.354922268e+00f, 8.262212053e+00f, 1.247773055e+01f, 1.295985533e+01f, 1.171306528e+01f, 1.441526938e+01f, 1.489779124e+01f, 1.357656604e+01f, -2.215307727e+00f, -1.879400527e+00f, -2.465778887e+00f, -7.133043743e+00f, -6.874388297e+00f, -7.238946911e+00f, -1.241856583e+01f, -1.224130059e+01f, -1.234149171e+01f, -1.583617274e+01f, -1.569548434e+01f, -1.558123017e+01f, -1.584964966e+01f, -1.572879905e+01f, -1.557201186e+01f, -1.243091516e+01f, -1.225245204e+01f, -1.225308375e+01f, -7.167503145e+00f, -6.888247104e+00f, -7.152805534e+00f, -2.348441421e+00f, -2.009103717e+00f, -2.475156071e+00f, -1.412354194e+01f, -1.388913821e+01f, -1.379254740e+01f, -2.103841659e+01f, -2.091655143e+01f, -2.050561868e+01f, -2.755383388e+01f, -2.754315455e+01f, -2.678957519e+01f, -3.159106594e+01f, -3.166130136e+01f, -3.067298391e+01f, -3.159718931e+01f, -3.166865966e+01f, -3.065767641e+01f, -2.755421954e+01f, -2.753813312e+01f, -2.671347857e+01f, -2.104190670e+01f, -2.093021169e+01f, -2.041139893e+01f, -1.415432504e+01f, -1.393684275e+01f, -1.374255253e+01f, -1.419714969e+01f, -1.397191962e+01f, -1.382552678e+01f, -2.118333701e+01f, -2.106939252e+01f, -2.057149954e+01f, -2.765978740e+01f, -2.764248312e+01f, -2.681743718e+01f, -3.163932525e+01f, -3.171386774e+01f, -3.064732578e+01f, -3.168569415e+01f, -3.174125857e+01f, -3.063565280e+01f, -2.762513705e+01f, -2.759814329e+01f, -2.668232594e+01f, -2.109437998e+01f, -2.097850330e+01f, -2.037863139e+01f, -1.416530740e+01f, -1.393949501e+01f, -1.370444438e+01f, -2.423369125e+00f, -2.085841550e+00f, -2.504986133e+00f, -7.339601610e+00f, -7.067724774e+00f, -7.245561407e+00f, -1.262840766e+01f, -1.240884310e+01f, -1.232258107e+01f, -1.591756152e+01f, -1.575327828e+01f, -1.545999007e+01f, -1.591319840e+01f, -1.574748550e+01f, -1.543281108e+01f, -1.258856680e+01f, -1.235155262e+01f, -1.221007196e+01f, -7.320937961e+00f, -7.013723495e+00f, -7.115258798e+00f, -2.414953527e+00f, -2.052623970e+00f, -2.407774050e+00f, 1.446379848e+01f, 1.501767671e+01f, 1.377177296e+01f, 1.242633736e+01f, 1.297903290e+01f, 1.181311296e+01f, 8.851760869e+00f, 9.391206522e+00f, 8.418930843e+00f, 6.502694144e+00f, 7.001048802e+00f, 6.182024124e+00f, 6.470371652e+00f, 6.951991535e+00f, 6.148973498e+00f, 8.780310453e+00f, 9.304376431e+00f, 8.380764740e+00f, 1.226424281e+01f, 1.282099938e+01f, 1.170878766e+01f, 1.425810602e+01f, 1.481875833e+01f, 1.358275021e+01f, 2.473377150e+01f, 2.544552270e+01f, 2.372485153e+01f, 2.453557983e+01f, 2.527274977e+01f, 2.354008265e+01f, 2.236820083e+01f, 2.310773425e+01f, 2.149163917e+01f, 2.086566836e+01f, 2.157906868e+01f, 2.007618472e+01f, 2.076495286e+01f, 2.147041730e+01f, 1.999590453e+01f, 2.227721851e+01f, 2.299571626e+01f, 2.144141156e+01f, 2.436192915e+01f, 2.509071104e+01f, 2.340487830e+01f, 2.456337154e+01f, 2.527299296e+01f, 2.355841856e+01f },
+  { -1.484757409e+01f, -1.524369523e+01f, -1.414210014e+01f, -3.490976701e+00f, -3.790324638e+00f, -3.202619911e+00f, 1.355141234e+01f, 1.349249555e+01f, 1.316400033e+01f, 2.541407369e+01f, 2.556929536e+01f, 2.451086596e+01f, 2.535193942e+01f, 2.552787000e+01f, 2.433255102e+01f, 1.314136399e+01f, 1.317019874e+01f, 1.256233681e+01f, -4.239250598e+00f, -4.532500812e+00f, -4.150355793e+00f, -1.556165457e+01f, -1.602765966e+01f, -1.499468604e+01f, -1.975650787e+01f, -2.020488951e+01f, -1.884158727e+01f, -7.018919717e+00f, -7.352766479e+00f, -6.551329160e+00f, 1.274508420e+01f, 1.270360943e+01f, 1.244133230e+01f, 2.666063291e+01f, 2.687262734e+01f, 2.576206472e+01f, 2.666068799e+01f, 2.690494270e+01f, 2.565202641e+01f, 1.236734647e+01f, 1.240809264e+01f, 1.186982682e+01f, -7.771194801e+00f, -8.087195345e+00f, -7.523085215e+00f, -2.056551486e+01f, -2.109802019e+01f, -1.981258336e+01f, -2.583117921e+01f, -2.635137510e+01f, -2.464796260e+01f, -1.291274451e+01f, -1.329902418e+01f, -1.216399658e+01f, 8.074257989e+00f, 7.992527225e+00f, 8.001714181e+00f, 2.298023969e+01f, 2.315232676e+01f, 2.224800568e+01f, 2.304704200e+01f, 2.327508297e+01f, 2.220229223e+01f, 7.892140885e+00f, 7.893220028e+00f, 7.571166408e+00f, -1.345310876e+01f, -1.380432296e+01f, -1.294642685e+01f, -2.654853322e+01f, -2.713150933e+01f, -2.551531165e+01f, -3.026983694e+01f, -3.084063850e+01f, -2.889463183e+01f, -1.746563930e+01f, -1.789794210e+01f, -1.651041236e+01f, 4.209049819e+00f, 4.064152668e+00f, 4.305054519e+00f, 1.965518441e+01f, 1.979535319e+01f, 1.907523483e+01f, 1.978668775e+01f, 1.998252164e+01f, 1.907205060e+01f, 4.304290284e+00f, 4.265143359e+00f, 4.111317639e+00f, -1.763764467e+01f, -1.804439955e+01f, -1.696236960e+01f, -3.065469357e+01f, -3.128410701e+01f, -2.942678756e+01f, -3.047944699e+01f, -3.103833620e+01f, -2.907780290e+01f, -1.765229858e+01f, -1.808977671e+01f, -1.670408226e+01f, 4.111982602e+00f, 3.978350186e+00f, 4.207938852e+00f, 1.966932155e+01f, 1.981828876e+01f, 1.908629414e+01f, 1.987157140e+01f, 2.005207691e+01f, 1.914574575e+01f, 4.547792142e+00f, 4.476843299e+00f, 4.341350645e+00f, -1.739058573e+01f, -1.780714598e+01f, -1.672297295e+01f, -3.045819662e+01f, -3.108478871e+01f, -2.923015953e+01f, -2.644775503e+01f, -2.695317541e+01f, -2.518033303e+01f, -1.358670199e+01f, -1.395069396e+01f, -1.277274387e+01f, 7.788340907e+00f, 7.710306868e+00f, 7.723041410e+00f, 2.292748902e+01f, 2.310256843e+01f, 2.217533458e+01f, 2.323013328e+01f, 2.346294489e+01f, 2.237668958e+01f, 8.507359700e+00f, 8.487557060e+00f, 8.145496566e+00f, -1.291414568e+01f, -1.326287102e+01f, -1.242505683e+01f, -2.607132441e+01f, -2.662364189e+01f, -2.500425808e+01f, -2.061678931e+01f, -2.103121217e+01f, -1.957125071e+01f, -7.985268663e+00f, -8.243004084e+00f, -7.375482609e+00f, 1.223041227e+01f, 1.221914492e+01f, 1.199081233e+01f, 2.644579434e+01f, 2.667243887e+01f, 2.554001983e+01f, 2.679794612e+01f, 2.708085044e+01f, 2.580111902e+01f, 1.306547066e+01f, 1.310257947e+01f, 1.252505226e+01f, -7.091645916e+00f, -7.343469327e+00f, -6.820194657e+00f, -1.997057699e+01f, -2.042667791e+01f, -1.912267339e+01f, -1.577455049e+01f, -1.610532560e+01f, -1.488190239e+01f, -4.448314429e+00f, -4.646842376e+00f, -3.964557162e+00f, 1.294365015e+01f, 1.294370525e+01f, 1.267050941e+01f, 2.508326344e+01f, 2.526484050e+01f, 2.422670011e+01f, 2.543407772e+01f, 2.565940754e+01f, 2.447351206e+01f, 1.372119673e+01f, 1.374370957e+01f, 1.316555064e+01f, -3.496959718e+00f, -3.718198569e+00f, -3.333702901e+00f, -1.510529051e+01f, -1.549968084e+01f, -1.444573520e+01f },
+  { 2.845005948e+01f, 2.895465911e+01f, 2.753730287e+01f, 2.789861976e+01f, 2.842004299e+01f, 2.699393581e+01f, 1.977329917e+01f, 2.015097991e+01f, 1.909135927e+01f, 6.899420406e+00f, 7.068431537e+00f, 6.542264746e+00f, -7.715156358e+00f, -7.782519619e+00f, -7.562288660e+00f, -2.024092488e+01f, -2.051386803e+01f, -1.965879422e+01f, -2.799977795e+01f, -2.841049980e+01f, -2.712782353e+01f, -2.806866824e+01f, -2.845224817e+01f, -2.711295874e+01f, 2.896476846e+01f, 2.944559276e+01f, 2.795814737e+01f, 2.893936873e+01f, 2.948972360e+01f, 2.796043864e+01f, 2.059372075e+01f, 2.102147140e+01f, 1.988869518e+01f, 7.266992731e+00f, 7.448936468e+00f, 6.935994867e+00f, -7.970225272e+00f, -8.024553805e+00f, -7.767673815e+00f, -2.091941837e+01f, -2.120789699e+01f, -2.025103424e+01f, -2.868746884e+01f, -2.908813264e+01f, -2.766503871e+01f, -2.832315200e+01f, -2.867351598e+01f, -2.721691166e+01f, 2.101583440e+01f, 2.136527885e+01f, 2.021899056e+01f, 2.120497305e+01f, 2.155493617e+01f, 2.037696328e+01f, 1.517918514e+01f, 1.548081485e+01f, 1.460651787e+01f, 5.356375455e+00f, 5.499043548e+00f, 5.129522401e+00f, -5.697205764e+00f, -5.734088011e+00f, -5.519117396e+00f, -1.513045181e+01f, -1.532914979e+01f, -1.461037276e+01f, -2.079539113e+01f, -2.104596488e+01f, -1.997835137e+01f, -2.039609905e+01f, -2.060589719e+01f, -1.951161292e+01f, 7.965563872e+00f, 8.064203729e+00f, 7.504255801e+00f, 8.031215797e+00f, 8.121202569e+00f, 7.572754724e+00f, 5.648531326e+00f, 5.730460156e+00f, 5.309326853e+00f, 1.834980673e+00f, 1.878603757e+00f, 1.722153684e+00f, -2.334663360e+00f, -2.336949888e+00f, -2.207611240e+00f, -5.742087532e+00f, -5.757798263e+00f, -5.411796430e+00f, -7.649699646e+00f, -7.648962010e+00f, -7.176151954e+00f, -7.407269804e+00f, -7.379419199e+00f, -6.926209443e+00f, -7.120123013e+00f, -7.321521230e+00f, -7.190576458e+00f, -7.266882061e+00f, -7.506518579e+00f, -7.342886535e+00f, -5.485034175e+00f, -5.656316634e+00f, -5.511297415e+00f, -2.340043397e+00f, -2.377517936e+00f, -2.291893568e+00f, 1.565818910e+00f, 1.648795770e+00f, 1.643605723e+00f, 5.204025955e+00f, 5.395804513e+00f, 5.240145866e+00f, 7.689864441e+00f, 7.948650028e+00f, 7.697456908e+00f, 7.852745074e+00f, 8.166613932e+00f, 7.872317826e+00f, -2.013978571e+01f, -2.058859672e+01f, -1.979258504e+01f, -2.060599409e+01f, -2.111532826e+01f, -2.024924833e+01f, -1.505075108e+01f, -1.544305628e+01f, -1.478019800e+01f, -5.893709846e+00f, -6.042327472e+00f, -5.711253612e+00f, 5.048288461e+00f, 5.192106943e+00f, 5.074953056e+00f, 1.466466900e+01f, 1.504283801e+01f, 1.447356110e+01f, 2.086994123e+01f, 2.137525331e+01f, 2.046434909e+01f, 2.092533085e+01f, 2.147153445e+01f, 2.049898233e+01f, -2.834554230e+01f, -2.898895225e+01f, -2.772604443e+01f, -2.878006227e+01f, -2.944277710e+01f, -2.812778737e+01f, -2.086779434e+01f, -2.133239351e+01f, -2.034504499e+01f, -7.872969491e+00f, -8.053439855e+00f, -7.628992182e+00f, 7.202167258e+00f, 7.382929259e+00f, 7.113802052e+00f, 2.036087874e+01f, 2.084465359e+01f, 1.996503688e+01f, 2.895090681e+01f, 2.959349603e+01f, 2.822694876e+01f, 2.901797890e+01f, 2.970587879e+01f, 2.823495303e+01f, -2.813185505e+01f, -2.873943294e+01f, -2.745763633e+01f, -2.808990911e+01f, -2.871224352e+01f, -2.736867930e+01f, -2.022412978e+01f, -2.062701076e+01f, -1.966379095e+01f, -7.562965973e+00f, -7.705436005e+00f, -7.347136130e+00f, 6.955544819e+00f, 7.083758013e+00f, 6.781908386e+00f, 1.987234086e+01f, 2.028981116e+01f, 1.934970740e+01f, 2.829016596e+01f, 2.890678167e+01f, 2.747851432e+01f, 2.878015726e+01f, 2.941960786e+01f, 2.794773975e+01f },
+};
+
+static const float nanostream__mean_interleaved[192] = {
+  1.199975762e+02f, 1.140646809e+02f, 1.038807334e+02f, 1.200097051e+02f, 1.140763083e+02f, 1.038892373e+02f, 1.200079876e+02f, 1.140719917e+02f, 1.038840620e+02f, 1.200096823e+02f, 1.140720753e+02f, 1.038870639e+02f, 1.199770269e+02f, 1.140429689e+02f, 1.038633607e+02f, 1.199779312e+02f, 1.140393819e+02f, 1.038585730e+02f, 1.199826734e+02f, 1.140459023e+02f, 1.038657166e+02f, 1.199769889e+02f, 1.140439644e+02f, 1.038601537e+02f, 1.199781364e+02f, 1.140311059e+02f, 1.038319972e+02f, 1.199873699e+02f, 1.140388879e+02f, 1.038329092e+02f, 1.199850369e+02f, 1.140325954e+02f, 1.038299225e+02f, 1.199900450e+02f, 1.140385004e+02f, 1.038335779e+02f, 1.199793295e+02f, 1.140321851e+02f, 1.038283950e+02f, 1.199833346e+02f, 1.140344953e+02f, 1.038292082e+02f, 1.199675122e+02f, 1.140199193e+02f, 1.038173756e+02f, 1.199491364e+02f, 1.140019919e+02f, 1.038016216e+02f, 1.199593426e+02f, 1.139979489e+02f, 1.037771509e+02f, 1.199594946e+02f, 1.139995448e+02f, 1.037725684e+02f, 1.199594946e+02f, 1.139931004e+02f, 1.037656528e+02f, 1.199708636e+02f, 1.139973334e+02f, 1.037742403e+02f, 1.199752106e+02f, 1.140048949e+02f, 1.037844086e+02f, 1.199644420e+02f, 1.139928192e+02f, 1.037724012e+02f, 1.199486804e+02f, 1.139833425e+02f, 1.037638669e+02f, 1.199345527e+02f, 1.139692453e+02f, 1.037511680e+02f, 1.199371974e+02f, 1.139554824e+02f, 1.037148115e+02f, 1.199456634e+02f, 1.139659318e+02f, 1.037255801e+02f, 1.199391049e+02f, 1.139505883e+02f, 1.037138540e+02f, 1.199373418e+02f, 1.139503223e+02f, 1.037093930e+02f, 1.199405184e+02f, 1.139483236e+02f, 1.037104569e+02f, 1.199429047e+02f, 1.139494027e+02f, 1.037119009e+02f, 1.199264440e+02f, 1.139360274e+02f, 1.037015350e+02f, 1.199169217e+02f, 1.139272043e+02f, 1.036915188e+02f, 1.199199539e+02f, 1.139147942e+02f, 1.036607632e+02f, 1.199179021e+02f, 1.139164205e+02f, 1.036618499e+02f, 1.199182440e+02f, 1.139139962e+02f, 1.036567126e+02f, 1.199182592e+02f, 1.139160177e+02f, 1.036533232e+02f, 1.199273255e+02f, 1.139167625e+02f, 1.036577462e+02f, 1.199325465e+02f, 1.139219758e+02f, 1.036641906e+02f, 1.199112372e+02f, 1.139042231e+02f, 1.036517805e+02f, 1.198952325e+02f, 1.138872608e+02f, 1.036350918e+02f, 1.199077110e+02f, 1.138799348e+02f, 1.036130758e+02f, 1.199097781e+02f, 1.138874053e+02f, 1.036140409e+02f, 1.198957872e+02f, 1.138710053e+02f, 1.035967442e+02f, 1.198920710e+02f, 1.138668560e+02f, 1.035932028e+02f, 1.199023989e+02f, 1.138776246e+02f, 1.036024667e+02f, 1.199065939e+02f, 1.138836890e+02f, 1.036108567e+02f, 1.198841371e+02f, 1.138586180e+02f, 1.035893726e+02f, 1.198716433e+02f, 1.138459647e+02f, 1.035751386e+02f, 1.198856570e+02f, 1.138449919e+02f, 1.035552429e+02f, 1.198909083e+02f, 1.138539366e+02f, 1.035624017e+02f, 1.198751771e+02f, 1.138374303e+02f, 1.035448162e+02f, 1.198724033e+02f, 1.138346337e+02f, 1.035434255e+02f, 1.198703666e+02f, 1.138276269e+02f, 1.035380146e+02f, 1.198657916e+02f, 1.138237739e+02f, 1.035333332e+02f, 1.198613079e+02f, 1.138177854e+02f, 1.035302402e+02f, 1.198628658e+02f, 1.138157791e+02f, 1.035311598e+02f, 1.198574017e+02f, 1.138027078e+02f, 1.034939218e+02f, 1.198520896e+02f, 1.138028066e+02f, 1.034892708e+02f, 1.198517172e+02f, 1.137995616e+02f, 1.034882525e+02f, 1.198488065e+02f, 1.137905257e+02f, 1.034787226e+02f, 1.198451132e+02f, 1.137858595e+02f, 1.034750444e+02f, 1.198461239e+02f, 1.137849931e+02f, 1.034804781e+02f, 1.198409106e+02f, 1.137803726e+02f, 1.034732433e+02f, 1.198296480e+02f, 1.137695964e+02f, 1.034654765e+02f
+};
+
+static const float nanostream__basis_half[8][48] = {
+  { 1.754507499e+01f, 1.831019766e+01f, 1.858286485e+01f, 1.778971394e+01f, 1.855909238e+01f, 1.881913997e+01f, 1.779006399e+01f, 1.855973977e+01f, 1.881808125e+01f, 1.754349950e+01f, 1.830852052e+01f, 1.857765486e+01f, 1.783046010e+01f, 1.859098359e+01f, 1.884315611e+01f, 1.809863593e+01f, 1.886445444e+01f, 1.910317283e+01f, 1.809878603e+01f, 1.886384362e+01f, 1.910113804e+01f, 1.782682987e+01f, 1.858553421e+01f, 1.883599397e+01f, 1.782357534e+01f, 1.857438086e+01f, 1.881926917e+01f, 1.809453643e+01f, 1.885055431e+01f, 1.908198992e+01f, 1.809724046e+01f, 1.885322794e+01f, 1.908399764e+01f, 1.782143463e+01f, 1.857296116e+01f, 1.881558146e+01f, 1.752572310e+01f, 1.826616135e+01f, 1.851762663e+01f, 1.777022051e+01f, 1.851452029e+01f, 1.875283923e+01f, 1.777187769e+01f, 1.851575570e+01f, 1.875382813e+01f, 1.752805143e+01f, 1.826895942e+01f, 1.851883354e+01f },
+  { 2.277222223e+01f, 6.725075374e-02f, -2.182727041e+01f, 2.310687882e+01f, 1.559997942e-01f, -2.195305268e+01f, 2.309613442e+01f, 1.446750139e-01f, -2.196243770e+01f, 2.273225502e+01f, 3.168859350e-02f, -2.185515996e+01f, 2.314836832e+01f, 1.705194069e-01f, -2.195707952e+01f, 2.352003920e+01f, 2.707406378e-01f, -2.209637814e+01f, 2.350446383e+01f, 2.513327599e-01f, -2.211322169e+01f, 2.310640432e+01f, 1.255035713e-01f, -2.198823310e+01f, 2.311200094e+01f, 1.344739381e-01f, -2.196115480e+01f, 2.347746628e+01f, 2.247374934e-01f, -2.210602440e+01f, 2.346052109e+01f, 2.069875326e-01f, -2.212498728e+01f, 2.306641622e+01f, 8.152762625e-02f, -2.199885068e+01f, 2.267445347e+01f, -2.170361289e-02f, -2.183078949e+01f, 2.299716873e+01f, 5.239735459e-02f, -2.196293548e+01f, 2.298320496e+01f, 3.560084168e-02f, -2.198228024e+01f, 2.263752658e+01f, -6.203288528e-02f, -2.186343639e+01f },
+  { -2.238951151e+01f, -2.246300527e+01f, -2.157982911e+01f, -2.487229829e+01f, -2.499570379e+01f, -2.398088797e+01f, -2.480099844e+01f, -2.492288735e+01f, -2.391856894e+01f, -2.225152762e+01f, -2.232145811e+01f, -2.143622674e+01f, -9.760302210e+00f, -9.750371205e+00f, -9.431168621e+00f, -1.092332991e+01f, -1.091650073e+01f, -1.054948709e+01f, -1.088503105e+01f, -1.087588779e+01f, -1.050392278e+01f, -9.675490167e+00f, -9.630222246e+00f, -9.328247106e+00f, 9.613031375e+00f, 9.772124563e+00f, 9.149634959e+00f, 1.084516383e+01f, 1.105446717e+01f, 1.035597760e+01f, 1.092291668e+01f, 1.114458265e+01f, 1.044311797e+01f, 9.773621564e+00f, 9.973609226e+00f, 9.319909523e+00f, 2.227335270e+01f, 2.253618554e+01f, 2.130047380e+01f, 2.485674904e+01f, 2.519202786e+01f, 2.381278451e+01f, 2.493353390e+01f, 2.527826281e+01f, 2.386935256e+01f, 2.240066154e+01f, 2.269180904e+01f, 2.140073522e+01f },
+  { -2.193058306e+01f, -2.234140087e+01f, -2.124318522e+01f, -9.423136921e+00f, -9.684504709e+00f, -9.112539094e+00f, 9.714794546e+00f, 9.751375538e+00f, 9.356326768e+00f, 2.216566077e+01f, 2.241096659e+01f, 2.136227606e+01f, -2.495402003e+01f, -2.540057824e+01f, -2.414959939e+01f, -1.087011353e+01f, -1.114930058e+01f, -1.051222367e+01f, 1.101799185e+01f, 1.107722925e+01f, 1.060733067e+01f, 2.503565152e+01f, 2.531661937e+01f, 2.410937332e+01f, -2.496490217e+01f, -2.540775558e+01f, -2.413828740e+01f, -1.092752025e+01f, -1.118516020e+01f, -1.054358125e+01f, 1.092444111e+01f, 1.099263938e+01f, 1.052578218e+01f, 2.500210930e+01f, 2.526871534e+01f, 2.405281478e+01f, -2.203475590e+01f, -2.239495805e+01f, -2.124958741e+01f, -9.534279176e+00f, -9.747085451e+00f, -9.183006194e+00f, 9.487326045e+00f, 9.533813345e+00f, 9.123207020e+00f, 2.198953738e+01f, 2.219448745e+01f, 2.111464002e+01f },
+  { -1.290346636e+01f, 2.520665612e+01f, -1.343551309e+01f, -1.285817611e+01f, 2.585651910e+01f, -1.331046845e+01f, -1.280552376e+01f, 2.588983381e+01f, -1.327728175e+01f, -1.276151808e+01f, 2.531343514e+01f, -1.333833473e+01f, -1.288328374e+01f, 2.590929826e+01f, -1.340424481e+01f, -1.280627446e+01f, 2.667339405e+01f, -1.323701721e+01f, -1.274449975e+01f, 2.673212132e+01f, -1.318081110e+01f, -1.274708147e+01f, 2.602540199e+01f, -1.329294878e+01f, -1.294480339e+01f, 2.588066395e+01f, -1.347079847e+01f, -1.287494105e+01f, 2.662197519e+01f, -1.330807624e+01f, -1.283314685e+01f, 2.665883180e+01f, -1.328056121e+01f, -1.283768167e+01f, 2.595090698e+01f, -1.336743262e+01f, -1.299380342e+01f, 2.512075746e+01f, -1.361922730e+01f, -1.298904631e+01f, 2.573190384e+01f, -1.352557372e+01f, -1.298522419e+01f, 2.572291637e+01f, -1.350943931e+01f, -1.298070101e+01f, 2.511096491e+01f, -1.357655060e+01f },
+  { 1.912109813e+01f, 1.959704753e+01f, 1.797469442e+01f, 1.481763383e+01f, 1.526706516e+01f, 1.382270424e+01f, 1.475998130e+01f, 1.520491451e+01f, 1.384445024e+01f, 1.905950700e+01f, 1.957406256e+01f, 1.802296371e+01f, -1.112757750e+01f, -1.088986962e+01f, -1.100072297e+01f, -2.184990960e+01f, -2.178531021e+01f, -2.134632024e+01f, -2.185799342e+01f, -2.179701097e+01f, -2.129906265e+01f, -1.117804407e+01f, -1.094110132e+01f, -1.094547827e+01f, -1.128586436e+01f, -1.104871962e+01f, -1.103689346e+01f, -2.196127046e+01f, -2.187961806e+01f, -2.131183353e+01f, -2.195314910e+01f, -2.185960999e+01f, -2.124021545e+01f, -1.124889472e+01f, -1.099608644e+01f, -1.090152715e+01f, 1.903987179e+01f, 1.967874552e+01f, 1.821245503e+01f, 1.464708105e+01f, 1.526976456e+01f, 1.404219471e+01f, 1.457321337e+01f, 1.518062538e+01f, 1.399176358e+01f, 1.886191238e+01f, 1.950086543e+01f, 1.806370868e+01f },
+  { -1.127849459e+01f, -1.164791897e+01f, -1.068440912e+01f, 1.959280079e+01f, 1.965950692e+01f, 1.896956583e+01f, 1.938033447e+01f, 1.950277602e+01f, 1.860418527e+01f, -1.203440371e+01f, -1.243634400e+01f, -1.162017760e+01f, -2.161984999e+01f, -2.209724497e+01f, -2.055425084e+01f, 1.372968298e+01f, 1.375108996e+01f, 1.340750230e+01f, 1.375754023e+01f, 1.385399200e+01f, 1.323920672e+01f, -2.207349506e+01f, -2.256608471e+01f, -2.121272392e+01f, -2.204155065e+01f, -2.250799557e+01f, -2.093374052e+01f, 1.362428352e+01f, 1.365237856e+01f, 1.329815224e+01f, 1.403921413e+01f, 1.411985554e+01f, 1.350232063e+01f, -2.170856311e+01f, -2.219461190e+01f, -2.084561185e+01f, -1.220623072e+01f, -1.250659606e+01f, -1.144829822e+01f, 1.917578005e+01f, 1.927503239e+01f, 1.860701042e+01f, 1.975467281e+01f, 1.989663675e+01f, 1.899130850e+01f, -1.141611828e+01f, -1.174700666e+01f, -1.093057654e+01f },
+  { 2.856320411e+01f, 2.907750462e+01f, 2.761245617e+01f, 1.363335826e+01f, 1.392245483e+01f, 1.311457851e+01f, -1.421143122e+01f, -1.438220961e+01f, -1.380994773e+01f, -2.826976676e+01f, -2.865609915e+01f, -2.728068316e+01f, 1.455439678e+01f, 1.477640533e+01f, 1.391824109e+01f, 7.004768149e+00f, 7.147230579e+00f, 6.691880202e+00f, -7.226102116e+00f, -7.289496489e+00f, -6.937224457e+00f, -1.406211491e+01f, -1.417006082e+01f, -1.339808142e+01f, -1.378319622e+01f, -1.413299120e+01f, -1.364382409e+01f, -7.192384625e+00f, -7.379804581e+00f, -7.073660649e+00f, 6.620700581e+00f, 6.819886309e+00f, 6.608066437e+00f, 1.433447040e+01f, 1.474051293e+01f, 1.413327654e+01f, -2.833684218e+01f, -2.897085145e+01f, -2.767003685e+01f, -1.413196490e+01f, -1.442957003e+01f, -1.374624106e+01f, 1.359773292e+01f, 1.390028800e+01f, 1.330261368e+01f, 2.875980223e+01f, 2.940644108e+01f, 2.797203896e+01f },
+};
+
+static const float nanostream__mean_half[48] = {
+  1.199931969e+02f, 1.140527458e+02f, 1.038587193e+02f, 1.199981879e+02f, 1.140537907e+02f, 1.038586566e+02f, 1.199794056e+02f, 1.140372578e+02f, 1.038448842e+02f, 1.199690777e+02f, 1.140279445e+02f, 1.038362169e+02f, 1.199504245e+02f, 1.139797270e+02f, 1.037475277e+02f, 1.199517012e+02f, 1.139728361e+02f, 1.037407850e+02f, 1.199557689e+02f, 1.139738601e+02f, 1.037447919e+02f, 1.199316497e+02f, 1.139539549e+02f, 1.037270221e+02f, 1.199138363e+02f, 1.138996387e+02f, 1.036374325e+02f, 1.199060904e+02f, 1.138919688e+02f, 1.036249957e+02f, 1.199172162e+02f, 1.139000130e+02f, 1.036338151e+02f, 1.198905625e+02f, 1.138740167e+02f, 1.036128459e+02f, 1.198715141e+02f, 1.138261107e+02f, 1.035252093e+02f, 1.198620260e+02f, 1.138155378e+02f, 1.035138042e+02f, 1.198568488e+02f, 1.138055633e+02f, 1.035067176e+02f, 1.198486831e+02f, 1.137958834e+02f, 1.035000299e+02f
+};
+
+#define NUM_VALUES_PER_BLOCK 192
+#define NUM_EIGEN_VALUES 8
+#define BLOCK_SIZE 8
+#define BYTES_PER_EV_BLOCK 4
+#define BLOCKS_PER_X (NANOSTREAM_TILE_WIDTH / BLOCK_SIZE)
+#define BLOCKS_PER_Y (NANOSTREAM_TILE_HEIGHT / BLOCK_SIZE)
+
+/* The lowest bits of the first lower eigenvalue bound of a packet that hold the index of its basis, when a tile is
+ * encoded with one of several. */
+#define BASIS_INDEX_MASK ((uint32_t)(NANOSTREAM_MAX_BASES - 1))
+
+/* The number of blocks of a tile that the basis it is encoded with is chosen on, and the stride they are taken at,
+ * which is coprime to the number of blocks so that they spread over the tile. */
+#define CHOICE_BLOCKS 16
+#define CHOICE_STRIDE 97
+
+/* Clamps and rounds a value in [0, 255]. Since the value is not negative once clamped, adding one half and truncating
+ * rounds it, which unlike lrintf compiles to vector instructions. */
+static unsigned char
+nanostream__f32_to_u8(const float x)
+{
+  float y = x;
+  if (y < 0.0F)
+    y = 0.0F;
+  if (y > 255.0F)
+    y = 255.0F;
+  return (unsigned char)(int)(y + 0.5F);
+}
+
+/* Projects a block onto the basis. The pixels are read in their packed order, NANOSTREAM_BASIS_LANES at a time, and
+ * each lane accumulates its own partial sums, so the inner loops map onto vector instructions without shuffles. */
+static void
+nanostream__block_to_eigen_values(const unsigned char* rgb,
+                      const int pitch,
+                      const float (*aosoa)[8 * NANOSTREAM_BASIS_LANES],
+                      const float* mean_projection,
+                      float* eigen_values_out)
+{
+  float acc[NUM_EIGEN_VALUES][NANOSTREAM_BASIS_LANES];
+  memset(acc, 0, sizeof(acc));
+
+  const int groups_per_row = (BLOCK_SIZE * 3) / NANOSTREAM_BASIS_LANES;
+
+  for (int g = 0; g < NANOSTREAM_BASIS_GROUPS; g++) {
+    const unsigned char* in = rgb + (g / groups_per_row) * pitch + (g % groups_per_row) * NANOSTREAM_BASIS_LANES;
+    const float* basis = aosoa[g];
+
+    float v[NANOSTREAM_BASIS_LANES];
+    for (int lane = 0; lane < NANOSTREAM_BASIS_LANES; lane++)
+      v[lane] = (float)in[lane];
+
+    for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+      for (int lane = 0; lane < NANOSTREAM_BASIS_LANES; lane++)
+        acc[i][lane] += v[lane] * basis[i * NANOSTREAM_BASIS_LANES + lane];
+  }
+
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    float s = -mean_projection[i];
+    for (int lane = 0; lane < NANOSTREAM_BASIS_LANES; lane++)
+      s += acc[i][lane];
+    eigen_values_out[i] = s;
+  }
+}
+
+static void
+nanostream__expand_eigen_value_bounds(const float* eigen_values, float* ev_min, float* ev_max)
+{
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    const float v = eigen_values[i];
+    ev_min[i] = fminf(ev_min[i], v);
+    ev_max[i] = fmaxf(ev_max[i], v);
+  }
+}
+
+static int
+nanostream__quantize_f32(const float x, const float min_x, const float max_x, const int res)
+{
+  if (res <= 0)
+    return 0;
+
+  const float denom = (max_x - min_x);
+  if (!(denom > 0.0F))
+    return 0;
+
+  float t = (x - min_x) / denom;
+  if (t < 0.0F)
+    t = 0.0F;
+  if (t > 1.0F)
+    t = 1.0F;
+
+  int q = (int)lrintf(t * (float)res);
+  if (q < 0)
+    q = 0;
+  if (q > res)
+    q = res;
+  return q;
+}
+
+static float
+nanostream__dequantize_f32(const int q, const float min_x, const float max_x, const int res)
+{
+  if (res <= 0)
+    return min_x;
+
+  int qq = q;
+  if (qq < 0)
+    qq = 0;
+  if (qq > res)
+    qq = res;
+
+  const float t = ((float)qq) * (1.0F / (float)res);
+  return min_x + t * (max_x - min_x);
+}
+
+/* FIXED packing: [8,8,4,4,2,2,2,2] bits into 4 bytes. */
+static void
+nanostream__quantize_eigen_values(const float* ev, const float* ev_min, const float* ev_max, unsigned char* bits)
+{
+  const int q0 = nanostream__quantize_f32(ev[0], ev_min[0], ev_max[0], 255);
+  const int q1 = nanostream__quantize_f32(ev[1], ev_min[1], ev_max[1], 255);
+  const int q2 = nanostream__quantize_f32(ev[2], ev_min[2], ev_max[2], 15);
+  const int q3 = nanostream__quantize_f32(ev[3], ev_min[3], ev_max[3], 15);
+
+  const int q4 = nanostream__quantize_f32(ev[4], ev_min[4], ev_max[4], 3);
+  const int q5 = nanostream__quantize_f32(ev[5], ev_min[5], ev_max[5], 3);
+  const int q6 = nanostream__quantize_f32(ev[6], ev_min[6], ev_max[6], 3);
+  const int q7 = nanostream__quantize_f32(ev[7], ev_min[7], ev_max[7], 3);
+
+  bits[0] = (unsigned char)(q0 & 0xFF);
+  bits[1] = (unsigned char)(q1 & 0xFF);
+  bits[2] = (unsigned char)(((q2 & 0x0F) << 4) | (q3 & 0x0F));
+  bits[3] = (unsigned char)((q4 & 0x03) | ((q5 & 0x03) << 2) | ((q6 & 0x03) << 4) | ((q7 & 0x03) << 6));
+}
+
+/* Records the index of a basis in the lowest bits of a lower eigenvalue bound. If that would raise the bound, it is
+ * moved down by one more step of those bits instead, so that the eigenvalues stay within it. */
+static float
+nanostream__stamp_basis_index(const float bound, const int index)
+{
+  uint32_t bits;
+  memcpy(&bits, &bound, sizeof(bits));
+
+  uint32_t stamped = (bits & ~BASIS_INDEX_MASK) | (uint32_t)index;
+  float value;
+  memcpy(&value, &stamped, sizeof(value));
+  if (value > bound) {
+    if (bits & 0x80000000u) {
+      stamped += BASIS_INDEX_MASK + 1;
+    } else if ((bits & ~BASIS_INDEX_MASK) == 0) {
+      stamped = 0x80000000u | (uint32_t)index;
+    } else {
+      stamped -= BASIS_INDEX_MASK + 1;
+    }
+    memcpy(&value, &stamped, sizeof(value));
+  }
+
+  return value;
+}
+
+/* 'basis_index' is recorded in the packet unless it is negative. */
+static void
+nanostream__encode_tile(const nanostream_basis* basis,
+            const int basis_index,
+            const unsigned char* rgb,
+            const int pitch,
+            unsigned char* packet_buffer)
+{
+  const float(*aosoa)[8 * NANOSTREAM_BASIS_LANES] = basis ? basis->aosoa : nanostream__basis_aosoa;
+  const float* mean_projection = basis ? basis->mean_projection : nanostream__mean_projection;
+
+  float eigen_values[BLOCKS_PER_X * BLOCKS_PER_Y][NUM_EIGEN_VALUES];
+  float ev_min[NUM_EIGEN_VALUES];
+  float ev_max[NUM_EIGEN_VALUES];
+
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    ev_min[i] = INFINITY;
+    ev_max[i] = -INFINITY;
+  }
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      const unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
+      float* ev = eigen_values[block_y * BLOCKS_PER_X + block_x];
+      nanostream__block_to_eigen_values(block_rgb_ptr, pitch, aosoa, mean_projection, ev);
+      nanostream__expand_eigen_value_bounds(ev, ev_min, ev_max);
+    }
+  }
+
+  if (basis_index >= 0)
+    ev_min[0] = nanostream__stamp_basis_index(ev_min[0], basis_index);
+
+  memcpy(packet_buffer, ev_min, sizeof(ev_min));
+  packet_buffer += sizeof(ev_min);
+
+  memcpy(packet_buffer, ev_max, sizeof(ev_max));
+  packet_buffer += sizeof(ev_max);
+
+  for (int i = 0; i < BLOCKS_PER_X * BLOCKS_PER_Y; i++) {
+    nanostream__quantize_eigen_values(eigen_values[i], ev_min, ev_max, packet_buffer);
+    packet_buffer += BYTES_PER_EV_BLOCK;
+  }
+}
+
+NANOSTREAM_DEF void
+nanostream_encode_tile(const unsigned char* rgb, const int pitch, unsigned char* packet_buffer)
+{
+  nanostream__encode_tile(NULL, -1, rgb, pitch, packet_buffer);
+}
+
+NANOSTREAM_DEF void
+nanostream_encode_tile_with_basis(const nanostream_basis* basis,
+                                  const unsigned char* rgb,
+                                  const int pitch,
+                                  unsigned char* packet_buffer)
+{
+  nanostream__encode_tile(basis, -1, rgb, pitch, packet_buffer);
+}
+
+/* Estimates the squared error, in units of 0 to 1, that encoding a sample of the blocks of a tile with a basis leaves:
+ * what the eigenvalues do not capture of each block, plus what quantizing them over their ranges in the sample
+ * adds. A basis that compacts more of the energy of the blocks into fewer eigenvalues, whose ranges are then narrower
+ * for the bits a packet has for them, scores lower. */
+static float
+nanostream__choice_error(const nanostream_basis* basis, const unsigned char* rgb, const int pitch)
+{
+  static const float levels[NUM_EIGEN_VALUES] = { 255.0F, 255.0F, 15.0F, 15.0F, 3.0F, 3.0F, 3.0F, 3.0F };
+
+  const float(*aosoa)[8 * NANOSTREAM_BASIS_LANES] = basis ? basis->aosoa : nanostream__basis_aosoa;
+  const float* mean_projection = basis ? basis->mean_projection : nanostream__mean_projection;
+  const float* mean = basis ? basis->mean_interleaved : nanostream__mean_interleaved;
+
+  float ev_min[NUM_EIGEN_VALUES];
+  float ev_max[NUM_EIGEN_VALUES];
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    ev_min[i] = INFINITY;
+    ev_max[i] = -INFINITY;
+  }
+
+  float residual = 0.0F;
+  for (int sample = 0; sample < CHOICE_BLOCKS; sample++) {
+    const int block = (sample * CHOICE_STRIDE) % (BLOCKS_PER_X * BLOCKS_PER_Y);
+    const unsigned char* in =
+      rgb + ((block / BLOCKS_PER_X) * BLOCK_SIZE) * pitch + ((block % BLOCKS_PER_X) * BLOCK_SIZE * 3);
+
+    float ev[NUM_EIGEN_VALUES];
+    nanostream__block_to_eigen_values(in, pitch, aosoa, mean_projection, ev);
+    nanostream__expand_eigen_value_bounds(ev, ev_min, ev_max);
+
+    float distance = 0.0F;
+    for (int y = 0; y < BLOCK_SIZE; y++) {
+      for (int k = 0; k < BLOCK_SIZE * 3; k++) {
+        const float d = (float)in[y * pitch + k] - mean[y * BLOCK_SIZE * 3 + k];
+        distance += d * d;
+      }
+    }
+
+    float captured = 0.0F;
+    for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+      captured += ev[i] * ev[i];
+
+    residual += distance * (1.0F / (255.0F * 255.0F)) - captured;
+  }
+
+  /* Rounding to steps of a given size adds a twelfth of the square of the step to each eigenvalue of each block. */
+  float quantization = 0.0F;
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    const float step = (ev_max[i] - ev_min[i]) / levels[i];
+    quantization += step * step * (1.0F / 12.0F);
+  }
+
+  return residual + quantization * (float)CHOICE_BLOCKS;
+}
+
+NANOSTREAM_DEF int
+nanostream_choose_basis(const nanostream_basis* const* bases,
+                        const int num_bases,
+                        const unsigned char* rgb,
+                        const int pitch)
+{
+  const int n = (num_bases < NANOSTREAM_MAX_BASES) ? num_bases : NANOSTREAM_MAX_BASES;
+  if (n <= 1)
+    return 0;
+
+  int best = 0;
+  float best_error = INFINITY;
+  for (int i = 0; i < n; i++) {
+    const float error = nanostream__choice_error(bases[i], rgb, pitch);
+    if (error < best_error) {
+      best_error = error;
+      best = i;
+    }
+  }
+
+  return best;
+}
+
+NANOSTREAM_DEF void
+nanostream_encode_tile_with_bases(const nanostream_basis* const* bases,
+                                  const int num_bases,
+                                  const unsigned char* rgb,
+                                  const int pitch,
+                                  unsigned char* packet_buffer)
+{
+  if (num_bases <= 1) {
+    nanostream__encode_tile((num_bases == 1) ? bases[0] : NULL, -1, rgb, pitch, packet_buffer);
+    return;
+  }
+
+  const int index = nanostream_choose_basis(bases, num_bases, rgb, pitch);
+  nanostream__encode_tile(bases[index], index, rgb, pitch, packet_buffer);
+}
+
+NANOSTREAM_DEF int
+nanostream_packet_basis(const unsigned char* packet_buffer)
+{
+  uint32_t bits;
+  memcpy(&bits, packet_buffer, sizeof(bits));
+  return (int)(bits & BASIS_INDEX_MASK);
+}
+
+/* Reconstructs values in interleaved order from the coefficients, by adding each scaled basis vector to the mean. */
+static void
+nanostream__reconstruct_interleaved(const float* ev, const float* mean, const float* basis, const int n, float* x)
+{
+  memcpy(x, mean, sizeof(float) * (size_t)n);
+
+  for (int i = 0; i < NUM_EIGEN_VALUES; i++) {
+    const float e = ev[i];
+    const float* row = basis + i * n;
+    for (int j = 0; j < n; j++)
+      x[j] += e * row[j];
+  }
+}
+
+static void
+nanostream__reconstruct_block(const float* ev, const nanostream_basis* basis, float* x)
+{
+  if (basis) {
+    nanostream__reconstruct_interleaved(ev, basis->mean_interleaved, &basis->interleaved[0][0], NUM_VALUES_PER_BLOCK, x);
+  } else {
+    nanostream__reconstruct_interleaved(
+      ev, nanostream__mean_interleaved, &nanostream__basis_interleaved[0][0], NUM_VALUES_PER_BLOCK, x);
+  }
+}
+
+static void
+nanostream__store_block(const float* x, unsigned char* rgb, const int pitch)
+{
+  for (int y = 0; y < BLOCK_SIZE; y++) {
+    unsigned char* line = rgb + y * pitch;
+    const float* row = x + y * BLOCK_SIZE * 3;
+    for (int k = 0; k < BLOCK_SIZE * 3; k++)
+      line[k] = nanostream__f32_to_u8(row[k]);
+  }
+}
+
+static void
+nanostream__eigen_values_to_block(const float* ev, const nanostream_basis* basis, unsigned char* rgb, const int pitch)
+{
+  float x[NUM_VALUES_PER_BLOCK];
+  nanostream__reconstruct_block(ev, basis, x);
+  nanostream__store_block(x, rgb, pitch);
+}
+
+/* Inverse of nanostream__quantize_eigen_values. */
+static void
+nanostream__dequantize_eigen_values(const unsigned char* bits, const float* ev_min, const float* ev_max, float* ev)
+{
+  const unsigned char b0 = bits[0];
+  const unsigned char b1 = bits[1];
+  const unsigned char b2 = bits[2];
+  const unsigned char b3 = bits[3];
+
+  const int q0 = (int)b0;
+  const int q1 = (int)b1;
+  const int q2 = (int)((b2 >> 4) & 0x0F);
+  const int q3 = (int)(b2 & 0x0F);
+
+  const int q4 = (int)(b3 & 0x03);
+  const int q5 = (int)((b3 >> 2) & 0x03);
+  const int q6 = (int)((b3 >> 4) & 0x03);
+  const int q7 = (int)((b3 >> 6) & 0x03);
+
+  ev[0] = nanostream__dequantize_f32(q0, ev_min[0], ev_max[0], 255);
+  ev[1] = nanostream__dequantize_f32(q1, ev_min[1], ev_max[1], 255);
+  ev[2] = nanostream__dequantize_f32(q2, ev_min[2], ev_max[2], 15);
+  ev[3] = nanostream__dequantize_f32(q3, ev_min[3], ev_max[3], 15);
+  ev[4] = nanostream__dequantize_f32(q4, ev_min[4], ev_max[4], 3);
+  ev[5] = nanostream__dequantize_f32(q5, ev_min[5], ev_max[5], 3);
+  ev[6] = nanostream__dequantize_f32(q6, ev_min[6], ev_max[6], 3);
+  ev[7] = nanostream__dequantize_f32(q7, ev_min[7], ev_max[7], 3);
+}
+
+NANOSTREAM_DEF void
+nanostream_decode_tile(const unsigned char* packet_buffer, int pitch, unsigned char* rgb)
+{
+  nanostream_decode_tile_with_basis(NULL, packet_buffer, pitch, rgb);
+}
+
+NANOSTREAM_DEF void
+nanostream_decode_tile_with_basis(const nanostream_basis* basis,
+                                  const unsigned char* packet_buffer,
+                                  const int pitch,
+                                  unsigned char* rgb)
+{
+  float ev_min[NUM_EIGEN_VALUES];
+  float ev_max[NUM_EIGEN_VALUES];
+
+  memcpy(ev_min, packet_buffer, sizeof(ev_min));
+  packet_buffer += sizeof(ev_min);
+
+  memcpy(ev_max, packet_buffer, sizeof(ev_max));
+  packet_buffer += sizeof(ev_max);
+
+  float ev[NUM_EIGEN_VALUES];
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      nanostream__dequantize_eigen_values(packet_buffer, ev_min, ev_max, ev);
+      packet_buffer += BYTES_PER_EV_BLOCK;
+
+      unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
+      nanostream__eigen_values_to_block(ev, basis, block_rgb_ptr, pitch);
+    }
+  }
+}
+
+/* The basis of 'bases' that a packet names, as nanostream_decode_tile_with_bases picks it. */
+static const nanostream_basis*
+packet_basis(const nanostream_basis* const* bases, const int num_bases, const unsigned char* packet_buffer)
+{
+  if (num_bases <= 1)
+    return (num_bases == 1) ? bases[0] : NULL;
+
+  const int index = nanostream_packet_basis(packet_buffer);
+  return (index < num_bases) ? bases[index] : bases[0];
+}
+
+NANOSTREAM_DEF void
+nanostream_decode_tile_with_bases(const nanostream_basis* const* bases,
+                                  const int num_bases,
+                                  const unsigned char* packet_buffer,
+                                  const int pitch,
+                                  unsigned char* rgb)
+{
+  nanostream_decode_tile_with_basis(packet_basis(bases, num_bases, packet_buffer), packet_buffer, pitch, rgb);
+}
+
+/* Dequantizes the coefficients of one block of a packet. */
+static void
+nanostream__dequantize_block(const unsigned char* packet_buffer, const int block_x, const int block_y, float* ev)
+{
+  float ev_min[NUM_EIGEN_VALUES];
+  float ev_max[NUM_EIGEN_VALUES];
+  memcpy(ev_min, packet_buffer, sizeof(ev_min));
+  memcpy(ev_max, packet_buffer + sizeof(ev_min), sizeof(ev_max));
+
+  const unsigned char* bits =
+    packet_buffer + sizeof(ev_min) + sizeof(ev_max) + (block_y * BLOCKS_PER_X + block_x) * BYTES_PER_EV_BLOCK;
+  nanostream__dequantize_eigen_values(bits, ev_min, ev_max, ev);
+}
+
+NANOSTREAM_DEF int
+nanostream_conceal_tile(const unsigned char* const* neighbours, const int pitch, unsigned char* rgb)
+{
+  return nanostream_conceal_tile_with_basis(NULL, neighbours, pitch, rgb);
+}
+
+NANOSTREAM_DEF int
+nanostream_conceal_tile_with_basis(const nanostream_basis* basis,
+                                   const unsigned char* const* neighbours,
+                                   const int pitch,
+                                   unsigned char* rgb)
+{
+  return nanostream_conceal_tile_with_bases(&basis, 1, neighbours, pitch, rgb);
+}
+
+NANOSTREAM_DEF int
+nanostream_conceal_tile_with_bases(const nanostream_basis* const* bases,
+                                   const int num_bases,
+                                   const unsigned char* const* neighbours,
+                                   const int pitch,
+                                   unsigned char* rgb)
+{
+  const unsigned char* left = neighbours[0];
+  const unsigned char* right = neighbours[1];
+  const unsigned char* above = neighbours[2];
+  const unsigned char* below = neighbours[3];
+  if (!left && !right && !above && !below)
+    return -1;
+
+  /* The blocks along the edges that face the lost tile. */
+  float left_edge[BLOCKS_PER_Y][NUM_EIGEN_VALUES];
+  float right_edge[BLOCKS_PER_Y][NUM_EIGEN_VALUES];
+  float top_edge[BLOCKS_PER_X][NUM_EIGEN_VALUES];
+  float bottom_edge[BLOCKS_PER_X][NUM_EIGEN_VALUES];
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    if (left)
+      nanostream__dequantize_block(left, BLOCKS_PER_X - 1, block_y, left_edge[block_y]);
+    if (right)
+      nanostream__dequantize_block(right, 0, block_y, right_edge[block_y]);
+  }
+
+  for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+    if (above)
+      nanostream__dequantize_block(above, block_x, BLOCKS_PER_Y - 1, top_edge[block_x]);
+    if (below)
+      nanostream__dequantize_block(below, block_x, 0, bottom_edge[block_x]);
+  }
+
+  /* Neighbours encoded with the same basis are blended in one group, since their coefficients mean the same. */
+  const nanostream_basis* group_bases[4];
+  int group[4] = { 0 };
+  int num_groups = 0;
+  for (int n = 0; n < 4; n++) {
+    if (!neighbours[n])
+      continue;
+    const nanostream_basis* basis = packet_basis(bases, num_bases, neighbours[n]);
+    for (group[n] = 0; (group[n] < num_groups) && (group_bases[group[n]] != basis); group[n]++) {
+    }
+    if (group[n] == num_groups)
+      group_bases[num_groups++] = basis;
+  }
+
+  /* Reconstruction is linear, so blending the coefficients blends the blocks they stand for. */
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      float ev[4][NUM_EIGEN_VALUES] = { { 0.0F } };
+      float weights[4] = { 0.0F };
+
+      const float* sources[4] = { left ? left_edge[block_y] : NULL,
+                                  right ? right_edge[block_y] : NULL,
+                                  above ? top_edge[block_x] : NULL,
+                                  below ? bottom_edge[block_x] : NULL };
+      const int distances[4] = { block_x + 1, BLOCKS_PER_X - block_x, block_y + 1, BLOCKS_PER_Y - block_y };
+
+      for (int n = 0; n < 4; n++) {
+        if (!sources[n])
+          continue;
+        const float weight = 1.0F / (float)distances[n];
+        for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+          ev[group[n]][i] += weight * sources[n][i];
+        weights[group[n]] += weight;
+      }
+
+      for (int g = 0; g < num_groups; g++) {
+        for (int i = 0; i < NUM_EIGEN_VALUES; i++)
+          ev[g][i] /= weights[g];
+      }
+
+      unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
+      if (num_groups == 1) {
+        nanostream__eigen_values_to_block(ev[0], group_bases[0], block_rgb_ptr, pitch);
+        continue;
+      }
+
+      /* Blocks of different bases are blended after reconstruction instead, by the weight of their groups. */
+      float total = 0.0F;
+      for (int g = 0; g < num_groups; g++)
+        total += weights[g];
+
+      float x[NUM_VALUES_PER_BLOCK] = { 0.0F };
+      for (int g = 0; g < num_groups; g++) {
+        float group_x[NUM_VALUES_PER_BLOCK];
+        nanostream__reconstruct_block(ev[g], group_bases[g], group_x);
+        const float share = weights[g] / total;
+        for (int j = 0; j < NUM_VALUES_PER_BLOCK; j++)
+          x[j] += share * group_x[j];
+      }
+      nanostream__store_block(x, block_rgb_ptr, pitch);
+    }
+  }
+
+  return 0;
+}
+
+#define HALF_BLOCK_SIZE (BLOCK_SIZE / 2)
+#define NUM_VALUES_PER_HALF_BLOCK (HALF_BLOCK_SIZE * HALF_BLOCK_SIZE * 3)
+
+NANOSTREAM_DEF void
+nanostream_decode_tile_half(const unsigned char* packet_buffer, const int pitch, unsigned char* rgb)
+{
+  nanostream_decode_tile_half_with_basis(NULL, packet_buffer, pitch, rgb);
+}
+
+NANOSTREAM_DEF void
+nanostream_decode_tile_half_with_basis(const nanostream_basis* basis,
+                                       const unsigned char* packet_buffer,
+                                       const int pitch,
+                                       unsigned char* rgb)
+{
+  const float* mean_half = basis ? basis->mean_half : nanostream__mean_half;
+  const float* basis_half = basis ? &basis->half[0][0] : &nanostream__basis_half[0][0];
+
+  float ev_min[NUM_EIGEN_VALUES];
+  float ev_max[NUM_EIGEN_VALUES];
+
+  memcpy(ev_min, packet_buffer, sizeof(ev_min));
+  packet_buffer += sizeof(ev_min);
+
+  memcpy(ev_max, packet_buffer, sizeof(ev_max));
+  packet_buffer += sizeof(ev_max);
+
+  float ev[NUM_EIGEN_VALUES];
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      nanostream__dequantize_eigen_values(packet_buffer, ev_min, ev_max, ev);
+      packet_buffer += BYTES_PER_EV_BLOCK;
+
+      unsigned char* block_rgb_ptr = rgb + (block_y * HALF_BLOCK_SIZE) * pitch + (block_x * HALF_BLOCK_SIZE * 3);
+
+      /* Since reconstruction is linear, the mean of each 2x2 cell is the same combination of the basis averaged over
+       * the cell, which the half layout holds. */
+      float x[NUM_VALUES_PER_HALF_BLOCK];
+      nanostream__reconstruct_interleaved(ev, mean_half, basis_half, NUM_VALUES_PER_HALF_BLOCK, x);
+
+      for (int y = 0; y < HALF_BLOCK_SIZE; y++) {
+        unsigned char* line = block_rgb_ptr + y * pitch;
+        const float* row = x + y * HALF_BLOCK_SIZE * 3;
+        for (int k = 0; k < HALF_BLOCK_SIZE * 3; k++)
+          line[k] = nanostream__f32_to_u8(row[k]);
+      }
+    }
+  }
+}
+
+NANOSTREAM_DEF void
+nanostream_decode_tile_half_with_bases(const nanostream_basis* const* bases,
+                                       const int num_bases,
+                                       const unsigned char* packet_buffer,
+                                       const int pitch,
+                                       unsigned char* rgb)
+{
+  nanostream_decode_tile_half_with_basis(packet_basis(bases, num_bases, packet_buffer), packet_buffer, pitch, rgb);
+}
+
+#undef NUM_VALUES_PER_BLOCK
+#undef NUM_EIGEN_VALUES
+#undef BLOCK_SIZE
+#undef BYTES_PER_EV_BLOCK
+#undef BLOCKS_PER_X
+#undef BLOCKS_PER_Y
+#undef BASIS_INDEX_MASK
+#undef CHOICE_BLOCKS
+#undef CHOICE_STRIDE
+#undef HALF_BLOCK_SIZE
+#undef NUM_VALUES_PER_HALF_BLOCK
+#undef NANOSTREAM_BASIS_LANES
+#undef NANOSTREAM_BASIS_GROUPS
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NANOSTREAM_IMPLEMENTATION */
@@ -0,0 +1,183 @@
+#include "nanostream_surface.h"
+
+#include "nanostream_buffer_pool.h"
+#include "nanostream_frame.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_BUFFERS 3
+
+/* Set in the shared state when the buffer it names has been published and not read yet. */
+#define FRESH 4u
+
+#define INDEX_MASK 3u
+
+struct nanostream_surface
+{
+  /* The index of the buffer holding the latest published frame, and the FRESH bit. */
+  _Atomic unsigned int shared;
+
+  /* Only accessed by the writer side. */
+  int back;
+  int previous;
+  uint64_t next_sequence;
+  _Atomic int remaining_tiles;
+
+  /* Only accessed by the reader side. */
+  int front;
+
+  unsigned char* buffers[NUM_BUFFERS];
+
+  /* The sequence number of the frame in each buffer, zero if none. Written by the writer side before the buffer is
+   * published, and read by the reader side after it took it. */
+  uint64_t sequences[NUM_BUFFERS];
+
+  int width;
+  int height;
+  int pitch;
+  int num_tiles;
+
+  nanostream_buffer_pool* pool;
+};
+
+nanostream_surface*
+nanostream_surface_create(const int width, const int height)
+{
+  if ((width <= 0) || (height <= 0) || (width > 0x7FFFFFFF / 3))
+    return NULL;
+
+  nanostream_surface* surface = calloc(1, sizeof(nanostream_surface));
+  if (!surface)
+    return NULL;
+
+  surface->width = width;
+  surface->height = height;
+  surface->pitch = width * 3;
+  surface->num_tiles = nanostream_frame_tiles_x(width) * nanostream_frame_tiles_y(height);
+
+  /* The pool backs the buffers with huge pages where it can. */
+  surface->pool = nanostream_buffer_pool_create((size_t)surface->pitch * (size_t)height, NUM_BUFFERS);
+  if (!surface->pool) {
+    free(surface);
+    return NULL;
+  }
+
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    surface->buffers[i] = nanostream_buffer_pool_acquire(surface->pool);
+    memset(surface->buffers[i], 0, (size_t)surface->pitch * (size_t)height);
+  }
+
+  surface->back = 0;
+  surface->previous = -1;
+  surface->front = 1;
+  surface->next_sequence = 1;
+  atomic_init(&surface->shared, 2u);
+  atomic_init(&surface->remaining_tiles, 0);
+
+  return surface;
+}
+
+void
+nanostream_surface_destroy(nanostream_surface* surface)
+{
+  if (!surface)
+    return;
+
+  for (int i = 0; i < NUM_BUFFERS; i++)
+    nanostream_buffer_pool_release(surface->pool, surface->buffers[i]);
+
+  nanostream_buffer_pool_destroy(surface->pool);
+  free(surface);
+}
+
+int
+nanostream_surface_width(const nanostream_surface* surface)
+{
+  return surface->width;
+}
+
+int
+nanostream_surface_height(const nanostream_surface* surface)
+{
+  return surface->height;
+}
+
+int
+nanostream_surface_pitch(const nanostream_surface* surface)
+{
+  return surface->pitch;
+}
+
+unsigned char*
+nanostream_surface_back_buffer(nanostream_surface* surface)
+{
+  return surface->buffers[surface->back];
+}
+
+uint64_t
+nanostream_surface_publish(nanostream_surface* surface)
+{
+  const uint64_t sequence = surface->next_sequence++;
+  surface->sequences[surface->back] = sequence;
+  surface->previous = surface->back;
+
+  /* Release the frame to the reader and take whichever buffer it is not using as the new back buffer. */
+  const unsigned int old =
+    atomic_exchange_explicit(&surface->shared, (unsigned int)surface->back | FRESH, memory_order_acq_rel);
+
+  surface->back = (int)(old & INDEX_MASK);
+  return sequence;
+}
+
+void
+nanostream_surface_begin_frame(nanostream_surface* surface, const int num_tiles)
+{
+  /* The previously published buffer is never written to until it comes back as the back buffer, so it can be read
+   * here while the reader may be reading it too. */
+  if ((num_tiles < surface->num_tiles) && (surface->previous >= 0))
+    memcpy(surface->buffers[surface->back],
+           surface->buffers[surface->previous],
+           (size_t)surface->pitch * (size_t)surface->height);
+
+  /* With no tile to decode there is no last tile to publish the frame, so it is published here. */
+  if (num_tiles <= 0) {
+    atomic_store_explicit(&surface->remaining_tiles, 0, memory_order_relaxed);
+    nanostream_surface_publish(surface);
+    return;
+  }
+
+  atomic_store_explicit(&surface->remaining_tiles, num_tiles, memory_order_relaxed);
+}
+
+int
+nanostream_surface_decode_tile(nanostream_surface* surface, const int tile_index, const unsigned char* packet)
+{
+  nanostream_decode_frame(
+    packet, tile_index, 1, surface->width, surface->height, surface->pitch, surface->buffers[surface->back]);
+
+  /* The worker that decodes the last tile acquires the writes of all the others before publishing. */
+  if (atomic_fetch_sub_explicit(&surface->remaining_tiles, 1, memory_order_acq_rel) != 1)
+    return 0;
+
+  nanostream_surface_publish(surface);
+  return 1;
+}
+
+const unsigned char*
+nanostream_surface_latest(nanostream_surface* surface, uint64_t* sequence)
+{
+  if (atomic_load_explicit(&surface->shared, memory_order_relaxed) & FRESH) {
+    const unsigned int old =
+      atomic_exchange_explicit(&surface->shared, (unsigned int)surface->front, memory_order_acq_rel);
+    surface->front = (int)(old & INDEX_MASK);
+  }
+
+  const uint64_t s = surface->sequences[surface->front];
+
+  if (sequence)
+    *sequence = s;
+
+  return (s > 0) ? surface->buffers[surface->front] : NULL;
+}
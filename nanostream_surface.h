@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+/* A surface hands decoded frames from decode workers to a consumer (a renderer, or analytics) without either side ever
+ * waiting for the other. It holds three frame buffers: the back buffer is written by the decoder, the front buffer is
+ * read by the consumer, and the third holds the latest published frame. Publishing swaps the back buffer with the
+ * latest one and reading swaps the front buffer with it, each with a single atomic exchange, so a slow consumer only
+ * skips frames and never stalls the decoder.
+ *
+ * There is one writer side and one reader side. The writer side may be a group of workers decoding the tiles of a
+ * frame in parallel: the frame is published by whichever worker decodes its last tile. */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct nanostream_surface nanostream_surface;
+
+  /* Creates a surface for RGB frames of the given size. Returns null if the buffers could not be allocated. */
+  nanostream_surface* nanostream_surface_create(int width, int height);
+
+  void nanostream_surface_destroy(nanostream_surface* surface);
+
+  int nanostream_surface_width(const nanostream_surface* surface);
+
+  int nanostream_surface_height(const nanostream_surface* surface);
+
+  /* The distance in bytes between rows of every buffer. */
+  int nanostream_surface_pitch(const nanostream_surface* surface);
+
+  /* Writer side, for writers that fill the back buffer themselves. The back buffer holds an older published frame, or
+   * zeros. */
+  unsigned char* nanostream_surface_back_buffer(nanostream_surface* surface);
+
+  /* Makes the back buffer the latest frame and returns its sequence number, which starts at one and increases by one
+   * with every published frame. */
+  uint64_t nanostream_surface_publish(nanostream_surface* surface);
+
+  /* Starts a frame of which 'num_tiles' tiles will be decoded with nanostream_surface_decode_tile. If that is fewer
+   * than all tiles of the frame, the tiles that are not decoded keep the contents of the previously published frame.
+   * Must happen before any of the tiles are decoded. If 'num_tiles' is zero (or negative), the frame is a copy of the
+   * previously published frame, and is published at once. */
+  void nanostream_surface_begin_frame(nanostream_surface* surface, int num_tiles);
+
+  /* Decodes one tile into the back buffer. Safe to call from several threads at once for different tiles of the
+   * frame. Publishes the frame and returns one if this was the last tile of the frame, otherwise returns zero. */
+  int nanostream_surface_decode_tile(nanostream_surface* surface, int tile_index, const unsigned char* packet);
+
+  /* Reader side. Returns the latest published frame, or null if no frame was published yet, and stores its sequence
+   * number in 'sequence' if it is not null. The frame stays valid until the next call. A gap in sequence numbers means
+   * frames were published faster than they were read. */
+  const unsigned char* nanostream_surface_latest(nanostream_surface* surface, uint64_t* sequence);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,196 @@
+#include "nanostream_vq.h"
+
+#include "nanostream.h"
+
+#include <stdint.h>
+
+#define BLOCK_SIZE 8
+#define QUARTER_SIZE 4
+#define QUARTER_PITCH (QUARTER_SIZE * 3)
+#define BLOCKS_PER_X (NANOSTREAM_TILE_WIDTH / BLOCK_SIZE)
+#define BLOCKS_PER_Y (NANOSTREAM_TILE_HEIGHT / BLOCK_SIZE)
+
+/* Takes the place of the coefficient ranges of the eigen codec. */
+#define HEADER_SIZE 64
+
+/* The quarters of a block, in the order of their indices. */
+static const unsigned char quarter_x[4] = { 0, QUARTER_SIZE, 0, QUARTER_SIZE };
+static const unsigned char quarter_y[4] = { 0, 0, QUARTER_SIZE, QUARTER_SIZE };
+
+/* The codewords sorted by the sum of their values, with the sum of each of their channels. */
+typedef struct codeword_order
+{
+  uint16_t sums[NANOSTREAM_VQ_CODEWORDS][3];
+  unsigned char index[NANOSTREAM_VQ_CODEWORDS];
+} codeword_order;
+
+static void
+channel_sums(const unsigned char* quarter, uint16_t* sums)
+{
+  int r = 0;
+  int g = 0;
+  int b = 0;
+  for (int j = 0; j < NANOSTREAM_VQ_CODEWORD_SIZE; j += 3) {
+    r += quarter[j];
+    g += quarter[j + 1];
+    b += quarter[j + 2];
+  }
+  sums[0] = (uint16_t)r;
+  sums[1] = (uint16_t)g;
+  sums[2] = (uint16_t)b;
+}
+
+static int32_t
+total(const uint16_t* sums)
+{
+  return (int32_t)sums[0] + (int32_t)sums[1] + (int32_t)sums[2];
+}
+
+static void
+sort_codewords(const unsigned char* codebook, codeword_order* order)
+{
+  for (int i = 0; i < NANOSTREAM_VQ_CODEWORDS; i++) {
+    uint16_t sums[3];
+    channel_sums(codebook + i * NANOSTREAM_VQ_CODEWORD_SIZE, sums);
+
+    int k = i;
+    for (; (k > 0) && (total(order->sums[k - 1]) > total(sums)); k--) {
+      order->sums[k][0] = order->sums[k - 1][0];
+      order->sums[k][1] = order->sums[k - 1][1];
+      order->sums[k][2] = order->sums[k - 1][2];
+      order->index[k] = order->index[k - 1];
+    }
+    order->sums[k][0] = sums[0];
+    order->sums[k][1] = sums[1];
+    order->sums[k][2] = sums[2];
+    order->index[k] = (unsigned char)i;
+  }
+}
+
+static int32_t
+quarter_error(const unsigned char* quarter, const unsigned char* word)
+{
+  int32_t error = 0;
+  for (int j = 0; j < NANOSTREAM_VQ_CODEWORD_SIZE; j++) {
+    const int32_t d = (int32_t)quarter[j] - (int32_t)word[j];
+    error += d * d;
+  }
+  return error;
+}
+
+/* By Cauchy-Schwarz, the squared error between two quarters is at least the squared difference of their sums over
+ * 48, and at least the sum over the channels of the squared difference of their channel sums over 16. So the search
+ * starts from the codeword whose sum is nearest that of the quarter, and works up and then down until the first bound
+ * rules out all the rest; the second rules out most of the codewords on the way without summing their error. Starting
+ * from 'guess', the codeword of the quarter before, makes the best error small early. */
+static int
+nearest_codeword(const unsigned char* codebook,
+                 const codeword_order* order,
+                 const unsigned char* quarter,
+                 const int guess)
+{
+  uint16_t sums[3];
+  channel_sums(quarter, sums);
+  const int32_t quarter_total = total(sums);
+
+  int best = guess;
+  int32_t best_error = quarter_error(quarter, codebook + guess * NANOSTREAM_VQ_CODEWORD_SIZE);
+
+  int high = 0;
+  int low = NANOSTREAM_VQ_CODEWORDS;
+  while (high < low) {
+    const int middle = (high + low) / 2;
+    if (total(order->sums[middle]) < quarter_total)
+      high = middle + 1;
+    else
+      low = middle;
+  }
+
+  for (int pass = 0; pass < 2; pass++) {
+    const int step = pass ? -1 : 1;
+    for (int k = pass ? (high - 1) : high; (k >= 0) && (k < NANOSTREAM_VQ_CODEWORDS); k += step) {
+      const int32_t difference = total(order->sums[k]) - quarter_total;
+      if (difference * difference >= best_error * NANOSTREAM_VQ_CODEWORD_SIZE)
+        break;
+
+      int32_t bound = 0;
+      for (int c = 0; c < 3; c++) {
+        const int32_t d = (int32_t)sums[c] - (int32_t)order->sums[k][c];
+        bound += d * d;
+      }
+      if (bound >= best_error * (QUARTER_SIZE * QUARTER_SIZE))
+        continue;
+
+      const int i = order->index[k];
+      const int32_t error = quarter_error(quarter, codebook + i * NANOSTREAM_VQ_CODEWORD_SIZE);
+      if (error < best_error) {
+        best_error = error;
+        best = i;
+      }
+    }
+  }
+  return best;
+}
+
+void
+nanostream_vq_encode_tile(const unsigned char* codebook,
+                          const unsigned char* rgb,
+                          const int pitch,
+                          unsigned char* packet_buffer)
+{
+  for (int i = 0; i < HEADER_SIZE; i++)
+    packet_buffer[i] = 0;
+  packet_buffer += HEADER_SIZE;
+
+  codeword_order order;
+  sort_codewords(codebook, &order);
+
+  unsigned char quarter[NANOSTREAM_VQ_CODEWORD_SIZE];
+  int code = 0;
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      const unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
+      for (int q = 0; q < 4; q++) {
+        const unsigned char* in = block_rgb_ptr + quarter_y[q] * pitch + quarter_x[q] * 3;
+        for (int y = 0; y < QUARTER_SIZE; y++) {
+          for (int x = 0; x < QUARTER_PITCH; x++)
+            quarter[y * QUARTER_PITCH + x] = in[y * pitch + x];
+        }
+        code = nearest_codeword(codebook, &order, quarter, code);
+        packet_buffer[q] = (unsigned char)code;
+      }
+      packet_buffer += 4;
+    }
+  }
+}
+
+static void
+copy_codeword(const unsigned char* restrict word, const int pitch, unsigned char* restrict out)
+{
+  for (int y = 0; y < QUARTER_SIZE; y++) {
+    for (int x = 0; x < QUARTER_PITCH; x++)
+      out[y * pitch + x] = word[y * QUARTER_PITCH + x];
+  }
+}
+
+void
+nanostream_vq_decode_tile(const unsigned char* codebook,
+                          const unsigned char* packet_buffer,
+                          const int pitch,
+                          unsigned char* rgb)
+{
+  packet_buffer += HEADER_SIZE;
+
+  for (int block_y = 0; block_y < BLOCKS_PER_Y; block_y++) {
+    for (int block_x = 0; block_x < BLOCKS_PER_X; block_x++) {
+      unsigned char* block_rgb_ptr = rgb + (block_y * BLOCK_SIZE) * pitch + (block_x * BLOCK_SIZE * 3);
+      for (int q = 0; q < 4; q++) {
+        const unsigned char* word = codebook + packet_buffer[q] * NANOSTREAM_VQ_CODEWORD_SIZE;
+        unsigned char* out = block_rgb_ptr + quarter_y[q] * pitch + quarter_x[q] * 3;
+        copy_codeword(word, pitch, out);
+      }
+      packet_buffer += 4;
+    }
+  }
+}
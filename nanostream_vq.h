@@ -0,0 +1,83 @@
+#pragma once
+
+/* A vector quantized alternative to the eigen codec, for receivers too weak to decode it. Each 8x8 block is coded as
+ * its four 4x4 quarters, and each quarter as the index of the nearest of 256 codewords: 4x4 pixels of packed RGB,
+ * stored as bytes in a codebook that the encoder and the decoder share. Decoding is then copying 4 rows of 12 bytes
+ * per quarter out of the codebook, with no arithmetic at all.
+ *
+ * The packets have the size of those of nanostream_encode_tile, so they travel the same way, but not its format: the
+ * first 64 bytes are zero, and the rest holds the four indices of each block (top left, top right, bottom left, bottom
+ * right), in the order of the blocks of the eigen codec. Which of the two codecs a stream uses is agreed on out of
+ * band.
+ *
+ * The point is a decoder that runs at the speed of memcpy, over ten times faster than nanostream_decode_tile. The
+ * quality depends more on the content than that of the eigen codec, as 256 quarters have to cover all of it, so the
+ * codebook is best trained on content like that of the stream. The encoder, which searches the codebook for each
+ * quarter, is several times slower than nanostream_encode_tile.
+ *
+ * The encoder and the decoder need nothing but a freestanding C99 environment and no floating point, and are built
+ * into the nanostream_vq_fixed library too. The decoder uses less than a hundred bytes of stack, the encoder about
+ * 2.3 KB; the nanostream_vq_fixed_footprint target reports the exact figures. The trainer needs the C library. */
+
+/* The number of codewords, one per value of an index byte. */
+#define NANOSTREAM_VQ_CODEWORDS 256
+
+/* The size of a codeword: 4 rows of 4 pixels of packed RGB. */
+#define NANOSTREAM_VQ_CODEWORD_SIZE (4 * 4 * 3)
+
+/* The size of a codebook, which is its codewords one after the other. Stored codebooks are the same bytes. */
+#define NANOSTREAM_VQ_CODEBOOK_SIZE (NANOSTREAM_VQ_CODEWORDS * NANOSTREAM_VQ_CODEWORD_SIZE)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* Codes a whole tile, NANOSTREAM_TILE_WIDTH by NANOSTREAM_TILE_HEIGHT pixels of packed RGB, into
+   * NANOSTREAM_PACKET_SIZE bytes, picking for each quarter the codeword with the least squared error. */
+  void nanostream_vq_encode_tile(const unsigned char* codebook,
+                                 const unsigned char* rgb,
+                                 int pitch,
+                                 unsigned char* packet_buffer);
+
+  void nanostream_vq_decode_tile(const unsigned char* codebook,
+                                 const unsigned char* packet_buffer,
+                                 int pitch,
+                                 unsigned char* rgb);
+
+  typedef struct nanostream_vq_trainer_config
+  {
+    /* The number of 8x8 blocks sampled from each image, at random positions that need not be aligned to the block
+     * grid, zero for 1024. These are the blocks eigen_decomposition.py derives the built-in basis from. */
+    int blocks_per_image;
+
+    /* The most rounds of k-means, zero for 16. Each round takes about a second per hundred images. */
+    int iterations;
+
+    /* Seeds the sampling and the choice of the initial codewords. */
+    unsigned seed;
+  } nanostream_vq_trainer_config;
+
+  /* A trainer is not safe to use from several threads at once. */
+  typedef struct nanostream_vq_trainer nanostream_vq_trainer;
+
+  /* Returns null on failure. */
+  nanostream_vq_trainer* nanostream_vq_trainer_create(const nanostream_vq_trainer_config* config);
+
+  void nanostream_vq_trainer_destroy(nanostream_vq_trainer* trainer);
+
+  /* Samples blocks from an image of packed RGB, of any size of at least 8x8 pixels. Returns 0, or -1 on failure. */
+  int nanostream_vq_trainer_add_image(nanostream_vq_trainer* trainer,
+                                      const unsigned char* rgb,
+                                      int width,
+                                      int height,
+                                      int pitch);
+
+  /* Clusters the quarters of the blocks sampled so far by k-means, seeded by k-means++, and writes the centers as
+   * NANOSTREAM_VQ_CODEBOOK_SIZE bytes. Returns 0, or -1 on failure, including if fewer quarters than codewords were
+   * sampled. */
+  int nanostream_vq_trainer_train(nanostream_vq_trainer* trainer, unsigned char* codebook);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
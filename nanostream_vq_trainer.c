@@ -0,0 +1,225 @@
+#include "nanostream_vq.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_SIZE 8
+#define QUARTER_SIZE 4
+#define QUARTER_PITCH (QUARTER_SIZE * 3)
+
+#define DEFAULT_BLOCKS_PER_IMAGE 1024
+#define DEFAULT_ITERATIONS 16
+
+/* The generator of Numerical Recipes, as in nanostream_basis.c. */
+#define SAMPLE_MULTIPLIER 1664525u
+#define SAMPLE_INCREMENT 1013904223u
+
+struct nanostream_vq_trainer
+{
+  int blocks_per_image;
+
+  int iterations;
+
+  uint32_t random;
+
+  /* The quarters sampled so far, NANOSTREAM_VQ_CODEWORD_SIZE bytes each. */
+  unsigned char* quarters;
+
+  size_t num_quarters;
+
+  size_t capacity;
+};
+
+nanostream_vq_trainer*
+nanostream_vq_trainer_create(const nanostream_vq_trainer_config* config)
+{
+  nanostream_vq_trainer* trainer = calloc(1, sizeof(nanostream_vq_trainer));
+  if (!trainer)
+    return NULL;
+
+  trainer->blocks_per_image = (config->blocks_per_image > 0) ? config->blocks_per_image : DEFAULT_BLOCKS_PER_IMAGE;
+  trainer->iterations = (config->iterations > 0) ? config->iterations : DEFAULT_ITERATIONS;
+  trainer->random = config->seed;
+  return trainer;
+}
+
+void
+nanostream_vq_trainer_destroy(nanostream_vq_trainer* trainer)
+{
+  if (!trainer)
+    return;
+
+  free(trainer->quarters);
+  free(trainer);
+}
+
+/* A uniform integer from 0 to n - 1, from the high bits of the generator, which are the random ones. */
+static int
+random_below(nanostream_vq_trainer* trainer, const int n)
+{
+  trainer->random = trainer->random * SAMPLE_MULTIPLIER + SAMPLE_INCREMENT;
+  return (int)(((uint64_t)trainer->random * (uint64_t)n) >> 32);
+}
+
+int
+nanostream_vq_trainer_add_image(nanostream_vq_trainer* trainer,
+                                const unsigned char* rgb,
+                                const int width,
+                                const int height,
+                                const int pitch)
+{
+  if ((width < BLOCK_SIZE) || (height < BLOCK_SIZE))
+    return 0;
+
+  const size_t needed = trainer->num_quarters + (size_t)trainer->blocks_per_image * 4;
+  if (needed > trainer->capacity) {
+    const size_t capacity = (needed > trainer->capacity * 2) ? needed : (trainer->capacity * 2);
+    unsigned char* quarters = realloc(trainer->quarters, capacity * NANOSTREAM_VQ_CODEWORD_SIZE);
+    if (!quarters)
+      return -1;
+    trainer->quarters = quarters;
+    trainer->capacity = capacity;
+  }
+
+  for (int i = 0; i < trainer->blocks_per_image; i++) {
+    const int y = random_below(trainer, height - BLOCK_SIZE + 1);
+    const int x = random_below(trainer, width - BLOCK_SIZE + 1);
+    const unsigned char* block = rgb + (size_t)y * (size_t)pitch + (size_t)x * 3;
+    for (int q = 0; q < 4; q++) {
+      const unsigned char* in = block + (q / 2) * QUARTER_SIZE * pitch + (q % 2) * QUARTER_PITCH;
+      unsigned char* out = trainer->quarters + trainer->num_quarters * NANOSTREAM_VQ_CODEWORD_SIZE;
+      for (int row = 0; row < QUARTER_SIZE; row++)
+        memcpy(out + row * QUARTER_PITCH, in + row * pitch, QUARTER_PITCH);
+      trainer->num_quarters++;
+    }
+  }
+
+  return 0;
+}
+
+static int32_t
+quarter_error(const unsigned char* a, const unsigned char* b)
+{
+  int32_t error = 0;
+  for (int j = 0; j < NANOSTREAM_VQ_CODEWORD_SIZE; j++) {
+    const int32_t d = (int32_t)a[j] - (int32_t)b[j];
+    error += d * d;
+  }
+  return error;
+}
+
+/* Picks the initial codewords by k-means++: each is a quarter drawn with a probability proportional to its squared
+ * error from the nearest codeword picked before it. */
+static void
+seed_codewords(nanostream_vq_trainer* trainer, unsigned char* codebook, int32_t* nearest)
+{
+  const size_t n = trainer->num_quarters;
+
+  memcpy(codebook, trainer->quarters + (size_t)random_below(trainer, (int)n) * NANOSTREAM_VQ_CODEWORD_SIZE,
+         NANOSTREAM_VQ_CODEWORD_SIZE);
+  for (size_t i = 0; i < n; i++)
+    nearest[i] = quarter_error(trainer->quarters + i * NANOSTREAM_VQ_CODEWORD_SIZE, codebook);
+
+  for (int c = 1; c < NANOSTREAM_VQ_CODEWORDS; c++) {
+    double total = 0.0;
+    for (size_t i = 0; i < n; i++)
+      total += (double)nearest[i];
+
+    trainer->random = trainer->random * SAMPLE_MULTIPLIER + SAMPLE_INCREMENT;
+    double target = total * (double)(trainer->random >> 8) / (double)(1u << 24);
+    size_t chosen = n - 1;
+    for (size_t i = 0; i < n; i++) {
+      target -= (double)nearest[i];
+      if (target < 0.0) {
+        chosen = i;
+        break;
+      }
+    }
+
+    unsigned char* word = codebook + c * NANOSTREAM_VQ_CODEWORD_SIZE;
+    memcpy(word, trainer->quarters + chosen * NANOSTREAM_VQ_CODEWORD_SIZE, NANOSTREAM_VQ_CODEWORD_SIZE);
+    for (size_t i = 0; i < n; i++) {
+      const int32_t error = quarter_error(trainer->quarters + i * NANOSTREAM_VQ_CODEWORD_SIZE, word);
+      if (error < nearest[i])
+        nearest[i] = error;
+    }
+  }
+}
+
+int
+nanostream_vq_trainer_train(nanostream_vq_trainer* trainer, unsigned char* codebook)
+{
+  const size_t n = trainer->num_quarters;
+  if (n < NANOSTREAM_VQ_CODEWORDS)
+    return -1;
+
+  int32_t* nearest = malloc(sizeof(int32_t) * n);
+  unsigned char* assigned = malloc(n);
+  uint64_t(*sums)[NANOSTREAM_VQ_CODEWORD_SIZE] = malloc(sizeof(uint64_t[NANOSTREAM_VQ_CODEWORD_SIZE]) *
+                                                        NANOSTREAM_VQ_CODEWORDS);
+  size_t* counts = malloc(sizeof(size_t) * NANOSTREAM_VQ_CODEWORDS);
+  if (!nearest || !assigned || !sums || !counts) {
+    free(nearest);
+    free(assigned);
+    free(sums);
+    free(counts);
+    return -1;
+  }
+
+  seed_codewords(trainer, codebook, nearest);
+
+  for (int iteration = 0; iteration < trainer->iterations; iteration++) {
+    size_t moved = 0;
+    for (size_t i = 0; i < n; i++) {
+      const unsigned char* quarter = trainer->quarters + i * NANOSTREAM_VQ_CODEWORD_SIZE;
+      int best = 0;
+      int32_t best_error = INT32_MAX;
+      for (int c = 0; c < NANOSTREAM_VQ_CODEWORDS; c++) {
+        const int32_t error = quarter_error(quarter, codebook + c * NANOSTREAM_VQ_CODEWORD_SIZE);
+        if (error < best_error) {
+          best_error = error;
+          best = c;
+        }
+      }
+      moved += ((iteration == 0) || (assigned[i] != best)) ? 1 : 0;
+      assigned[i] = (unsigned char)best;
+      nearest[i] = best_error;
+    }
+    if (moved == 0)
+      break;
+
+    memset(sums, 0, sizeof(uint64_t[NANOSTREAM_VQ_CODEWORD_SIZE]) * NANOSTREAM_VQ_CODEWORDS);
+    memset(counts, 0, sizeof(size_t) * NANOSTREAM_VQ_CODEWORDS);
+    for (size_t i = 0; i < n; i++) {
+      const unsigned char* quarter = trainer->quarters + i * NANOSTREAM_VQ_CODEWORD_SIZE;
+      for (int j = 0; j < NANOSTREAM_VQ_CODEWORD_SIZE; j++)
+        sums[assigned[i]][j] += quarter[j];
+      counts[assigned[i]]++;
+    }
+
+    for (int c = 0; c < NANOSTREAM_VQ_CODEWORDS; c++) {
+      unsigned char* word = codebook + c * NANOSTREAM_VQ_CODEWORD_SIZE;
+      if (counts[c] > 0) {
+        for (int j = 0; j < NANOSTREAM_VQ_CODEWORD_SIZE; j++)
+          word[j] = (unsigned char)((sums[c][j] + counts[c] / 2) / counts[c]);
+        continue;
+      }
+
+      /* A codeword that lost all of its quarters takes the quarter that is coded worst instead. */
+      size_t worst = 0;
+      for (size_t i = 1; i < n; i++) {
+        if (nearest[i] > nearest[worst])
+          worst = i;
+      }
+      memcpy(word, trainer->quarters + worst * NANOSTREAM_VQ_CODEWORD_SIZE, NANOSTREAM_VQ_CODEWORD_SIZE);
+      nearest[worst] = 0;
+    }
+  }
+
+  free(nearest);
+  free(assigned);
+  free(sums);
+  free(counts);
+  return 0;
+}
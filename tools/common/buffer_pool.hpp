@@ -0,0 +1,74 @@
+#pragma once
+
+#include <nanostream_buffer_pool.h>
+
+#include <cstddef>
+#include <cstdio>
+
+namespace nanostream_tools {
+
+// Owns a nanostream_buffer_pool.
+class BufferPool
+{
+public:
+  BufferPool(const size_t buffer_size, const int num_buffers)
+    : pool_(nanostream_buffer_pool_create(buffer_size, num_buffers))
+  {
+    if (!pool_)
+      fprintf(stderr, "failed to allocate %d buffers of %zu bytes\n", num_buffers, buffer_size);
+  }
+
+  BufferPool(const BufferPool&) = delete;
+
+  auto operator=(const BufferPool&) -> BufferPool& = delete;
+
+  ~BufferPool() { nanostream_buffer_pool_destroy(pool_); }
+
+  explicit operator bool() const { return pool_ != nullptr; }
+
+  [[nodiscard]] auto acquire() -> unsigned char*
+  {
+    return static_cast<unsigned char*>(nanostream_buffer_pool_acquire(pool_));
+  }
+
+  void release(unsigned char* buffer) { nanostream_buffer_pool_release(pool_, buffer); }
+
+  [[nodiscard]] auto total_size() const -> size_t
+  {
+    return nanostream_buffer_pool_buffer_size(pool_) * static_cast<size_t>(nanostream_buffer_pool_num_buffers(pool_));
+  }
+
+  [[nodiscard]] auto backing_name() const -> const char*
+  {
+    return nanostream_buffer_backing_name(nanostream_buffer_pool_backing(pool_));
+  }
+
+private:
+  nanostream_buffer_pool* pool_;
+};
+
+// A buffer taken from a pool for the lifetime of this object.
+class PooledBuffer
+{
+public:
+  explicit PooledBuffer(BufferPool& pool)
+    : pool_(pool)
+    , data_(pool.acquire())
+  {
+  }
+
+  PooledBuffer(const PooledBuffer&) = delete;
+
+  auto operator=(const PooledBuffer&) -> PooledBuffer& = delete;
+
+  ~PooledBuffer() { pool_.release(data_); }
+
+  [[nodiscard]] auto data() -> unsigned char* { return data_; }
+
+private:
+  BufferPool& pool_;
+
+  unsigned char* data_;
+};
+
+} // namespace nanostream_tools
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <nanostream.h>
+#include <nanostream_net.h>
+#include <nanostream_recording.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace nanostream_tools {
+
+// The nanostream datagrams of a capture, with the time each was captured, in capture order.
+class Capture
+{
+public:
+  [[nodiscard]] auto size() const -> size_t { return times_.size(); }
+
+  [[nodiscard]] auto time_us(const size_t i) const -> uint64_t { return times_[i]; }
+
+  [[nodiscard]] auto datagram(const size_t i) const -> const unsigned char* { return bytes_.data() + offsets_[i]; }
+
+  [[nodiscard]] auto datagram_size(const size_t i) const -> size_t { return offsets_[i + 1] - offsets_[i]; }
+
+  // UDP payloads that are not nanostream datagrams, or that are not complete in the capture.
+  [[nodiscard]] auto skipped() const -> uint64_t { return skipped_; }
+
+  // Loads the UDP datagrams of a pcap file (not pcapng) captured on Ethernet, Linux cooked, loopback or raw IP
+  // links. 'port' selects the destination port, or zero for any.
+  auto load_pcap(const char* path, const int port) -> bool
+  {
+    MappedFile file;
+    if (!file.open_read(path))
+      return false;
+
+    const unsigned char* data = file.data();
+    const size_t size = file.size();
+    if (size < 24) {
+      fprintf(stderr, "\"%s\" is too short for a pcap file\n", path);
+      return false;
+    }
+
+    // The magic number tells the byte order and whether timestamps are in microseconds or nanoseconds.
+    const uint32_t magic = load_u32(data, false);
+    bool swapped = false;
+    bool nanoseconds = false;
+    if ((magic == 0xa1b2c3d4U) || (magic == 0xd4c3b2a1U)) {
+      swapped = magic == 0xd4c3b2a1U;
+    } else if ((magic == 0xa1b23c4dU) || (magic == 0x4d3cb2a1U)) {
+      swapped = magic == 0x4d3cb2a1U;
+      nanoseconds = true;
+    } else {
+      fprintf(stderr, "\"%s\" is not a pcap file (pcapng is not supported)\n", path);
+      return false;
+    }
+
+    const uint32_t link_type = load_u32(data + 20, swapped) & 0xffffU;
+
+    for (size_t offset = 24; offset + 16 <= size;) {
+      const uint64_t seconds = load_u32(data + offset, swapped);
+      const uint64_t fraction = load_u32(data + offset + 4, swapped);
+      const size_t captured = load_u32(data + offset + 8, swapped);
+      const size_t original = load_u32(data + offset + 12, swapped);
+      offset += 16;
+      if (captured > size - offset)
+        break;
+
+      const uint64_t time_us = seconds * 1000000U + (nanoseconds ? fraction / 1000U : fraction);
+      if (captured < original) {
+        skipped_++;
+      } else {
+        add_frame(data + offset, captured, link_type, port, time_us);
+      }
+      offset += captured;
+    }
+
+    offsets_.push_back(bytes_.size());
+    return check_empty(path);
+  }
+
+  // Turns a recording into the datagrams that a sender would have sent for it: the tiles of each frame in one burst at
+  // the timestamp of the frame, as stream 0. With 'parity_per_group' above zero, the tiles go in groups of
+  // 'group_size', each followed by its parity datagrams, as nanostream_net_send_tiles_with_parity sends them; a group
+  // size of zero means a tile row. With 'checksum' set, every datagram ends with its checksum.
+  auto load_recording(const char* path, int group_size = 0, const int parity_per_group = 0, const bool checksum = false)
+    -> bool
+  {
+    nanostream_recording* recording = nanostream_recording_open(path);
+    if (!recording) {
+      fprintf(stderr, "failed to open the recording \"%s\"\n", path);
+      return false;
+    }
+
+    const int tiles_x = nanostream_recording_tiles_x(recording);
+    const int tiles_y = nanostream_recording_tiles_y(recording);
+    if (nanostream_net_check_size(tiles_x * NANOSTREAM_TILE_WIDTH, tiles_y * NANOSTREAM_TILE_HEIGHT) != 0) {
+      fprintf(stderr, "the %dx%d tiles of \"%s\" do not fit the transport\n", tiles_x, tiles_y, path);
+      nanostream_recording_close(recording);
+      return false;
+    }
+    if (group_size <= 0)
+      group_size = tiles_x;
+    group_size = std::min(group_size, NANOSTREAM_FEC_MAX_DATA);
+    std::vector<int> group_tiles;
+
+    nanostream_net_header header{};
+    header.type = NANOSTREAM_NET_TILE;
+    header.flags = checksum ? NANOSTREAM_NET_FLAG_CHECKSUM : 0;
+    header.width = tiles_x * NANOSTREAM_TILE_WIDTH;
+    header.height = tiles_y * NANOSTREAM_TILE_HEIGHT;
+
+    const int num_frames = nanostream_recording_num_frames(recording);
+    for (int i = 0; i < num_frames; i++) {
+      nanostream_recording_frame frame{};
+      if (nanostream_recording_get_frame(recording, i, &frame) != 0)
+        break;
+
+      header.frame = static_cast<uint32_t>(i);
+      header.num_tiles = frame.num_tiles;
+      header.timestamp_us = frame.timestamp_us;
+
+      for (int t = 0; t < frame.num_tiles; t++) {
+        int tile_x = 0;
+        int tile_y = 0;
+        const unsigned char* packet = nanostream_recording_tile(&frame, t, &tile_x, &tile_y);
+        header.type = NANOSTREAM_NET_TILE;
+        header.tile = tile_y * tiles_x + tile_x;
+
+        const size_t start = bytes_.size();
+        const size_t tile_size = NANOSTREAM_NET_HEADER_SIZE + NANOSTREAM_PACKET_SIZE;
+        bytes_.resize(start + tile_size + (checksum ? NANOSTREAM_NET_CHECKSUM_SIZE : 0));
+        nanostream_net_store_header(bytes_.data() + start, &header);
+        memcpy(bytes_.data() + start + NANOSTREAM_NET_HEADER_SIZE, packet, NANOSTREAM_PACKET_SIZE);
+        if (checksum)
+          nanostream_net_store_checksum(bytes_.data() + start, tile_size);
+        offsets_.push_back(start);
+        times_.push_back(frame.timestamp_us);
+        header.sequence++;
+
+        group_tiles.push_back(header.tile);
+        const bool group_done = (static_cast<int>(group_tiles.size()) == group_size) || (t + 1 == frame.num_tiles);
+        if ((parity_per_group > 0) && group_done) {
+          // The packets of a frame are stored back to back, so the group ends at this packet.
+          const int k = static_cast<int>(group_tiles.size());
+          const unsigned char* first = packet - static_cast<size_t>(k - 1) * NANOSTREAM_PACKET_SIZE;
+          const size_t size = nanostream_net_parity_size(k) + (checksum ? NANOSTREAM_NET_CHECKSUM_SIZE : 0);
+          const size_t parity_start = bytes_.size();
+          bytes_.resize(parity_start + size * static_cast<size_t>(parity_per_group));
+          nanostream_net_store_parity(
+            bytes_.data() + parity_start, &header, group_tiles.data(), first, k, parity_per_group);
+          for (int j = 0; j < parity_per_group; j++) {
+            offsets_.push_back(parity_start + size * static_cast<size_t>(j));
+            times_.push_back(frame.timestamp_us);
+          }
+          header.sequence += static_cast<uint32_t>(parity_per_group);
+        }
+        if (group_done)
+          group_tiles.clear();
+      }
+    }
+
+    nanostream_recording_close(recording);
+    offsets_.push_back(bytes_.size());
+    return check_empty(path);
+  }
+
+private:
+  static auto load_u16be(const unsigned char* p) -> uint32_t { return (static_cast<uint32_t>(p[0]) << 8) | p[1]; }
+
+  static auto load_u32(const unsigned char* p, const bool swapped) -> uint32_t
+  {
+    uint32_t value = 0;
+    memcpy(&value, p, 4);
+    return swapped ? __builtin_bswap32(value) : value;
+  }
+
+  auto check_empty(const char* path) const -> bool
+  {
+    if (times_.empty()) {
+      fprintf(stderr, "\"%s\" has no nanostream datagrams\n", path);
+      return false;
+    }
+    return true;
+  }
+
+  // Strips the link layer header, and returns the IP version of the packet, or zero if it is not IP.
+  static auto strip_link(const unsigned char*& p, size_t& size, const uint32_t link_type) -> int
+  {
+    uint32_t protocol = 0;
+    switch (link_type) {
+      case 1: // Ethernet, possibly with VLAN tags
+        if (size < 14)
+          return 0;
+        protocol = load_u16be(p + 12);
+        p += 14;
+        size -= 14;
+        while (((protocol == 0x8100U) || (protocol == 0x88a8U)) && (size >= 4)) {
+          protocol = load_u16be(p + 2);
+          p += 4;
+          size -= 4;
+        }
+        break;
+      case 113: // Linux cooked capture
+        if (size < 16)
+          return 0;
+        protocol = load_u16be(p + 14);
+        p += 16;
+        size -= 16;
+        break;
+      case 276: // Linux cooked capture v2
+        if (size < 20)
+          return 0;
+        protocol = load_u16be(p);
+        p += 20;
+        size -= 20;
+        break;
+      case 0: // BSD loopback, with the address family in host order
+        if (size < 4)
+          return 0;
+        p += 4;
+        size -= 4;
+        return (size > 0) ? (p[0] >> 4) : 0;
+      case 101: // Raw IP
+      case 228:
+      case 229:
+        return (size > 0) ? (p[0] >> 4) : 0;
+      default:
+        return 0;
+    }
+
+    if (protocol == 0x0800U)
+      return 4;
+    if (protocol == 0x86ddU)
+      return 6;
+    return 0;
+  }
+
+  void add_frame(const unsigned char* p, size_t size, const uint32_t link_type, const int port, const uint64_t time_us)
+  {
+    const int version = strip_link(p, size, link_type);
+
+    if ((version == 4) && (size >= 20)) {
+      const size_t header_size = static_cast<size_t>(p[0] & 0x0f) * 4;
+      const uint32_t total = load_u16be(p + 2);
+      // Only whole datagrams: fragments are skipped.
+      const bool fragment = (load_u16be(p + 6) & 0x3fffU) != 0;
+      if ((p[9] != 17) || fragment || (header_size < 20) || (total > size) || (total < header_size))
+        return;
+      add_udp(p + header_size, total - header_size, port, time_us);
+    } else if ((version == 6) && (size >= 40)) {
+      const size_t payload = load_u16be(p + 4);
+      if ((p[6] != 17) || (payload > size - 40))
+        return;
+      add_udp(p + 40, payload, port, time_us);
+    }
+  }
+
+  void add_udp(const unsigned char* p, const size_t size, const int port, const uint64_t time_us)
+  {
+    if (size < 8)
+      return;
+
+    const size_t length = load_u16be(p + 4);
+    if ((port != 0) && (load_u16be(p + 2) != static_cast<uint32_t>(port)))
+      return;
+    if ((length < 8) || (length > size))
+      return;
+
+    const unsigned char* payload = p + 8;
+    const size_t payload_size = length - 8;
+    nanostream_net_header header{};
+    if (nanostream_net_parse_header(payload, payload_size, &header) != 0) {
+      skipped_++;
+      return;
+    }
+
+    offsets_.push_back(bytes_.size());
+    bytes_.insert(bytes_.end(), payload, payload + payload_size);
+    times_.push_back(time_us);
+  }
+
+  std::vector<unsigned char> bytes_;
+
+  // The start of each datagram in 'bytes_', and its end as the last entry once loaded.
+  std::vector<size_t> offsets_;
+
+  std::vector<uint64_t> times_;
+
+  uint64_t skipped_{ 0 };
+};
+
+} // namespace nanostream_tools
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+#include <time.h>
+
+namespace nanostream_tools {
+
+// CLOCK_MONOTONIC in microseconds, the clock the encode server and the transport timestamps use.
+inline auto
+now_us() -> uint64_t
+{
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000U + static_cast<uint64_t>(ts.tv_nsec) / 1000U;
+}
+
+// The CPU time of the calling thread in microseconds.
+inline auto
+thread_cpu_us() -> uint64_t
+{
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000U + static_cast<uint64_t>(ts.tv_nsec) / 1000U;
+}
+
+} // namespace nanostream_tools
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "raster.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace nanostream_tools {
+
+// Maps an image file and finds its pixels, naming the file in the error message if it is not a raster.
+inline auto
+open_image(const char* path, MappedFile* file, Raster* raster) -> bool
+{
+  if (!file->open_read(path))
+    return false;
+  if (!open_raster(file->data(), file->size(), file->size(), nullptr, raster)) {
+    fprintf(stderr, "in \"%s\"\n", path);
+    return false;
+  }
+  return true;
+}
+
+inline auto
+squared_error(const unsigned char* a, const unsigned char* b, const size_t n) -> double
+{
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    const double d = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+    sum += d * d;
+  }
+  return sum;
+}
+
+// The peak signal to noise ratio of 8-bit values with the given sum of squared errors, capped at 99 dB when there is
+// no error.
+inline auto
+psnr(const double squared_error, const double values) -> double
+{
+  const double mse = (values > 0.0) ? (squared_error / values) : 0.0;
+  return (mse > 0.0) ? (10.0 * std::log10(255.0 * 255.0 / mse)) : 99.0;
+}
+
+// Collects the input image paths among the arguments from 'first' on. Every option takes a value, and is handed to
+// 'parse_option', which returns false if it does not know the option.
+template<typename ParseOption>
+auto
+parse_inputs(const int argc, char** argv, const int first, ParseOption parse_option, std::vector<const char*>* inputs)
+  -> bool
+{
+  for (int i = first; i < argc; i++) {
+    if (strncmp(argv[i], "--", 2) != 0) {
+      inputs->push_back(argv[i]);
+    } else if (((i + 1) < argc) && parse_option(argv[i], argv[i + 1])) {
+      i++;
+    } else {
+      fprintf(stderr, "unknown option \"%s\"\n", argv[i]);
+      return false;
+    }
+  }
+
+  if (inputs->empty()) {
+    fprintf(stderr, "no input images\n");
+    return false;
+  }
+  return true;
+}
+
+// Runs the command line of a tool that trains a model on images and evaluates it, "<program> train <model> <input>..."
+// or "<program> eval <model> <input>...". 'parse_arguments' collects the inputs and options from the given argument
+// on, and 'train' and 'evaluate' are given the model path and the inputs. Prints the usage if the arguments are wrong.
+template<typename ParseArguments, typename Train, typename Evaluate>
+auto
+train_or_evaluate(const int argc,
+                  char** argv,
+                  void (*print_usage)(const char*),
+                  ParseArguments parse_arguments,
+                  Train train,
+                  Evaluate evaluate) -> int
+{
+  const bool training = (argc >= 4) && (strcmp(argv[1], "train") == 0);
+  const bool evaluating = (argc >= 4) && (strcmp(argv[1], "eval") == 0);
+
+  std::vector<const char*> inputs;
+  if ((!training && !evaluating) || !parse_arguments(argc, argv, 3, &inputs)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  return training ? train(argv[2], inputs) : evaluate(argv[2], inputs);
+}
+
+} // namespace nanostream_tools
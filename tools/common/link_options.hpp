@@ -0,0 +1,88 @@
+#pragma once
+
+#include <nanostream_link.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace nanostream_tools {
+
+// The command line options of the link emulator, for the usage text of the tools that take them.
+constexpr const char* link_usage =
+  "link options: [--seed N] [--loss <rate> | --loss-ge <good to bad>,<bad to good>[,<loss good>,<loss bad>]]\n"
+  "              [--delay <ms>] [--jitter <ms>] [--rate <Mbit/s>] [--bucket <bytes>] [--max-queue <ms>]\n"
+  "              [--reorder <rate>] [--reorder-delay <ms>]\n";
+
+// Parses the link emulator option at argv[*i], if it is one, and moves *i past its value. Returns false if it is not
+// a link option; sets *error if it is one but its value is not valid.
+inline auto
+parse_link_option(const int argc, char** argv, int* i, nanostream_link_config* config, bool* error) -> bool
+{
+  const char* name = argv[*i];
+  if ((*i + 1) >= argc)
+    return false;
+  const char* value = argv[*i + 1];
+
+  const auto ms_to_us = [](const char* text) { return static_cast<uint64_t>(atof(text) * 1000.0); };
+
+  if (strcmp(name, "--seed") == 0) {
+    config->seed = strtoull(value, nullptr, 0);
+  } else if (strcmp(name, "--loss") == 0) {
+    config->loss_model = NANOSTREAM_LOSS_RANDOM;
+    config->loss_rate = atof(value);
+  } else if (strcmp(name, "--loss-ge") == 0) {
+    config->loss_model = NANOSTREAM_LOSS_GILBERT_ELLIOTT;
+    config->loss_good = 0.0;
+    config->loss_bad = 1.0;
+    const int n = sscanf(value,
+                         "%lf,%lf,%lf,%lf",
+                         &config->good_to_bad,
+                         &config->bad_to_good,
+                         &config->loss_good,
+                         &config->loss_bad);
+    if ((n != 2) && (n != 4)) {
+      fprintf(stderr, "--loss-ge takes two or four probabilities separated by commas\n");
+      *error = true;
+    }
+  } else if (strcmp(name, "--delay") == 0) {
+    config->delay_us = ms_to_us(value);
+  } else if (strcmp(name, "--jitter") == 0) {
+    config->jitter_us = ms_to_us(value);
+  } else if (strcmp(name, "--rate") == 0) {
+    config->rate_bps = static_cast<uint64_t>(atof(value) * 1.0e6);
+  } else if (strcmp(name, "--bucket") == 0) {
+    config->bucket_size = static_cast<size_t>(atol(value));
+  } else if (strcmp(name, "--max-queue") == 0) {
+    config->max_queue_us = ms_to_us(value);
+  } else if (strcmp(name, "--reorder") == 0) {
+    config->reorder_rate = atof(value);
+  } else if (strcmp(name, "--reorder-delay") == 0) {
+    config->reorder_delay_us = ms_to_us(value);
+  } else {
+    return false;
+  }
+
+  (*i)++;
+  return true;
+}
+
+inline void
+print_link_stats(const nanostream_link_stats& stats)
+{
+  const double delivered = static_cast<double>(stats.datagrams_out);
+  printf("link: %llu in, %llu out, %llu lost in %llu bursts (longest %llu), %llu queue drops, %llu overflow drops,"
+         " %llu reordered, delay %.3f ms mean, %.3f ms max\n",
+         static_cast<unsigned long long>(stats.datagrams_in),
+         static_cast<unsigned long long>(stats.datagrams_out),
+         static_cast<unsigned long long>(stats.lost),
+         static_cast<unsigned long long>(stats.loss_bursts),
+         static_cast<unsigned long long>(stats.longest_loss_burst),
+         static_cast<unsigned long long>(stats.queue_drops),
+         static_cast<unsigned long long>(stats.overflow_drops),
+         static_cast<unsigned long long>(stats.reordered),
+         (delivered > 0.0) ? static_cast<double>(stats.total_delay_us) * 1.0e-3 / delivered : 0.0,
+         static_cast<double>(stats.max_delay_us) * 1.0e-3);
+}
+
+} // namespace nanostream_tools
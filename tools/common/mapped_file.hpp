@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nanostream_tools {
+
+// A file mapped into memory, either read-only or created at a fixed size for writing.
+class MappedFile
+{
+public:
+  MappedFile() = default;
+
+  MappedFile(const MappedFile&) = delete;
+
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+  ~MappedFile() { close(); }
+
+  auto open_read(const char* path) -> bool
+  {
+    close();
+
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      fprintf(stderr, "failed to open \"%s\"\n", path);
+      return false;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+      fprintf(stderr, "failed to get the size of \"%s\"\n", path);
+      ::close(fd);
+      return false;
+    }
+
+    return map(fd, static_cast<size_t>(st.st_size), PROT_READ, path);
+  }
+
+  auto create(const char* path, const size_t size) -> bool
+  {
+    close();
+
+    const int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      fprintf(stderr, "failed to create \"%s\"\n", path);
+      return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      fprintf(stderr, "failed to resize \"%s\"\n", path);
+      ::close(fd);
+      return false;
+    }
+
+    return map(fd, size, PROT_READ | PROT_WRITE, path);
+  }
+
+  void close()
+  {
+    if (data_) {
+      munmap(data_, size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  // Hints that the mapping will be read from start to end.
+  void advise_sequential() { madvise(data_, size_, MADV_SEQUENTIAL); }
+
+  [[nodiscard]] auto data() -> unsigned char* { return static_cast<unsigned char*>(data_); }
+
+  [[nodiscard]] auto data() const -> const unsigned char* { return static_cast<const unsigned char*>(data_); }
+
+  [[nodiscard]] auto size() const -> size_t { return size_; }
+
+private:
+  auto map(const int fd, const size_t size, const int prot, const char* path) -> bool
+  {
+    void* data = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      fprintf(stderr, "failed to map \"%s\"\n", path);
+      return false;
+    }
+    data_ = data;
+    size_ = size;
+    return true;
+  }
+
+  void* data_{ nullptr };
+
+  size_t size_{ 0 };
+};
+
+} // namespace nanostream_tools
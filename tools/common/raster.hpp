@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace nanostream_tools {
+
+// An uncompressed RGB raster inside a mapped file: either a binary PPM or headerless raw pixels.
+struct Raster
+{
+  int width{ 0 };
+
+  int height{ 0 };
+
+  // The offset of the first pixel in the file.
+  size_t offset{ 0 };
+
+  [[nodiscard]] auto pitch() const -> size_t { return static_cast<size_t>(width) * 3; }
+
+  [[nodiscard]] auto pixel_size() const -> size_t { return pitch() * static_cast<size_t>(height); }
+};
+
+// Parses a size argument of the form "<width>x<height>".
+inline auto
+parse_size(const char* text, int* width, int* height) -> bool
+{
+  return (sscanf(text, "%dx%d", width, height) == 2) && (*width > 0) && (*height > 0);
+}
+
+inline auto
+has_extension(const char* path, const char* extension) -> bool
+{
+  const size_t n = strlen(path);
+  const size_t m = strlen(extension);
+  return (n >= m) && (strcmp(path + n - m, extension) == 0);
+}
+
+namespace detail {
+
+inline auto
+skip_space_and_comments(const unsigned char* data, const size_t size, size_t i) -> size_t
+{
+  while (i < size) {
+    if (data[i] == '#') {
+      while ((i < size) && (data[i] != '\n'))
+        i++;
+    } else if ((data[i] == ' ') || (data[i] == '\t') || (data[i] == '\r') || (data[i] == '\n')) {
+      i++;
+    } else {
+      break;
+    }
+  }
+  return i;
+}
+
+inline auto
+read_number(const unsigned char* data, const size_t size, size_t* i, long* value) -> bool
+{
+  *i = skip_space_and_comments(data, size, *i);
+  long v = 0;
+  size_t digits = 0;
+  while ((*i < size) && (data[*i] >= '0') && (data[*i] <= '9') && (digits < 10)) {
+    v = v * 10 + (data[*i] - '0');
+    (*i)++;
+    digits++;
+  }
+  *value = v;
+  return digits > 0;
+}
+
+} // namespace detail
+
+// Parses the header of a binary PPM with a maximum value of 255, without checking that the pixels follow.
+inline auto
+parse_ppm_header(const unsigned char* data, const size_t size, Raster* raster) -> bool
+{
+  if ((size < 2) || (data[0] != 'P') || (data[1] != '6'))
+    return false;
+
+  size_t i = 2;
+  long w = 0;
+  long h = 0;
+  long max_value = 0;
+  if (!detail::read_number(data, size, &i, &w) || !detail::read_number(data, size, &i, &h) ||
+      !detail::read_number(data, size, &i, &max_value))
+    return false;
+
+  // Exactly one whitespace character separates the header from the pixels.
+  if ((i >= size) || (max_value != 255) || (w <= 0) || (h <= 0) || (w > 0x7FFFFFFF / 3) || (h > 0x7FFFFFFF))
+    return false;
+
+  raster->width = static_cast<int>(w);
+  raster->height = static_cast<int>(h);
+  raster->offset = i + 1;
+  return true;
+}
+
+// Writes a PPM header into 'out', which must hold at least 32 bytes, and returns its length.
+inline auto
+format_ppm_header(char* out, const int width, const int height) -> size_t
+{
+  return static_cast<size_t>(snprintf(out, 32, "P6\n%d %d\n255\n", width, height));
+}
+
+// Works out the raster in an input file from its first 'head_size' bytes: a PPM, or raw pixels of the given size if
+// 'raw_size' is not null. The head may be the whole file when it is mapped.
+inline auto
+open_raster(const unsigned char* head,
+            const size_t head_size,
+            const size_t file_size,
+            const char* raw_size,
+            Raster* raster) -> bool
+{
+  if (raw_size) {
+    if (!parse_size(raw_size, &raster->width, &raster->height)) {
+      fprintf(stderr, "invalid raw size \"%s\", expected <width>x<height>\n", raw_size);
+      return false;
+    }
+    raster->offset = 0;
+  } else if (!parse_ppm_header(head, head_size, raster)) {
+    fprintf(stderr, "input is not a binary PPM with 8-bit samples (use --raw <width>x<height> for raw pixels)\n");
+    return false;
+  }
+
+  if (raster->offset + raster->pixel_size() > file_size) {
+    fprintf(stderr, "input is smaller than %dx%d RGB pixels\n", raster->width, raster->height);
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace nanostream_tools
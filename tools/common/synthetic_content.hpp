@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace nanostream_tools {
+
+enum class ContentClass
+{
+  // A still image.
+  still,
+  // Lines of text scrolling up.
+  text,
+  // A still image with fresh sensor noise in every frame.
+  noise,
+  // A camera panning across a scene.
+  pan,
+  // A different scene every second or so.
+  cuts
+};
+
+inline auto
+content_class_name(const ContentClass c) -> const char*
+{
+  switch (c) {
+    case ContentClass::still:
+      return "static";
+    case ContentClass::text:
+      return "text";
+    case ContentClass::noise:
+      return "noise";
+    case ContentClass::pan:
+      return "pan";
+    case ContentClass::cuts:
+      return "cuts";
+  }
+  return "unknown";
+}
+
+inline auto
+parse_content_class(const char* name, ContentClass* c) -> bool
+{
+  for (const ContentClass candidate :
+       { ContentClass::still, ContentClass::text, ContentClass::noise, ContentClass::pan, ContentClass::cuts }) {
+    if (strcmp(name, content_class_name(candidate)) == 0) {
+      *c = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Synthetic frames of one content class. Every frame is a view into canvases that are drawn once up front, so
+// producing a frame costs nothing and a load test measures the codec and the transport only. Views stay valid for the
+// lifetime of the object.
+class SyntheticContent
+{
+public:
+  // Frames per scene of the 'cuts' class, and pixels moved per frame by 'pan' and 'text'.
+  static constexpr int frames_per_cut = 30;
+  static constexpr int pan_speed = 4;
+  static constexpr int scroll_speed = 2;
+
+  SyntheticContent(const ContentClass c, const int width, const int height, const uint32_t seed)
+    : class_(c)
+    , width_(width)
+    , height_(height)
+  {
+    std::mt19937 rng(seed);
+
+    switch (c) {
+      case ContentClass::still:
+        add_canvas(width, height);
+        draw_scene(canvases_[0].data(), width, height, pitch_, rng);
+        break;
+      case ContentClass::text:
+        // Twice as tall, with the bottom half repeating the top, so that every scroll offset is a valid view.
+        add_canvas(width, height * 2);
+        draw_text(canvases_[0].data(), width, height, pitch_, rng);
+        memcpy(canvases_[0].data() + static_cast<size_t>(height) * pitch_,
+               canvases_[0].data(),
+               static_cast<size_t>(height) * pitch_);
+        break;
+      case ContentClass::noise:
+        for (int i = 0; i < num_noise_frames; i++)
+          add_canvas(width, height);
+        draw_scene(canvases_[0].data(), width, height, pitch_, rng);
+        for (int i = num_noise_frames - 1; i >= 0; i--)
+          add_noise(canvases_[0].data(), canvases_[i].data(), rng);
+        break;
+      case ContentClass::pan:
+        // Twice as wide, with the right half repeating the left.
+        add_canvas(width * 2, height);
+        draw_scene(canvases_[0].data(), width, height, pitch_, rng);
+        for (int y = 0; y < height; y++) {
+          unsigned char* row = canvases_[0].data() + static_cast<size_t>(y) * pitch_;
+          memcpy(row + static_cast<size_t>(width) * 3, row, static_cast<size_t>(width) * 3);
+        }
+        break;
+      case ContentClass::cuts:
+        for (int i = 0; i < num_scenes; i++) {
+          add_canvas(width, height);
+          draw_scene(canvases_[i].data(), width, height, pitch_, rng);
+        }
+        break;
+    }
+  }
+
+  [[nodiscard]] auto width() const -> int { return width_; }
+
+  [[nodiscard]] auto height() const -> int { return height_; }
+
+  [[nodiscard]] auto pitch() const -> int { return pitch_; }
+
+  [[nodiscard]] auto content_class() const -> ContentClass { return class_; }
+
+  [[nodiscard]] auto frame(const uint64_t index) const -> const unsigned char*
+  {
+    switch (class_) {
+      case ContentClass::still:
+        return canvases_[0].data();
+      case ContentClass::text: {
+        const uint64_t y = (index * scroll_speed) % static_cast<uint64_t>(height_);
+        return canvases_[0].data() + y * static_cast<uint64_t>(pitch_);
+      }
+      case ContentClass::noise:
+        return canvases_[index % num_noise_frames].data();
+      case ContentClass::pan: {
+        const uint64_t x = (index * pan_speed) % static_cast<uint64_t>(width_);
+        return canvases_[0].data() + x * 3;
+      }
+      case ContentClass::cuts:
+        return canvases_[(index / frames_per_cut) % num_scenes].data();
+    }
+    return nullptr;
+  }
+
+private:
+  static constexpr int num_noise_frames = 4;
+
+  static constexpr int num_scenes = 4;
+
+  void add_canvas(const int width, const int height)
+  {
+    pitch_ = width * 3;
+    canvases_.emplace_back(static_cast<size_t>(pitch_) * height);
+  }
+
+  // A gradient sky over a textured ground, with a few soft shapes in front.
+  static void draw_scene(unsigned char* rgb, const int w, const int h, const int pitch, std::mt19937& rng)
+  {
+    std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+    const float hue[3] = { unit(rng), unit(rng), unit(rng) };
+    const float horizon = 0.3F + 0.4F * unit(rng);
+    const float fx = 0.01F + 0.05F * unit(rng);
+    const float fy = 0.01F + 0.05F * unit(rng);
+
+    for (int y = 0; y < h; y++) {
+      unsigned char* row = rgb + static_cast<size_t>(y) * pitch;
+      const float v = static_cast<float>(y) / static_cast<float>(h);
+      for (int x = 0; x < w; x++) {
+        for (int c = 0; c < 3; c++) {
+          float value = 0.0F;
+          if (v < horizon) {
+            value = 0.5F + 0.4F * hue[c] * (1.0F - v / horizon);
+          } else {
+            value = 0.25F + 0.2F * hue[(c + 1) % 3] + 0.1F * std::sin(x * fx + c) * std::cos(y * fy);
+          }
+          row[x * 3 + c] = static_cast<unsigned char>(std::clamp(value, 0.0F, 1.0F) * 255.0F);
+        }
+      }
+    }
+
+    std::uniform_int_distribution<int> px(0, w - 1);
+    std::uniform_int_distribution<int> py(0, h - 1);
+    const int num_shapes = 8 + static_cast<int>(unit(rng) * 16);
+    for (int i = 0; i < num_shapes; i++) {
+      const int cx = px(rng);
+      const int cy = py(rng);
+      const int r = 4 + static_cast<int>(unit(rng) * static_cast<float>(std::min(w, h)) / 8.0F);
+      const unsigned char color[3] = { static_cast<unsigned char>(unit(rng) * 255.0F),
+                                       static_cast<unsigned char>(unit(rng) * 255.0F),
+                                       static_cast<unsigned char>(unit(rng) * 255.0F) };
+      for (int y = std::max(cy - r, 0); y < std::min(cy + r, h); y++) {
+        for (int x = std::max(cx - r, 0); x < std::min(cx + r, w); x++) {
+          if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r)
+            memcpy(rgb + static_cast<size_t>(y) * pitch + x * 3, color, 3);
+        }
+      }
+    }
+  }
+
+  // Dark 5x7 glyphs in lines of words on a light background, like a terminal or a document.
+  static void draw_text(unsigned char* rgb, const int w, const int h, const int pitch, std::mt19937& rng)
+  {
+    for (int y = 0; y < h; y++)
+      memset(rgb + static_cast<size_t>(y) * pitch, 235, static_cast<size_t>(w) * 3);
+
+    constexpr int cell_w = 7;
+    constexpr int cell_h = 12;
+    std::uniform_int_distribution<int> glyph_bits(0, (1 << 20) - 1);
+    std::uniform_int_distribution<int> word_length(1, 9);
+    std::uniform_int_distribution<int> line_length(0, w / cell_w);
+
+    for (int line = 0; line + cell_h <= h; line += cell_h) {
+      const int columns = line_length(rng);
+      int column = 1;
+      while (column < columns) {
+        const int end = std::min(column + word_length(rng), columns);
+        for (; column < end; column++) {
+          // 35 pseudo-random bits from two draws, one per pixel of the glyph.
+          const uint64_t bits = (static_cast<uint64_t>(glyph_bits(rng)) << 20) | static_cast<uint64_t>(glyph_bits(rng));
+          for (int gy = 0; gy < 7; gy++) {
+            for (int gx = 0; gx < 5; gx++) {
+              if (!((bits >> (gy * 5 + gx)) & 1))
+                continue;
+              const int x = column * cell_w + gx;
+              const int y = line + 2 + gy;
+              if (x < w)
+                memset(rgb + static_cast<size_t>(y) * pitch + x * 3, 30, 3);
+            }
+          }
+        }
+        column++;
+      }
+    }
+  }
+
+  void add_noise(const unsigned char* clean, unsigned char* out, std::mt19937& rng) const
+  {
+    std::uniform_int_distribution<int> noise(-6, 6);
+    const size_t size = static_cast<size_t>(pitch_) * height_;
+    for (size_t i = 0; i < size; i++) {
+      const int value = clean[i] + noise(rng) + noise(rng);
+      out[i] = static_cast<unsigned char>(std::clamp(value, 0, 255));
+    }
+  }
+
+  ContentClass class_;
+
+  int width_;
+
+  int height_;
+
+  int pitch_{ 0 };
+
+  std::vector<std::vector<unsigned char>> canvases_;
+};
+
+} // namespace nanostream_tools
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nanostream_tools {
+
+// A fixed set of worker threads that split ranges of tiles between them. The calling thread works on the range too.
+class TilePool
+{
+public:
+  explicit TilePool(const int num_threads = 0)
+  {
+    const int n = (num_threads > 0) ? num_threads : static_cast<int>(std::thread::hardware_concurrency());
+    for (int i = 1; i < std::max(n, 1); i++)
+      workers_.emplace_back([this] { work(); });
+  }
+
+  TilePool(const TilePool&) = delete;
+
+  auto operator=(const TilePool&) -> TilePool& = delete;
+
+  ~TilePool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    start_.notify_all();
+    for (auto& worker : workers_)
+      worker.join();
+  }
+
+  [[nodiscard]] auto num_threads() const -> int { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls 'fn(first, count)' on chunks of [0, num_items) and returns once every chunk is done.
+  void run(const int num_items, const int chunk_size, std::function<void(int, int)> fn)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fn_ = std::move(fn);
+      num_items_ = num_items;
+      chunk_size_ = std::max(chunk_size, 1);
+      next_.store(0);
+      busy_ = static_cast<int>(workers_.size());
+      generation_++;
+    }
+    start_.notify_all();
+
+    process();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    fn_ = nullptr;
+  }
+
+private:
+  void process()
+  {
+    for (;;) {
+      const int first = next_.fetch_add(chunk_size_);
+      if (first >= num_items_)
+        break;
+      fn_(first, std::min(chunk_size_, num_items_ - first));
+    }
+  }
+
+  void work()
+  {
+    unsigned long long seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        start_.wait(lock, [&] { return stop_ || (generation_ != seen); });
+        if (stop_)
+          return;
+        seen = generation_;
+      }
+
+      process();
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_ == 0)
+        done_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+
+  std::condition_variable start_;
+
+  std::condition_variable done_;
+
+  std::function<void(int, int)> fn_;
+
+  std::atomic<int> next_{ 0 };
+
+  int num_items_{ 0 };
+
+  int chunk_size_{ 1 };
+
+  int busy_{ 0 };
+
+  unsigned long long generation_{ 0 };
+
+  bool stop_{ false };
+};
+
+} // namespace nanostream_tools
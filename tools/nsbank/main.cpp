@@ -0,0 +1,217 @@
+#include "../common/image.hpp"
+
+#include <nanostream.h>
+#include <nanostream_basis.h>
+#include <nanostream_frame.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace nanostream_tools;
+
+constexpr int tile_pitch = NANOSTREAM_TILE_WIDTH * 3;
+
+constexpr size_t tile_size = static_cast<size_t>(tile_pitch) * NANOSTREAM_TILE_HEIGHT;
+
+struct Options
+{
+  nanostream_basis_bank_config bank{};
+
+  // The most whole tiles taken from each training image, spread over it.
+  int tiles_per_image{ 64 };
+};
+
+void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+          "usage:\n"
+          "  %s train <output.nsb> <input.ppm>... [--bases N] [--rounds N] [--tiles-per-image N]\n"
+          "  %s eval <bank.nsb> <input.ppm>...\n",
+          program,
+          program);
+}
+
+// Splits the arguments from 'first' on into options and input paths.
+auto
+parse_arguments(const int argc, char** argv, const int first, Options* options, std::vector<const char*>* inputs)
+  -> bool
+{
+  auto parse_option = [options](const char* option, const char* value) {
+    if (strcmp(option, "--bases") == 0)
+      options->bank.num_bases = atoi(value);
+    else if (strcmp(option, "--rounds") == 0)
+      options->bank.rounds = atoi(value);
+    else if (strcmp(option, "--tiles-per-image") == 0)
+      options->tiles_per_image = atoi(value);
+    else
+      return false;
+    return true;
+  };
+  if (!parse_inputs(argc, argv, first, parse_option, inputs))
+    return false;
+  if ((options->bank.num_bases < 0) || (options->bank.num_bases > NANOSTREAM_MAX_BASES) ||
+      (options->tiles_per_image <= 0)) {
+    fprintf(stderr, "the number of bases must be at most %d, and tiles per image positive\n", NANOSTREAM_MAX_BASES);
+    return false;
+  }
+  return true;
+}
+
+// Copies whole tiles, evenly spread over each image, and trains a bank on them.
+auto
+train(const char* output_path, const std::vector<const char*>& inputs, const Options& options) -> int
+{
+  std::vector<unsigned char> pixels;
+  for (const char* path : inputs) {
+    MappedFile file;
+    Raster raster;
+    if (!open_image(path, &file, &raster))
+      return EXIT_FAILURE;
+
+    const int tiles_x = raster.width / NANOSTREAM_TILE_WIDTH;
+    const int whole = tiles_x * (raster.height / NANOSTREAM_TILE_HEIGHT);
+    const int taken = (whole < options.tiles_per_image) ? whole : options.tiles_per_image;
+    for (int k = 0; k < taken; k++) {
+      const int i = static_cast<int>((static_cast<int64_t>(k) * whole) / taken);
+      const unsigned char* in = file.data() + raster.offset +
+                                static_cast<size_t>(i / tiles_x) * NANOSTREAM_TILE_HEIGHT * raster.pitch() +
+                                static_cast<size_t>(i % tiles_x) * tile_pitch;
+      const size_t at = pixels.size();
+      pixels.resize(at + tile_size);
+      for (int row = 0; row < NANOSTREAM_TILE_HEIGHT; row++)
+        memcpy(&pixels[at + static_cast<size_t>(row) * tile_pitch], in + row * raster.pitch(), tile_pitch);
+    }
+  }
+
+  std::vector<const unsigned char*> tiles;
+  for (size_t at = 0; at < pixels.size(); at += tile_size)
+    tiles.push_back(&pixels[at]);
+
+  const auto t0 = std::chrono::steady_clock::now();
+  nanostream_basis* bases[NANOSTREAM_MAX_BASES];
+  const int num_bases =
+    nanostream_basis_bank_train(&options.bank, tiles.data(), static_cast<int>(tiles.size()), tile_pitch, bases);
+  const auto t1 = std::chrono::steady_clock::now();
+  if (num_bases < 0) {
+    fprintf(stderr, "failed to train the bank\n");
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+  MappedFile output;
+  if (output.create(output_path, static_cast<size_t>(num_bases) * NANOSTREAM_BASIS_SIZE)) {
+    for (int i = 0; i < num_bases; i++)
+      nanostream_basis_store(bases[i], output.data() + static_cast<size_t>(i) * NANOSTREAM_BASIS_SIZE);
+    printf("%d bases from %zu tiles in %.2f s\n",
+           num_bases,
+           tiles.size(),
+           std::chrono::duration<double>(t1 - t0).count());
+  } else {
+    result = EXIT_FAILURE;
+  }
+
+  for (int i = 0; i < num_bases; i++)
+    nanostream_basis_destroy(bases[i]);
+  return result;
+}
+
+// Encodes and decodes each image with the built-in basis and with the bank, and compares quality and encode time.
+auto
+evaluate(const char* bank_path, const std::vector<const char*>& inputs) -> int
+{
+  MappedFile bank;
+  if (!bank.open_read(bank_path))
+    return EXIT_FAILURE;
+  nanostream_basis* bases[NANOSTREAM_MAX_BASES];
+  const int num_bases = nanostream_basis_bank_load(bank.data(), bank.size(), bases);
+  if (num_bases < 0) {
+    fprintf(stderr, "\"%s\" is not a bank of bases\n", bank_path);
+    return EXIT_FAILURE;
+  }
+  const nanostream_basis* const* bank_bases = bases;
+
+  printf("%-32s %9s %9s %11s %11s  %s\n", "image", "built-in", "bank", "encode us", "with bank", "tiles per basis");
+
+  int result = EXIT_SUCCESS;
+  for (const char* path : inputs) {
+    MappedFile file;
+    Raster raster;
+    if (!open_image(path, &file, &raster)) {
+      result = EXIT_FAILURE;
+      continue;
+    }
+
+    const int num_tiles = nanostream_frame_tiles_x(raster.width) * nanostream_frame_tiles_y(raster.height);
+    std::vector<unsigned char> packets(static_cast<size_t>(num_tiles) * NANOSTREAM_PACKET_SIZE);
+    std::vector<unsigned char> decoded(raster.pixel_size());
+    const unsigned char* rgb = file.data() + raster.offset;
+    const int pitch = static_cast<int>(raster.pitch());
+
+    const auto t0 = std::chrono::steady_clock::now();
+    nanostream_encode_frame(
+      rgb, raster.width, raster.height, pitch, NANOSTREAM_PADDING_EDGE, 0, num_tiles, packets.data());
+    const auto t1 = std::chrono::steady_clock::now();
+    nanostream_decode_frame(packets.data(), 0, num_tiles, raster.width, raster.height, pitch, decoded.data());
+    const double built_in = squared_error(rgb, decoded.data(), decoded.size());
+
+    const auto t2 = std::chrono::steady_clock::now();
+    nanostream_encode_frame_with_bases(bank_bases,
+                                       num_bases,
+                                       rgb,
+                                       raster.width,
+                                       raster.height,
+                                       pitch,
+                                       NANOSTREAM_PADDING_EDGE,
+                                       0,
+                                       num_tiles,
+                                       packets.data());
+    const auto t3 = std::chrono::steady_clock::now();
+    nanostream_decode_frame_with_bases(
+      bank_bases, num_bases, packets.data(), 0, num_tiles, raster.width, raster.height, pitch, decoded.data());
+    const double with_bank = squared_error(rgb, decoded.data(), decoded.size());
+
+    int uses[NANOSTREAM_MAX_BASES] = {};
+    for (int i = 0; (num_bases > 1) && (i < num_tiles); i++)
+      uses[nanostream_packet_basis(&packets[static_cast<size_t>(i) * NANOSTREAM_PACKET_SIZE])]++;
+
+    const double values = static_cast<double>(decoded.size());
+    printf("%-32s %9.2f %9.2f %11.1f %11.1f ",
+           path,
+           psnr(built_in, values),
+           psnr(with_bank, values),
+           std::chrono::duration<double, std::micro>(t1 - t0).count() / num_tiles,
+           std::chrono::duration<double, std::micro>(t3 - t2).count() / num_tiles);
+    for (int i = 0; i < num_bases; i++)
+      printf(" %d", uses[i]);
+    printf("\n");
+  }
+
+  for (int i = 0; i < num_bases; i++)
+    nanostream_basis_destroy(bases[i]);
+  return result;
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  Options options;
+  return train_or_evaluate(
+    argc,
+    argv,
+    print_usage,
+    [&options](const int argc, char** argv, const int first, std::vector<const char*>* inputs) {
+      return parse_arguments(argc, argv, first, &options, inputs);
+    },
+    [&options](const char* output_path, const std::vector<const char*>& inputs) {
+      return train(output_path, inputs, options);
+    },
+    evaluate);
+}
@@ -0,0 +1,246 @@
+#include "../common/image.hpp"
+
+#include <nanostream.h>
+#include <nanostream_fixed.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Checks on the host that the fixed point codec is compatible with the floating point one: each decoder must decode
+// the packets of the other encoder, and the results must differ by rounding only.
+
+namespace {
+
+using namespace nanostream_tools;
+
+constexpr int tile_pitch = NANOSTREAM_TILE_WIDTH * 3;
+
+constexpr size_t tile_size = static_cast<size_t>(tile_pitch) * NANOSTREAM_TILE_HEIGHT;
+
+using Tile = std::vector<unsigned char>;
+
+struct Limits
+{
+  // The largest difference between the two decoders decoding the same packet.
+  int max_decode_error{ 2 };
+
+  // The largest difference between the coefficient ranges found by the two encoders, where 1 is the difference
+  // between a black and a white pixel.
+  double max_range_error{ 1.0e-4 };
+
+  // The largest difference between quantized coefficients of the two encoders, in quantization steps.
+  int max_step_error{ 1 };
+
+  // How much worse the fixed point encoder may be than the floating point one, in dB.
+  double max_psnr_loss{ 0.05 };
+};
+
+struct Result
+{
+  int decode_error{ 0 };
+
+  double range_error{ 0.0 };
+
+  int step_error{ 0 };
+
+  double steps_differing{ 0.0 };
+
+  double psnr_float{ 0.0 };
+
+  double psnr_fixed{ 0.0 };
+};
+
+auto
+load_float(const unsigned char* p) -> float
+{
+  float f;
+  memcpy(&f, p, sizeof(f));
+  return f;
+}
+
+// Unpacks the [8,8,4,4,2,2,2,2] quantized coefficients of a block.
+void
+unpack(const unsigned char* bits, int* q)
+{
+  q[0] = bits[0];
+  q[1] = bits[1];
+  q[2] = (bits[2] >> 4) & 0x0F;
+  q[3] = bits[2] & 0x0F;
+  for (int i = 0; i < 4; i++)
+    q[4 + i] = (bits[3] >> (i * 2)) & 0x03;
+}
+
+auto
+check(const Tile& tile) -> Result
+{
+  std::vector<unsigned char> packet_float(NANOSTREAM_PACKET_SIZE);
+  std::vector<unsigned char> packet_fixed(NANOSTREAM_PACKET_SIZE);
+  nanostream_encode_tile(tile.data(), tile_pitch, packet_float.data());
+  nanostream_fixed_encode_tile(tile.data(), tile_pitch, packet_fixed.data());
+
+  Result result;
+
+  // Both decoders on the packet of the floating point encoder.
+  Tile decoded_float(tile_size);
+  Tile decoded_fixed(tile_size);
+  nanostream_decode_tile(packet_float.data(), tile_pitch, decoded_float.data());
+  nanostream_fixed_decode_tile(packet_float.data(), tile_pitch, decoded_fixed.data());
+  for (size_t i = 0; i < tile_size; i++)
+    result.decode_error = std::max(result.decode_error, std::abs(decoded_float[i] - decoded_fixed[i]));
+
+  // Both decoders on the packet of the fixed point encoder.
+  Tile decoded_from_fixed(tile_size);
+  nanostream_decode_tile(packet_fixed.data(), tile_pitch, decoded_from_fixed.data());
+  nanostream_fixed_decode_tile(packet_fixed.data(), tile_pitch, decoded_fixed.data());
+  for (size_t i = 0; i < tile_size; i++)
+    result.decode_error = std::max(result.decode_error, std::abs(decoded_from_fixed[i] - decoded_fixed[i]));
+
+  // The coefficient ranges.
+  for (int i = 0; i < 16; i++) {
+    const double a = load_float(packet_float.data() + i * 4);
+    const double b = load_float(packet_fixed.data() + i * 4);
+    result.range_error = std::max(result.range_error, std::fabs(a - b));
+  }
+
+  // The quantized coefficients.
+  const int num_blocks = (NANOSTREAM_TILE_WIDTH / 8) * (NANOSTREAM_TILE_HEIGHT / 8);
+  int differing = 0;
+  for (int block = 0; block < num_blocks; block++) {
+    int qa[8];
+    int qb[8];
+    unpack(packet_float.data() + 64 + block * 4, qa);
+    unpack(packet_fixed.data() + 64 + block * 4, qb);
+    for (int i = 0; i < 8; i++) {
+      result.step_error = std::max(result.step_error, std::abs(qa[i] - qb[i]));
+      differing += (qa[i] != qb[i]) ? 1 : 0;
+    }
+  }
+  result.steps_differing = static_cast<double>(differing) / (num_blocks * 8);
+
+  const double values = static_cast<double>(tile.size());
+  result.psnr_float = psnr(squared_error(tile.data(), decoded_float.data(), tile.size()), values);
+  result.psnr_fixed = psnr(squared_error(tile.data(), decoded_from_fixed.data(), tile.size()), values);
+  return result;
+}
+
+// Tiles that exercise flat areas, saturated colors, edges and noise.
+auto
+synthetic_tiles() -> std::vector<Tile>
+{
+  std::vector<Tile> tiles;
+  std::mt19937 rng(1234);
+
+  for (const int value : { 0, 128, 255 })
+    tiles.emplace_back(tile_size, static_cast<unsigned char>(value));
+
+  Tile gradient(tile_size);
+  Tile checker(tile_size);
+  Tile noise(tile_size);
+  Tile smooth(tile_size);
+  for (int y = 0; y < NANOSTREAM_TILE_HEIGHT; y++) {
+    for (int x = 0; x < NANOSTREAM_TILE_WIDTH; x++) {
+      unsigned char* g = &gradient[y * tile_pitch + x * 3];
+      g[0] = static_cast<unsigned char>(x * 255 / (NANOSTREAM_TILE_WIDTH - 1));
+      g[1] = static_cast<unsigned char>(y * 255 / (NANOSTREAM_TILE_HEIGHT - 1));
+      g[2] = static_cast<unsigned char>(255 - g[0]);
+
+      const unsigned char c = (((x / 5) + (y / 5)) % 2) ? 255 : 0;
+      memset(&checker[y * tile_pitch + x * 3], c, 3);
+
+      for (int i = 0; i < 3; i++) {
+        noise[y * tile_pitch + x * 3 + i] = static_cast<unsigned char>(rng() & 0xFF);
+        smooth[y * tile_pitch + x * 3 + i] =
+          static_cast<unsigned char>(128.0 + 100.0 * std::sin(x * 0.05 + y * 0.03 + i));
+      }
+    }
+  }
+  tiles.push_back(gradient);
+  tiles.push_back(checker);
+  tiles.push_back(noise);
+  tiles.push_back(smooth);
+  return tiles;
+}
+
+// Adds the full tiles of a PPM.
+auto
+load_tiles(const char* path, std::vector<Tile>* tiles) -> bool
+{
+  MappedFile file;
+  Raster raster;
+  if (!open_image(path, &file, &raster))
+    return false;
+
+  for (int ty = 0; ty < raster.height / NANOSTREAM_TILE_HEIGHT; ty++) {
+    for (int tx = 0; tx < raster.width / NANOSTREAM_TILE_WIDTH; tx++) {
+      Tile tile(tile_size);
+      for (int y = 0; y < NANOSTREAM_TILE_HEIGHT; y++) {
+        const size_t row = static_cast<size_t>(ty * NANOSTREAM_TILE_HEIGHT + y);
+        const unsigned char* in = file.data() + raster.offset + row * raster.pitch() + tx * tile_pitch;
+        memcpy(&tile[y * tile_pitch], in, tile_pitch);
+      }
+      tiles->push_back(std::move(tile));
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  std::vector<Tile> tiles = synthetic_tiles();
+  for (int i = 1; i < argc; i++) {
+    if (!load_tiles(argv[i], &tiles))
+      return EXIT_FAILURE;
+  }
+
+  const Limits limits;
+  Result worst;
+  double steps_differing = 0.0;
+  double psnr_float = 0.0;
+  double psnr_fixed = 0.0;
+  bool ok = true;
+
+  for (size_t i = 0; i < tiles.size(); i++) {
+    const Result r = check(tiles[i]);
+    worst.decode_error = std::max(worst.decode_error, r.decode_error);
+    worst.range_error = std::max(worst.range_error, r.range_error);
+    worst.step_error = std::max(worst.step_error, r.step_error);
+    steps_differing += r.steps_differing;
+    psnr_float += r.psnr_float;
+    psnr_fixed += r.psnr_fixed;
+
+    if ((r.decode_error > limits.max_decode_error) || (r.range_error > limits.max_range_error) ||
+        (r.step_error > limits.max_step_error) || ((r.psnr_float - r.psnr_fixed) > limits.max_psnr_loss)) {
+      fprintf(stderr,
+              "tile %zu: decode error %d, range error %g, step error %d, PSNR %.2f dB (float) vs %.2f dB (fixed)\n",
+              i,
+              r.decode_error,
+              r.range_error,
+              r.step_error,
+              r.psnr_float,
+              r.psnr_fixed);
+      ok = false;
+    }
+  }
+
+  const double n = static_cast<double>(tiles.size());
+  printf("%zu tiles\n", tiles.size());
+  printf("largest difference between decoders: %d\n", worst.decode_error);
+  printf("largest difference in coefficient ranges: %g\n", worst.range_error);
+  printf("largest difference in quantized coefficients: %d step(s), %.3f%% differ\n",
+         worst.step_error,
+         steps_differing / n * 100.0);
+  printf("mean PSNR: %.3f dB (float encoder), %.3f dB (fixed encoder)\n", psnr_float / n, psnr_fixed / n);
+  printf("%s\n", ok ? "compatible" : "NOT compatible");
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
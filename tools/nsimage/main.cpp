@@ -0,0 +1,381 @@
+#include "../common/buffer_pool.hpp"
+#include "../common/mapped_file.hpp"
+#include "../common/raster.hpp"
+#include "../common/tile_pool.hpp"
+
+#include <nanostream.h>
+#include <nanostream_frame.h>
+#include <nanostream_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using namespace nanostream_tools;
+
+struct Options
+{
+  const char* command{ nullptr };
+
+  const char* input{ nullptr };
+
+  const char* output{ nullptr };
+
+  const char* raw_size{ nullptr };
+
+  nanostream_padding padding{ NANOSTREAM_PADDING_EDGE };
+
+  int threads{ 0 };
+
+  // The number of tile rows per band when encoding out of core, or zero to map the whole input.
+  int bands{ 0 };
+};
+
+void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+          "usage:\n"
+          "  %s encode <input.ppm> <output.nsi> [--raw <width>x<height>] [--padding edge|black] [--threads N]\n"
+          "                                        [--bands <tile rows>]\n"
+          "  %s decode <input.nsi> <output.ppm|output.raw> [--threads N]\n",
+          program,
+          program);
+}
+
+auto
+parse_options(const int argc, char** argv, Options* options) -> bool
+{
+  if (argc < 4)
+    return false;
+
+  options->command = argv[1];
+  options->input = argv[2];
+  options->output = argv[3];
+
+  for (int i = 4; i < argc; i++) {
+    const bool has_value = (i + 1) < argc;
+    if ((strcmp(argv[i], "--raw") == 0) && has_value) {
+      options->raw_size = argv[++i];
+    } else if ((strcmp(argv[i], "--threads") == 0) && has_value) {
+      options->threads = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--bands") == 0) && has_value) {
+      options->bands = atoi(argv[++i]);
+      if (options->bands <= 0) {
+        fprintf(stderr, "the band height must be at least one tile row\n");
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--padding") == 0) && has_value) {
+      const char* padding = argv[++i];
+      if (strcmp(padding, "edge") == 0) {
+        options->padding = NANOSTREAM_PADDING_EDGE;
+      } else if (strcmp(padding, "black") == 0) {
+        options->padding = NANOSTREAM_PADDING_BLACK;
+      } else {
+        fprintf(stderr, "unknown padding \"%s\"\n", padding);
+        return false;
+      }
+    } else {
+      fprintf(stderr, "unknown option \"%s\"\n", argv[i]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void
+report(const char* what, const int width, const int height, const int num_tiles, const double seconds)
+{
+  const double megapixels = (static_cast<double>(width) * height) * 1.0e-6;
+  printf("%s %dx%d (%d tiles) in %.3f ms, %.1f MP/s, %.1f tiles/s\n",
+         what,
+         width,
+         height,
+         num_tiles,
+         seconds * 1.0e3,
+         megapixels / seconds,
+         num_tiles / seconds);
+}
+
+auto
+encode(const Options& options) -> int
+{
+  MappedFile input;
+  if (!input.open_read(options.input))
+    return EXIT_FAILURE;
+
+  Raster raster;
+  if (!open_raster(input.data(), input.size(), input.size(), options.raw_size, &raster))
+    return EXIT_FAILURE;
+
+  const int width = raster.width;
+  const int height = raster.height;
+  const int num_tiles = nanostream_frame_tiles_x(width) * nanostream_frame_tiles_y(height);
+
+  MappedFile output;
+  if (!output.create(options.output, nanostream_image_file_size(width, height)))
+    return EXIT_FAILURE;
+
+  nanostream_image_store_header(output.data(), width, height, options.padding);
+
+  const unsigned char* rgb = input.data() + raster.offset;
+  unsigned char* packets = output.data() + NANOSTREAM_IMAGE_HEADER_SIZE;
+  const int pitch = static_cast<int>(raster.pitch());
+
+  TilePool pool(options.threads);
+
+  const auto t0 = std::chrono::steady_clock::now();
+
+  pool.run(num_tiles, 4, [&](const int first, const int count) {
+    unsigned char* out = packets + static_cast<size_t>(first) * NANOSTREAM_PACKET_SIZE;
+    nanostream_encode_frame(rgb, width, height, pitch, options.padding, first, count, out);
+  });
+
+  const auto t1 = std::chrono::steady_clock::now();
+
+  report("encoded", width, height, num_tiles, std::chrono::duration<double>(t1 - t0).count());
+
+  return EXIT_SUCCESS;
+}
+
+auto
+read_full(const int fd, unsigned char* data, size_t size, off_t offset) -> bool
+{
+  while (size > 0) {
+    const ssize_t n = pread(fd, data, size, offset);
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= static_cast<size_t>(n);
+    offset += n;
+  }
+  return true;
+}
+
+auto
+write_full(const int fd, const unsigned char* data, size_t size, off_t offset) -> bool
+{
+  while (size > 0) {
+    const ssize_t n = pwrite(fd, data, size, offset);
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= static_cast<size_t>(n);
+    offset += n;
+  }
+  return true;
+}
+
+// Encodes a raster that may be far bigger than memory, a band of tile rows at a time. The next band is read while the
+// current one is encoded, and both files are accessed with pread/pwrite and dropped from the page cache as they go, so
+// the memory used is a few bands regardless of the image size.
+auto
+encode_bands(const Options& options) -> int
+{
+  const int in_fd = open(options.input, O_RDONLY);
+  if (in_fd < 0) {
+    fprintf(stderr, "failed to open \"%s\"\n", options.input);
+    return EXIT_FAILURE;
+  }
+
+  struct stat st;
+  unsigned char head[4096];
+  const ssize_t head_size = (fstat(in_fd, &st) == 0) ? pread(in_fd, head, sizeof(head), 0) : -1;
+
+  Raster raster;
+  if ((head_size <= 0) ||
+      !open_raster(head, static_cast<size_t>(head_size), static_cast<size_t>(st.st_size), options.raw_size, &raster)) {
+    close(in_fd);
+    return EXIT_FAILURE;
+  }
+
+  const int width = raster.width;
+  const int height = raster.height;
+  const int tiles_x = nanostream_frame_tiles_x(width);
+  const int tiles_y = nanostream_frame_tiles_y(height);
+  const size_t pitch = raster.pitch();
+
+  const int out_fd = open(options.output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (out_fd < 0) {
+    fprintf(stderr, "failed to create \"%s\"\n", options.output);
+    close(in_fd);
+    return EXIT_FAILURE;
+  }
+
+  unsigned char header[NANOSTREAM_IMAGE_HEADER_SIZE];
+  nanostream_image_store_header(header, width, height, options.padding);
+  if ((ftruncate(out_fd, static_cast<off_t>(nanostream_image_file_size(width, height))) != 0) ||
+      !write_full(out_fd, header, sizeof(header), 0)) {
+    fprintf(stderr, "failed to write \"%s\"\n", options.output);
+    close(out_fd);
+    close(in_fd);
+    return EXIT_FAILURE;
+  }
+
+  const int band_rows = options.bands;
+  const int band_height = band_rows * NANOSTREAM_TILE_HEIGHT;
+  const int num_bands = (tiles_y + band_rows - 1) / band_rows;
+
+  // The two pixel bands and the packets are taken from pools, which are backed by huge pages where available.
+  BufferPool band_pool(pitch * band_height, 2);
+  BufferPool packet_pool(static_cast<size_t>(tiles_x) * band_rows * NANOSTREAM_PACKET_SIZE, 1);
+  if (!band_pool || !packet_pool) {
+    close(out_fd);
+    close(in_fd);
+    return EXIT_FAILURE;
+  }
+
+  PooledBuffer pixels[2] = { PooledBuffer(band_pool), PooledBuffer(band_pool) };
+  PooledBuffer packets(packet_pool);
+
+  // Reads band 'b' into 'pixels[b % 2]' and returns its height in pixels, or zero on failure.
+  auto read_band = [&](const int b) -> int {
+    const int y = b * band_height;
+    const int h = std::min(band_height, height - y);
+    const off_t offset = static_cast<off_t>(raster.offset + pitch * static_cast<size_t>(y));
+    const size_t size = pitch * static_cast<size_t>(h);
+    if (!read_full(in_fd, pixels[b % 2].data(), size, offset))
+      return 0;
+    posix_fadvise(in_fd, offset, static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+    return h;
+  };
+
+  TilePool pool(options.threads);
+
+  const auto t0 = std::chrono::steady_clock::now();
+
+  bool ok = true;
+  int band_h = read_band(0);
+
+  for (int b = 0; (b < num_bands) && ok; b++) {
+    if (band_h == 0) {
+      fprintf(stderr, "failed to read \"%s\"\n", options.input);
+      ok = false;
+      break;
+    }
+
+    int next_h = 0;
+    std::thread reader;
+    if (b + 1 < num_bands)
+      reader = std::thread([&] { next_h = read_band(b + 1); });
+
+    const unsigned char* rgb = pixels[b % 2].data();
+    const int num_tiles = tiles_x * ((band_h + NANOSTREAM_TILE_HEIGHT - 1) / NANOSTREAM_TILE_HEIGHT);
+
+    pool.run(num_tiles, 4, [&](const int first, const int count) {
+      unsigned char* out = packets.data() + static_cast<size_t>(first) * NANOSTREAM_PACKET_SIZE;
+      nanostream_encode_frame(rgb, width, band_h, static_cast<int>(pitch), options.padding, first, count, out);
+    });
+
+    const size_t first_tile = static_cast<size_t>(b) * band_rows * tiles_x;
+    const off_t offset = static_cast<off_t>(NANOSTREAM_IMAGE_HEADER_SIZE + first_tile * NANOSTREAM_PACKET_SIZE);
+    const size_t size = static_cast<size_t>(num_tiles) * NANOSTREAM_PACKET_SIZE;
+    if (write_full(out_fd, packets.data(), size, offset)) {
+      fdatasync(out_fd);
+      posix_fadvise(out_fd, offset, static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+    } else {
+      fprintf(stderr, "failed to write \"%s\"\n", options.output);
+      ok = false;
+    }
+
+    if (reader.joinable())
+      reader.join();
+
+    band_h = next_h;
+  }
+
+  const auto t1 = std::chrono::steady_clock::now();
+
+  close(out_fd);
+  close(in_fd);
+
+  if (!ok)
+    return EXIT_FAILURE;
+
+  report("encoded", width, height, tiles_x * tiles_y, std::chrono::duration<double>(t1 - t0).count());
+
+  const size_t buffer_size = band_pool.total_size() + packet_pool.total_size();
+  printf("%d bands of %d tile rows, %.1f MB of band buffers in %s\n",
+         num_bands,
+         band_rows,
+         buffer_size / 1.0e6,
+         band_pool.backing_name());
+
+  return EXIT_SUCCESS;
+}
+
+auto
+decode(const Options& options) -> int
+{
+  MappedFile input;
+  if (!input.open_read(options.input))
+    return EXIT_FAILURE;
+
+  nanostream_image_info info;
+  if (nanostream_image_parse_header(input.data(), input.size(), &info) != 0) {
+    fprintf(stderr, "\"%s\" is not a valid nanostream image\n", options.input);
+    return EXIT_FAILURE;
+  }
+
+  const bool ppm = !has_extension(options.output, ".raw");
+
+  char header[32];
+  const size_t header_size = ppm ? format_ppm_header(header, info.width, info.height) : 0;
+  const size_t pitch = static_cast<size_t>(info.width) * 3;
+
+  MappedFile output;
+  if (!output.create(options.output, header_size + pitch * static_cast<size_t>(info.height)))
+    return EXIT_FAILURE;
+
+  memcpy(output.data(), header, header_size);
+
+  const unsigned char* packets = input.data() + NANOSTREAM_IMAGE_HEADER_SIZE;
+  unsigned char* rgb = output.data() + header_size;
+  const int num_tiles = info.tiles_x * info.tiles_y;
+
+  TilePool pool(options.threads);
+
+  const auto t0 = std::chrono::steady_clock::now();
+
+  pool.run(num_tiles, 4, [&](const int first, const int count) {
+    const unsigned char* in = packets + static_cast<size_t>(first) * NANOSTREAM_PACKET_SIZE;
+    nanostream_decode_frame(in, first, count, info.width, info.height, static_cast<int>(pitch), rgb);
+  });
+
+  const auto t1 = std::chrono::steady_clock::now();
+
+  report("decoded", info.width, info.height, num_tiles, std::chrono::duration<double>(t1 - t0).count());
+
+  return EXIT_SUCCESS;
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  Options options;
+  if (!parse_options(argc, argv, &options)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(options.command, "encode") == 0)
+    return (options.bands > 0) ? encode_bands(options) : encode(options);
+
+  if (strcmp(options.command, "decode") == 0)
+    return decode(options);
+
+  print_usage(argv[0]);
+  return EXIT_FAILURE;
+}
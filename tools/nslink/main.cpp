@@ -0,0 +1,166 @@
+#include "../common/link_options.hpp"
+
+#include <nanostream_link.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace {
+
+using namespace nanostream_tools;
+
+struct Options
+{
+  std::string listen_host{ "127.0.0.1" };
+
+  int listen_port{ 0 };
+
+  std::string forward_host;
+
+  int forward_port{ 0 };
+
+  // Seconds between statistics reports.
+  double interval{ 1.0 };
+
+  // Seconds to run for, or zero until interrupted.
+  double duration{ 0.0 };
+
+  nanostream_link_config link{};
+};
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void
+on_signal(int)
+{
+  interrupted = 1;
+}
+
+void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+          "usage: %s --forward <host>:<port> [--listen [<host>:]<port>] [--interval <seconds>] [--duration <seconds>]\n"
+          "          [link options]\n"
+          "%s",
+          program,
+          link_usage);
+}
+
+// Splits "host:port", or just "port" if 'host' may be left as it is.
+auto
+parse_address(const char* text, std::string* host, int* port, const bool port_only_allowed) -> bool
+{
+  const char* colon = strrchr(text, ':');
+  if (!colon) {
+    if (!port_only_allowed)
+      return false;
+    *port = atoi(text);
+    return true;
+  }
+  host->assign(text, static_cast<size_t>(colon - text));
+  *port = atoi(colon + 1);
+  return !host->empty() && (*port > 0);
+}
+
+auto
+parse_options(const int argc, char** argv, Options* options) -> bool
+{
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = (i + 1) < argc;
+    bool error = false;
+    if ((strcmp(argv[i], "--listen") == 0) && has_value) {
+      if (!parse_address(argv[++i], &options->listen_host, &options->listen_port, true)) {
+        fprintf(stderr, "invalid listen address \"%s\"\n", argv[i]);
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--forward") == 0) && has_value) {
+      if (!parse_address(argv[++i], &options->forward_host, &options->forward_port, false)) {
+        fprintf(stderr, "invalid forward address \"%s\"\n", argv[i]);
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--interval") == 0) && has_value) {
+      options->interval = atof(argv[++i]);
+    } else if ((strcmp(argv[i], "--duration") == 0) && has_value) {
+      options->duration = atof(argv[++i]);
+    } else if (parse_link_option(argc, argv, &i, &options->link, &error)) {
+      if (error)
+        return false;
+    } else {
+      fprintf(stderr, "unknown option \"%s\"\n", argv[i]);
+      return false;
+    }
+  }
+
+  if (options->forward_host.empty()) {
+    fprintf(stderr, "a destination is required\n");
+    return false;
+  }
+
+  if (options->interval <= 0.0)
+    options->interval = 1.0;
+
+  return true;
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  Options options;
+  if (!parse_options(argc, argv, &options)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  nanostream_link_relay* relay = nanostream_link_relay_create(&options.link,
+                                                              options.listen_host.c_str(),
+                                                              options.listen_port,
+                                                              options.forward_host.c_str(),
+                                                              options.forward_port);
+  if (!relay) {
+    fprintf(stderr, "failed to start the relay\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("relaying %s:%d to %s:%d\n",
+         options.listen_host.c_str(),
+         nanostream_link_relay_port(relay),
+         options.forward_host.c_str(),
+         options.forward_port);
+  fflush(stdout);
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  const auto interval =
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.interval));
+  const auto start = std::chrono::steady_clock::now();
+  auto next_report = start + interval;
+  while (!interrupted) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto now = std::chrono::steady_clock::now();
+    if ((options.duration > 0.0) && (std::chrono::duration<double>(now - start).count() >= options.duration))
+      break;
+    if (now >= next_report) {
+      nanostream_link_stats stats{};
+      nanostream_link_relay_get_stats(relay, &stats);
+      print_link_stats(stats);
+      fflush(stdout);
+      next_report += interval;
+    }
+  }
+
+  nanostream_link_stats stats{};
+  nanostream_link_relay_get_stats(relay, &stats);
+  nanostream_link_relay_destroy(relay);
+  print_link_stats(stats);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,762 @@
+#include "../common/clock.hpp"
+#include "../common/image.hpp"
+#include "../common/synthetic_content.hpp"
+
+#include <nanostream_frame.h>
+#include <nanostream_net.h>
+#include <nanostream_server.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace nanostream_tools;
+
+struct Options
+{
+  int width{ 1280 };
+
+  int height{ 720 };
+
+  double fps{ 30.0 };
+
+  std::vector<ContentClass> content{ ContentClass::still,
+                                     ContentClass::text,
+                                     ContentClass::noise,
+                                     ContentClass::pan,
+                                     ContentClass::cuts };
+
+  // The end-to-end deadline of a frame, from submitting it to its last tile being decoded.
+  int deadline_ms{ 50 };
+
+  // The share of frames that may miss their deadline (or be dropped, or arrive incomplete) for a stream count to be
+  // sustainable.
+  double max_miss{ 0.01 };
+
+  int encode_threads{ 0 };
+
+  int decode_threads{ 1 };
+
+  // Run a single step with this many streams instead of searching for the capacity.
+  int streams{ 0 };
+
+  int max_streams{ 1024 };
+
+  double step_seconds{ 3.0 };
+
+  double warmup_seconds{ 0.5 };
+
+  bool shed{ false };
+
+  // Append a checksum to every datagram, for the receivers to verify before decoding.
+  bool checksum{ false };
+
+  // How often each stream derives a basis from its content, or zero to use the built-in basis.
+  double adapt_basis_seconds{ 0.0 };
+
+  // Compare every complete frame with the frame that was submitted.
+  bool psnr{ false };
+};
+
+void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+          "usage: %s [--size <width>x<height>] [--fps N] [--content static,text,noise,pan,cuts] [--deadline <ms>]\n"
+          "          [--max-miss <fraction>] [--encode-threads N] [--decode-threads N] [--streams N]\n"
+          "          [--max-streams N] [--duration <seconds per step>] [--shed] [--checksum]\n"
+          "          [--adapt-basis <seconds>] [--psnr]\n",
+          program);
+}
+
+auto
+parse_content(const char* list, std::vector<ContentClass>* content) -> bool
+{
+  content->clear();
+  std::string name;
+  for (const char* c = list;; c++) {
+    if ((*c == ',') || (*c == 0)) {
+      ContentClass value{};
+      if (!parse_content_class(name.c_str(), &value)) {
+        fprintf(stderr, "unknown content class \"%s\"\n", name.c_str());
+        return false;
+      }
+      content->push_back(value);
+      name.clear();
+      if (*c == 0)
+        return true;
+    } else {
+      name += *c;
+    }
+  }
+}
+
+auto
+parse_options(const int argc, char** argv, Options* options) -> bool
+{
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = (i + 1) < argc;
+    if ((strcmp(argv[i], "--size") == 0) && has_value) {
+      if ((sscanf(argv[++i], "%dx%d", &options->width, &options->height) != 2) || (options->width <= 0) ||
+          (options->height <= 0)) {
+        fprintf(stderr, "invalid size \"%s\"\n", argv[i]);
+        return false;
+      }
+      if (nanostream_net_check_size(options->width, options->height) != 0) {
+        fprintf(stderr,
+                "frames of %dx%d do not fit the transport, which takes at most %dx%d and %d tiles\n",
+                options->width,
+                options->height,
+                NANOSTREAM_NET_MAX_SIZE,
+                NANOSTREAM_NET_MAX_SIZE,
+                NANOSTREAM_NET_MAX_TILES);
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--fps") == 0) && has_value) {
+      options->fps = atof(argv[++i]);
+    } else if ((strcmp(argv[i], "--content") == 0) && has_value) {
+      if (!parse_content(argv[++i], &options->content))
+        return false;
+    } else if ((strcmp(argv[i], "--deadline") == 0) && has_value) {
+      options->deadline_ms = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--max-miss") == 0) && has_value) {
+      options->max_miss = atof(argv[++i]);
+    } else if ((strcmp(argv[i], "--encode-threads") == 0) && has_value) {
+      options->encode_threads = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--decode-threads") == 0) && has_value) {
+      options->decode_threads = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--streams") == 0) && has_value) {
+      options->streams = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--max-streams") == 0) && has_value) {
+      options->max_streams = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--duration") == 0) && has_value) {
+      options->step_seconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--shed") == 0) {
+      options->shed = true;
+    } else if (strcmp(argv[i], "--checksum") == 0) {
+      options->checksum = true;
+    } else if ((strcmp(argv[i], "--adapt-basis") == 0) && has_value) {
+      options->adapt_basis_seconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--psnr") == 0) {
+      options->psnr = true;
+    } else {
+      fprintf(stderr, "unknown option \"%s\"\n", argv[i]);
+      return false;
+    }
+  }
+
+  if ((options->fps <= 0.0) || (options->deadline_ms <= 0) || (options->decode_threads <= 0) ||
+      (options->max_streams <= 0) || (options->step_seconds <= 0.0)) {
+    fprintf(stderr, "the frame rate, deadline, decode threads, stream limit and duration must be positive\n");
+    return false;
+  }
+
+  return true;
+}
+
+// Counts of one step. Frames are counted if they were submitted within the measured window, which starts after the
+// warmup, so that the start and the end of a step do not skew the result.
+struct Counters
+{
+  std::atomic<uint64_t> submitted{ 0 };
+  std::atomic<uint64_t> refused{ 0 };
+  std::atomic<uint64_t> dropped{ 0 };
+  std::atomic<uint64_t> completed{ 0 };
+  std::atomic<uint64_t> late{ 0 };
+  std::atomic<uint64_t> incomplete{ 0 };
+
+  std::atomic<uint64_t> send_cpu_us{ 0 };
+  std::atomic<uint64_t> receive_cpu_us{ 0 };
+  std::atomic<uint64_t> decode_cpu_us{ 0 };
+
+  // The squared error summed over the values of the complete frames compared, and the time spent comparing them,
+  // which is not part of decoding.
+  std::atomic<uint64_t> quality_sse{ 0 };
+  std::atomic<uint64_t> quality_values{ 0 };
+  std::atomic<uint64_t> quality_cpu_us{ 0 };
+};
+
+struct Window
+{
+  uint64_t start_us{ 0 };
+  uint64_t end_us{ 0 };
+
+  [[nodiscard]] auto contains(const uint64_t timestamp_us) const -> bool
+  {
+    return (timestamp_us >= start_us) && (timestamp_us < end_us);
+  }
+};
+
+struct Stream
+{
+  int id{ -1 };
+
+  const SyntheticContent* content{ nullptr };
+
+  Counters* counters{ nullptr };
+
+  const Window* window{ nullptr };
+
+  uint64_t deadline_us{ 0 };
+
+  // The frame of the content a timestamp shows is (timestamp_us - first_due_us) / interval_us.
+  uint64_t first_due_us{ 0 };
+  uint64_t interval_us{ 0 };
+  bool measure_quality{ false };
+
+  // Sender side, used by the producer and by the server callback, which the server serializes per stream.
+  nanostream_net_sender* sender{ nullptr };
+  unsigned int flags{ 0 };
+  uint64_t next_due_us{ 0 };
+  uint64_t frames_produced{ 0 };
+  uint32_t next_frame{ 0 };
+  uint32_t next_sequence{ 0 };
+
+  // The latest basis the receiver holds, which the producer acknowledges to the server on its behalf, as feedback
+  // would.
+  std::atomic<int> basis_held{ 0 };
+  int basis_acknowledged{ 0 };
+
+  // Receiver side, used only by the thread of the receiver the stream is sent to.
+  nanostream_net_bases* bases{ nullptr };
+  std::vector<unsigned char> canvas;
+  bool receiving{ false };
+  uint32_t frame{ 0 };
+  int tiles_expected{ 0 };
+  int tiles_received{ 0 };
+  uint64_t timestamp_us{ 0 };
+};
+
+void
+on_frame(void* user_data, const nanostream_server_frame* frame)
+{
+  auto* stream = static_cast<Stream*>(user_data);
+  const bool measured = stream->window->contains(frame->timestamp_us);
+
+  if (frame->drop_reason != NANOSTREAM_DROP_NONE) {
+    if (measured)
+      stream->counters->dropped++;
+    return;
+  }
+
+  // Every tile was shed: there is nothing to send, and the receiver already shows the frame.
+  if (frame->num_tiles == 0) {
+    if (measured)
+      stream->counters->completed++;
+    return;
+  }
+
+  nanostream_net_header header{};
+  header.stream = stream->id;
+  header.flags = stream->flags;
+
+  const uint64_t t0 = thread_cpu_us();
+
+  // A new basis goes out ahead of the tiles, with every frame until the receiver has it.
+  if (frame->new_basis) {
+    header.type = NANOSTREAM_NET_BASIS;
+    nanostream_net_send_basis(stream->sender, &header, frame->new_basis, frame->new_basis_version);
+  }
+
+  header.type = NANOSTREAM_NET_TILE;
+  header.flags |= NANOSTREAM_NET_FLAGS_BASIS(frame->basis_version);
+  header.frame = stream->next_frame++;
+  header.sequence = stream->next_sequence;
+  header.num_tiles = frame->num_tiles;
+  header.width = stream->content->width();
+  header.height = stream->content->height();
+  header.timestamp_us = frame->timestamp_us;
+
+  const int sent =
+    nanostream_net_send_tiles(stream->sender, &header, frame->tile_indices, frame->packets, frame->num_tiles);
+  stream->counters->send_cpu_us += thread_cpu_us() - t0;
+
+  stream->next_sequence += static_cast<uint32_t>(sent);
+}
+
+// Adds the squared error of the frame just completed, against the content frame of its timestamp.
+void
+measure_quality(Stream* stream)
+{
+  const uint64_t t0 = thread_cpu_us();
+  const SyntheticContent& content = *stream->content;
+  const uint64_t index = (stream->timestamp_us - stream->first_due_us + stream->interval_us / 2) / stream->interval_us;
+  const unsigned char* expected = content.frame(index);
+  const size_t row_size = static_cast<size_t>(content.width()) * 3;
+
+  uint64_t sse = 0;
+  for (int y = 0; y < content.height(); y++) {
+    const unsigned char* a = expected + static_cast<size_t>(y) * content.pitch();
+    const unsigned char* b = stream->canvas.data() + y * row_size;
+    for (size_t x = 0; x < row_size; x++) {
+      const int d = static_cast<int>(a[x]) - static_cast<int>(b[x]);
+      sse += static_cast<uint64_t>(d * d);
+    }
+  }
+
+  stream->counters->quality_sse += sse;
+  stream->counters->quality_values += row_size * static_cast<size_t>(content.height());
+  stream->counters->quality_cpu_us += thread_cpu_us() - t0;
+}
+
+void
+finish_frame(Stream* stream, const bool complete)
+{
+  stream->receiving = false;
+  if (!stream->window->contains(stream->timestamp_us))
+    return;
+
+  if (!complete) {
+    stream->counters->incomplete++;
+    return;
+  }
+
+  stream->counters->completed++;
+  if ((now_us() - stream->timestamp_us) > stream->deadline_us)
+    stream->counters->late++;
+
+  if (stream->measure_quality)
+    measure_quality(stream);
+}
+
+// Receives the datagrams of the streams sent to one receiver and decodes each tile as it arrives, with the basis its
+// datagram names. A frame is complete when all of its tiles arrived, and incomplete if a tile of a newer frame arrives
+// first.
+void
+receive_loop(nanostream_net_receiver* receiver,
+             std::vector<std::unique_ptr<Stream>>* streams,
+             Counters* counters,
+             const std::atomic<bool>* stop)
+{
+  constexpr int batch = 64;
+  nanostream_net_packet packets[batch];
+
+  while (!stop->load()) {
+    const uint64_t t0 = thread_cpu_us();
+    const int n = nanostream_net_receive(receiver, packets, batch, 20);
+    const uint64_t t1 = thread_cpu_us();
+
+    for (int i = 0; i < n; i++) {
+      const nanostream_net_header& header = packets[i].header;
+      if ((header.stream < 0) || (header.stream >= static_cast<int>(streams->size())))
+        continue;
+
+      Stream* stream = (*streams)[static_cast<size_t>(header.stream)].get();
+      if (header.type == NANOSTREAM_NET_BASIS) {
+        const int version = nanostream_net_bases_add(stream->bases, &packets[i]);
+        if (version > 0)
+          stream->basis_held = version;
+        continue;
+      }
+
+      if ((header.type != NANOSTREAM_NET_TILE) || (header.width != stream->content->width()) ||
+          (header.height != stream->content->height()))
+        continue;
+
+      // A tile whose basis is missing cannot be decoded, which leaves its frame incomplete.
+      const nanostream_basis* basis = nullptr;
+      if (nanostream_net_bases_find(stream->bases, NANOSTREAM_NET_BASIS_VERSION(header.flags), &basis) != 0)
+        continue;
+
+      if (stream->receiving && (header.frame != stream->frame)) {
+        // A tile of an older frame that arrived late is of no use any more.
+        if (static_cast<int32_t>(header.frame - stream->frame) < 0)
+          continue;
+        finish_frame(stream, false);
+      }
+
+      if (!stream->receiving) {
+        // Ignore stray tiles of a frame that was already finished.
+        if ((stream->tiles_expected > 0) && (static_cast<int32_t>(header.frame - stream->frame) <= 0))
+          continue;
+        stream->receiving = true;
+        stream->frame = header.frame;
+        stream->tiles_expected = header.num_tiles;
+        stream->tiles_received = 0;
+        stream->timestamp_us = header.timestamp_us;
+      }
+
+      nanostream_decode_frame_with_basis(basis,
+                                         packets[i].payload,
+                                         header.tile,
+                                         1,
+                                         header.width,
+                                         header.height,
+                                         header.width * 3,
+                                         stream->canvas.data());
+
+      if (++stream->tiles_received == stream->tiles_expected)
+        finish_frame(stream, true);
+    }
+
+    counters->receive_cpu_us += t1 - t0;
+    counters->decode_cpu_us += thread_cpu_us() - t1;
+  }
+}
+
+struct StepResult
+{
+  int streams{ 0 };
+  uint64_t submitted{ 0 };
+  uint64_t refused{ 0 };
+  uint64_t dropped{ 0 };
+  uint64_t completed{ 0 };
+  uint64_t late{ 0 };
+  uint64_t incomplete{ 0 };
+  double miss{ 1.0 };
+
+  // Busy cores per stage: submitting frames, encoding, sending, receiving and decoding.
+  double produce_cores{ 0.0 };
+  double encode_cores{ 0.0 };
+  double send_cores{ 0.0 };
+  double receive_cores{ 0.0 };
+  double decode_cores{ 0.0 };
+
+  // Of the complete frames, if measured.
+  double psnr{ 0.0 };
+
+  int encode_threads{ 0 };
+};
+
+auto
+encode_cpu_us(nanostream_server* server, const std::vector<std::unique_ptr<Stream>>& streams) -> uint64_t
+{
+  uint64_t total = 0;
+  for (const auto& stream : streams) {
+    nanostream_server_stream_stats stats{};
+    if (nanostream_server_get_stream_stats(server, stream->id, &stats) == 0)
+      total += stats.cpu_time_us;
+  }
+  return total;
+}
+
+// Runs a number of streams for one step: frames are submitted on schedule to an encode server, sent over loopback to
+// the receivers, and decoded there.
+auto
+run_step(const Options& options,
+         const std::vector<std::unique_ptr<SyntheticContent>>& library,
+         const int num_streams,
+         StepResult* result) -> bool
+{
+  Counters counters;
+  Window window;
+
+  std::vector<nanostream_net_receiver*> receivers;
+  std::vector<nanostream_net_sender*> senders;
+  const auto cleanup = [&]() {
+    for (nanostream_net_sender* sender : senders)
+      nanostream_net_sender_destroy(sender);
+    for (nanostream_net_receiver* receiver : receivers)
+      nanostream_net_receiver_destroy(receiver);
+  };
+
+  for (int i = 0; i < options.decode_threads; i++) {
+    nanostream_net_receiver* receiver = nanostream_net_receiver_create("127.0.0.1", 0, 0);
+    nanostream_net_sender* sender =
+      receiver ? nanostream_net_sender_create("127.0.0.1", nanostream_net_receiver_port(receiver), 0) : nullptr;
+    if (receiver)
+      receivers.push_back(receiver);
+    if (!sender) {
+      fprintf(stderr, "failed to open the loopback sockets\n");
+      cleanup();
+      return false;
+    }
+    senders.push_back(sender);
+  }
+
+  nanostream_server_config server_config{};
+  server_config.num_threads = options.encode_threads;
+  server_config.max_streams = num_streams;
+  nanostream_server* server = nanostream_server_create(&server_config);
+  if (!server) {
+    fprintf(stderr, "failed to create the encode server\n");
+    cleanup();
+    return false;
+  }
+
+  const uint64_t interval_us = static_cast<uint64_t>(1.0e6 / options.fps);
+  const uint64_t deadline_us = static_cast<uint64_t>(options.deadline_ms) * 1000U;
+
+  // The receivers look streams up by id, and ids are assigned from zero, so they index this list.
+  std::vector<std::unique_ptr<Stream>> streams;
+  for (int i = 0; i < num_streams; i++) {
+    auto stream = std::make_unique<Stream>();
+    stream->content = library[static_cast<size_t>(i) % library.size()].get();
+    stream->counters = &counters;
+    stream->window = &window;
+    stream->deadline_us = deadline_us;
+    stream->sender = senders[static_cast<size_t>(i) % senders.size()];
+    stream->flags = options.checksum ? NANOSTREAM_NET_FLAG_CHECKSUM : 0;
+    stream->interval_us = interval_us;
+    stream->measure_quality = options.psnr;
+    stream->bases = nanostream_net_bases_create();
+    stream->canvas.resize(static_cast<size_t>(options.width) * options.height * 3);
+
+    nanostream_server_stream_config config{};
+    config.width = options.width;
+    config.height = options.height;
+    config.padding = NANOSTREAM_PADDING_EDGE;
+    config.deadline_us = deadline_us;
+    config.shed_unchanged_tiles = options.shed ? 1 : 0;
+    config.adapt_basis_interval_us = static_cast<uint64_t>(options.adapt_basis_seconds * 1.0e6);
+    config.callback = on_frame;
+    config.user_data = stream.get();
+    stream->id = nanostream_server_add_stream(server, &config);
+    if (!stream->bases || (stream->id != i)) {
+      fprintf(stderr, "failed to add stream %d\n", i);
+      nanostream_server_destroy(server);
+      nanostream_net_bases_destroy(stream->bases);
+      for (const auto& added : streams)
+        nanostream_net_bases_destroy(added->bases);
+      cleanup();
+      return false;
+    }
+    streams.push_back(std::move(stream));
+  }
+
+  std::atomic<bool> stop{ false };
+  std::vector<std::thread> threads;
+  for (nanostream_net_receiver* receiver : receivers)
+    threads.emplace_back(receive_loop, receiver, &streams, &counters, &stop);
+
+  // Spread the streams over a frame interval, as independent sources would be.
+  const uint64_t start_us = now_us();
+  for (int i = 0; i < num_streams; i++) {
+    Stream* stream = streams[static_cast<size_t>(i)].get();
+    stream->next_due_us = start_us + (interval_us * static_cast<uint64_t>(i)) / num_streams;
+    stream->first_due_us = stream->next_due_us;
+  }
+
+  window.start_us = start_us + static_cast<uint64_t>(options.warmup_seconds * 1.0e6);
+  window.end_us = window.start_us + static_cast<uint64_t>(options.step_seconds * 1.0e6);
+
+  const uint64_t produce_cpu_start = thread_cpu_us();
+  uint64_t encode_cpu_start = 0;
+  uint64_t receive_cpu_start = 0;
+  uint64_t decode_cpu_start = 0;
+  uint64_t send_cpu_start = 0;
+  uint64_t produce_cpu_window = 0;
+  bool measuring = false;
+
+  for (;;) {
+    Stream* next = streams[0].get();
+    for (const auto& stream : streams) {
+      if (stream->next_due_us < next->next_due_us)
+        next = stream.get();
+    }
+
+    const uint64_t due_us = next->next_due_us;
+    if (due_us >= window.end_us)
+      break;
+
+    if (!measuring && (due_us >= window.start_us)) {
+      measuring = true;
+      encode_cpu_start = encode_cpu_us(server, streams);
+      receive_cpu_start = counters.receive_cpu_us.load();
+      decode_cpu_start = counters.decode_cpu_us.load() - counters.quality_cpu_us.load();
+      send_cpu_start = counters.send_cpu_us.load();
+      produce_cpu_window = thread_cpu_us();
+    }
+
+    const uint64_t now = now_us();
+    if (due_us > now)
+      std::this_thread::sleep_for(std::chrono::microseconds(due_us - now));
+
+    const int basis_held = next->basis_held.load();
+    if (basis_held != next->basis_acknowledged) {
+      nanostream_server_acknowledge_basis(server, next->id, basis_held);
+      next->basis_acknowledged = basis_held;
+    }
+
+    // The timestamp is the scheduled time, so a producer that falls behind shows up as latency.
+    const unsigned char* rgb = next->content->frame(next->frames_produced++);
+    const bool measured = window.contains(due_us);
+    if (measured)
+      counters.submitted++;
+    if ((nanostream_server_submit_frame(server, next->id, rgb, next->content->pitch(), due_us) != 0) && measured)
+      counters.refused++;
+
+    next->next_due_us += interval_us;
+  }
+
+  const uint64_t wall_us = now_us() - std::max(window.start_us, start_us);
+  const uint64_t encode_cpu = encode_cpu_us(server, streams) - encode_cpu_start;
+  const uint64_t produce_cpu = thread_cpu_us() - (measuring ? produce_cpu_window : produce_cpu_start);
+
+  // Let the frames in flight arrive, then stop.
+  std::this_thread::sleep_for(std::chrono::microseconds(deadline_us * 2));
+  result->encode_threads = nanostream_server_num_threads(server);
+  nanostream_server_destroy(server);
+  const uint64_t receive_cpu = counters.receive_cpu_us.load() - receive_cpu_start;
+  const uint64_t decode_cpu = counters.decode_cpu_us.load() - counters.quality_cpu_us.load() - decode_cpu_start;
+  const uint64_t send_cpu = counters.send_cpu_us.load() - send_cpu_start;
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  stop = true;
+  for (std::thread& thread : threads)
+    thread.join();
+
+  // Frames whose tiles never all arrived, and were not followed by a newer frame, are incomplete too.
+  for (const auto& stream : streams) {
+    if (stream->receiving)
+      finish_frame(stream.get(), false);
+    nanostream_net_bases_destroy(stream->bases);
+  }
+
+  cleanup();
+
+  const double wall = static_cast<double>(wall_us);
+  result->streams = num_streams;
+  result->submitted = counters.submitted.load();
+  result->refused = counters.refused.load();
+  result->dropped = counters.dropped.load();
+  result->completed = counters.completed.load();
+  result->late = counters.late.load();
+  result->incomplete = counters.incomplete.load();
+  const uint64_t on_time = result->completed - std::min(result->late, result->completed);
+  result->miss = (result->submitted > 0)
+                   ? 1.0 - static_cast<double>(std::min(on_time, result->submitted)) / result->submitted
+                   : 1.0;
+  result->produce_cores = produce_cpu / wall;
+  result->encode_cores = encode_cpu / wall;
+  result->send_cores = send_cpu / wall;
+  result->receive_cores = receive_cpu / wall;
+  result->decode_cores = decode_cpu / wall;
+  result->psnr =
+    psnr(static_cast<double>(counters.quality_sse.load()), static_cast<double>(counters.quality_values.load()));
+  return true;
+}
+
+void
+print_header(const bool psnr)
+{
+  printf("%8s %8s %7s %7s %7s %7s %7s %7s %7s | %8s %8s %8s %8s %8s",
+         "streams",
+         "frames",
+         "miss%",
+         "refused",
+         "dropped",
+         "late",
+         "partial",
+         "lost",
+         "result",
+         "produce",
+         "encode",
+         "send",
+         "receive",
+         "decode");
+  if (psnr)
+    printf(" | %6s", "psnr");
+  printf("\n");
+}
+
+void
+print_step(const StepResult& r, const bool sustainable, const bool psnr)
+{
+  // Frames that were sent but of which no tile arrived in time for the step to see it.
+  const uint64_t seen = r.refused + r.dropped + r.completed + r.incomplete;
+  const uint64_t lost = r.submitted - std::min(seen, r.submitted);
+  printf("%8d %8llu %7.2f %7llu %7llu %7llu %7llu %7llu %7s | %8.2f %8.2f %8.2f %8.2f %8.2f",
+         r.streams,
+         static_cast<unsigned long long>(r.submitted),
+         r.miss * 100.0,
+         static_cast<unsigned long long>(r.refused),
+         static_cast<unsigned long long>(r.dropped),
+         static_cast<unsigned long long>(r.late),
+         static_cast<unsigned long long>(r.incomplete),
+         static_cast<unsigned long long>(lost),
+         sustainable ? "ok" : "FAIL",
+         r.produce_cores,
+         r.encode_cores,
+         r.send_cores,
+         r.receive_cores,
+         r.decode_cores);
+  if (psnr)
+    printf(" | %6.2f", r.psnr);
+  printf("\n");
+  fflush(stdout);
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  Options options;
+  if (!parse_options(argc, argv, &options)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // One instance of each content class, shared by the streams of that class.
+  std::vector<std::unique_ptr<SyntheticContent>> library;
+  for (size_t i = 0; i < options.content.size(); i++) {
+    library.push_back(
+      std::make_unique<SyntheticContent>(options.content[i], options.width, options.height, static_cast<uint32_t>(i)));
+  }
+
+  printf("%dx%d at %.1f fps, content", options.width, options.height, options.fps);
+  for (const ContentClass c : options.content)
+    printf(" %s", content_class_name(c));
+  printf(", %d ms deadline, at most %.2f%% missed\n", options.deadline_ms, options.max_miss * 100.0);
+  printf("stage columns are busy cores\n");
+  print_header(options.psnr);
+
+  int encode_threads = 0;
+  const auto step = [&](const int n, bool* sustainable) -> bool {
+    StepResult result;
+    if (!run_step(options, library, n, &result))
+      return false;
+    encode_threads = result.encode_threads;
+    *sustainable = result.miss <= options.max_miss;
+    print_step(result, *sustainable, options.psnr);
+    return true;
+  };
+
+  if (options.streams > 0) {
+    bool sustainable = false;
+    return step(options.streams, &sustainable) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // Double the number of streams until a step fails, then bisect between the last success and the first failure.
+  int good = 0;
+  int bad = options.max_streams + 1;
+  for (int n = 1; n <= options.max_streams; n *= 2) {
+    bool sustainable = false;
+    if (!step(n, &sustainable))
+      return EXIT_FAILURE;
+    if (!sustainable) {
+      bad = n;
+      break;
+    }
+    good = n;
+  }
+
+  while ((bad - good) > 1 && (good < options.max_streams)) {
+    const int n = good + (bad - good) / 2;
+    bool sustainable = false;
+    if (!step(n, &sustainable))
+      return EXIT_FAILURE;
+    if (sustainable) {
+      good = n;
+    } else {
+      bad = n;
+    }
+  }
+
+  printf("sustainable streams: %d (%d encode threads, %d decode threads)\n",
+         good,
+         encode_threads,
+         options.decode_threads);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,333 @@
+#include "../common/buffer_pool.hpp"
+#include "../common/mapped_file.hpp"
+#include "../common/raster.hpp"
+#include "../common/tile_pool.hpp"
+
+#include <nanostream.h>
+#include <nanostream_frame.h>
+#include <nanostream_pyramid.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using namespace nanostream_tools;
+
+constexpr int half_tile_width = NANOSTREAM_TILE_WIDTH / 2;
+
+constexpr int half_tile_height = NANOSTREAM_TILE_HEIGHT / 2;
+
+enum class Source
+{
+  // Build each level from the packets of the level below, averaging in the coefficient domain.
+  coefficients,
+  // Build each level by averaging the full resolution pixels.
+  pixels
+};
+
+struct Options
+{
+  const char* raw_size{ nullptr };
+
+  nanostream_padding padding{ NANOSTREAM_PADDING_EDGE };
+
+  Source source{ Source::coefficients };
+
+  int threads{ 0 };
+};
+
+void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+          "usage:\n"
+          "  %s build <input.ppm> <output.nsp> [--raw <width>x<height>] [--padding edge|black]\n"
+          "                                   [--source coefficients|pixels] [--threads N]\n"
+          "  %s info <input.nsp>\n"
+          "  %s tile <input.nsp> <level> <x> <y> <output.ppm>\n",
+          program,
+          program,
+          program);
+}
+
+auto
+parse_options(const int argc, char** argv, const int first, Options* options) -> bool
+{
+  for (int i = first; i < argc; i++) {
+    const bool has_value = (i + 1) < argc;
+    if ((strcmp(argv[i], "--raw") == 0) && has_value) {
+      options->raw_size = argv[++i];
+    } else if ((strcmp(argv[i], "--threads") == 0) && has_value) {
+      options->threads = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--padding") == 0) && has_value) {
+      const char* padding = argv[++i];
+      if (strcmp(padding, "edge") == 0) {
+        options->padding = NANOSTREAM_PADDING_EDGE;
+      } else if (strcmp(padding, "black") == 0) {
+        options->padding = NANOSTREAM_PADDING_BLACK;
+      } else {
+        fprintf(stderr, "unknown padding \"%s\"\n", padding);
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--source") == 0) && has_value) {
+      const char* source = argv[++i];
+      if (strcmp(source, "coefficients") == 0) {
+        options->source = Source::coefficients;
+      } else if (strcmp(source, "pixels") == 0) {
+        options->source = Source::pixels;
+      } else {
+        fprintf(stderr, "unknown source \"%s\"\n", source);
+        return false;
+      }
+    } else {
+      fprintf(stderr, "unknown option \"%s\"\n", argv[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fills a band of one tile row of 'level' from two tile rows of the level below, decoding their packets at half
+// resolution.
+void
+fill_band_from_coefficients(TilePool& pool,
+                            const unsigned char* file,
+                            const nanostream_pyramid_info& info,
+                            const int level,
+                            const int tile_y,
+                            const int band_height,
+                            unsigned char* band)
+{
+  const nanostream_pyramid_level& below = info.levels[level - 1];
+  const int width = info.levels[level].width;
+  const size_t pitch = static_cast<size_t>(width) * 3;
+  const int first_row = tile_y * 2;
+  const int num_rows = std::min(2, below.tiles_y - first_row);
+
+  pool.run(below.tiles_x * num_rows, 2, [&](const int first, const int count) {
+    unsigned char half[half_tile_height * half_tile_width * 3];
+    for (int i = first; i < first + count; i++) {
+      const int tx = i % below.tiles_x;
+      const int row = i / below.tiles_x;
+      nanostream_decode_tile_half(nanostream_pyramid_tile(file, &info, level - 1, tx, first_row + row),
+                                  half_tile_width * 3,
+                                  half);
+
+      const int x = tx * half_tile_width;
+      const int y = row * half_tile_height;
+      const int w = std::min(half_tile_width, width - x);
+      const int h = std::min(half_tile_height, band_height - y);
+      for (int r = 0; r < h; r++)
+        memcpy(band + (y + r) * pitch + x * 3, half + r * half_tile_width * 3, static_cast<size_t>(w) * 3);
+    }
+  });
+}
+
+// Fills a band of one tile row of 'level' by averaging the full resolution pixels.
+void
+fill_band_from_pixels(TilePool& pool,
+                      const unsigned char* rgb,
+                      const nanostream_pyramid_info& info,
+                      const int level,
+                      const int tile_y,
+                      const int band_height,
+                      unsigned char* band)
+{
+  const int src_width = info.levels[0].width;
+  const int src_height = info.levels[0].height;
+  const size_t src_pitch = static_cast<size_t>(src_width) * 3;
+  const int width = info.levels[level].width;
+  const int scale = 1 << level;
+
+  pool.run(band_height, 1, [&](const int first, const int count) {
+    for (int r = first; r < first + count; r++) {
+      const int y0 = (tile_y * NANOSTREAM_TILE_HEIGHT + r) * scale;
+      const int y1 = std::min(y0 + scale, src_height);
+      unsigned char* out = band + static_cast<size_t>(r) * width * 3;
+      for (int x = 0; x < width; x++) {
+        const int x0 = x * scale;
+        const int x1 = std::min(x0 + scale, src_width);
+        unsigned long sum[3] = { 0, 0, 0 };
+        for (int y = y0; y < y1; y++) {
+          const unsigned char* in = rgb + static_cast<size_t>(y) * src_pitch + static_cast<size_t>(x0) * 3;
+          for (int i = 0; i < (x1 - x0); i++) {
+            sum[0] += in[i * 3 + 0];
+            sum[1] += in[i * 3 + 1];
+            sum[2] += in[i * 3 + 2];
+          }
+        }
+        const unsigned long n = static_cast<unsigned long>((y1 - y0) * (x1 - x0));
+        for (int c = 0; c < 3; c++)
+          out[x * 3 + c] = static_cast<unsigned char>((sum[c] + n / 2) / n);
+      }
+    }
+  });
+}
+
+auto
+build(const char* input_path, const char* output_path, const Options& options) -> int
+{
+  MappedFile input;
+  if (!input.open_read(input_path))
+    return EXIT_FAILURE;
+
+  Raster raster;
+  if (!open_raster(input.data(), input.size(), input.size(), options.raw_size, &raster))
+    return EXIT_FAILURE;
+
+  nanostream_pyramid_info info;
+  nanostream_pyramid_layout(raster.width, raster.height, options.padding, &info);
+
+  MappedFile output;
+  if (!output.create(output_path, nanostream_pyramid_file_size(&info)))
+    return EXIT_FAILURE;
+
+  nanostream_pyramid_store_header(output.data(), &info);
+
+  const unsigned char* rgb = input.data() + raster.offset;
+  unsigned char* packets = output.data() + nanostream_pyramid_packets_offset(&info);
+
+  // Level 1 has the widest bands, so one buffer from the pool fits the band of any level.
+  BufferPool band_pool(static_cast<size_t>(info.levels[std::min(1, info.num_levels - 1)].width) * 3 *
+                         NANOSTREAM_TILE_HEIGHT,
+                       1);
+  if (!band_pool)
+    return EXIT_FAILURE;
+
+  TilePool pool(options.threads);
+
+  for (int level = 0; level < info.num_levels; level++) {
+    const nanostream_pyramid_level& l = info.levels[level];
+    unsigned char* level_packets = packets + static_cast<size_t>(l.first_tile) * NANOSTREAM_PACKET_SIZE;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    if (level == 0) {
+      pool.run(l.tiles_x * l.tiles_y, 4, [&](const int first, const int count) {
+        unsigned char* out = level_packets + static_cast<size_t>(first) * NANOSTREAM_PACKET_SIZE;
+        nanostream_encode_frame(
+          rgb, l.width, l.height, static_cast<int>(raster.pitch()), options.padding, first, count, out);
+      });
+    } else {
+      // Each tile row of a level only needs two tile rows of the level below, so levels are built a band at a time.
+      const size_t pitch = static_cast<size_t>(l.width) * 3;
+      PooledBuffer band(band_pool);
+
+      for (int ty = 0; ty < l.tiles_y; ty++) {
+        const int band_height = std::min(NANOSTREAM_TILE_HEIGHT, l.height - ty * NANOSTREAM_TILE_HEIGHT);
+
+        if (options.source == Source::coefficients)
+          fill_band_from_coefficients(pool, output.data(), info, level, ty, band_height, band.data());
+        else
+          fill_band_from_pixels(pool, rgb, info, level, ty, band_height, band.data());
+
+        unsigned char* row_packets = level_packets + static_cast<size_t>(ty) * l.tiles_x * NANOSTREAM_PACKET_SIZE;
+        pool.run(l.tiles_x, 1, [&](const int first, const int count) {
+          unsigned char* out = row_packets + static_cast<size_t>(first) * NANOSTREAM_PACKET_SIZE;
+          nanostream_encode_frame(
+            band.data(), l.width, band_height, static_cast<int>(pitch), options.padding, first, count, out);
+        });
+      }
+    }
+
+    const auto t1 = std::chrono::steady_clock::now();
+
+    printf("level %d: %dx%d, %dx%d tiles, %.3f ms\n",
+           level,
+           l.width,
+           l.height,
+           l.tiles_x,
+           l.tiles_y,
+           std::chrono::duration<double>(t1 - t0).count() * 1.0e3);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+auto
+open_pyramid(const char* path, MappedFile* file, nanostream_pyramid_info* info) -> bool
+{
+  if (!file->open_read(path))
+    return false;
+
+  if (nanostream_pyramid_parse_header(file->data(), file->size(), info) != 0) {
+    fprintf(stderr, "\"%s\" is not a valid nanostream pyramid\n", path);
+    return false;
+  }
+
+  return true;
+}
+
+auto
+print_info(const char* path) -> int
+{
+  MappedFile file;
+  nanostream_pyramid_info info;
+  if (!open_pyramid(path, &file, &info))
+    return EXIT_FAILURE;
+
+  for (int level = 0; level < info.num_levels; level++) {
+    const nanostream_pyramid_level& l = info.levels[level];
+    printf("level %d: %dx%d, %dx%d tiles, first tile %llu\n",
+           level,
+           l.width,
+           l.height,
+           l.tiles_x,
+           l.tiles_y,
+           static_cast<unsigned long long>(l.first_tile));
+  }
+
+  return EXIT_SUCCESS;
+}
+
+auto
+extract_tile(const char* path, const int level, const int x, const int y, const char* output_path) -> int
+{
+  MappedFile file;
+  nanostream_pyramid_info info;
+  if (!open_pyramid(path, &file, &info))
+    return EXIT_FAILURE;
+
+  const unsigned char* packet = nanostream_pyramid_tile(file.data(), &info, level, x, y);
+  if (!packet) {
+    fprintf(stderr, "there is no tile %d/%d/%d\n", level, x, y);
+    return EXIT_FAILURE;
+  }
+
+  char header[32];
+  const size_t header_size = format_ppm_header(header, NANOSTREAM_TILE_WIDTH, NANOSTREAM_TILE_HEIGHT);
+
+  MappedFile output;
+  if (!output.create(output_path, header_size + NANOSTREAM_TILE_WIDTH * NANOSTREAM_TILE_HEIGHT * 3))
+    return EXIT_FAILURE;
+
+  memcpy(output.data(), header, header_size);
+  nanostream_decode_tile(packet, NANOSTREAM_TILE_WIDTH * 3, output.data() + header_size);
+  return EXIT_SUCCESS;
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  if ((argc >= 4) && (strcmp(argv[1], "build") == 0)) {
+    Options options;
+    if (!parse_options(argc, argv, 4, &options))
+      return EXIT_FAILURE;
+    return build(argv[2], argv[3], options);
+  }
+
+  if ((argc == 3) && (strcmp(argv[1], "info") == 0))
+    return print_info(argv[2]);
+
+  if ((argc == 7) && (strcmp(argv[1], "tile") == 0))
+    return extract_tile(argv[2], atoi(argv[3]), atoi(argv[4]), atoi(argv[5]), argv[6]);
+
+  print_usage(argv[0]);
+  return EXIT_FAILURE;
+}
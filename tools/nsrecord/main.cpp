@@ -0,0 +1,333 @@
+#include "../common/clock.hpp"
+#include "../common/synthetic_content.hpp"
+
+#include <nanostream_frame.h>
+#include <nanostream_recorder.h>
+#include <nanostream_recording.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using namespace nanostream_tools;
+
+// The number of distinct frames encoded up front, which the streams then record over and over.
+constexpr int clip_frames = 30;
+
+struct Options
+{
+  const char* directory{ nullptr };
+
+  int streams{ 300 };
+
+  int width{ 1920 };
+
+  int height{ 1080 };
+
+  double fps{ 30.0 };
+
+  double seconds{ 10.0 };
+
+  // The threads that write the frames, each for its share of the streams.
+  int threads{ 1 };
+
+  nanostream_recorder_config recorder{};
+
+  // Keep the segments instead of removing them at the end.
+  bool keep{ false };
+};
+
+void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+          "usage: %s <directory> [--streams N] [--size <width>x<height>] [--fps N] [--duration <seconds>]\n"
+          "          [--threads N] [--segment-size <MB>] [--staging-size <KB>] [--queue-depth N] [--keep]\n",
+          program);
+}
+
+auto
+parse_options(const int argc, char** argv, Options* options) -> bool
+{
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = (i + 1) < argc;
+    if ((strcmp(argv[i], "--streams") == 0) && has_value) {
+      options->streams = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--size") == 0) && has_value) {
+      if ((sscanf(argv[++i], "%dx%d", &options->width, &options->height) != 2) || (options->width <= 0) ||
+          (options->height <= 0)) {
+        fprintf(stderr, "invalid size \"%s\"\n", argv[i]);
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--fps") == 0) && has_value) {
+      options->fps = atof(argv[++i]);
+    } else if ((strcmp(argv[i], "--duration") == 0) && has_value) {
+      options->seconds = atof(argv[++i]);
+    } else if ((strcmp(argv[i], "--threads") == 0) && has_value) {
+      options->threads = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--segment-size") == 0) && has_value) {
+      options->recorder.segment_size = static_cast<size_t>(atoi(argv[++i])) << 20;
+    } else if ((strcmp(argv[i], "--staging-size") == 0) && has_value) {
+      options->recorder.staging_size = static_cast<size_t>(atoi(argv[++i])) << 10;
+    } else if ((strcmp(argv[i], "--queue-depth") == 0) && has_value) {
+      options->recorder.queue_depth = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--keep") == 0) {
+      options->keep = true;
+    } else if ((strncmp(argv[i], "--", 2) != 0) && !options->directory) {
+      options->directory = argv[i];
+    } else {
+      fprintf(stderr, "unknown option \"%s\"\n", argv[i]);
+      return false;
+    }
+  }
+
+  if (!options->directory) {
+    fprintf(stderr, "no directory\n");
+    return false;
+  }
+  if ((options->streams <= 0) || (options->fps <= 0.0) || (options->seconds <= 0.0) || (options->threads <= 0)) {
+    fprintf(stderr, "the streams, frame rate, duration and threads must be positive\n");
+    return false;
+  }
+
+  options->recorder.directory = options->directory;
+  options->recorder.max_streams = options->streams;
+  return true;
+}
+
+auto
+stream_name(const int stream) -> std::string
+{
+  char name[32];
+  snprintf(name, sizeof(name), "nsrecord%04d", stream);
+  return name;
+}
+
+// The packets of every tile of each frame of the clip, one frame after the other.
+auto
+encode_clip(const Options& options) -> std::vector<unsigned char>
+{
+  const SyntheticContent content(ContentClass::pan, options.width, options.height, 0);
+  const int num_tiles = nanostream_frame_tiles_x(options.width) * nanostream_frame_tiles_y(options.height);
+  const size_t frame_size = static_cast<size_t>(num_tiles) * NANOSTREAM_PACKET_SIZE;
+
+  std::vector<unsigned char> clip(frame_size * clip_frames);
+  for (int i = 0; i < clip_frames; i++) {
+    nanostream_encode_frame(content.frame(static_cast<uint64_t>(i)),
+                            options.width,
+                            options.height,
+                            content.pitch(),
+                            NANOSTREAM_PADDING_EDGE,
+                            0,
+                            num_tiles,
+                            &clip[frame_size * static_cast<size_t>(i)]);
+  }
+  return clip;
+}
+
+struct Producer
+{
+  // The time each call to nanostream_recorder_write_frame took, in nanoseconds.
+  std::vector<uint64_t> latencies;
+
+  uint64_t dropped{ 0 };
+
+  // The most a frame was written after it was due, in microseconds.
+  uint64_t max_behind_us{ 0 };
+};
+
+// Writes whole frames of the streams first, first + step, ... on schedule until 'end_us', spread over a frame
+// interval as independent sources would be.
+void
+produce(nanostream_recorder* recorder,
+        const Options& options,
+        const std::vector<unsigned char>* clip,
+        const int num_tiles,
+        const int first,
+        const int step,
+        const uint64_t start_us,
+        const uint64_t end_us,
+        Producer* producer)
+{
+  const uint64_t interval_us = static_cast<uint64_t>(1.0e6 / options.fps);
+  const size_t frame_size = static_cast<size_t>(num_tiles) * NANOSTREAM_PACKET_SIZE;
+
+  struct Schedule
+  {
+    int stream;
+    uint64_t next_due_us;
+    uint64_t frames;
+  };
+  std::vector<Schedule> schedules;
+  for (int i = first; i < options.streams; i += step)
+    schedules.push_back({ i, start_us + (interval_us * static_cast<uint64_t>(i)) / options.streams, 0 });
+
+  for (;;) {
+    Schedule* next = &schedules[0];
+    for (Schedule& schedule : schedules) {
+      if (schedule.next_due_us < next->next_due_us)
+        next = &schedule;
+    }
+
+    const uint64_t due_us = next->next_due_us;
+    if (due_us >= end_us)
+      break;
+
+    const uint64_t now = now_us();
+    if (due_us > now)
+      std::this_thread::sleep_for(std::chrono::microseconds(due_us - now));
+    else
+      producer->max_behind_us = std::max(producer->max_behind_us, now - due_us);
+
+    // Each stream starts at a different frame of the clip, so the streams do not all write the same bytes.
+    const size_t frame = (next->frames + static_cast<uint64_t>(next->stream)) % clip_frames;
+    const auto t0 = std::chrono::steady_clock::now();
+    const int result =
+      nanostream_recorder_write_frame(recorder, next->stream, due_us, nullptr, &(*clip)[frame * frame_size], num_tiles);
+    const auto t1 = std::chrono::steady_clock::now();
+
+    producer->latencies.push_back(
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+    if (result != 0)
+      producer->dropped++;
+
+    next->frames++;
+    next->next_due_us += interval_us;
+  }
+}
+
+auto
+percentile(const std::vector<uint64_t>& sorted, const double q) -> double
+{
+  if (sorted.empty())
+    return 0.0;
+  const size_t i = std::min(sorted.size() - 1, static_cast<size_t>(q * static_cast<double>(sorted.size())));
+  return static_cast<double>(sorted[i]) * 1.0e-3;
+}
+
+// Removes the segments of the streams, which are numbered from zero until one is missing.
+void
+remove_segments(const Options& options)
+{
+  for (int i = 0; i < options.streams; i++) {
+    for (int sequence = 0;; sequence++) {
+      char path[4096];
+      snprintf(path, sizeof(path), "%s/%s-%06d.nsrec", options.directory, stream_name(i).c_str(), sequence);
+      if (unlink(path) != 0)
+        break;
+    }
+  }
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  Options options;
+  if (!parse_options(argc, argv, &options)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if ((mkdir(options.directory, 0755) != 0) && (errno != EEXIST)) {
+    fprintf(stderr, "failed to create \"%s\": %s\n", options.directory, strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  const int tiles_x = nanostream_frame_tiles_x(options.width);
+  const int tiles_y = nanostream_frame_tiles_y(options.height);
+  const int num_tiles = tiles_x * tiles_y;
+  const std::vector<unsigned char> clip = encode_clip(options);
+
+  nanostream_recorder* recorder = nanostream_recorder_create(&options.recorder);
+  if (!recorder) {
+    fprintf(stderr, "failed to create the recorder\n");
+    return EXIT_FAILURE;
+  }
+  for (int i = 0; i < options.streams; i++) {
+    if (nanostream_recorder_add_stream(recorder, stream_name(i).c_str(), tiles_x, tiles_y) != i) {
+      fprintf(stderr, "failed to add stream %d\n", i);
+      nanostream_recorder_destroy(recorder);
+      return EXIT_FAILURE;
+    }
+  }
+
+  const double frame_bytes = static_cast<double>(nanostream_recording_frame_head_size(num_tiles) +
+                                                 static_cast<size_t>(num_tiles) * NANOSTREAM_PACKET_SIZE);
+  printf("%d streams of %dx%d at %.1f fps for %.1f s: %.2f MB/s per stream, %.1f MB/s in all\n",
+         options.streams,
+         options.width,
+         options.height,
+         options.fps,
+         options.seconds,
+         frame_bytes * options.fps * 1.0e-6,
+         frame_bytes * options.fps * options.streams * 1.0e-6);
+  fflush(stdout);
+
+  const uint64_t start_us = now_us();
+  const uint64_t end_us = start_us + static_cast<uint64_t>(options.seconds * 1.0e6);
+
+  std::vector<Producer> producers(static_cast<size_t>(options.threads));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < options.threads; i++) {
+    threads.emplace_back(
+      produce, recorder, std::cref(options), &clip, num_tiles, i, options.threads, start_us, end_us, &producers[i]);
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  // The statistics of the run, without the staged frames that destroying the recorder flushes.
+  nanostream_recorder_stats stats{};
+  nanostream_recorder_get_stats(recorder, &stats);
+  const uint64_t stop_us = now_us();
+  nanostream_recorder_destroy(recorder);
+  const uint64_t flushed_us = now_us();
+
+  std::vector<uint64_t> latencies;
+  uint64_t dropped = 0;
+  uint64_t max_behind_us = 0;
+  for (const Producer& producer : producers) {
+    latencies.insert(latencies.end(), producer.latencies.begin(), producer.latencies.end());
+    dropped += producer.dropped;
+    max_behind_us = std::max(max_behind_us, producer.max_behind_us);
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  const double seconds = static_cast<double>(stop_us - start_us) * 1.0e-6;
+  printf("%zu frames, %llu dropped (%.2f%%), producers at most %.1f ms behind\n",
+         latencies.size(),
+         static_cast<unsigned long long>(dropped),
+         latencies.empty() ? 0.0 : 100.0 * static_cast<double>(dropped) / static_cast<double>(latencies.size()),
+         static_cast<double>(max_behind_us) * 1.0e-3);
+  printf("written %.1f MB/s (%.2f MB/s per stream), %llu writes in %llu submissions, %llu write errors, "
+         "%llu preallocation errors, %.2f s to flush at the end\n",
+         static_cast<double>(stats.bytes_written) / seconds * 1.0e-6,
+         static_cast<double>(stats.bytes_written) / seconds * 1.0e-6 / options.streams,
+         static_cast<unsigned long long>(stats.writes),
+         static_cast<unsigned long long>(stats.submits),
+         static_cast<unsigned long long>(stats.write_errors),
+         static_cast<unsigned long long>(stats.preallocation_errors),
+         static_cast<double>(flushed_us - stop_us) * 1.0e-6);
+  printf("write_frame latency: p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+         percentile(latencies, 0.50),
+         percentile(latencies, 0.99),
+         percentile(latencies, 0.999),
+         latencies.empty() ? 0.0 : static_cast<double>(latencies.back()) * 1.0e-3);
+
+  if (!options.keep)
+    remove_segments(options);
+
+  return ((stats.write_errors == 0) && (dropped == 0)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,854 @@
+#include "../common/capture.hpp"
+#include "../common/clock.hpp"
+#include "../common/link_options.hpp"
+
+#include <nanostream_assembler.h>
+#include <nanostream_feedback.h>
+#include <nanostream_frame.h>
+#include <nanostream_link.h>
+#include <nanostream_net.h>
+#include <nanostream_pacer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using namespace nanostream_tools;
+
+struct Options
+{
+  const char* input{ nullptr };
+
+  // "pcap", "recording", or null to tell by the file contents.
+  const char* format{ nullptr };
+
+  // The destination port to take from a pcap file, or zero for any.
+  int port{ 0 };
+
+  // The replay speed relative to the captured timing, or zero for as fast as possible.
+  double speed{ 1.0 };
+
+  // The socket receive buffer size, or zero for the receiver default.
+  int receive_buffer{ 0 };
+
+  // Parity added to the tiles of a recording: the tiles per group (zero for a tile row) and parity packets per group.
+  int fec_group{ 0 };
+
+  int fec_parity{ 0 };
+
+  // Append a checksum to the datagrams of a recording.
+  bool checksum{ false };
+
+  // How the frames of each stream are assembled: concealment and the bounds of the playout delay.
+  nanostream_assembler_config assembly{};
+
+  // Set to report losses back to the replaying side, which sends them again within the latency budget.
+  bool feedback{ false };
+
+  nanostream_feedback_responder_config responder{};
+
+  // Set to spread the bursts of the capture over time rather than send them back to back.
+  bool pace{ false };
+
+  nanostream_pacer_config pacer{};
+
+  // The multicast group to send to, or null for unicast, the interface it is joined on, and the number of viewers
+  // that join it. Linux only gives the loopback interface IPv4 multicast; IPv6 groups need another interface.
+  const char* multicast{ nullptr };
+
+  const char* interface{ "lo" };
+
+  int viewers{ 1 };
+
+  // Set if any link option was given, to replay through an emulated link.
+  bool use_link{ false };
+
+  nanostream_link_config link{};
+};
+
+void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+          "usage: %s <capture.pcap|recording.nsrec> [--format pcap|recording] [--port N] [--speed X | --fast]\n"
+          "          [--fec <parity per group>[,<tiles per group>]] [--checksum] [--conceal previous|neighbours]\n"
+          "          [--playout <min ms>[,<max ms>]] [--feedback <budget ms>] [--pace <max delay ms>[,<burst>]]\n"
+          "          [--kernel-pacing] [--multicast <group> [--interface <name>] [--viewers N]]\n"
+          "          [--receive-buffer <bytes>] [link options]\n"
+          "%s",
+          program,
+          link_usage);
+}
+
+auto
+parse_options(const int argc, char** argv, Options* options) -> bool
+{
+  if (argc < 2)
+    return false;
+
+  options->input = argv[1];
+
+  for (int i = 2; i < argc; i++) {
+    const bool has_value = (i + 1) < argc;
+    bool error = false;
+    if ((strcmp(argv[i], "--format") == 0) && has_value) {
+      options->format = argv[++i];
+      if ((strcmp(options->format, "pcap") != 0) && (strcmp(options->format, "recording") != 0)) {
+        fprintf(stderr, "unknown format \"%s\"\n", options->format);
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--port") == 0) && has_value) {
+      options->port = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--speed") == 0) && has_value) {
+      options->speed = atof(argv[++i]);
+      if (options->speed <= 0.0) {
+        fprintf(stderr, "the speed must be positive, use --fast for as fast as possible\n");
+        return false;
+      }
+    } else if (strcmp(argv[i], "--fast") == 0) {
+      options->speed = 0.0;
+    } else if ((strcmp(argv[i], "--fec") == 0) && has_value) {
+      if (sscanf(argv[++i], "%d,%d", &options->fec_parity, &options->fec_group) < 1 || (options->fec_parity < 1) ||
+          (options->fec_parity > NANOSTREAM_FEC_MAX_PARITY)) {
+        fprintf(stderr, "invalid parity \"%s\"\n", argv[i]);
+        return false;
+      }
+    } else if (strcmp(argv[i], "--checksum") == 0) {
+      options->checksum = true;
+    } else if ((strcmp(argv[i], "--conceal") == 0) && has_value) {
+      const char* mode = argv[++i];
+      if (strcmp(mode, "previous") == 0) {
+        options->assembly.concealment = NANOSTREAM_CONCEAL_PREVIOUS;
+      } else if (strcmp(mode, "neighbours") == 0) {
+        options->assembly.concealment = NANOSTREAM_CONCEAL_NEIGHBOURS;
+      } else {
+        fprintf(stderr, "unknown concealment \"%s\"\n", mode);
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--playout") == 0) && has_value) {
+      double min_ms = 0.0;
+      double max_ms = 0.0;
+      const int n = sscanf(argv[++i], "%lf,%lf", &min_ms, &max_ms);
+      if ((n < 1) || (min_ms < 0.0) || ((n == 2) && (max_ms < min_ms))) {
+        fprintf(stderr, "invalid playout delay \"%s\"\n", argv[i]);
+        return false;
+      }
+      options->assembly.min_delay_us = static_cast<uint64_t>(min_ms * 1000.0);
+      options->assembly.max_delay_us = static_cast<uint64_t>(((n == 2) ? max_ms : std::max(min_ms, 200.0)) * 1000.0);
+    } else if ((strcmp(argv[i], "--feedback") == 0) && has_value) {
+      const double budget_ms = atof(argv[++i]);
+      if (budget_ms <= 0.0) {
+        fprintf(stderr, "invalid latency budget \"%s\"\n", argv[i]);
+        return false;
+      }
+      options->feedback = true;
+      options->responder.budget_us = static_cast<uint64_t>(budget_ms * 1000.0);
+    } else if ((strcmp(argv[i], "--pace") == 0) && has_value) {
+      double delay_ms = 0.0;
+      const int n = sscanf(argv[++i], "%lf,%d", &delay_ms, &options->pacer.burst);
+      if ((n < 1) || (delay_ms <= 0.0) || ((n == 2) && (options->pacer.burst < 1))) {
+        fprintf(stderr, "invalid pacing \"%s\"\n", argv[i]);
+        return false;
+      }
+      options->pace = true;
+      options->pacer.max_delay_us = static_cast<uint64_t>(delay_ms * 1000.0);
+    } else if (strcmp(argv[i], "--kernel-pacing") == 0) {
+      options->pacer.kernel = 1;
+    } else if ((strcmp(argv[i], "--multicast") == 0) && has_value) {
+      options->multicast = argv[++i];
+    } else if ((strcmp(argv[i], "--interface") == 0) && has_value) {
+      options->interface = argv[++i];
+    } else if ((strcmp(argv[i], "--viewers") == 0) && has_value) {
+      options->viewers = atoi(argv[++i]);
+      if (options->viewers < 1) {
+        fprintf(stderr, "invalid number of viewers \"%s\"\n", argv[i]);
+        return false;
+      }
+    } else if ((strcmp(argv[i], "--receive-buffer") == 0) && has_value) {
+      options->receive_buffer = atoi(argv[++i]);
+    } else if (parse_link_option(argc, argv, &i, &options->link, &error)) {
+      if (error)
+        return false;
+      options->use_link = true;
+    } else {
+      fprintf(stderr, "unknown option \"%s\"\n", argv[i]);
+      return false;
+    }
+  }
+
+  if (options->pace && (options->speed == 0.0)) {
+    fprintf(stderr, "pacing needs the captured timing, not --fast\n");
+    return false;
+  }
+
+  if (options->multicast && options->use_link) {
+    fprintf(stderr, "multicast is sent straight to the group, not through an emulated link\n");
+    return false;
+  }
+
+  if (!options->multicast && (options->viewers > 1)) {
+    fprintf(stderr, "more than one viewer needs --multicast\n");
+    return false;
+  }
+
+  return true;
+}
+
+// Tells a pcap file from a recording by its first bytes.
+auto
+is_pcap(const char* path) -> bool
+{
+  FILE* file = fopen(path, "rb");
+  if (!file)
+    return false;
+  unsigned char magic[4] = { 0, 0, 0, 0 };
+  const size_t n = fread(magic, 1, sizeof(magic), file);
+  fclose(file);
+  if (n != sizeof(magic))
+    return false;
+  const uint32_t value = static_cast<uint32_t>(magic[0]) | (static_cast<uint32_t>(magic[1]) << 8) |
+                         (static_cast<uint32_t>(magic[2]) << 16) | (static_cast<uint32_t>(magic[3]) << 24);
+  return (value == 0xa1b2c3d4U) || (value == 0xd4c3b2a1U) || (value == 0xa1b23c4dU) || (value == 0x4d3cb2a1U);
+}
+
+auto
+datagram_key(const nanostream_net_header& header) -> uint64_t
+{
+  return (static_cast<uint64_t>(header.stream) << 32) | header.sequence;
+}
+
+// A datagram as the receiver saw it: which one it was, and when its tile was decoded.
+struct Arrival
+{
+  uint64_t key;
+  uint64_t time_us;
+};
+
+struct ReceiveStats
+{
+  // Read by the replay loop to know when everything arrived.
+  std::atomic<uint64_t> received{ 0 };
+  uint64_t tiles_recovered{ 0 };
+  uint64_t groups_unrecoverable{ 0 };
+  uint64_t tiles_concealed{ 0 };
+  uint64_t reordered{ 0 };
+  uint64_t first_us{ 0 };
+  uint64_t last_us{ 0 };
+  uint64_t receive_cpu_us{ 0 };
+  uint64_t decode_cpu_us{ 0 };
+  std::vector<Arrival> arrivals;
+
+  // Summed over the assemblers of all streams, except for the delays, which are the largest.
+  nanostream_assembler_stats assembly{};
+
+  nanostream_feedback_reporter_stats feedback{};
+};
+
+// Receives datagrams and assembles the frames of each stream as a viewer would, decoding every tile as it arrives,
+// until told to stop. Losses are reported through 'feedback' unless it is null.
+void
+receive_loop(nanostream_net_receiver* receiver,
+             const nanostream_assembler_config* config,
+             nanostream_net_sender* feedback,
+             const std::atomic<bool>* stop,
+             ReceiveStats* stats)
+{
+  constexpr int batch = 64;
+  nanostream_net_packet packets[batch];
+  nanostream_net_packet recovered[NANOSTREAM_FEC_MAX_PARITY];
+  std::unordered_map<int, nanostream_assembler*> assemblers;
+  std::unordered_map<int, uint32_t> highest_sequence;
+  nanostream_net_recovery* recovery = nanostream_net_recovery_create(65536);
+  const nanostream_feedback_reporter_config reporter_config{};
+  nanostream_feedback_reporter* reporter = feedback ? nanostream_feedback_reporter_create(&reporter_config) : nullptr;
+
+  const auto add = [&](const nanostream_net_packet& packet, const uint64_t now) {
+    nanostream_assembler*& assembler = assemblers[packet.header.stream];
+    if (!assembler)
+      assembler = nanostream_assembler_create(config);
+    if (!assembler)
+      return;
+    nanostream_assembler_add(assembler, now, &packet);
+    // Tell the sender once a new basis is complete, so that it can switch to it.
+    const int basis_version = nanostream_assembler_basis_version(assembler);
+    if (reporter && (packet.header.type == NANOSTREAM_NET_BASIS) && (basis_version > 0))
+      nanostream_feedback_reporter_acknowledge_basis(reporter, packet.header.stream, basis_version);
+  };
+
+  const auto release = [&](const uint64_t now) {
+    nanostream_assembled_frame frame{};
+    for (auto& entry : assemblers) {
+      while (entry.second && nanostream_assembler_release(entry.second, now, &frame))
+        stats->tiles_concealed += static_cast<uint64_t>(frame.tiles_concealed);
+    }
+  };
+
+  while (!stop->load()) {
+    // Wake up in time for the next playout deadline.
+    uint64_t next_deadline = UINT64_MAX;
+    for (const auto& entry : assemblers) {
+      if (entry.second)
+        next_deadline = std::min(next_deadline, nanostream_assembler_next_deadline(entry.second));
+    }
+    // Feedback is due every few milliseconds while losses are pending.
+    const uint64_t before = now_us();
+    const uint64_t longest_ms = reporter ? 1 : 10;
+    const int timeout_ms = (next_deadline == UINT64_MAX) ? static_cast<int>(longest_ms)
+                           : (next_deadline <= before)
+                             ? 0
+                             : static_cast<int>(std::min<uint64_t>((next_deadline - before + 999) / 1000, longest_ms));
+
+    const uint64_t t0 = thread_cpu_us();
+    const int n = nanostream_net_receive(receiver, packets, batch, timeout_ms);
+    const uint64_t t1 = thread_cpu_us();
+    stats->receive_cpu_us += t1 - t0;
+
+    for (int i = 0; i < n; i++) {
+      const nanostream_net_header& header = packets[i].header;
+
+      const auto highest = highest_sequence.find(header.stream);
+      if (highest == highest_sequence.end()) {
+        highest_sequence[header.stream] = header.sequence;
+      } else if (static_cast<int32_t>(header.sequence - highest->second) < 0) {
+        stats->reordered++;
+      } else {
+        highest->second = header.sequence;
+      }
+
+      const uint64_t arrived = now_us();
+      add(packets[i], arrived);
+      if (reporter)
+        nanostream_feedback_reporter_add(reporter, arrived, &packets[i]);
+
+      // Lost tiles rebuilt from parity are decoded as if they had arrived.
+      const int num_recovered =
+        recovery ? nanostream_net_recovery_add(recovery, &packets[i], recovered, NANOSTREAM_FEC_MAX_PARITY) : 0;
+      for (int r = 0; r < num_recovered; r++)
+        add(recovered[r], arrived);
+
+      const uint64_t t = now_us();
+      stats->arrivals.push_back(Arrival{ datagram_key(header), t });
+      if (stats->received++ == 0)
+        stats->first_us = t;
+      stats->last_us = t;
+    }
+
+    release(now_us());
+    stats->decode_cpu_us += thread_cpu_us() - t1;
+
+    if (reporter)
+      nanostream_feedback_reporter_send(reporter, now_us(), feedback);
+  }
+
+  // Whatever is still being assembled is shown as it is.
+  release(UINT64_MAX);
+
+  for (auto& entry : assemblers) {
+    if (!entry.second)
+      continue;
+    nanostream_assembler_stats s{};
+    nanostream_assembler_get_stats(entry.second, &s);
+    nanostream_assembler_stats& total = stats->assembly;
+    total.frames_complete += s.frames_complete;
+    total.frames_incomplete += s.frames_incomplete;
+    total.frames_missing += s.frames_missing;
+    total.tiles_decoded += s.tiles_decoded;
+    total.tiles_late += s.tiles_late;
+    total.tiles_duplicate += s.tiles_duplicate;
+    total.tiles_dropped += s.tiles_dropped;
+    total.playout_delay_us = std::max(total.playout_delay_us, s.playout_delay_us);
+    total.jitter_us = std::max(total.jitter_us, s.jitter_us);
+    nanostream_assembler_destroy(entry.second);
+  }
+
+  if (reporter) {
+    nanostream_feedback_reporter_get_stats(reporter, &stats->feedback);
+    nanostream_feedback_reporter_destroy(reporter);
+  }
+
+  if (recovery) {
+    stats->tiles_recovered = nanostream_net_recovery_recovered(recovery);
+    stats->groups_unrecoverable = nanostream_net_recovery_unrecoverable(recovery);
+    nanostream_net_recovery_destroy(recovery);
+  }
+}
+
+// Answers the receiver's feedback as the sender would, until told to stop. The replay cannot encode tiles again, so
+// the tiles to refresh are only counted.
+void
+feedback_loop(nanostream_net_receiver* receiver,
+              nanostream_net_sender* sender,
+              const std::unordered_map<int, nanostream_feedback_responder*>* responders,
+              const std::atomic<bool>* stop)
+{
+  constexpr int batch = 16;
+  nanostream_net_packet packets[batch];
+  int refresh_tiles[256];
+
+  while (!stop->load()) {
+    const int n = nanostream_net_receive(receiver, packets, batch, 10);
+    for (int i = 0; i < n; i++) {
+      const auto it = responders->find(packets[i].header.stream);
+      if (it != responders->end())
+        nanostream_feedback_responder_handle(it->second, now_us(), &packets[i], sender, refresh_tiles, 256);
+    }
+  }
+}
+
+auto
+percentile(const std::vector<uint64_t>& sorted, const double q) -> double
+{
+  if (sorted.empty())
+    return 0.0;
+  const size_t i = std::min(sorted.size() - 1, static_cast<size_t>(q * static_cast<double>(sorted.size())));
+  return static_cast<double>(sorted[i]) * 1.0e-3;
+}
+
+// Gaps and reordering in the capture itself, by the sequence numbers of each stream.
+void
+report_capture(const Capture& capture)
+{
+  struct Sequences
+  {
+    uint32_t highest{ 0 };
+    uint64_t count{ 0 };
+    uint64_t reordered{ 0 };
+    uint64_t gaps{ 0 };
+  };
+
+  std::map<int, Sequences> streams;
+  for (size_t i = 0; i < capture.size(); i++) {
+    nanostream_net_header header{};
+    nanostream_net_parse_header(capture.datagram(i), capture.datagram_size(i), &header);
+    Sequences& s = streams[header.stream];
+    if (s.count++ == 0) {
+      s.highest = header.sequence;
+    } else if (static_cast<int32_t>(header.sequence - s.highest) > 0) {
+      s.gaps += header.sequence - s.highest - 1;
+      s.highest = header.sequence;
+    } else {
+      // A late datagram fills a gap counted earlier.
+      s.reordered++;
+      s.gaps -= (s.gaps > 0) ? 1 : 0;
+    }
+  }
+
+  uint64_t gaps = 0;
+  uint64_t reordered = 0;
+  for (const auto& entry : streams) {
+    gaps += entry.second.gaps;
+    reordered += entry.second.reordered;
+  }
+
+  const double seconds = static_cast<double>(capture.time_us(capture.size() - 1) - capture.time_us(0)) * 1.0e-6;
+  printf("capture: %zu datagrams of %zu streams over %.3f s, %llu missing and %llu out of order, %llu skipped\n",
+         capture.size(),
+         streams.size(),
+         seconds,
+         static_cast<unsigned long long>(gaps),
+         static_cast<unsigned long long>(reordered),
+         static_cast<unsigned long long>(capture.skipped()));
+}
+
+auto
+replay(const Options& options, const Capture& capture) -> int
+{
+  // With multicast, every viewer joins the group with a receiver of its own, as viewers on different hosts would, and
+  // the first one picks the port.
+  std::vector<nanostream_net_receiver*> receivers;
+  for (int i = 0; i < options.viewers; i++) {
+    const int group_port = receivers.empty() ? 0 : nanostream_net_receiver_port(receivers[0]);
+    nanostream_net_receiver* r =
+      options.multicast
+        ? nanostream_net_receiver_join(options.multicast, group_port, options.interface, options.receive_buffer)
+        : nanostream_net_receiver_create("127.0.0.1", 0, options.receive_buffer);
+    if (!r)
+      break;
+    receivers.push_back(r);
+  }
+  const auto close_receivers = [&]() {
+    for (nanostream_net_receiver* r : receivers)
+      nanostream_net_receiver_destroy(r);
+  };
+
+  nanostream_net_receiver* receiver =
+    (static_cast<int>(receivers.size()) == options.viewers) ? receivers[0] : nullptr;
+  nanostream_link_relay* relay =
+    (receiver && options.use_link)
+      ? nanostream_link_relay_create(&options.link, "127.0.0.1", 0, "127.0.0.1", nanostream_net_receiver_port(receiver))
+      : nullptr;
+  const int port = relay ? nanostream_link_relay_port(relay) : (receiver ? nanostream_net_receiver_port(receiver) : 0);
+  const auto open_sender = [&]() -> nanostream_net_sender* {
+    const char* host = options.multicast ? options.multicast : "127.0.0.1";
+    nanostream_net_sender* s = nanostream_net_sender_create(host, port, 0);
+    if (s && options.multicast && (nanostream_net_sender_set_multicast(s, options.interface, 0) != 0)) {
+      nanostream_net_sender_destroy(s);
+      return nullptr;
+    }
+    return s;
+  };
+  nanostream_net_sender* sender = (receiver && (relay || !options.use_link)) ? open_sender() : nullptr;
+  if (!sender) {
+    fprintf(stderr, "failed to open the loopback sockets\n");
+    nanostream_link_relay_destroy(relay);
+    close_receivers();
+    return EXIT_FAILURE;
+  }
+
+  // Feedback goes straight back over loopback, bypassing the emulated link, and retransmissions go out through the
+  // link like the rest.
+  nanostream_net_receiver* feedback_receiver = nullptr;
+  nanostream_net_sender* feedback_sender = nullptr;
+  nanostream_net_sender* retransmit_sender = nullptr;
+  std::unordered_map<int, nanostream_feedback_responder*> responders;
+  if (options.feedback) {
+    feedback_receiver = nanostream_net_receiver_create("127.0.0.1", 0, 0);
+    feedback_sender = feedback_receiver
+                        ? nanostream_net_sender_create("127.0.0.1", nanostream_net_receiver_port(feedback_receiver), 0)
+                        : nullptr;
+    retransmit_sender = open_sender();
+    for (size_t i = 0; i < capture.size(); i++) {
+      nanostream_net_header header{};
+      nanostream_net_parse_header(capture.datagram(i), capture.datagram_size(i), &header);
+      nanostream_feedback_responder*& responder = responders[header.stream];
+      if (!responder)
+        responder = nanostream_feedback_responder_create(&options.responder);
+    }
+  }
+
+  const auto close_feedback = [&]() {
+    for (auto& entry : responders)
+      nanostream_feedback_responder_destroy(entry.second);
+    nanostream_net_sender_destroy(retransmit_sender);
+    nanostream_net_sender_destroy(feedback_sender);
+    nanostream_net_receiver_destroy(feedback_receiver);
+  };
+
+  // With pacing, the capture is sent through a pacer, whose delay counts towards the latency.
+  nanostream_pacer* pacer = options.pace ? nanostream_pacer_create(&options.pacer, sender) : nullptr;
+  if (options.pace && !pacer) {
+    fprintf(stderr, "failed to create the pacer\n");
+    close_feedback();
+    nanostream_net_sender_destroy(sender);
+    nanostream_link_relay_destroy(relay);
+    close_receivers();
+    return EXIT_FAILURE;
+  }
+
+  if (options.feedback &&
+      (!feedback_sender || !retransmit_sender ||
+       std::any_of(responders.begin(), responders.end(), [](const auto& entry) { return !entry.second; }))) {
+    fprintf(stderr, "failed to set up the feedback channel\n");
+    nanostream_pacer_destroy(pacer);
+    close_feedback();
+    nanostream_net_sender_destroy(sender);
+    nanostream_link_relay_destroy(relay);
+    close_receivers();
+    return EXIT_FAILURE;
+  }
+
+  // The statistics are those of the first viewer, with a summary of the others.
+  ReceiveStats stats;
+  stats.arrivals.reserve(capture.size());
+  std::vector<std::unique_ptr<ReceiveStats>> other_stats;
+  std::atomic<bool> stop{ false };
+  std::atomic<bool> stop_feedback{ false };
+  std::thread receive_thread(receive_loop, receiver, &options.assembly, feedback_sender, &stop, &stats);
+  std::vector<std::thread> other_threads;
+  for (size_t i = 1; i < receivers.size(); i++) {
+    other_stats.push_back(std::make_unique<ReceiveStats>());
+    other_threads.emplace_back(
+      receive_loop, receivers[i], &options.assembly, feedback_sender, &stop, other_stats.back().get());
+  }
+  std::thread feedback_thread;
+  if (options.feedback)
+    feedback_thread = std::thread(feedback_loop, feedback_receiver, retransmit_sender, &responders, &stop_feedback);
+
+  // When each datagram was due to be sent. Latency is measured from there to its tile being decoded, so it includes
+  // any lag of the sender behind the captured timing.
+  std::vector<uint64_t> due(capture.size());
+
+  // The pacer takes a whole burst at once, since it cannot reschedule what it already handed to the kernel.
+  const size_t batch = pacer ? 4096 : 64;
+  std::vector<const unsigned char*> datagrams(batch);
+  std::vector<size_t> sizes(batch);
+
+  const uint64_t start_us = now_us();
+  const uint64_t first_capture_us = capture.time_us(0);
+  uint64_t sent = 0;
+
+  for (size_t i = 0; i < capture.size();) {
+    const uint64_t now = now_us();
+    if (pacer)
+      nanostream_pacer_send(pacer, now);
+    uint64_t due_us = now;
+    if (options.speed > 0.0) {
+      const double offset = static_cast<double>(capture.time_us(i) - first_capture_us) / options.speed;
+      due_us = start_us + static_cast<uint64_t>(offset);
+      if (due_us > now) {
+        const uint64_t wake_us = pacer ? std::min(due_us, nanostream_pacer_next_send(pacer)) : due_us;
+        if (wake_us > now)
+          std::this_thread::sleep_for(std::chrono::microseconds(wake_us - now));
+        continue;
+      }
+    }
+
+    // Everything that is due goes out in one batch, so bursts in the capture stay bursts.
+    size_t n = 0;
+    for (; (n < batch) && (i + n < capture.size()); n++) {
+      if (options.speed > 0.0) {
+        const double offset = static_cast<double>(capture.time_us(i + n) - first_capture_us) / options.speed;
+        const uint64_t t = start_us + static_cast<uint64_t>(offset);
+        if ((n > 0) && (t > now))
+          break;
+        due[i + n] = t;
+      } else {
+        due[i + n] = now;
+      }
+      datagrams[n] = capture.datagram(i + n);
+      sizes[n] = capture.datagram_size(i + n);
+    }
+
+    // Copies are kept before sending, so feedback never arrives for a datagram the responder has not seen.
+    if (options.feedback) {
+      for (size_t j = 0; j < n; j++) {
+        nanostream_net_header header{};
+        if (nanostream_net_parse_header(datagrams[j], sizes[j], &header) == 0)
+          nanostream_feedback_responder_store(responders[header.stream], now, datagrams[j], sizes[j]);
+      }
+    }
+
+    if (pacer) {
+      nanostream_pacer_submit(pacer, now, datagrams.data(), sizes.data(), static_cast<int>(n));
+    } else {
+      sent += static_cast<uint64_t>(
+        nanostream_net_send_datagrams(sender, datagrams.data(), sizes.data(), static_cast<int>(n)));
+    }
+    i += n;
+  }
+
+  nanostream_pacer_stats pacer_stats{};
+  if (pacer) {
+    // Let the pacer drain.
+    for (uint64_t next = nanostream_pacer_next_send(pacer); next != UINT64_MAX;) {
+      const uint64_t now = now_us();
+      if (next > now)
+        std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+      nanostream_pacer_send(pacer, now_us());
+      next = nanostream_pacer_next_send(pacer);
+    }
+    nanostream_pacer_get_stats(pacer, &pacer_stats);
+    nanostream_pacer_destroy(pacer);
+    sent = pacer_stats.datagrams_sent;
+  }
+
+  const uint64_t send_end_us = now_us();
+
+  // Wait until everything arrived, or nothing more arrives for a while, allowing for the delay of the link.
+  const uint64_t quiet_us = 200000 + (options.use_link ? options.link.delay_us + options.link.jitter_us +
+                                                           options.link.reorder_delay_us + options.link.max_queue_us
+                                                       : 0);
+  uint64_t last_count = 0;
+  uint64_t idle_since = now_us();
+  for (;;) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint64_t count = stats.received.load();
+    for (const auto& s : other_stats)
+      count = std::min(count, s->received.load());
+    if (count + nanostream_net_receiver_invalid(receiver) >= sent)
+      break;
+    if (count != last_count) {
+      last_count = count;
+      idle_since = now_us();
+    } else if (now_us() - idle_since > quiet_us) {
+      break;
+    }
+  }
+
+  stop = true;
+  receive_thread.join();
+  for (std::thread& thread : other_threads)
+    thread.join();
+  stop_feedback = true;
+  if (feedback_thread.joinable())
+    feedback_thread.join();
+
+  nanostream_feedback_responder_stats responder_stats{};
+  for (const auto& entry : responders) {
+    nanostream_feedback_responder_stats s{};
+    nanostream_feedback_responder_get_stats(entry.second, &s);
+    responder_stats.feedback_received += s.feedback_received;
+    responder_stats.retransmitted += s.retransmitted;
+    responder_stats.expired += s.expired;
+    responder_stats.forgotten += s.forgotten;
+    responder_stats.refreshes += s.refreshes;
+    responder_stats.round_trip_us = std::max(responder_stats.round_trip_us, s.round_trip_us);
+  }
+  close_feedback();
+
+  nanostream_link_stats link_stats{};
+  if (relay) {
+    nanostream_link_relay_get_stats(relay, &link_stats);
+    nanostream_link_relay_destroy(relay);
+  }
+
+  const uint64_t invalid = nanostream_net_receiver_invalid(receiver);
+  const uint64_t corrupted = nanostream_net_receiver_corrupted(receiver);
+  nanostream_net_sender_destroy(sender);
+  close_receivers();
+
+  // Match arrivals to the datagrams they came from. A key can occur more than once in a capture (retransmissions),
+  // so arrivals of a key are matched to its datagrams in order.
+  std::unordered_map<uint64_t, std::vector<size_t>> datagrams_of_key;
+  for (size_t i = 0; i < capture.size(); i++) {
+    nanostream_net_header header{};
+    nanostream_net_parse_header(capture.datagram(i), capture.datagram_size(i), &header);
+    datagrams_of_key[datagram_key(header)].push_back(i);
+  }
+
+  std::unordered_map<uint64_t, size_t> matched;
+  std::vector<uint64_t> latencies;
+  latencies.reserve(stats.arrivals.size());
+  for (const Arrival& arrival : stats.arrivals) {
+    const auto it = datagrams_of_key.find(arrival.key);
+    if (it == datagrams_of_key.end())
+      continue;
+    size_t& next = matched[arrival.key];
+    if (next >= it->second.size())
+      continue;
+    const uint64_t due_us = due[it->second[next++]];
+    latencies.push_back((arrival.time_us > due_us) ? arrival.time_us - due_us : 0);
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  const double send_seconds = static_cast<double>(send_end_us - start_us) * 1.0e-6;
+  const double receive_seconds = std::max(static_cast<double>(stats.last_us - stats.first_us) * 1.0e-6, 1.0e-6);
+  const uint64_t received = stats.received.load();
+  const uint64_t dropped = sent - std::min(sent, received + invalid);
+
+  if (options.speed > 0.0) {
+    printf("replay: %.3f s at %gx\n", send_seconds, options.speed);
+  } else {
+    printf("replay: %.3f s as fast as possible\n", send_seconds);
+  }
+  if (options.pace) {
+    static const char* const pacing_names[] = { "user space", "SO_TXTIME", "SO_MAX_PACING_RATE" };
+    printf("pacing: %s, %llu sent, %llu dropped, longest delay %.3f ms, last rate %.1f Mbit/s\n",
+           pacing_names[pacer_stats.pacing],
+           static_cast<unsigned long long>(pacer_stats.datagrams_sent),
+           static_cast<unsigned long long>(pacer_stats.datagrams_dropped),
+           static_cast<double>(pacer_stats.longest_delay_us) * 1.0e-3,
+           static_cast<double>(pacer_stats.rate_bytes_per_second) * 8.0e-6);
+  }
+  if (options.use_link)
+    print_link_stats(link_stats);
+  printf("datagrams: %llu sent, %llu received, %llu invalid (%llu corrupted), %llu dropped (%.3f%%), "
+         "%llu out of order\n",
+         static_cast<unsigned long long>(sent),
+         static_cast<unsigned long long>(received),
+         static_cast<unsigned long long>(invalid),
+         static_cast<unsigned long long>(corrupted),
+         static_cast<unsigned long long>(dropped),
+         (sent > 0) ? 100.0 * static_cast<double>(dropped) / static_cast<double>(sent) : 0.0,
+         static_cast<unsigned long long>(stats.reordered));
+  if ((stats.tiles_recovered > 0) || (stats.groups_unrecoverable > 0)) {
+    printf("parity: %llu tiles rebuilt, %llu groups still missing tiles\n",
+           static_cast<unsigned long long>(stats.tiles_recovered),
+           static_cast<unsigned long long>(stats.groups_unrecoverable));
+  }
+  // Every viewer reports its own losses.
+  nanostream_feedback_reporter_stats feedback = stats.feedback;
+  for (const auto& s : other_stats) {
+    feedback.feedback_sent += s->feedback.feedback_sent;
+    feedback.reported += s->feedback.reported;
+    feedback.repaired += s->feedback.repaired;
+  }
+  if (options.feedback) {
+    printf("feedback: %llu sent, %llu losses reported, %llu sent again, %llu too late to, %llu no longer kept, "
+           "%llu repaired, %llu tiles to refresh, round trip %.3f ms\n",
+           static_cast<unsigned long long>(feedback.feedback_sent),
+           static_cast<unsigned long long>(feedback.reported),
+           static_cast<unsigned long long>(responder_stats.retransmitted),
+           static_cast<unsigned long long>(responder_stats.expired),
+           static_cast<unsigned long long>(responder_stats.forgotten),
+           static_cast<unsigned long long>(feedback.repaired),
+           static_cast<unsigned long long>(responder_stats.refreshes),
+           static_cast<double>(responder_stats.round_trip_us) * 1.0e-3);
+  }
+  const nanostream_assembler_stats& assembly = stats.assembly;
+  printf("frames: %llu complete, %llu shown incomplete with %llu tiles concealed from neighbours, %llu never seen\n",
+         static_cast<unsigned long long>(assembly.frames_complete),
+         static_cast<unsigned long long>(assembly.frames_incomplete),
+         static_cast<unsigned long long>(stats.tiles_concealed),
+         static_cast<unsigned long long>(assembly.frames_missing));
+  printf("playout: delay %.3f ms, jitter %.3f ms, %llu tiles late, %llu duplicate, %llu dropped\n",
+         static_cast<double>(assembly.playout_delay_us) * 1.0e-3,
+         static_cast<double>(assembly.jitter_us) * 1.0e-3,
+         static_cast<unsigned long long>(assembly.tiles_late),
+         static_cast<unsigned long long>(assembly.tiles_duplicate),
+         static_cast<unsigned long long>(assembly.tiles_dropped));
+  printf("receive: %.0f packets/s, %.0f tiles/s decoded, %.2f us receive and %.2f us decode CPU per packet\n",
+         static_cast<double>(received) / receive_seconds,
+         static_cast<double>(assembly.tiles_decoded) / receive_seconds,
+         (received > 0) ? static_cast<double>(stats.receive_cpu_us) / static_cast<double>(received) : 0.0,
+         (received > 0) ? static_cast<double>(stats.decode_cpu_us) / static_cast<double>(received) : 0.0);
+  printf("latency from due to decoded: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, p99.9 %.3f ms, max %.3f ms\n",
+         percentile(latencies, 0.50),
+         percentile(latencies, 0.90),
+         percentile(latencies, 0.99),
+         percentile(latencies, 0.999),
+         latencies.empty() ? 0.0 : static_cast<double>(latencies.back()) * 1.0e-3);
+
+  if (options.multicast) {
+    // The sender sent each datagram once, whatever the number of viewers.
+    printf("multicast: %d viewers of %s\n", options.viewers, options.multicast);
+    for (size_t i = 0; i < other_stats.size(); i++) {
+      const ReceiveStats& s = *other_stats[i];
+      printf("viewer %zu: %llu datagrams received, %llu frames complete, %llu shown incomplete, %llu never seen\n",
+             i + 2,
+             static_cast<unsigned long long>(s.received.load()),
+             static_cast<unsigned long long>(s.assembly.frames_complete),
+             static_cast<unsigned long long>(s.assembly.frames_incomplete),
+             static_cast<unsigned long long>(s.assembly.frames_missing));
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  Options options;
+  if (!parse_options(argc, argv, &options)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const bool pcap = options.format ? (strcmp(options.format, "pcap") == 0) : is_pcap(options.input);
+
+  Capture capture;
+  if (pcap && ((options.fec_parity > 0) || options.checksum)) {
+    fprintf(stderr, "parity and checksums can only be added to recordings; a capture carries what was sent\n");
+    return EXIT_FAILURE;
+  }
+  if (!(pcap ? capture.load_pcap(options.input, options.port)
+             : capture.load_recording(options.input, options.fec_group, options.fec_parity, options.checksum)))
+    return EXIT_FAILURE;
+
+  report_capture(capture);
+
+  return replay(options, capture);
+}
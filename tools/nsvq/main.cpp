@@ -0,0 +1,217 @@
+#include "../common/image.hpp"
+
+#include <nanostream.h>
+#include <nanostream_vq.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace nanostream_tools;
+
+constexpr int tile_pitch = NANOSTREAM_TILE_WIDTH * 3;
+
+constexpr size_t tile_size = static_cast<size_t>(tile_pitch) * NANOSTREAM_TILE_HEIGHT;
+
+// Decoding a tile takes microseconds, so each image is decoded this many times to time it.
+constexpr int decode_repeats = 16;
+
+struct Options
+{
+  nanostream_vq_trainer_config trainer{};
+};
+
+void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+          "usage:\n"
+          "  %s train <output.nsv> <input.ppm>... [--blocks-per-image N] [--iterations N] [--seed N]\n"
+          "  %s eval <codebook.nsv> <input.ppm>...\n",
+          program,
+          program);
+}
+
+// Splits the arguments from 'first' on into options and input paths.
+auto
+parse_arguments(const int argc, char** argv, const int first, Options* options, std::vector<const char*>* inputs)
+  -> bool
+{
+  auto parse_option = [options](const char* option, const char* value) {
+    if (strcmp(option, "--blocks-per-image") == 0)
+      options->trainer.blocks_per_image = atoi(value);
+    else if (strcmp(option, "--iterations") == 0)
+      options->trainer.iterations = atoi(value);
+    else if (strcmp(option, "--seed") == 0)
+      options->trainer.seed = static_cast<unsigned>(strtoul(value, nullptr, 10));
+    else
+      return false;
+    return true;
+  };
+  if (!parse_inputs(argc, argv, first, parse_option, inputs))
+    return false;
+  if ((options->trainer.blocks_per_image < 0) || (options->trainer.iterations < 0)) {
+    fprintf(stderr, "the blocks per image and the iterations must not be negative\n");
+    return false;
+  }
+  return true;
+}
+
+auto
+train(const char* output_path, const std::vector<const char*>& inputs, const Options& options) -> int
+{
+  nanostream_vq_trainer* trainer = nanostream_vq_trainer_create(&options.trainer);
+  if (!trainer) {
+    fprintf(stderr, "failed to create the trainer\n");
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+  for (const char* path : inputs) {
+    MappedFile file;
+    Raster raster;
+    if (!open_image(path, &file, &raster) ||
+        (nanostream_vq_trainer_add_image(
+           trainer, file.data() + raster.offset, raster.width, raster.height, static_cast<int>(raster.pitch())) != 0)) {
+      result = EXIT_FAILURE;
+      break;
+    }
+  }
+
+  std::vector<unsigned char> codebook(NANOSTREAM_VQ_CODEBOOK_SIZE);
+  const auto t0 = std::chrono::steady_clock::now();
+  if ((result == EXIT_SUCCESS) && (nanostream_vq_trainer_train(trainer, codebook.data()) != 0)) {
+    fprintf(stderr, "failed to train the codebook, or too few blocks were sampled\n");
+    result = EXIT_FAILURE;
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  nanostream_vq_trainer_destroy(trainer);
+
+  MappedFile output;
+  if ((result == EXIT_SUCCESS) && output.create(output_path, codebook.size())) {
+    memcpy(output.data(), codebook.data(), codebook.size());
+    printf("codebook from %zu images in %.2f s\n", inputs.size(), std::chrono::duration<double>(t1 - t0).count());
+  } else {
+    result = EXIT_FAILURE;
+  }
+  return result;
+}
+
+// Codes the whole tiles of each image with the eigen codec and with the codebook, and compares quality and the
+// encode and decode times per tile.
+auto
+evaluate(const char* codebook_path, const std::vector<const char*>& inputs) -> int
+{
+  MappedFile codebook;
+  if (!codebook.open_read(codebook_path))
+    return EXIT_FAILURE;
+  if (codebook.size() != NANOSTREAM_VQ_CODEBOOK_SIZE) {
+    fprintf(stderr, "\"%s\" is not a codebook\n", codebook_path);
+    return EXIT_FAILURE;
+  }
+
+  printf("%-32s %7s %7s %11s %11s %11s %11s\n",
+         "image",
+         "eigen",
+         "vq",
+         "encode us",
+         "vq encode",
+         "decode us",
+         "vq decode");
+
+  int result = EXIT_SUCCESS;
+  for (const char* path : inputs) {
+    MappedFile file;
+    Raster raster;
+    if (!open_image(path, &file, &raster)) {
+      result = EXIT_FAILURE;
+      continue;
+    }
+
+    const int tiles_x = raster.width / NANOSTREAM_TILE_WIDTH;
+    const int num_tiles = tiles_x * (raster.height / NANOSTREAM_TILE_HEIGHT);
+    if (num_tiles == 0) {
+      fprintf(stderr, "\"%s\" is smaller than a tile\n", path);
+      result = EXIT_FAILURE;
+      continue;
+    }
+
+    const int pitch = static_cast<int>(raster.pitch());
+    auto tile_at = [&](const int i) {
+      return static_cast<size_t>(i / tiles_x) * NANOSTREAM_TILE_HEIGHT * pitch +
+             static_cast<size_t>(i % tiles_x) * tile_pitch;
+    };
+    const unsigned char* rgb = file.data() + raster.offset;
+    std::vector<unsigned char> packets(static_cast<size_t>(num_tiles) * NANOSTREAM_PACKET_SIZE);
+    std::vector<unsigned char> decoded(raster.pixel_size());
+
+    double errors[2];
+    double encode_us[2];
+    double decode_us[2];
+    for (int codec = 0; codec < 2; codec++) {
+      const auto t0 = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_tiles; i++) {
+        unsigned char* packet = &packets[static_cast<size_t>(i) * NANOSTREAM_PACKET_SIZE];
+        if (codec == 0)
+          nanostream_encode_tile(rgb + tile_at(i), pitch, packet);
+        else
+          nanostream_vq_encode_tile(codebook.data(), rgb + tile_at(i), pitch, packet);
+      }
+      const auto t1 = std::chrono::steady_clock::now();
+      for (int repeat = 0; repeat < decode_repeats; repeat++) {
+        for (int i = 0; i < num_tiles; i++) {
+          const unsigned char* packet = &packets[static_cast<size_t>(i) * NANOSTREAM_PACKET_SIZE];
+          if (codec == 0)
+            nanostream_decode_tile(packet, pitch, &decoded[tile_at(i)]);
+          else
+            nanostream_vq_decode_tile(codebook.data(), packet, pitch, &decoded[tile_at(i)]);
+        }
+      }
+      const auto t2 = std::chrono::steady_clock::now();
+
+      errors[codec] = 0.0;
+      for (int i = 0; i < num_tiles; i++) {
+        for (int row = 0; row < NANOSTREAM_TILE_HEIGHT; row++) {
+          const size_t at = tile_at(i) + static_cast<size_t>(row) * pitch;
+          errors[codec] += squared_error(rgb + at, &decoded[at], tile_pitch);
+        }
+      }
+      encode_us[codec] = std::chrono::duration<double, std::micro>(t1 - t0).count() / num_tiles;
+      decode_us[codec] = std::chrono::duration<double, std::micro>(t2 - t1).count() / (num_tiles * decode_repeats);
+    }
+
+    const double values = static_cast<double>(num_tiles) * tile_size;
+    printf("%-32s %7.2f %7.2f %11.1f %11.1f %11.2f %11.2f\n",
+           path,
+           psnr(errors[0], values),
+           psnr(errors[1], values),
+           encode_us[0],
+           encode_us[1],
+           decode_us[0],
+           decode_us[1]);
+  }
+  return result;
+}
+
+} // namespace
+
+auto
+main(int argc, char** argv) -> int
+{
+  Options options;
+  return train_or_evaluate(
+    argc,
+    argv,
+    print_usage,
+    [&options](const int argc, char** argv, const int first, std::vector<const char*>* inputs) {
+      return parse_arguments(argc, argv, first, &options, inputs);
+    },
+    [&options](const char* output_path, const std::vector<const char*>& inputs) {
+      return train(output_path, inputs, options);
+    },
+    evaluate);
+}